@@ -108,6 +108,31 @@ void ATTR_ROW::Replace(const uint16_t beginIndex, const uint16_t endIndex, const
     _data.replace(beginIndex, endIndex, newAttr);
 }
 
+// Routine Description:
+// - Copies the attributes of a range of columns from another row, run by run.
+// Arguments:
+// - source - the row to copy the attributes from
+// - sourceBegin, sourceEnd - the [sourceBegin, sourceEnd) range of the source row to copy
+// - target - the column of this row the range is copied to
+// Return Value:
+// - <none>
+void ATTR_ROW::CopyRange(const ATTR_ROW& source, const uint16_t sourceBegin, const uint16_t sourceEnd, const uint16_t target)
+{
+    const auto slice = source._data.slice(sourceBegin, sourceEnd);
+    const auto& runs = slice.runs();
+    _data.replace(target, gsl::narrow<uint16_t>(target + slice.size()), { runs.data(), runs.size() });
+}
+
+// Routine Description:
+// - Gets the runs of attributes this row is encoded with.
+// Return Value:
+// - the runs of attributes, covering the whole width of the row
+gsl::span<const ATTR_ROW::run_type> ATTR_ROW::GetRuns() const noexcept
+{
+    const auto& runs = _data.runs();
+    return { runs.data(), runs.size() };
+}
+
 ATTR_ROW::const_iterator ATTR_ROW::begin() const noexcept
 {
     return _data.begin();
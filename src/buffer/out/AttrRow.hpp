@@ -29,6 +29,7 @@ class ATTR_ROW final
 
 public:
     using const_iterator = rle_vector::const_iterator;
+    using run_type = rle_vector::rle_type;
 
     ATTR_ROW(uint16_t width, TextAttribute attr);
 
@@ -42,11 +43,13 @@ public:
 
     TextAttribute GetAttrByColumn(uint16_t column) const;
     std::vector<uint16_t> GetHyperlinks() const;
+    gsl::span<const run_type> GetRuns() const noexcept;
 
     bool SetAttrToEnd(uint16_t beginIndex, TextAttribute attr);
     void ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith);
     void Resize(uint16_t newWidth);
     void Replace(uint16_t beginIndex, uint16_t endIndex, const TextAttribute& newAttr);
+    void CopyRange(const ATTR_ROW& source, uint16_t sourceBegin, uint16_t sourceEnd, uint16_t target);
 
     const_iterator begin() const noexcept;
     const_iterator end() const noexcept;
@@ -5,21 +5,19 @@
 
 #include "CharRow.hpp"
 #include "unicode.hpp"
-#include "Row.hpp"
 
 // Routine Description:
 // - constructor
 // Arguments:
 // - rowWidth - the size (in wchar_t) of the char and attribute rows
-// - pParent - the parent ROW
 // Return Value:
 // - instantiated object
 // Note: will through if unable to allocate char/attribute buffers
 #pragma warning(push)
 #pragma warning(disable : 26447) // small_vector's constructor says it can throw but it should not given how we use it.  This suppresses this error for the AuditMode build.
-CharRow::CharRow(size_t rowWidth, ROW* const pParent) noexcept :
+CharRow::CharRow(size_t rowWidth) noexcept :
     _data(rowWidth, value_type()),
-    _pParent{ FAIL_FAST_IF_NULL(pParent) }
+    _glyphs{}
 {
 }
 #pragma warning(pop)
@@ -47,6 +45,18 @@ void CharRow::Reset() noexcept
     {
         cell.Reset();
     }
+    _glyphs.clear();
+}
+
+// Routine Description:
+// - Releases the memory of all cells and glyphs. The row has a size of 0
+//   afterwards, until it's resized again. Rows that fit into the inline
+//   storage of the cells only give back their glyphs.
+void CharRow::Release() noexcept
+{
+    _data.clear();
+    _data.shrink_to_fit();
+    std::wstring{}.swap(_glyphs);
 }
 
 // Routine Description:
@@ -61,6 +71,12 @@ void CharRow::Reset() noexcept
     {
         const value_type insertVals;
         _data.resize(newSize, insertVals);
+
+        // Release the glyphs of the columns we just cut off.
+        if (!_glyphs.empty())
+        {
+            CompactGlyphs();
+        }
     }
     CATCH_RETURN();
 
@@ -178,6 +194,51 @@ void CharRow::ClearGlyph(const size_t column)
     _data.at(column).EraseChars();
 }
 
+// Routine Description:
+// - copies a run of cells, including their glyphs and double byte attributes, from another row
+//   or from elsewhere in this row. The runs may overlap if they're in the same row.
+// Arguments:
+// - source - the row to copy the cells from. Can be this row.
+// - sourceBegin - the first column to copy
+// - sourceEnd - one past the last column to copy
+// - target - the column of this row to copy the first cell to
+// Note: will throw exception if either range is out of bounds
+void CharRow::CopyCells(const CharRow& source, const size_t sourceBegin, const size_t sourceEnd, const size_t target)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceBegin > sourceEnd || sourceEnd > source._data.size());
+    THROW_HR_IF(E_INVALIDARG, target > _data.size() || sourceEnd - sourceBegin > _data.size() - target);
+
+    // Stored glyphs of this row stay where they are, so the cells that refer
+    // to them can just be moved. Walk backwards when moving right, so that
+    // none of them are overwritten before they're moved.
+    if (&source == this)
+    {
+        const auto first = _data.begin() + sourceBegin;
+        const auto last = _data.begin() + sourceEnd;
+        if (target > sourceBegin)
+        {
+            std::copy_backward(first, last, _data.begin() + target + (sourceEnd - sourceBegin));
+        }
+        else
+        {
+            std::copy(first, last, _data.begin() + target);
+        }
+        return;
+    }
+
+    for (size_t column = sourceBegin, destination = target; column < sourceEnd; ++column, ++destination)
+    {
+        const auto& cell = til::at(source._data, column);
+        til::at(_data, destination) = cell;
+
+        // Stored glyphs refer to the glyph storage of their row and have to move over.
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            StoreGlyph(destination, source.GlyphData(cell));
+        }
+    }
+}
+
 // Routine Description:
 // - returns text data at column as a const reference.
 // Arguments:
@@ -250,32 +311,91 @@ const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::w
     }
 }
 
-UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
+// Routine Description:
+// - gets the glyph data of a cell of this row
+// Arguments:
+// - cell - the cell to get the glyph data for
+// Return Value:
+// - the glyph data. For glyphs longer than one code unit it points into the row's glyph storage.
+std::wstring_view CharRow::GlyphData(const value_type& cell) const noexcept
 {
-    return _pParent->GetUnicodeStorage();
-}
+    if (cell.DbcsAttr().IsGlyphStored())
+    {
+        const size_t offset = cell.Char();
+        if (offset < _glyphs.size())
+        {
+            const size_t length = til::at(_glyphs, offset);
+            if (length < _glyphs.size() - offset)
+            {
+                return std::wstring_view{ _glyphs }.substr(offset + 1, length);
+            }
+        }
 
-const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
-{
-    return _pParent->GetUnicodeStorage();
+        // The cell was marked as stored without storing a glyph through this row.
+        return { &UNICODE_REPLACEMENT, 1 };
+    }
+
+    return { &cell.Char(), 1 };
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - stores a glyph that doesn't fit into a single code unit in the row's glyph storage
+//   and makes the cell at column refer to it.
 // Arguments:
-// - column - the column to generate the key for
-// Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - column - the column to store the glyph for
+// - chars - the glyph data to store
+// Note: will throw exception if column is out of bounds
+void CharRow::StoreGlyph(const size_t column, const std::wstring_view chars)
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    auto& cell = _data.at(column);
+    auto& dbcsAttr = cell.DbcsAttr();
+
+    // The previous glyph of the cell isn't overwritten in place, since the
+    // DbcsAttribute might have been copied from another cell and then the
+    // offset isn't ours. Its space is reclaimed by the next compaction.
+    dbcsAttr.SetGlyphStored(false);
+
+    // Before the storage has to grow, reclaim the space of glyphs that were overwritten or erased.
+    if (_glyphs.size() + chars.size() + 1 > _glyphs.capacity())
+    {
+        CompactGlyphs();
+    }
+
+    // The offset and the length of the glyph have to fit into a single code unit.
+    constexpr size_t maxOffset = std::numeric_limits<wchar_t>::max();
+    if (_glyphs.size() > maxOffset || chars.size() > maxOffset)
+    {
+        cell.Char() = UNICODE_REPLACEMENT;
+        return;
+    }
+
+    const auto offset = _glyphs.size();
+    _glyphs.push_back(gsl::narrow_cast<wchar_t>(chars.size()));
+    _glyphs.append(chars);
+
+    cell.Char() = gsl::narrow_cast<wchar_t>(offset);
+    dbcsAttr.SetGlyphStored(true);
 }
 
 // Routine Description:
-// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
-// Arguments:
-// - pParent - Pointer to the parent row
-void CharRow::UpdateParent(ROW* const pParent)
+// - rebuilds the glyph storage from the glyphs that are still referenced by a cell,
+//   dropping the ones that were overwritten, erased or cut off by a resize.
+void CharRow::CompactGlyphs()
 {
-    _pParent = FAIL_FAST_IF_NULL(pParent);
+    std::wstring glyphs;
+    glyphs.reserve(_glyphs.capacity());
+
+    for (auto& cell : _data)
+    {
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            const auto glyph = GlyphData(cell);
+            const auto offset = glyphs.size();
+            glyphs.push_back(gsl::narrow_cast<wchar_t>(glyph.size()));
+            glyphs.append(glyph);
+            cell.Char() = gsl::narrow_cast<wchar_t>(offset);
+        }
+    }
+
+    _glyphs.swap(glyphs);
 }
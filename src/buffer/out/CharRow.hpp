@@ -23,9 +23,6 @@ Revision History:
 #include "DbcsAttribute.hpp"
 #include "CharRowCellReference.hpp"
 #include "CharRowCell.hpp"
-#include "UnicodeStorage.hpp"
-
-class ROW;
 
 enum class DelimiterClass
 {
@@ -44,6 +41,12 @@ enum class DelimiterClass
 //       ^    ^                  ^                     ^
 //       |    |                  |                     |
 //     Chars Left               Right                end of Chars buffer
+//
+// Glyphs that don't fit into a single UTF-16 code unit (surrogate pairs and
+// clusters) are kept in a contiguous buffer that belongs to the row. The cell
+// then stores the offset of the glyph in that buffer instead of a character.
+// Since the row owns all of its text, rows can be moved around in the text
+// buffer without having to update any other data structure.
 class CharRow final
 {
 public:
@@ -54,7 +57,7 @@ public:
     using const_reverse_iterator = typename boost::container::small_vector_base<value_type>::const_reverse_iterator;
     using reference = typename CharRowCellReference;
 
-    CharRow(size_t rowWidth, ROW* const pParent) noexcept;
+    CharRow(size_t rowWidth) noexcept;
 
     size_t size() const noexcept;
     [[nodiscard]] HRESULT Resize(const size_t newSize) noexcept;
@@ -64,6 +67,7 @@ public:
     const DbcsAttribute& DbcsAttrAt(const size_t column) const;
     DbcsAttribute& DbcsAttrAt(const size_t column);
     void ClearGlyph(const size_t column);
+    void CopyCells(const CharRow& source, const size_t sourceBegin, const size_t sourceEnd, const size_t target);
 
     const DelimiterClass DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const;
 
@@ -80,26 +84,30 @@ public:
     const_iterator cend() const noexcept;
     const_iterator end() const noexcept { return cend(); }
 
-    UnicodeStorage& GetUnicodeStorage() noexcept;
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
-
-    void UpdateParent(ROW* const pParent);
-
     friend CharRowCellReference;
     friend class ROW;
 
+#ifdef UNIT_TESTING
+    friend class CharRowTests;
+    friend class TextBufferTests;
+#endif
+
 private:
     void Reset() noexcept;
+    void Release() noexcept;
     void ClearCell(const size_t column);
     std::wstring GetText() const;
 
+    std::wstring_view GlyphData(const value_type& cell) const noexcept;
+    void StoreGlyph(const size_t column, const std::wstring_view chars);
+    void CompactGlyphs();
+
 protected:
     // storage for glyph data and dbcs attributes
     boost::container::small_vector<value_type, 120> _data;
 
-    // ROW that this CharRow belongs to
-    ROW* _pParent;
+    // storage for glyphs longer than one code unit. every glyph is preceded by its length.
+    std::wstring _glyphs;
 };
 
 template<typename InputIt1, typename InputIt2>
@@ -55,7 +55,7 @@ const DbcsAttribute& CharRowCell::DbcsAttr() const noexcept
 }
 
 // Routine Description:
-// - Access the cell's wchar field. this does not access any char data through UnicodeStorage.
+// - Access the cell's wchar field. this does not access any char data in the glyph storage of the row.
 // Return Value:
 // - the cell's wchar field
 wchar_t& CharRowCell::Char() noexcept
@@ -64,7 +64,7 @@ wchar_t& CharRowCell::Char() noexcept
 }
 
 // Routine Description:
-// - Access the cell's wchar field. this does not access any char data through UnicodeStorage.
+// - Access the cell's wchar field. this does not access any char data in the glyph storage of the row.
 // Return Value:
 // - the cell's wchar field
 const wchar_t& CharRowCell::Char() const noexcept
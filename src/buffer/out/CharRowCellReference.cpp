@@ -2,11 +2,10 @@
 // Licensed under the MIT license.
 
 #include "precomp.h"
-#include "UnicodeStorage.hpp"
 #include "CharRow.hpp"
 
 // Routine Description:
-// - assignment operator. will store extended glyph data in a separate storage location
+// - assignment operator. will store extended glyph data in the glyph storage of the row
 // Arguments:
 // - chars - the glyph data to store
 void CharRowCellReference::operator=(const std::wstring_view chars)
@@ -19,10 +18,7 @@ void CharRowCellReference::operator=(const std::wstring_view chars)
     }
     else
     {
-        auto& storage = _parent.GetUnicodeStorage();
-        const auto key = _parent.GetStorageKey(_index);
-        storage.StoreGlyph(key, { chars.cbegin(), chars.cend() });
-        _cellData().DbcsAttr().SetGlyphStored(true);
+        _parent.StoreGlyph(_index, chars);
     }
 }
 
@@ -59,16 +55,7 @@ const CharRowCell& CharRowCellReference::_cellData() const
 // - the glyph data
 std::wstring_view CharRowCellReference::_glyphData() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
-    {
-        const auto& text = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
-
-        return { text.data(), text.size() };
-    }
-    else
-    {
-        return { &_cellData().Char(), 1 };
-    }
+    return _parent.GlyphData(_cellData());
 }
 
 // Routine Description:
@@ -77,14 +64,7 @@ std::wstring_view CharRowCellReference::_glyphData() const
 // - iterator of the glyph data
 CharRowCellReference::const_iterator CharRowCellReference::begin() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
-    {
-        return _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index)).data();
-    }
-    else
-    {
-        return &_cellData().Char();
-    }
+    return _glyphData().data();
 }
 
 // Routine Description:
@@ -96,15 +76,8 @@ CharRowCellReference::const_iterator CharRowCellReference::begin() const
 // TODO GH 2672: eliminate using pointers raw as begin/end markers in this class
 CharRowCellReference::const_iterator CharRowCellReference::end() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
-    {
-        const auto& chars = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
-        return chars.data() + chars.size();
-    }
-    else
-    {
-        return &_cellData().Char() + 1;
-    }
+    const auto chars = _glyphData();
+    return chars.data() + chars.size();
 }
 #pragma warning(pop)
 
@@ -125,8 +98,8 @@ bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& gly
     }
     else
     {
-        const auto& chars = ref._parent.GetUnicodeStorage().GetText(ref._parent.GetStorageKey(ref._index));
-        return chars == glyph;
+        const auto chars = ref._glyphData();
+        return std::equal(chars.begin(), chars.end(), glyph.begin(), glyph.end());
     }
 }
 
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FrozenRow.hpp"
+
+// Routine Description:
+// - constructor. freezes the given contents of a row.
+// Arguments:
+// - charRow - the text of the row
+// - attrRow - the attributes of the row
+FrozenRow::FrozenRow(const CharRow& charRow, const ATTR_ROW& attrRow)
+{
+    const auto right = charRow.MeasureRight();
+    _text.reserve(right);
+    auto detailed = false;
+
+    for (size_t column = 0; column < right; ++column)
+    {
+        const auto& dbcsAttr = charRow.DbcsAttrAt(column);
+        // The trailing half of a wide glyph is restored together with its leading half.
+        if (dbcsAttr.IsTrailing() && column > 0 && charRow.DbcsAttrAt(column - 1).IsLeading())
+        {
+            continue;
+        }
+
+        const std::wstring_view glyph = charRow.GlyphAt(column);
+        const auto wide = dbcsAttr.IsLeading() && column + 1 < charRow.size();
+
+        // Most rows consist of single code units in single cells only and
+        // don't need to store any layout. Switch over on the first glyph that isn't.
+        if (!detailed && (wide || glyph.size() != 1))
+        {
+            detailed = true;
+            _glyphs.assign(_text.size(), uint16_t{ 1 });
+        }
+        if (detailed)
+        {
+            const auto length = gsl::narrow<uint16_t>(glyph.size());
+            THROW_HR_IF(E_INVALIDARG, WI_IsFlagSet(length, WideGlyph));
+            _glyphs.push_back(wide ? length | WideGlyph : length);
+        }
+
+        _text.append(glyph);
+    }
+
+    const auto runs = attrRow.GetRuns();
+    _attributes.assign(runs.begin(), runs.end());
+}
+
+// Routine Description:
+// - gets the text of the row, without the trailing whitespace.
+std::wstring_view FrozenRow::GetText() const noexcept
+{
+    return _text;
+}
+
+// Routine Description:
+// - gets the number of cells the text of the row takes up.
+size_t FrozenRow::MeasureRight() const noexcept
+{
+    if (_glyphs.empty())
+    {
+        return _text.size();
+    }
+
+    size_t right = 0;
+    for (const auto length : _glyphs)
+    {
+        right += WI_IsFlagSet(length, WideGlyph) ? 2 : 1;
+    }
+    return right;
+}
+
+// Routine Description:
+// - gets the ids of the hyperlinks in the attributes of the row, the same as ATTR_ROW::GetHyperlinks.
+std::vector<uint16_t> FrozenRow::GetHyperlinks() const
+{
+    std::vector<uint16_t> ids;
+    for (const auto& run : _attributes)
+    {
+        if (run.value.IsHyperlink())
+        {
+            ids.emplace_back(run.value.GetHyperlinkId());
+        }
+    }
+    return ids;
+}
+
+// Routine Description:
+// - restores the frozen contents into the given, freshly reset row.
+//   Glyphs and attributes that don't fit into its width are cut off.
+// Arguments:
+// - charRow - the text of the row to restore into
+// - attrRow - the attributes of the row to restore into
+void FrozenRow::ThawInto(CharRow& charRow, ATTR_ROW& attrRow) const
+{
+    const auto width = charRow.size();
+    const std::wstring_view text{ _text };
+    const auto glyphCount = _glyphs.empty() ? text.size() : _glyphs.size();
+    size_t column = 0;
+    size_t offset = 0;
+
+    for (size_t i = 0; i < glyphCount && column < width; ++i)
+    {
+        uint16_t length = 1;
+        auto wide = false;
+        if (!_glyphs.empty())
+        {
+            length = til::at(_glyphs, i);
+            wide = WI_IsFlagSet(length, WideGlyph);
+            WI_ClearFlag(length, WideGlyph);
+        }
+
+        const auto glyph = text.substr(offset, length);
+        offset += length;
+
+        if (wide)
+        {
+            if (column + 1 >= width)
+            {
+                break;
+            }
+            charRow.DbcsAttrAt(column).SetLeading();
+            charRow.GlyphAt(column) = glyph;
+            charRow.DbcsAttrAt(column + 1).SetTrailing();
+            charRow.GlyphAt(column + 1) = glyph;
+            column += 2;
+        }
+        else
+        {
+            charRow.GlyphAt(column) = glyph;
+            ++column;
+        }
+    }
+
+    size_t begin = 0;
+    for (const auto& run : _attributes)
+    {
+        if (begin >= width)
+        {
+            break;
+        }
+        const auto end = std::min<size_t>(begin + run.length, width);
+        attrRow.Replace(gsl::narrow_cast<uint16_t>(begin), gsl::narrow_cast<uint16_t>(end), run.value);
+        begin = end;
+    }
+}
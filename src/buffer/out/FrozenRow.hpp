@@ -0,0 +1,40 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FrozenRow.hpp
+
+Abstract:
+- contains the compact, immutable form of the contents of a row.
+- Only the text up to the last non-space glyph is kept, the layout of the
+  glyphs only if the row has any wide or multi code unit ones, and the
+  attributes as the runs they're already encoded with. It's used for rows
+  that are far away from the viewport and for the scrollback store.
+--*/
+
+#pragma once
+
+#include "CharRow.hpp"
+#include "AttrRow.hpp"
+
+class FrozenRow final
+{
+public:
+    FrozenRow(const CharRow& charRow, const ATTR_ROW& attrRow);
+
+    std::wstring_view GetText() const noexcept;
+    size_t MeasureRight() const noexcept;
+    std::vector<uint16_t> GetHyperlinks() const;
+    void ThawInto(CharRow& charRow, ATTR_ROW& attrRow) const;
+
+private:
+    static constexpr uint16_t WideGlyph = 0x8000;
+
+    // The glyphs of all single and leading cells up to MeasureRight().
+    std::wstring _text;
+    // Empty if every glyph is a single code unit in a single cell. Otherwise
+    // the length of every glyph, with WideGlyph set for the leading ones.
+    std::vector<uint16_t> _glyphs;
+    boost::container::small_vector<ATTR_ROW::run_type, 1> _attributes;
+};
@@ -4,6 +4,7 @@
 #include "precomp.h"
 #include "Row.hpp"
 #include "CharRow.hpp"
+#include "FrozenRow.hpp"
 #include "textBuffer.hpp"
 #include "../types/inc/convert.hpp"
 
@@ -19,11 +20,12 @@
 ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
     _id{ rowId },
     _rowWidth{ rowWidth },
-    _charRow{ rowWidth, this },
+    _charRow{ rowWidth },
     _attrRow{ rowWidth, fillAttribute },
     _lineRendition{ LineRendition::SingleWidth },
     _wrapForced{ false },
     _doubleBytePadded{ false },
+    _revision{ 0 },
     _pParent{ pParent }
 {
 }
@@ -39,9 +41,16 @@ bool ROW::Reset(const TextAttribute Attr)
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
     _doubleBytePadded = false;
-    _charRow.Reset();
+    ++_revision;
     try
     {
+        // There's no need to thaw the contents just to clear them.
+        if (_frozen)
+        {
+            THROW_IF_FAILED(_charRow.Resize(_rowWidth));
+            _frozen.reset();
+        }
+        _charRow.Reset();
         _attrRow.Reset(Attr);
     }
     catch (...)
@@ -60,6 +69,13 @@ bool ROW::Reset(const TextAttribute Attr)
 // - S_OK if successful, otherwise relevant error
 [[nodiscard]] HRESULT ROW::Resize(const unsigned short width)
 {
+    try
+    {
+        Thaw();
+    }
+    CATCH_RETURN();
+
+    ++_revision;
     RETURN_IF_FAILED(_charRow.Resize(width));
     try
     {
@@ -80,18 +96,114 @@ bool ROW::Reset(const TextAttribute Attr)
 // - <none>
 void ROW::ClearColumn(const size_t column)
 {
+    Thaw();
+    ++_revision;
     THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
     _charRow.ClearCell(column);
 }
 
-UnicodeStorage& ROW::GetUnicodeStorage() noexcept
+// Routine Description:
+// - Replaces the contents of the row with a copy of the contents of another
+//   row of the same width. The id of the row and the buffer it belongs to stay
+//   the same. A frozen source is thawed into this row, but stays frozen itself.
+// Arguments:
+// - source - the row to copy
+// Return Value:
+// - <none>
+void ROW::CopyFrom(const ROW& source)
 {
-    return _pParent->GetUnicodeStorage();
+    THROW_HR_IF(E_INVALIDARG, source._rowWidth != _rowWidth);
+
+    if (_frozen)
+    {
+        THROW_IF_FAILED(_charRow.Resize(_rowWidth));
+        _frozen.reset();
+    }
+
+    if (source._frozen)
+    {
+        _charRow.Reset();
+        source._frozen->ThawInto(_charRow, _attrRow);
+    }
+    else
+    {
+        // Copy assignment keeps the storage of the cells if it's large enough.
+        _charRow = source._charRow;
+        _attrRow = source._attrRow;
+    }
+
+    _lineRendition = source._lineRendition;
+    _wrapForced = source._wrapForced;
+    _doubleBytePadded = source._doubleBytePadded;
+    ++_revision;
 }
 
-const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - Copies a run of cells, including their attributes, from another row or
+//   from elsewhere in this row. Overlapping runs within the same row are
+//   copied as if the source run was read before anything was written.
+// - A frozen source stays frozen. It's thawed into a copy first.
+// - A wide glyph that ends up split at the start or end of the row is padded
+//   out by clearing it, the same as when the cells are written one by one.
+// Arguments:
+// - source - the row to copy the cells from. Can be this row.
+// - sourceBegin - the first column to copy
+// - sourceEnd - one past the last column to copy
+// - target - the column of this row to copy the first cell to
+// Return Value:
+// - <none>
+// Note: will throw exception if either range is out of bounds
+void ROW::CopyCells(const ROW& source, const size_t sourceBegin, const size_t sourceEnd, const size_t target)
 {
-    return _pParent->GetUnicodeStorage();
+    Thaw();
+    if (source._frozen)
+    {
+        ROW thawed{ source._id, source._rowWidth, TextAttribute{}, nullptr };
+        thawed.CopyFrom(source);
+        CopyCells(thawed, sourceBegin, sourceEnd, target);
+        return;
+    }
+    ++_revision;
+
+    _charRow.CopyCells(source._charRow, sourceBegin, sourceEnd, target);
+    _attrRow.CopyRange(source._attrRow, gsl::narrow<uint16_t>(sourceBegin), gsl::narrow<uint16_t>(sourceEnd), gsl::narrow<uint16_t>(target));
+
+    if (sourceEnd == sourceBegin)
+    {
+        return;
+    }
+
+    if (target == 0 && _charRow.DbcsAttrAt(0).IsTrailing())
+    {
+        _charRow.ClearCell(0);
+    }
+
+    const auto end = target + sourceEnd - sourceBegin;
+    if (end == _charRow.size() && _charRow.DbcsAttrAt(end - 1).IsLeading())
+    {
+        _charRow.ClearCell(end - 1);
+        SetDoubleBytePadded(true);
+    }
+}
+
+// Routine Description:
+// - Fills a run of cells with the same narrow glyph and attribute.
+// Arguments:
+// - begin - the first column to fill
+// - end - one past the last column to fill
+// - wch - the glyph to fill the cells with. Has to be a narrow glyph.
+// - attr - the attribute to fill the cells with
+// Return Value:
+// - <none>
+// Note: will throw exception if the range is out of bounds
+void ROW::FillCells(const size_t begin, const size_t end, const wchar_t wch, const TextAttribute& attr)
+{
+    Thaw();
+    ++_revision;
+    THROW_HR_IF(E_INVALIDARG, begin > end || end > _charRow.size());
+
+    std::fill_n(_charRow.begin() + begin, end - begin, CharRow::value_type{ wch, DbcsAttribute{} });
+    _attrRow.Replace(gsl::narrow<uint16_t>(begin), gsl::narrow<uint16_t>(end), attr);
 }
 
 // Routine Description:
@@ -105,6 +217,8 @@ const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
 // - iterator to first cell that was not written to this row.
 OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap, std::optional<size_t> limitRight)
 {
+    Thaw();
+    ++_revision;
     THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
     THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= _charRow.size());
 
@@ -196,3 +310,75 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - Gets the text of the row, including the spaces up to its end. Doesn't
+//   thaw a frozen row.
+// Return Value:
+// - the glyphs of all single and leading cells
+std::wstring ROW::GetText() const
+{
+    if (_frozen)
+    {
+        std::wstring text{ _frozen->GetText() };
+        text.append(_rowWidth - std::min<size_t>(_frozen->MeasureRight(), _rowWidth), L' ');
+        return text;
+    }
+    return _charRow.GetText();
+}
+
+// Routine Description:
+// - Gets the ids of the hyperlinks the row refers to. Doesn't thaw a frozen row.
+// Return Value:
+// - the ids, in the order of the runs they're in. May contain duplicates.
+std::vector<uint16_t> ROW::GetHyperlinks() const
+{
+    return _frozen ? _frozen->GetHyperlinks() : _attrRow.GetHyperlinks();
+}
+
+// Routine Description:
+// - Replaces the text and attributes of the row with their compact frozen
+//   form and releases the memory of the cells. Meant for rows that are far
+//   away from the cursor and unlikely to change or be rendered any time soon.
+// - Its contents can't be accessed until it's thawed again. The methods that
+//   modify the row do that themselves.
+void ROW::Freeze()
+{
+    if (_frozen)
+    {
+        return;
+    }
+
+    _frozen = std::make_shared<const FrozenRow>(_charRow, _attrRow);
+    _charRow.Release();
+    _attrRow = ATTR_ROW{ _rowWidth, TextAttribute{} };
+}
+
+// Routine Description:
+// - Gets the frozen form of the contents of the row, without freezing the row itself.
+// Return Value:
+// - the frozen contents. Shared with the row if it's frozen already.
+std::shared_ptr<const FrozenRow> ROW::GetFrozen() const
+{
+    if (_frozen)
+    {
+        return _frozen;
+    }
+    return std::make_shared<const FrozenRow>(_charRow, _attrRow);
+}
+
+// Routine Description:
+// - Restores the cells of a frozen row. The row stays thawed until it's
+//   frozen again. Does nothing if the row isn't frozen.
+void ROW::Thaw()
+{
+    if (!_frozen)
+    {
+        return;
+    }
+
+    THROW_IF_FAILED(_charRow.Resize(_rowWidth));
+    _charRow.Reset();
+    _frozen->ThawInto(_charRow, _attrRow);
+    _frozen.reset();
+}
@@ -25,9 +25,9 @@ Revision History:
 #include "OutputCell.hpp"
 #include "OutputCellIterator.hpp"
 #include "CharRow.hpp"
-#include "UnicodeStorage.hpp"
 
 class TextBuffer;
+class FrozenRow;
 
 class ROW final
 {
@@ -36,14 +36,23 @@ public:
 
     size_t size() const noexcept { return _rowWidth; }
 
-    void SetWrapForced(const bool wrap) noexcept { _wrapForced = wrap; }
+    void SetWrapForced(const bool wrap) noexcept
+    {
+        _revision += _wrapForced != wrap;
+        _wrapForced = wrap;
+    }
     bool WasWrapForced() const noexcept { return _wrapForced; }
 
     void SetDoubleBytePadded(const bool doubleBytePadded) noexcept { _doubleBytePadded = doubleBytePadded; }
     bool WasDoubleBytePadded() const noexcept { return _doubleBytePadded; }
 
+    // The contents of a frozen row are released. Thaw it before accessing them.
     const CharRow& GetCharRow() const noexcept { return _charRow; }
-    CharRow& GetCharRow() noexcept { return _charRow; }
+    CharRow& GetCharRow() noexcept
+    {
+        ++_revision;
+        return _charRow;
+    }
 
     const ATTR_ROW& GetAttrRow() const noexcept { return _attrRow; }
     ATTR_ROW& GetAttrRow() noexcept { return _attrRow; }
@@ -54,14 +63,23 @@ public:
     SHORT GetId() const noexcept { return _id; }
     void SetId(const SHORT id) noexcept { _id = id; }
 
+    // Changes whenever the text or the wrapping of the row may have changed.
+    uint32_t GetRevision() const noexcept { return _revision; }
+
     bool Reset(const TextAttribute Attr);
     [[nodiscard]] HRESULT Resize(const unsigned short width);
 
     void ClearColumn(const size_t column);
-    std::wstring GetText() const { return _charRow.GetText(); }
+    void CopyFrom(const ROW& source);
+    void CopyCells(const ROW& source, const size_t sourceBegin, const size_t sourceEnd, const size_t target);
+    void FillCells(const size_t begin, const size_t end, const wchar_t wch, const TextAttribute& attr);
+    std::wstring GetText() const;
+    std::vector<uint16_t> GetHyperlinks() const;
 
-    UnicodeStorage& GetUnicodeStorage() noexcept;
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
+    void Freeze();
+    void Thaw();
+    bool IsFrozen() const noexcept { return _frozen != nullptr; }
+    std::shared_ptr<const FrozenRow> GetFrozen() const;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
 
@@ -73,6 +91,10 @@ public:
 private:
     CharRow _charRow;
     ATTR_ROW _attrRow;
+    // The contents of the row while it's frozen. _charRow is released and
+    // _attrRow is blank in the meantime.
+    std::shared_ptr<const FrozenRow> _frozen;
+    uint32_t _revision;
     LineRendition _lineRendition;
     SHORT _id;
     unsigned short _rowWidth;
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ScrollbackStore.hpp"
+
+// Routine Description:
+// - Sets the maximum number of rows to keep. The oldest rows are dropped
+//   once there are more. A limit of 0 disables the store.
+// Arguments:
+// - limit - the maximum number of rows
+void ScrollbackStore::SetLimit(const size_t limit)
+{
+    _limit = limit;
+    while (_rows.size() > _limit)
+    {
+        _rows.pop_front();
+        ++_firstRowNumber;
+    }
+}
+
+size_t ScrollbackStore::GetLimit() const noexcept
+{
+    return _limit;
+}
+
+// Routine Description:
+// - Freezes the given row and appends it as the newest row of the history.
+// Arguments:
+// - row - the row that's about to leave the text buffer
+void ScrollbackStore::Append(const ROW& row)
+{
+    if (_limit == 0)
+    {
+        return;
+    }
+
+    Entry entry;
+    entry.contents = row.GetFrozen();
+    entry.lineRendition = row.GetLineRendition();
+    entry.wrapForced = row.WasWrapForced();
+    entry.doubleBytePadded = row.WasDoubleBytePadded();
+
+    _rows.emplace_back(std::move(entry));
+    if (_rows.size() > _limit)
+    {
+        _rows.pop_front();
+        ++_firstRowNumber;
+    }
+}
+
+// Routine Description:
+// - Drops all rows. Row numbers continue after the last row that was stored.
+void ScrollbackStore::Clear() noexcept
+{
+    _firstRowNumber += _rows.size();
+    _rows.clear();
+}
+
+size_t ScrollbackStore::size() const noexcept
+{
+    return _rows.size();
+}
+
+bool ScrollbackStore::empty() const noexcept
+{
+    return _rows.empty();
+}
+
+// Routine Description:
+// - Gets the row number of the oldest row that's still stored.
+ScrollbackStore::row_number ScrollbackStore::GetFirstRowNumber() const noexcept
+{
+    return _firstRowNumber;
+}
+
+// Routine Description:
+// - Gets the row number following the newest row. The first row of the
+//   text buffer the history belongs to continues at this number.
+ScrollbackStore::row_number ScrollbackStore::GetEndRowNumber() const noexcept
+{
+    return _firstRowNumber + _rows.size();
+}
+
+// Routine Description:
+// - Gets the text of a stored row, without the trailing whitespace.
+// Arguments:
+// - rowNumber - the logical number of the row
+// Return Value:
+// - the text of the row
+// Note: will throw exception if the row isn't stored (anymore)
+std::wstring ScrollbackStore::GetText(const row_number rowNumber) const
+{
+    return std::wstring{ _at(rowNumber).contents->GetText() };
+}
+
+bool ScrollbackStore::WasWrapForced(const row_number rowNumber) const
+{
+    return _at(rowNumber).wrapForced;
+}
+
+// Routine Description:
+// - Thaws a stored row into the given row, for instance to render or search it.
+//   Glyphs and attributes that don't fit into the width of the row are cut off.
+// Arguments:
+// - rowNumber - the logical number of the row
+// - row - the row to overwrite with the stored one
+// Note: will throw exception if the row isn't stored (anymore)
+void ScrollbackStore::CopyTo(const row_number rowNumber, ROW& row) const
+{
+    const auto& entry = _at(rowNumber);
+
+    THROW_HR_IF(E_OUTOFMEMORY, !row.Reset(TextAttribute{}));
+    entry.contents->ThawInto(row.GetCharRow(), row.GetAttrRow());
+
+    row.SetLineRendition(entry.lineRendition);
+    row.SetWrapForced(entry.wrapForced);
+    row.SetDoubleBytePadded(entry.doubleBytePadded);
+}
+
+const ScrollbackStore::Entry& ScrollbackStore::_at(const row_number rowNumber) const
+{
+    THROW_HR_IF(E_INVALIDARG, rowNumber < _firstRowNumber || rowNumber >= GetEndRowNumber());
+    return til::at(_rows, gsl::narrow_cast<size_t>(rowNumber - _firstRowNumber));
+}
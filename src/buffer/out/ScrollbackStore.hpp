@@ -0,0 +1,59 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ScrollbackStore.hpp
+
+Abstract:
+- Storage for the rows that scrolled out of the top of a text buffer.
+- The rows of a TextBuffer are addressed with SHORTs, which limits it to
+  32767 rows. Instead of discarding a row when it circles out of the buffer,
+  it's appended to this store. Rows in here are addressed by 64-bit logical
+  row numbers, which keep counting up for as long as the buffer lives.
+- Rows are stored as FrozenRows, so the memory used by the history is
+  proportional to the text written and not to the width of the buffer.
+  Rows that were already frozen in the buffer are shared, not copied.
+--*/
+
+#pragma once
+
+#include "Row.hpp"
+#include "FrozenRow.hpp"
+
+class ScrollbackStore final
+{
+public:
+    using row_number = uint64_t;
+
+    void SetLimit(const size_t limit);
+    size_t GetLimit() const noexcept;
+
+    void Append(const ROW& row);
+    void Clear() noexcept;
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    row_number GetFirstRowNumber() const noexcept;
+    row_number GetEndRowNumber() const noexcept;
+
+    std::wstring GetText(const row_number rowNumber) const;
+    bool WasWrapForced(const row_number rowNumber) const;
+    void CopyTo(const row_number rowNumber, ROW& row) const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const FrozenRow> contents;
+        LineRendition lineRendition{ LineRendition::SingleWidth };
+        bool wrapForced{ false };
+        bool doubleBytePadded{ false };
+    };
+
+    const Entry& _at(const row_number rowNumber) const;
+
+    std::deque<Entry> _rows;
+    row_number _firstRowNumber{ 0 };
+    size_t _limit{ 0 };
+};
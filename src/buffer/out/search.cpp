@@ -7,11 +7,13 @@
 
 #include "CharRow.hpp"
 #include "textBuffer.hpp"
-#include "../types/inc/Utf16Parser.hpp"
-#include "../types/inc/GlyphWidth.hpp"
 
 using namespace Microsoft::Console::Types;
 
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
 // Routine Description:
 // - Constructs a Search object.
 // - Make a Search object then call .FindNext() to locate items.
@@ -22,17 +24,19 @@ using namespace Microsoft::Console::Types;
 // - str - The search term you want to find (the "needle")
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
+// - syntax - Whether the search term is literal text or a regular expression
 Search::Search(IUiaData& uiaData,
                const std::wstring& str,
                const Direction direction,
-               const Sensitivity sensitivity) :
+               const Sensitivity sensitivity,
+               const Syntax syntax) :
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
+    _syntax(syntax),
+    _needle(str),
     _uiaData(uiaData),
     _coordAnchor(s_GetInitialAnchor(uiaData, direction))
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
@@ -46,18 +50,66 @@ Search::Search(IUiaData& uiaData,
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
 // - anchor - starting search location in screenInfo
+// - syntax - Whether the search term is literal text or a regular expression
 Search::Search(IUiaData& uiaData,
                const std::wstring& str,
                const Direction direction,
                const Sensitivity sensitivity,
-               const COORD anchor) :
+               const COORD anchor,
+               const Syntax syntax) :
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
+    _syntax(syntax),
+    _needle(str),
     _coordAnchor(anchor),
     _uiaData(uiaData)
 {
-    _coordNext = _coordAnchor;
+}
+
+// Routine Description:
+// - Starts over with a new search term, anchored at the current selection
+//   just like a newly constructed Search.
+// - As long as the buffer didn't change, its text is reused. If the new term
+//   merely extends the previous literal one, like it does while it's being
+//   typed, only the previous matches need to be checked again.
+// Arguments:
+// - str - The search term you want to find (the "needle")
+// - direction - The direction to search (upward or downward)
+// - sensitivity - Whether or not you care about case
+// - syntax - Whether the search term is literal text or a regular expression
+void Search::Update(const std::wstring& str,
+                    const Direction direction,
+                    const Sensitivity sensitivity,
+                    const Syntax syntax)
+{
+    std::optional<std::wstring> previousNeedle;
+    if (_indexed)
+    {
+        previousNeedle = std::move(_needle);
+    }
+    const auto previousSensitivity = _sensitivity;
+    const auto previousSyntax = _syntax;
+
+    _needle = str;
+    _direction = direction;
+    _sensitivity = sensitivity;
+    _syntax = syntax;
+    _coordAnchor = s_GetInitialAnchor(_uiaData, direction);
+    _coordSelStart = {};
+    _coordSelEnd = {};
+    _matchesFound = 0;
+    _indexed = false;
+
+    if (previousNeedle && _IsHaystackCurrent())
+    {
+        _FindAll(previousNeedle, previousSensitivity, previousSyntax);
+    }
+    else
+    {
+        _BuildHaystack();
+        _FindAll(std::nullopt, previousSensitivity, previousSyntax);
+    }
+    _indexed = true;
 }
 
 // Routine Description
@@ -69,30 +121,24 @@ Search::Search(IUiaData& uiaData,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    _Index();
+
+    const auto count = _matches.size();
+    if (_matchesFound == count)
     {
-        _reachedEnd = false;
+        _matchesFound = 0;
         return false;
     }
 
-    do
-    {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
-
-    } while (_coordNext != _coordAnchor);
+    // Walk through the matches in order, starting at the anchor, and wrap around once.
+    const auto index = _direction == Direction::Forward ?
+                           (_firstMatch + _matchesFound) % count :
+                           (_firstMatch + count - _matchesFound) % count;
+    ++_matchesFound;
 
-    return false;
+    std::tie(_coordSelStart, _coordSelEnd) = _GetLocation(til::at(_matches, index));
+    return true;
 }
-
 // Routine Description:
 // - Takes the found word and selects it in the screen buffer
 void Search::Select() const
@@ -152,12 +198,12 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
 
         if (direction == Direction::Forward)
         {
-            textBuffer.GetSize().IncrementInBoundsCircular(anchor);
+            textBuffer.GetSizeWithScrollback().IncrementInBoundsCircular(anchor);
         }
         else
         {
-            textBuffer.GetSize().DecrementInBoundsCircular(anchor);
-            // If the selection starts at (0, 0), we need to make sure
+            textBuffer.GetSizeWithScrollback().DecrementInBoundsCircular(anchor);
+            // If the selection starts at the top left, we need to make sure
             // it does not exceed the text buffer end position
             anchor.X = std::min(textBufferEndPosition.X, anchor.X);
             anchor.Y = std::min(textBufferEndPosition.Y, anchor.Y);
@@ -168,7 +214,7 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
     {
         if (direction == Direction::Forward)
         {
-            return { 0, 0 };
+            return { 0, -textBuffer.GetScrollbackWindowHeight() };
         }
         else
         {
@@ -178,169 +224,336 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
+// - gets the start and end positions of all occurrences of the search term,
+//   ordered by their position in the buffer.
 // Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - vector of [start, end] coord positions of the text found by the search
+std::vector<std::pair<COORD, COORD>> Search::GetAllFoundLocations()
 {
-    start = { 0 };
-    end = { 0 };
+    _Index();
 
-    COORD bufferPos = pos;
-
-    for (const auto& needleCell : _needle)
+    std::vector<std::pair<COORD, COORD>> locations;
+    locations.reserve(_matches.size());
+    for (const auto& match : _matches)
     {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _uiaData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
+        locations.emplace_back(_GetLocation(match));
     }
+    return locations;
+}
 
-    _DecrementCoord(bufferPos);
+// Routine Description:
+// - Finds all matches in the buffer, if that didn't happen yet, and picks
+//   the one that FindNext starts with.
+void Search::_Index()
+{
+    if (!_indexed)
+    {
+        _BuildHaystack();
+        _FindAll(std::nullopt, _sensitivity, _syntax);
+        _indexed = true;
+        _matchesFound = 0;
+    }
 
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+    // The anchor is inclusive in either direction: FindNext starts with the
+    // first match at or after it, or the last match at or before it.
+    const auto anchor = gsl::narrow_cast<size_t>(std::max(_coordAnchor.Y - _haystackTop, 0)) * _haystackWidth + _coordAnchor.X;
+    const auto it = std::partition_point(_matches.begin(), _matches.end(), [&](const Match& match) {
+        return _GetCellAt(match.start) < anchor;
+    });
+    const auto index = gsl::narrow_cast<size_t>(it - _matches.begin());
 
-    return true;
+    if (_direction == Direction::Forward)
+    {
+        _firstMatch = index;
+    }
+    else
+    {
+        const auto atAnchor = it != _matches.end() && _GetCellAt(it->start) == anchor;
+        _firstMatch = atAnchor ? index : (index + _matches.size() - 1);
+    }
+    _firstMatch = _matches.empty() ? 0 : _firstMatch % _matches.size();
 }
 
 // Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
+// - Checks whether the haystack still holds the current text of the buffer.
 // Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
+// - True if none of its rows changed or moved since it was built.
+bool Search::_IsHaystackCurrent() const
 {
-    if (one.size() != two.size())
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    if (textBuffer.GetGeneration() != _haystackGeneration ||
+        gsl::narrow_cast<size_t>(_uiaData.GetTextBufferEndPosition().Y - _haystackTop) + 1 != _rowRevisions.size())
     {
         return false;
     }
 
-    for (size_t i = 0; i < one.size(); i++)
+    for (size_t y = 0; y < _rowRevisions.size(); ++y)
     {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
+        if (textBuffer.GetRowByOffset(_haystackTop + gsl::narrow_cast<ptrdiff_t>(y)).GetRevision() != til::at(_rowRevisions, y))
         {
             return false;
         }
     }
-
     return true;
 }
 
 // Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
+// - Copies the text of the buffer up to its last character into the haystack,
+//   in one pass over the rows instead of one cell iterator per position.
+// - The rows of the scrollback window above the buffer come first.
+void Search::_BuildHaystack()
+{
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    _haystackGeneration = textBuffer.GetGeneration();
+    _haystackTop = -textBuffer.GetScrollbackWindowHeight();
+    const auto rowCount = gsl::narrow_cast<size_t>(_uiaData.GetTextBufferEndPosition().Y - _haystackTop) + 1;
+
+    _haystack.clear();
+    _foldedHaystack.clear();
+    _rowOffsets.clear();
+    _rowColumns.clear();
+    _rowRevisions.clear();
+    _haystackWidth = textBuffer.GetSize().Width();
+
+    _haystack.reserve(rowCount * _haystackWidth);
+    _rowOffsets.reserve(rowCount + 1);
+    _rowColumns.resize(rowCount);
+    _rowRevisions.reserve(rowCount);
+
+    for (size_t y = 0; y < rowCount; ++y)
+    {
+        const auto& row = textBuffer.GetRowByOffset(_haystackTop + gsl::narrow_cast<ptrdiff_t>(y));
+        const auto& charRow = row.GetCharRow();
+        const auto rowOffset = _haystack.size();
+        _rowOffsets.push_back(rowOffset);
+        _rowRevisions.push_back(row.GetRevision());
+
+        auto& columns = til::at(_rowColumns, y);
+        for (size_t x = 0; x < charRow.size(); ++x)
+        {
+            const auto& dbcsAttr = charRow.DbcsAttrAt(x);
+            if (dbcsAttr.IsTrailing())
+            {
+                continue;
+            }
+
+            const std::wstring_view glyph = charRow.GlyphAt(x);
+            // Most rows map every code unit to the cell at the same offset.
+            // Only the ones that don't keep the column of every code unit.
+            if (columns.empty() && (dbcsAttr.IsLeading() || glyph.size() != 1))
+            {
+                for (size_t i = 0; i < _haystack.size() - rowOffset; ++i)
+                {
+                    columns.push_back(gsl::narrow_cast<uint16_t>(i));
+                }
+                columns.push_back(gsl::narrow_cast<uint16_t>(x));
+                columns.insert(columns.end(), glyph.size() - 1, gsl::narrow_cast<uint16_t>(x));
+            }
+            else if (!columns.empty())
+            {
+                columns.insert(columns.end(), glyph.size(), gsl::narrow_cast<uint16_t>(x));
+            }
+            _haystack.append(glyph);
+        }
+    }
+    _rowOffsets.push_back(_haystack.size());
+}
+
+// Routine Description:
+// - Finds all matches of the needle in the haystack.
 // Arguments:
-// - wch - Character to adjust if necessary
-// Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const noexcept
+// - previousNeedle - The needle that _matches were found for, if they're still valid.
+// - previousSensitivity - The sensitivity that _matches were found with.
+// - previousSyntax - The syntax that _matches were found with.
+void Search::_FindAll(const std::optional<std::wstring>& previousNeedle, const Sensitivity previousSensitivity, const Syntax previousSyntax)
 {
-    if (_sensitivity == Sensitivity::CaseInsensitive)
+    const auto insensitive = _sensitivity == Sensitivity::CaseInsensitive;
+
+    if (_syntax == Syntax::RegularExpression)
     {
-        return ::towlower(wch);
+        _matches.clear();
+        try
+        {
+            const auto flags = insensitive ? std::regex_constants::ECMAScript | std::regex_constants::icase : std::regex_constants::ECMAScript;
+            const std::wregex regex{ _needle, flags };
+
+            const auto begin = _haystack.data();
+            const auto end = begin + _haystack.size();
+            for (auto it = std::wcregex_iterator{ begin, end, regex }; it != std::wcregex_iterator{}; ++it)
+            {
+                if (it->length() != 0)
+                {
+                    const auto start = gsl::narrow_cast<size_t>(it->position());
+                    _matches.push_back({ start, start + gsl::narrow_cast<size_t>(it->length()) });
+                }
+            }
+        }
+        catch (const std::regex_error&)
+        {
+            // An incomplete expression, like one that's still being typed, just doesn't match anything.
+            _matches.clear();
+        }
+        return;
     }
-    else
+
+    std::wstring foldedNeedle;
+    std::wstring_view needle{ _needle };
+    std::wstring_view haystack{ _haystack };
+    if (insensitive)
+    {
+        if (_foldedHaystack.size() != _haystack.size())
+        {
+            _foldedHaystack.resize(_haystack.size());
+            std::transform(_haystack.begin(), _haystack.end(), _foldedHaystack.begin(), s_FoldCase);
+        }
+        foldedNeedle.resize(_needle.size());
+        std::transform(_needle.begin(), _needle.end(), foldedNeedle.begin(), s_FoldCase);
+        needle = foldedNeedle;
+        haystack = _foldedHaystack;
+    }
+
+    if (needle.empty())
+    {
+        _matches.clear();
+        return;
+    }
+
+    // While a term is being typed, every new match starts where one of the
+    // previous matches did. Only those need to be checked again.
+    const auto refine = previousNeedle &&
+                        previousSyntax == Syntax::Literal &&
+                        previousSensitivity == _sensitivity &&
+                        !previousNeedle->empty() &&
+                        _needle.size() >= previousNeedle->size() &&
+                        _needle.compare(0, previousNeedle->size(), *previousNeedle) == 0;
+    if (refine)
+    {
+        const auto it = std::remove_if(_matches.begin(), _matches.end(), [&](const Match& match) {
+            return haystack.compare(match.start, needle.size(), needle) != 0;
+        });
+        _matches.erase(it, _matches.end());
+        for (auto& match : _matches)
+        {
+            match.end = match.start + needle.size();
+        }
+        return;
+    }
+
+    _matches.clear();
+    // Overlapping matches are found as well, just like they are selectable.
+    for (auto offset = s_FindLiteral(haystack, needle, 0); offset != std::wstring_view::npos; offset = s_FindLiteral(haystack, needle, offset + 1))
     {
-        return wch;
+        _matches.push_back({ offset, offset + needle.size() });
     }
 }
 
 // Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(COORD& coord) const noexcept
+// - Maps an offset in the haystack to the cell its code unit came from.
+// Arguments:
+// - offset - The offset in the haystack. May be its size.
+// Return Value:
+// - The index of the cell, counting row by row from the start of the haystack.
+size_t Search::_GetCellAt(const size_t offset) const
 {
-    _uiaData.GetTextBuffer().GetSize().IncrementInBoundsCircular(coord);
+    // _rowOffsets ends with the size of the haystack, which maps to the start of the row after the last.
+    const auto it = std::upper_bound(_rowOffsets.begin(), _rowOffsets.end(), offset);
+    const auto y = gsl::narrow_cast<size_t>(it - _rowOffsets.begin()) - 1;
+    const auto column = offset - til::at(_rowOffsets, y);
+    const auto x = y < _rowColumns.size() && !til::at(_rowColumns, y).empty() ? til::at(til::at(_rowColumns, y), column) : column;
+    return y * _haystackWidth + x;
 }
 
 // Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(COORD& coord) const noexcept
+// - Converts a match into the positions of its first and last cell.
+// Arguments:
+// - match - The match to convert.
+// Return Value:
+// - The [start, end] coord positions of the match.
+std::pair<COORD, COORD> Search::_GetLocation(const Match& match) const
 {
-    _uiaData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
+    const auto width = gsl::narrow_cast<size_t>(_haystackWidth);
+    const auto start = _GetCellAt(match.start);
+    // The end is the cell before the one the next code unit came from, which
+    // includes the trailing half of a wide glyph at the end of the match.
+    const auto end = _GetCellAt(match.end) - 1;
+    return {
+        { gsl::narrow_cast<SHORT>(start % width), gsl::narrow_cast<SHORT>(gsl::narrow_cast<ptrdiff_t>(start / width) + _haystackTop) },
+        { gsl::narrow_cast<SHORT>(end % width), gsl::narrow_cast<SHORT>(gsl::narrow_cast<ptrdiff_t>(end / width) + _haystackTop) },
+    };
 }
 
 // Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
+// - Folds a code unit to lower case, for case-insensitive searches.
+// Arguments:
+// - wch - Character to fold.
 // Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
+// - The lower case character.
+wchar_t Search::s_FoldCase(const wchar_t wch) noexcept
 {
-    if (_direction == Direction::Forward)
+    if (wch < 0x80)
     {
-        _IncrementCoord(_coordNext);
+        return wch >= L'A' && wch <= L'Z' ? wch + (L'a' - L'A') : wch;
     }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
-    }
-    else
+    return ::towlower(wch);
+}
+
+// Routine Description:
+// - Finds the next occurrence of a needle in a haystack.
+// - Candidates are found by comparing the first and the last code unit of the
+//   needle with 8 positions of the haystack at a time (SSE2). Only positions
+//   where both of them match are compared in full.
+// Arguments:
+// - haystack - The text to search through.
+// - needle - The text to search for. Must not be empty.
+// - offset - The offset in the haystack to start at.
+// Return Value:
+// - The offset of the occurrence, or npos if there is none.
+size_t Search::s_FindLiteral(const std::wstring_view haystack, const std::wstring_view needle, const size_t offset) noexcept
+{
+    const auto length = needle.size();
+    if (offset >= haystack.size() || haystack.size() - offset < length)
     {
-        THROW_HR(E_NOTIMPL);
+        return std::wstring_view::npos;
     }
 
-    // To reduce wrap-around time, if the next position is larger than
-    // the end position of the written text
-    // We put the next position to:
-    // Forward: (0, 0)
-    // Backward: the position of the end of the text buffer
-    const COORD bufferEndPosition = _uiaData.GetTextBufferEndPosition();
+    const auto beg = haystack.data();
+    const auto last = beg + (haystack.size() - length); // the last position a match can start at
+    auto it = beg + offset;
 
-    if (_coordNext.Y > bufferEndPosition.Y ||
-        (_coordNext.Y == bufferEndPosition.Y && _coordNext.X > bufferEndPosition.X))
+#if defined(__AVX2__) || defined(_M_AMD64)
     {
-        if (_direction == Direction::Forward)
-        {
-            _coordNext = { 0 };
-        }
-        else
+        const auto head = _mm_set1_epi16(static_cast<short>(needle.front()));
+        const auto tail = _mm_set1_epi16(static_cast<short>(needle.back()));
+
+        for (; last - it >= 8; it += 8)
         {
-            _coordNext = bufferEndPosition;
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + length - 1));
+            // One bit per *byte*, two for each code unit. Only the lower ones are needed.
+            auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(a, head), _mm_cmpeq_epi16(b, tail)))) & 0x5555;
+
+            unsigned long index;
+            while (_BitScanForward(&index, mask))
+            {
+                const auto candidate = it + index / 2;
+                if (wmemcmp(candidate, needle.data(), length) == 0)
+                {
+                    return gsl::narrow_cast<size_t>(candidate - beg);
+                }
+                mask &= mask - 1;
+            }
         }
     }
-}
+#endif
 
-// Routine Description:
-// - Creates a "needle" of the correct format for comparison to the screen buffer text data
-//   that we can use for our search
-// Arguments:
-// - wstr - String that will be our search term
-// Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
-{
-    const auto charData = Utf16Parser::Parse(wstr);
-    std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    for (; it <= last; ++it)
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
+        if (*it == needle.front() && wmemcmp(it, needle.data(), length) == 0)
         {
-            cells.emplace_back(chars);
+            return gsl::narrow_cast<size_t>(it - beg);
         }
-        cells.emplace_back(chars);
     }
-    return cells;
+    return std::wstring_view::npos;
 }
+
+#pragma warning(pop)
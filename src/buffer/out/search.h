@@ -40,47 +40,92 @@ public:
         CaseSensitive
     };
 
+    enum class Syntax
+    {
+        Literal,
+        RegularExpression
+    };
+
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
-           const Sensitivity sensitivity);
+           const Sensitivity sensitivity,
+           const Syntax syntax = Syntax::Literal);
 
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
            const Sensitivity sensitivity,
-           const COORD anchor);
+           const COORD anchor,
+           const Syntax syntax = Syntax::Literal);
+
+    void Update(const std::wstring& str,
+                const Direction dir,
+                const Sensitivity sensitivity,
+                const Syntax syntax = Syntax::Literal);
 
     bool FindNext();
     void Select() const;
     void Color(const TextAttribute attr) const;
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
+    std::vector<std::pair<COORD, COORD>> GetAllFoundLocations();
 
 private:
-    wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
-    void _UpdateNextPosition();
+    // A match, as the range of code units [start, end) in the haystack.
+    struct Match
+    {
+        size_t start;
+        size_t end;
+    };
 
-    void _IncrementCoord(COORD& coord) const noexcept;
-    void _DecrementCoord(COORD& coord) const noexcept;
+    void _Index();
+    bool _IsHaystackCurrent() const;
+    void _BuildHaystack();
+    void _FindAll(const std::optional<std::wstring>& previousNeedle, const Sensitivity previousSensitivity, const Syntax previousSyntax);
+    size_t _GetCellAt(const size_t offset) const;
+    std::pair<COORD, COORD> _GetLocation(const Match& match) const;
 
     static COORD s_GetInitialAnchor(Microsoft::Console::Types::IUiaData& uiaData, const Direction dir);
+    static wchar_t s_FoldCase(const wchar_t wch) noexcept;
+    static size_t s_FindLiteral(const std::wstring_view haystack, const std::wstring_view needle, const size_t offset) noexcept;
 
-    static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
-
-    bool _reachedEnd = false;
-    COORD _coordNext = { 0 };
+    bool _indexed = false;
+    size_t _firstMatch = 0;
+    size_t _matchesFound = 0;
     COORD _coordSelStart = { 0 };
     COORD _coordSelEnd = { 0 };
 
-    const COORD _coordAnchor;
-    const std::vector<std::vector<wchar_t>> _needle;
-    const Direction _direction;
-    const Sensitivity _sensitivity;
+    COORD _coordAnchor;
+    std::wstring _needle;
+    Direction _direction;
+    Sensitivity _sensitivity;
+    Syntax _syntax;
     Microsoft::Console::Types::IUiaData& _uiaData;
 
+    // The text of the buffer up to its last character, as one string. Every
+    // cell contributes its glyph, except for the trailing halves of wide ones.
+    std::wstring _haystack;
+    // The haystack folded to lower case, for case-insensitive literal searches.
+    std::wstring _foldedHaystack;
+    // The offset of every row in the haystack, followed by its length.
+    std::vector<size_t> _rowOffsets;
+    // The column of every code unit, for the rows where it isn't just its offset in the row.
+    std::vector<std::vector<uint16_t>> _rowColumns;
+    // The revision of every row in the haystack, to tell whether it's still current.
+    std::vector<uint32_t> _rowRevisions;
+    // The generation of the buffer the haystack was built from. If it's
+    // still current, the rows are where they were when it was built.
+    std::optional<uint64_t> _haystackGeneration;
+    SHORT _haystackWidth = 0;
+    // The row the haystack starts at. Negative if the buffer has a window
+    // into its scrollback store, which is searched as well.
+    SHORT _haystackTop = 0;
+
+    // Every match of the needle, ordered by position. A sorted set of
+    // intervals, so that extending the needle only needs to check these.
+    std::vector<Match> _matches;
+
 #ifdef UNIT_TESTING
     friend class SearchTests;
 #endif
@@ -10,6 +10,8 @@
 #include "../types/inc/convert.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
 
+#include <execution>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console;
@@ -35,7 +37,15 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
     _storage{},
-    _unicodeStorage{},
+    _scrollback{},
+    _scrollbackWindowEnd{},
+    _scrollbackWindowHeight{ 0 },
+    _generation{ 0 },
+    _scrollbackRows{},
+    _scrollbackRowOrder{},
+    _coldRowDistance{ 0 },
+    _thawedRows{},
+    _thawedRowOrder{},
     _renderTarget{ renderTarget },
     _size{},
     _currentHyperlinkId{ 1 },
@@ -49,6 +59,7 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     }
 
     _UpdateSize();
+    _NextGeneration();
 }
 
 // Routine Description:
@@ -81,13 +92,23 @@ UINT TextBuffer::TotalRowCount() const noexcept
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - const reference to the requested row. Asserts if out of bounds.
-const ROW& TextBuffer::GetRowByOffset(const size_t index) const
+// - A frozen row stays frozen. A thawed copy of it is returned instead,
+//   which is cached by the buffer. That isn't safe to do from several
+//   threads at once, so those have to thaw the rows they read first.
+const ROW& TextBuffer::GetRowByOffset(const ptrdiff_t index) const
 {
+    // Rows above the first row of the buffer come from the scrollback window.
+    if (index < 0)
+    {
+        return _GetScrollbackRow(index);
+    }
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
-    const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    const size_t offsetIndex = (_firstRow + gsl::narrow_cast<size_t>(index)) % totalRows;
+    const auto& row = _storage.at(offsetIndex);
+    return row.IsFrozen() ? _GetThawedRow(row) : row;
 }
 
 // Routine Description:
@@ -97,13 +118,23 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - reference to the requested row. Asserts if out of bounds.
-ROW& TextBuffer::GetRowByOffset(const size_t index)
+// - A frozen row is thawed, until FreezeColdRows freezes it again.
+ROW& TextBuffer::GetRowByOffset(const ptrdiff_t index)
 {
+    // Rows above the first row of the buffer come from the scrollback window.
+    // They're thawed copies, so any changes made to them are discarded.
+    if (index < 0)
+    {
+        return _GetScrollbackRow(index);
+    }
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
-    const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    const size_t offsetIndex = (_firstRow + gsl::narrow_cast<size_t>(index)) % totalRows;
+    auto& row = _storage.at(offsetIndex);
+    row.Thaw();
+    return row;
 }
 
 // Routine Description:
@@ -184,6 +215,38 @@ TextBufferCellIterator TextBuffer::GetCellDataAt(const COORD at, const Viewport
     return TextBufferCellIterator(*this, at, limit);
 }
 
+// Routine Description:
+// - Retrieves a read-only iterator over the runs of cells that share the same
+//   attributes, from the given buffer location to the end of its row.
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// Return Value:
+// - Read-only iterator of runs of cells.
+TextBufferRunIterator TextBuffer::GetRunsAt(const COORD at) const
+{
+    SMALL_RECT limit;
+    limit.Top = at.Y;
+    limit.Bottom = at.Y;
+    limit.Left = 0;
+    limit.Right = GetSize().RightInclusive();
+
+    return TextBufferRunIterator(*this, at, Viewport::FromInclusive(limit));
+}
+
+// Routine Description:
+// - Retrieves a read-only iterator over the runs of cells that share the same
+//   attributes, starting at the given buffer location and ending at the right
+//   edge of the given viewport. Only the row of the location is walked through.
+// Arguments:
+// - at - X,Y position in buffer for iterator start position
+// - limit - boundaries for the iterator to operate within
+// Return Value:
+// - Read-only iterator of runs of cells.
+TextBufferRunIterator TextBuffer::GetRunsAt(const COORD at, const Viewport limit) const
+{
+    return TextBufferRunIterator(*this, at, limit);
+}
+
 //Routine Description:
 // - Corrects and enforces consistent double byte character state (KAttrs line) within a row of the text buffer.
 // - This will take the given double byte information and check that it will be consistent when inserted into the buffer
@@ -391,6 +454,84 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes a run of printable text to the output buffer as a stream.
+// - Each row is filled with as many cells as fit in a single pass. When a row
+//   runs out of space, it's marked as wrapped and writing continues at the
+//   start of the next row. Wide glyphs that would straddle the end of a row
+//   are padded onto the next one.
+// - If the text runs past the bottom of the buffer, the buffer is circled.
+// Arguments:
+// - text - The UTF-16 text to write. Control characters are written as-is.
+// - attr - The attribute to apply to every cell that's written
+// - target - The position to start writing at. An X coordinate at (or past) the
+//   width of the row means the row is already full and writing starts on the next one.
+// - allowCircling - If false, writing stops at the bottom of the buffer instead
+//   of circling it. Used by callers that manage scrolling on their own.
+// Return Value:
+// - The position following the last cell written, the number of code units
+//   consumed, the number of cells written and the number of times the buffer circled.
+//   The X coordinate is equal to the row width if the final row was filled exactly.
+TextBuffer::WriteStreamResult TextBuffer::WriteStream(const std::wstring_view text,
+                                                      const TextAttribute& attr,
+                                                      const COORD target,
+                                                      const bool allowCircling)
+{
+    WriteStreamResult result;
+    auto& position = result.cursorPosition;
+    position = target;
+
+    const OutputCellIterator begin{ text, attr };
+    auto it = begin;
+    const auto bufferHeight = GetSize().Height();
+
+    while (it)
+    {
+        // If the previous row is full, move onto the next one first.
+        if (position.X >= GetLineWidth(position.Y))
+        {
+            if (position.Y + 1 < bufferHeight)
+            {
+                position.Y++;
+            }
+            else if (allowCircling && IncrementCircularBuffer())
+            {
+                result.rowsCircled++;
+            }
+            else
+            {
+                break;
+            }
+            position.X = 0;
+        }
+
+        const auto lineWidth = GetLineWidth(position.Y);
+        const auto rowStart = it;
+        it = GetRowByOffset(position.Y).WriteCells(it, position.X, true, gsl::narrow_cast<size_t>(lineWidth) - 1);
+
+        const auto written = gsl::narrow<SHORT>(it.GetCellDistance(rowStart));
+        if (written > 0)
+        {
+            _NotifyPaint(Viewport::FromDimensions(position, { written, 1 }));
+        }
+        else if (position.X == 0)
+        {
+            // A glyph that doesn't even fit into an empty row (a wide glyph
+            // in a 1 column buffer) would make us loop forever.
+            break;
+        }
+
+        result.cellsWritten += written;
+
+        // If there's still text left, this row is full. This includes the
+        // case where a wide glyph was padded over to the next row.
+        position.X = it ? lineWidth : position.X + written;
+    }
+
+    result.charsConsumed = it.GetInputDistance(begin);
+    return result;
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -421,8 +562,8 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
 
         try
         {
-            charRow.GlyphAt(iCol) = chars;
             charRow.DbcsAttrAt(iCol) = dbcsAttribute;
+            charRow.GlyphAt(iCol) = chars;
         }
         catch (...)
         {
@@ -560,6 +701,16 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
     // Prune hyperlinks to delete obsolete references
     _PruneHyperlinks();
 
+    // Preserve the contents of the old "first row" in the scrollback, if it's enabled.
+    if (_scrollback.GetLimit() != 0)
+    {
+        try
+        {
+            _scrollback.Append(_storage.at(_firstRow));
+        }
+        CATCH_LOG();
+    }
+
     // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     auto fillAttributes = _currentAttributes;
     if (inVtMode)
@@ -580,6 +731,21 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         {
             _firstRow = 0;
         }
+
+        // Every row moved up, and the scrollback window slid along.
+        _NextGeneration();
+
+        // We only circle while writing into the last row. Whatever is now
+        // the cold distance above it has scrolled far enough out of sight.
+        const auto coldRow = GetSize().Height() - 1 - _coldRowDistance;
+        if (_coldRowDistance > 0 && coldRow >= 0)
+        {
+            try
+            {
+                _storage.at((_firstRow + gsl::narrow_cast<size_t>(coldRow)) % TotalRowCount()).Freeze();
+            }
+            CATCH_LOG();
+        }
     }
     return fSuccess;
 }
@@ -678,6 +844,28 @@ void TextBuffer::_UpdateSize()
 void TextBuffer::_SetFirstRowIndex(const SHORT FirstRowIndex) noexcept
 {
     _firstRow = FirstRowIndex;
+    _NextGeneration();
+}
+
+// Routine Description:
+// - Gives the buffer a new generation, after rows moved to other offsets.
+void TextBuffer::_NextGeneration() noexcept
+{
+    static std::atomic<uint64_t> s_lastGeneration{ 0 };
+    _generation = s_lastGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    _scrollbackWindowHeight = GetScrollbackWindowHeight();
+}
+
+// Routine Description:
+// - Gets the generation of the buffer. It changes whenever rows move to other
+//   offsets: when the buffer circles, is scrolled or resized, and when the
+//   scrollback window above it slides. Together with the revisions of its
+//   rows, it tells whether anything read from the buffer is still current.
+// Return Value:
+// - the generation, which no other buffer has had
+uint64_t TextBuffer::GetGeneration() const noexcept
+{
+    return _generation;
 }
 
 void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta)
@@ -777,8 +965,61 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
     }
 
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
     _RefreshRowIDs(std::nullopt);
+    _NextGeneration();
+}
+
+// Routine Description:
+// - Copies a rectangle of cells to another position in the buffer, a run of
+//   cells per row. The source and the target may overlap: the rows are walked
+//   in the direction that reads every source row before it's overwritten.
+// Arguments:
+// - source - the rectangle to copy. Has to be within the buffer.
+// - targetOrigin - the top left corner of the copy. The target rectangle
+//   of the same size has to be within the buffer.
+// Return Value:
+// - <none>
+// Note: will throw exception if either rectangle is out of bounds
+void TextBuffer::CopyRectangle(const Viewport& source, const COORD targetOrigin)
+{
+    const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(source) || !GetSize().IsInBounds(target));
+
+    const auto height = source.Height();
+    const auto bottomUp = target.Top() > source.Top();
+    for (SHORT i = 0; i < height; ++i)
+    {
+        const auto offset = bottomUp ? height - 1 - i : i;
+        const ROW& sourceRow = GetRowByOffset(source.Top() + offset);
+        ROW& targetRow = GetRowByOffset(target.Top() + offset);
+        targetRow.CopyCells(sourceRow, source.Left(), source.RightExclusive(), target.Left());
+    }
+
+    _NotifyPaint(target);
+}
+
+// Routine Description:
+// - Fills a rectangle of cells with the same narrow glyph and attribute, a run
+//   of cells per row. Like writing a block of cells, this unwraps every row.
+// Arguments:
+// - rect - the rectangle to fill. Has to be within the buffer.
+// - wch - the glyph to fill the cells with. Has to be a narrow glyph.
+// - attr - the attribute to fill the cells with
+// Return Value:
+// - <none>
+// Note: will throw exception if the rectangle is out of bounds
+void TextBuffer::FillRectangle(const Viewport& rect, const wchar_t wch, const TextAttribute& attr)
+{
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(rect));
+
+    for (auto y = rect.Top(); y < rect.BottomExclusive(); ++y)
+    {
+        ROW& row = GetRowByOffset(y);
+        row.FillCells(rect.Left(), rect.RightExclusive(), wch, attr);
+        row.SetWrapForced(false);
+    }
+
+    _NotifyPaint(rect);
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -836,17 +1077,17 @@ void TextBuffer::ResetLineRenditionRange(const size_t startRow, const size_t end
     }
 }
 
-LineRendition TextBuffer::GetLineRendition(const size_t row) const
+LineRendition TextBuffer::GetLineRendition(const ptrdiff_t row) const
 {
     return GetRowByOffset(row).GetLineRendition();
 }
 
-bool TextBuffer::IsDoubleWidthLine(const size_t row) const
+bool TextBuffer::IsDoubleWidthLine(const ptrdiff_t row) const
 {
     return GetLineRendition(row) != LineRendition::SingleWidth;
 }
 
-SHORT TextBuffer::GetLineWidth(const size_t row) const
+SHORT TextBuffer::GetLineWidth(const ptrdiff_t row) const
 {
     // Use shift right to quickly divide the width by 2 for double width lines.
     const SHORT scale = IsDoubleWidthLine(row) ? 1 : 0;
@@ -930,52 +1171,302 @@ void TextBuffer::Reset()
         }
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
+        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension.
         _RefreshRowIDs(newSize.X);
 
+        // The rows thawed out of the scrollback have the old width.
+        _scrollbackRows.clear();
+        _scrollbackRowOrder.clear();
+        _thawedRows.clear();
+        _thawedRowOrder.clear();
+
         // Update the cached size value
         _UpdateSize();
+        _NextGeneration();
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
+// Routine Description:
+// - Gets the rows that circled out of the top of the buffer. They're numbered
+//   with 64-bit logical row numbers and the first row of the buffer continues
+//   at GetScrollback().GetEndRowNumber().
+// Return Value:
+// - the scrollback store of this buffer
+const ScrollbackStore& TextBuffer::GetScrollback() const noexcept
+{
+    return _scrollback;
+}
+
+ScrollbackStore& TextBuffer::GetScrollback() noexcept
 {
-    return _unicodeStorage;
+    return _scrollback;
 }
 
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
+// Routine Description:
+// - Gets the number of rows of the scrollback that are mapped above the first
+//   row of the buffer, as the rows -1, -2 and so on. They're a window of the
+//   scrollback that ends at GetScrollbackWindowEnd(). Together with the rows
+//   of the buffer they're limited to SHORT_MAX rows.
+// Return Value:
+// - the number of rows of the scrollback window
+SHORT TextBuffer::GetScrollbackWindowHeight() const noexcept
 {
-    return _unicodeStorage;
+    const auto end = _scrollbackWindowEnd.value_or(_scrollback.GetEndRowNumber());
+    const auto first = _scrollback.GetFirstRowNumber();
+    const auto available = end > first ? end - first : 0;
+    const auto room = gsl::narrow_cast<uint64_t>(SHORT_MAX - _size.Height());
+    return gsl::narrow_cast<SHORT>(std::min(available, room));
+}
+
+// Routine Description:
+// - Gets the row following the last row of the scrollback window.
+// Return Value:
+// - the logical row number, or nullopt if the window ends with the newest row
+//   of the scrollback and is thus followed by the first row of the buffer.
+std::optional<ScrollbackStore::row_number> TextBuffer::GetScrollbackWindowEnd() const noexcept
+{
+    return _scrollbackWindowEnd;
+}
+
+// Routine Description:
+// - Moves the scrollback window, so that older rows of the scrollback can be
+//   addressed with the (SHORT) row offsets of the buffer. The rows between the
+//   end of the window and the first row of the buffer can't be addressed then.
+//   The caller is responsible for adjusting any offsets it holds on to.
+// Arguments:
+// - end - the row following the last row of the window, or nullopt to map the
+//         newest rows of the scrollback again.
+void TextBuffer::SetScrollbackWindowEnd(const std::optional<ScrollbackStore::row_number> end) noexcept
+{
+    const auto oldEnd = _scrollbackWindowEnd;
+    if (end && *end < _scrollback.GetEndRowNumber())
+    {
+        _scrollbackWindowEnd = end;
+    }
+    else
+    {
+        _scrollbackWindowEnd.reset();
+    }
+
+    // The window slides if its end moves, but also if rows were cleared or
+    // trimmed from the scrollback since the generation last changed.
+    if (_scrollbackWindowEnd != oldEnd || GetScrollbackWindowHeight() != _scrollbackWindowHeight)
+    {
+        _NextGeneration();
+    }
+}
+
+// Routine Description:
+// - Gets the size of the buffer including the scrollback window above it.
+//   Use this instead of GetSize() to clamp or step through positions that
+//   may be in the scrollback, like the ones of the selection.
+// Return Value:
+// - the area of the buffer and its scrollback window. Its top is negative
+//   if there's any scrollback.
+const Viewport TextBuffer::GetSizeWithScrollback() const noexcept
+{
+    const auto windowHeight = GetScrollbackWindowHeight();
+    const COORD origin{ 0, gsl::narrow_cast<SHORT>(-windowHeight) };
+    const COORD dimensions{ _size.Width(), gsl::narrow_cast<SHORT>(_size.Height() + windowHeight) };
+    return Viewport::FromDimensions(origin, dimensions);
+}
+
+// Routine Description:
+// - Gets the logical row number of a row of the buffer or its scrollback
+//   window. Unlike the row offsets, they don't change as the buffer circles.
+// Arguments:
+// - row - the offset of the row, negative ones are in the scrollback window
+// Return Value:
+// - the logical row number of the row
+ScrollbackStore::row_number TextBuffer::GetRowNumber(const ptrdiff_t row) const noexcept
+{
+    if (row < 0)
+    {
+        const auto end = _scrollbackWindowEnd.value_or(_scrollback.GetEndRowNumber());
+        return end - gsl::narrow_cast<uint64_t>(-row);
+    }
+    return _scrollback.GetEndRowNumber() + gsl::narrow_cast<uint64_t>(row);
+}
+
+// Routine Description:
+// - The inverse of GetRowNumber.
+// Arguments:
+// - rowNumber - the logical row number of a row
+// Return Value:
+// - the offset of the row, or nullopt if it's neither in the buffer nor in
+//   the scrollback window.
+std::optional<SHORT> TextBuffer::GetRowOffset(const ScrollbackStore::row_number rowNumber) const noexcept
+{
+    const auto bufferStart = _scrollback.GetEndRowNumber();
+    if (rowNumber >= bufferStart)
+    {
+        const auto offset = rowNumber - bufferStart;
+        return offset < gsl::narrow_cast<uint64_t>(_size.Height()) ? std::optional{ gsl::narrow_cast<SHORT>(offset) } : std::nullopt;
+    }
+
+    const auto windowEnd = _scrollbackWindowEnd.value_or(bufferStart);
+    const auto windowHeight = gsl::narrow_cast<uint64_t>(GetScrollbackWindowHeight());
+    if (rowNumber < windowEnd && windowEnd - rowNumber <= windowHeight)
+    {
+        return gsl::narrow_cast<SHORT>(-gsl::narrow_cast<ptrdiff_t>(windowEnd - rowNumber));
+    }
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Gets a row of the scrollback window, thawed out of the scrollback. The
+//   renderer and the selection ask for the same rows over and over, so the
+//   most recently thawed rows are kept around.
+// Arguments:
+// - index - the negative offset of the row
+// Return Value:
+// - the thawed row. It stays valid until ScrollbackRowCacheSize other rows
+//   of the scrollback were thawed.
+// Note: will throw exception if the row isn't in the scrollback window
+ROW& TextBuffer::_GetScrollbackRow(const ptrdiff_t index) const
+{
+    THROW_HR_IF(E_INVALIDARG, index < -GetScrollbackWindowHeight());
+
+    const auto rowNumber = GetRowNumber(index);
+    if (const auto it = _scrollbackRows.find(rowNumber); it != _scrollbackRows.end())
+    {
+        return it->second;
+    }
+
+    if (_scrollbackRowOrder.size() >= ScrollbackRowCacheSize)
+    {
+        _scrollbackRows.erase(_scrollbackRowOrder.front());
+        _scrollbackRowOrder.pop_front();
+    }
+
+    auto& row = _scrollbackRows.try_emplace(rowNumber, gsl::narrow_cast<SHORT>(index), gsl::narrow_cast<unsigned short>(_size.Width()), _currentAttributes, nullptr).first->second;
+    _scrollbackRowOrder.push_back(rowNumber);
+    try
+    {
+        _scrollback.CopyTo(rowNumber, row);
+    }
+    catch (...)
+    {
+        _scrollbackRowOrder.pop_back();
+        _scrollbackRows.erase(rowNumber);
+        throw;
+    }
+    return row;
+}
+
+// Routine Description:
+// - Gets a thawed copy of a frozen row. The renderer and the selection ask
+//   for the same rows over and over, so the most recently thawed copies are
+//   kept around, until FreezeColdRows drops them.
+// Arguments:
+// - row - the frozen row
+// Return Value:
+// - the thawed copy. It stays valid until ThawedRowCacheSize other rows were
+//   thawed, or until FreezeColdRows is called.
+const ROW& TextBuffer::_GetThawedRow(const ROW& row) const
+{
+    auto frozen = row.GetFrozen();
+    if (const auto it = _thawedRows.find(frozen.get()); it != _thawedRows.end())
+    {
+        // The contents can't change without thawing the row, but the
+        // properties can. The wrapping is part of the revision.
+        auto& thawed = it->second;
+        if (thawed.GetRevision() != row.GetRevision())
+        {
+            thawed.SetWrapForced(row.WasWrapForced());
+        }
+        thawed.SetId(row.GetId());
+        thawed.SetLineRendition(row.GetLineRendition());
+        thawed.SetDoubleBytePadded(row.WasDoubleBytePadded());
+        return thawed;
+    }
+
+    if (_thawedRowOrder.size() >= ThawedRowCacheSize)
+    {
+        _thawedRows.erase(_thawedRowOrder.front().get());
+        _thawedRowOrder.pop_front();
+    }
+
+    // The copy keeps the revision of the row, so that it can't be told apart from it.
+    auto& thawed = _thawedRows.try_emplace(frozen.get(), row).first->second;
+    try
+    {
+        thawed.Thaw();
+        _thawedRowOrder.emplace_back(std::move(frozen));
+    }
+    catch (...)
+    {
+        _thawedRows.erase(frozen.get());
+        throw;
+    }
+    return thawed;
+}
+
+// Routine Description:
+// - Sets how far above the cursor rows have to be before they're frozen
+//   into their compact form (see ROW::Freeze). Rows are frozen as they
+//   scroll past that distance. Writing to them thaws them again.
+// Arguments:
+// - distance - the distance in rows. 0 disables freezing.
+void TextBuffer::SetColdRowDistance(const SHORT distance) noexcept
+{
+    _coldRowDistance = std::max<SHORT>(distance, 0);
+}
+
+SHORT TextBuffer::GetColdRowDistance() const noexcept
+{
+    return _coldRowDistance;
+}
+
+// Routine Description:
+// - Freezes all rows that are at least the cold distance above the cursor
+//   and drops the copies of frozen rows that were thawed for reading them.
+//   Rows are usually frozen one at a time as they scroll out of sight. This
+//   catches up after operations that rewrote many rows at once, like a
+//   reflow, and after reading many of them, like a search.
+void TextBuffer::FreezeColdRows() noexcept
+{
+    _thawedRows.clear();
+    _thawedRowOrder.clear();
+
+    if (_coldRowDistance <= 0)
+    {
+        return;
+    }
+
+    const auto end = _cursor.GetPosition().Y - _coldRowDistance;
+    for (SHORT y = 0; y < end; ++y)
+    {
+        try
+        {
+            _storage.at((_firstRow + gsl::narrow_cast<size_t>(y)) % TotalRowCount()).Freeze();
+        }
+        CATCH_LOG();
+    }
 }
 
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
-// - This will also update parent pointers that are stored in depth within the buffer
-//   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - Optionally takes a new row width if we're resizing to perform a resize operation
+//   while we're already looping through the rows. Every row keeps its own glyph data,
+//   so there's nothing else to re-key after the rows moved around, except for the
+//   pattern cache, which is keyed by the position of the rows in the storage.
 // Arguments:
 // - newRowWidth - Optional new value for the row width.
 void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
 {
-    std::unordered_map<SHORT, SHORT> rowMap;
+    _patternCache.clear();
+
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
         // Update the IDs
         it.SetId(i++);
 
-        // Also update the char row parent pointers as they can get shuffled up in the rotates.
-        it.GetCharRow().UpdateParent(&it);
-
         // Resize the rows in the X dimension if we have a new width
         if (newRowWidth.has_value())
         {
@@ -983,9 +1474,6 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
             THROW_IF_FAILED(it.Resize(newRowWidth.value()));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -1022,7 +1510,9 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
     }
 
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage.at(prevRowIndex);
+    auto& prevRow = _storage.at(prevRowIndex);
+    prevRow.Thaw();
+    return prevRow;
 }
 
 // Method Description:
@@ -1074,7 +1564,8 @@ const COORD TextBuffer::GetWordStart(const COORD target, const std::wstring_view
 
 #pragma warning(suppress : 26496)
     auto copy{ target };
-    const auto bufferSize{ GetSize() };
+    // Selections can extend into the scrollback window, UIA doesn't know about it.
+    const auto bufferSize{ accessibilityMode ? GetSize() : GetSizeWithScrollback() };
     const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
     if (target == bufferSize.Origin())
     {
@@ -1158,7 +1649,7 @@ const COORD TextBuffer::_GetWordStartForAccessibility(const COORD target, const
 const COORD TextBuffer::_GetWordStartForSelection(const COORD target, const std::wstring_view wordDelimiters) const
 {
     COORD result = target;
-    const auto bufferSize = GetSize();
+    const auto bufferSize = GetSizeWithScrollback();
 
     const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
 
@@ -1201,7 +1692,8 @@ const COORD TextBuffer::GetWordEnd(const COORD target, const std::wstring_view w
     // NOTE: the end anchor (this one) is exclusive, whereas the start anchor (GetWordStart) is inclusive
 
     // Already at/past the limit. Can't move forward.
-    const auto bufferSize{ GetSize() };
+    // Selections can extend into the scrollback window, UIA doesn't know about it.
+    const auto bufferSize{ accessibilityMode ? GetSize() : GetSizeWithScrollback() };
     const auto limit{ limitOptional.value_or(bufferSize.EndExclusive()) };
     if (bufferSize.CompareInBounds(target, limit, true) >= 0)
     {
@@ -1278,7 +1770,7 @@ const COORD TextBuffer::_GetWordEndForAccessibility(const COORD target, const st
 // - The COORD for the last character of the current word or delimiter run (stopped by right margin)
 const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::wstring_view wordDelimiters) const
 {
-    const auto bufferSize = GetSize();
+    const auto bufferSize = GetSizeWithScrollback();
 
     // can't expand right
     if (target.X == bufferSize.RightInclusive())
@@ -1311,7 +1803,7 @@ void TextBuffer::_PruneHyperlinks()
     // If the buffer does not contain the same reference, we can remove that hyperlink from our map
     // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
     // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
+    const auto hyperlinks = _storage.at(_firstRow).GetHyperlinks();
 
     if (!hyperlinks.empty())
     {
@@ -1324,10 +1816,11 @@ void TextBuffer::_PruneHyperlinks()
         // Loop through all the rows in the buffer except the first row -
         // we have found all hyperlink references in the first row and put them in refs,
         // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
+        // to see if those references are anywhere else.
+        // Frozen rows are only peeked at, so that this doesn't thaw them.
         for (size_t i = 1; i != total; ++i)
         {
-            const auto nextRowRefs = GetRowByOffset(i).GetAttrRow().GetHyperlinks();
+            const auto nextRowRefs = _storage.at((_firstRow + i) % total).GetHyperlinks();
             for (auto id : nextRowRefs)
             {
                 if (firstRowRefs.find(id) != firstRowRefs.end())
@@ -1555,7 +2048,8 @@ const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, b
 {
     std::vector<SMALL_RECT> textRects;
 
-    const auto bufferSize = GetSize();
+    // The selection can extend into the scrollback window.
+    const auto bufferSize = GetSizeWithScrollback();
 
     // (0,0) is the top-left of the screen
     // the physically "higher" coordinate is closer to the top-left
@@ -1608,7 +2102,7 @@ const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, b
 // - modifies selectionRow's Left and Right values to expand properly
 void TextBuffer::_ExpandTextRow(SMALL_RECT& textRow) const
 {
-    const auto bufferSize = GetSize();
+    const auto bufferSize = GetSizeWithScrollback();
 
     // expand left side of rect
     COORD targetPoint{ textRow.Left, textRow.Top };
@@ -2145,11 +2639,314 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
     }
 }
 
+namespace
+{
+    // The fewest rows a chunk of a parallel reflow consists of.
+    // Buffers with fewer rows than that are reflowed on the calling thread.
+    constexpr size_t ReflowRowsPerChunk = 512;
+
+    // A run of cells that's copied from one row of the old buffer into one row of the new buffer.
+    struct ReflowRun
+    {
+        size_t sourceRow;
+        uint16_t sourceBegin;
+        uint16_t sourceEnd;
+        uint16_t target;
+    };
+
+    // The layout of a row of the new buffer.
+    struct ReflowRow
+    {
+        size_t firstRun;
+        size_t endRun;
+        LineRendition lineRendition;
+        bool wrapForced;
+        bool doubleBytePadded;
+    };
+
+    // A leading byte that has to be erased, because it's not followed by its trailing byte.
+    struct ReflowErasure
+    {
+        size_t row;
+        uint16_t column;
+    };
+
+    // A range of logical lines of the old buffer, laid out independently of the
+    // others. Since every logical line ends with a newline, the layout of a chunk
+    // only depends on where the chunk starts, which is always the start of a row.
+    struct ReflowChunk
+    {
+        size_t firstOldRow;
+        size_t endOldRow;
+
+        std::vector<ReflowRow> rows;
+        std::vector<ReflowRun> runs;
+        std::vector<ReflowErasure> erasures;
+
+        // The position the new cursor ended up at, relative to the chunk's first row.
+        size_t endX{ 0 };
+        size_t endY{ 0 };
+
+        // The first row of the chunk in the new buffer, before it circled.
+        size_t firstNewRow{ 0 };
+
+        std::optional<std::pair<size_t, size_t>> cursor;
+        std::optional<size_t> mutableViewportTop;
+        std::optional<size_t> visibleViewportTop;
+
+        // The first character inserted at the chunk's origin, whose validity
+        // depends on the last cell of the previous chunk.
+        std::optional<DbcsAttribute> firstInserted;
+        std::optional<std::pair<size_t, size_t>> lastInserted;
+        DbcsAttribute lastInsertedAttr;
+
+        HRESULT hr{ S_OK };
+    };
+
+    // The parameters of a reflow, shared by all chunks.
+    struct ReflowLayout
+    {
+        const TextBuffer& oldBuffer;
+        const std::vector<SHORT>& rights;
+        COORD oldCursor;
+        size_t oldRowsTotal;
+        std::optional<size_t> mutableViewportTop;
+        std::optional<size_t> visibleViewportTop;
+        SHORT newWidth;
+        SHORT newHeight;
+    };
+
+    // Routine Description:
+    // - Calls func for every chunk, in parallel if there's more than one.
+    //   func must not throw. It may only read rows of the old buffer that
+    //   aren't frozen, because reading a frozen one thaws a shared copy.
+    template<typename Func>
+    void ForEachReflowChunk(std::vector<ReflowChunk>& chunks, Func&& func)
+    {
+        if (chunks.size() > 1)
+        {
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), func);
+        }
+        else
+        {
+            std::for_each(chunks.begin(), chunks.end(), func);
+        }
+    }
+
+    // Routine Description:
+    // - Lays out the rows of a chunk of the old buffer in the new buffer, exactly as
+    //   if every character was inserted at the cursor of the new buffer, one by one.
+    // Arguments:
+    // - layout - the parameters of the reflow
+    // - chunk - the chunk to lay out. Receives the rows, runs and positions.
+    void LayoutReflowChunk(const ReflowLayout& layout, ReflowChunk& chunk)
+    {
+        auto& rows = chunk.rows;
+        size_t x = 0;
+        size_t y = 0;
+
+        const auto newRow = [&]() {
+            rows.push_back({ chunk.runs.size(), chunk.runs.size(), LineRendition::SingleWidth, false, false });
+        };
+        const auto lineWidth = [&](const size_t row) noexcept -> ptrdiff_t {
+            const SHORT scale = til::at(rows, row).lineRendition != LineRendition::SingleWidth ? 1 : 0;
+            return layout.newWidth >> scale;
+        };
+        const auto newline = [&]() {
+            x = 0;
+            ++y;
+            if (rows.size() <= y)
+            {
+                newRow();
+            }
+        };
+        const auto increment = [&]() {
+            ++x;
+            if (gsl::narrow_cast<ptrdiff_t>(x) > lineWidth(y) - 1)
+            {
+                til::at(rows, y).wrapForced = true;
+                newline();
+            }
+        };
+
+        newRow();
+
+        for (auto oldRow = chunk.firstOldRow; oldRow < chunk.endOldRow; ++oldRow)
+        {
+            const ROW& row = layout.oldBuffer.GetRowByOffset(oldRow);
+            const auto& charRow = row.GetCharRow();
+            const auto oldColsTotal = layout.oldBuffer.GetLineWidth(oldRow);
+            const auto right = til::at(layout.rights, oldRow);
+
+            // If we're starting a new row, try and preserve the line rendition
+            // from the row in the original buffer.
+            if (x == 0)
+            {
+                til::at(rows, y).lineRendition = row.GetLineRendition();
+            }
+
+            auto cell = charRow.cbegin();
+            for (SHORT oldCol = 0; oldCol < right; ++oldCol, ++cell)
+            {
+                if (oldCol == layout.oldCursor.X && oldRow == gsl::narrow_cast<size_t>(layout.oldCursor.Y))
+                {
+                    chunk.cursor.emplace(x, y);
+                }
+
+                const auto dbcsAttr = cell->DbcsAttr();
+
+                // A leading byte that isn't followed by its trailing byte is erased.
+                // The cell before the chunk's origin belongs to the previous chunk.
+                std::optional<std::pair<size_t, size_t>> previous;
+                if (x > 0)
+                {
+                    previous.emplace(x - 1, y);
+                }
+                else if (y > 0 && layout.newHeight > 1)
+                {
+                    if (lineWidth(y - 1) > 0)
+                    {
+                        previous.emplace(gsl::narrow_cast<size_t>(lineWidth(y - 1) - 1), y - 1);
+                    }
+                }
+                else if (y == 0)
+                {
+                    chunk.firstInserted = dbcsAttr;
+                }
+
+                if (previous && previous == chunk.lastInserted && chunk.lastInsertedAttr.IsLeading() && !dbcsAttr.IsTrailing())
+                {
+                    chunk.erasures.push_back({ previous->second, gsl::narrow_cast<uint16_t>(previous->first) });
+                }
+
+                // If we're about to lead on the last column in the row, we need to add a padding space.
+                if (dbcsAttr.IsLeading() && gsl::narrow_cast<ptrdiff_t>(x) == lineWidth(y) - 1)
+                {
+                    til::at(rows, y).doubleBytePadded = true;
+                    increment();
+                }
+
+                // Extend the previous run if this cell directly follows it in both buffers.
+                auto& target = til::at(rows, y);
+                const auto column = gsl::narrow_cast<uint16_t>(oldCol);
+                if (target.endRun > target.firstRun)
+                {
+                    auto& run = chunk.runs.back();
+                    if (run.sourceRow == oldRow && run.sourceEnd == column && gsl::narrow_cast<size_t>(run.target) + run.sourceEnd - run.sourceBegin == x)
+                    {
+                        ++run.sourceEnd;
+                        chunk.lastInserted.emplace(x, y);
+                        chunk.lastInsertedAttr = dbcsAttr;
+                        increment();
+                        continue;
+                    }
+                }
+
+                chunk.runs.push_back({ oldRow, column, gsl::narrow_cast<uint16_t>(column + 1), gsl::narrow_cast<uint16_t>(x) });
+                target.endRun = chunk.runs.size();
+                chunk.lastInserted.emplace(x, y);
+                chunk.lastInsertedAttr = dbcsAttr;
+                increment();
+            }
+
+            // Note the new location of the _end_ of the rows the caller was interested in.
+            if (oldRow == layout.mutableViewportTop)
+            {
+                chunk.mutableViewportTop = y;
+            }
+            if (oldRow == layout.visibleViewportTop)
+            {
+                chunk.visibleViewportTop = y;
+            }
+
+            // If we didn't have a full row to copy, insert a new line. Only do so
+            // if we were not forced to wrap. If we did force a word wrap, then the
+            // existing line break was only because we ran out of space.
+            if (right < oldColsTotal && !row.WasWrapForced())
+            {
+                if (right == layout.oldCursor.X && oldRow == gsl::narrow_cast<size_t>(layout.oldCursor.Y))
+                {
+                    chunk.cursor.emplace(x, y);
+                }
+
+                // On the final line, we want the cursor to sit where it is done
+                // printing. Unless the line just barely fit into the new buffer and
+                // caused a soft return. Then we insert one more hard newline, so
+                // that a later reflow doesn't lose the hard return.
+                if (oldRow < layout.oldRowsTotal - 1)
+                {
+                    newline();
+                }
+                else if (x == 0 && y > 0 && layout.newHeight > 1 && til::at(rows, y - 1).wrapForced)
+                {
+                    newline();
+                }
+            }
+        }
+
+        chunk.endX = x;
+        chunk.endY = y;
+    }
+
+    // Routine Description:
+    // - Writes a row that was laid out by LayoutReflowChunk into the new buffer.
+    // Arguments:
+    // - oldBuffer - the buffer the runs are copied from
+    // - chunk - the chunk the row belongs to
+    // - index - the index of the row in the chunk
+    // - target - the row to write to. Has to be blank.
+    void ApplyReflowRow(const TextBuffer& oldBuffer, const ReflowChunk& chunk, const size_t index, ROW& target)
+    {
+        const auto& layout = til::at(chunk.rows, index);
+        target.SetLineRendition(layout.lineRendition);
+        target.SetWrapForced(layout.wrapForced);
+        target.SetDoubleBytePadded(layout.doubleBytePadded);
+
+        if (layout.endRun == layout.firstRun)
+        {
+            return;
+        }
+
+        auto& charRow = target.GetCharRow();
+        auto& attrRow = target.GetAttrRow();
+        for (auto i = layout.firstRun; i < layout.endRun; ++i)
+        {
+            const auto& run = til::at(chunk.runs, i);
+            const ROW& source = oldBuffer.GetRowByOffset(run.sourceRow);
+            charRow.CopyCells(source.GetCharRow(), run.sourceBegin, run.sourceEnd, run.target);
+            attrRow.CopyRange(source.GetAttrRow(), run.sourceBegin, run.sourceEnd, run.target);
+        }
+
+        // Every character inserted into a row colors the rest of it.
+        if (layout.endRun > layout.firstRun)
+        {
+            const auto& run = til::at(chunk.runs, layout.endRun - 1);
+            const auto end = gsl::narrow_cast<uint16_t>(run.target + run.sourceEnd - run.sourceBegin);
+            if (end < target.size())
+            {
+                const auto attr = oldBuffer.GetRowByOffset(run.sourceRow).GetAttrRow().GetAttrByColumn(run.sourceEnd - 1);
+                attrRow.SetAttrToEnd(end, attr);
+            }
+        }
+
+        for (const auto& erasure : chunk.erasures)
+        {
+            if (erasure.row == index)
+            {
+                target.ClearColumn(erasure.column);
+            }
+        }
+    }
+}
+
 // Function Description:
 // - Reflow the contents from the old buffer into the new buffer. The new buffer
 //   can have different dimensions than the old buffer. If it does, then this
 //   function will attempt to maintain the logical contents of the old buffer,
 //   by continuing wrapped lines onto the next line in the new buffer.
+// - The logical lines are laid out in parallel chunks first, the same way
+//   inserting their characters one by one would lay them out. Then the cells
+//   and attributes are copied into the new buffer run by run.
 // Arguments:
 // - oldBuffer - the text buffer to copy the contents FROM
 // - newBuffer - the text buffer to copy the contents TO
@@ -2169,6 +2966,10 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
     const Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
 
+    // The history moves over first, so that rows which don't fit into the new buffer are appended to it.
+    newBuffer._scrollback = std::move(oldBuffer._scrollback);
+    newBuffer._coldRowDistance = oldBuffer._coldRowDistance;
+
     // We need to save the old cursor position so that we can
     // place the new cursor back on the equivalent character in
     // the new buffer.
@@ -2179,162 +2980,219 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
     COORD cNewCursorPos = { 0 };
     bool fFoundCursorPos = false;
-    bool foundOldMutable = false;
-    bool foundOldVisible = false;
     HRESULT hr = S_OK;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
-    {
-        // Fetch the row and its "right" which is the last printable character.
-        const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
-        const short cOldColsTotal = oldBuffer.GetLineWidth(iOldRow);
-        const CharRow& charRow = row.GetCharRow();
-        short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
-
-        // If we're starting a new row, try and preserve the line rendition
-        // from the row in the original buffer.
-        const auto newBufferPos = newBuffer.GetCursor().GetPosition();
-        if (newBufferPos.X == 0)
-        {
-            auto& newRow = newBuffer.GetRowByOffset(newBufferPos.Y);
-            newRow.SetLineRendition(row.GetLineRendition());
-        }
-
-        // There is a special case here. If the row has a "wrap"
-        // flag on it, but the right isn't equal to the width (one
-        // index past the final valid index in the row) then there
-        // were a bunch trailing of spaces in the row.
-        // (But the measuring functions for each row Left/Right do
-        // not count spaces as "displayable" so they're not
-        // included.)
-        // As such, adjust the "right" to be the width of the row
-        // to capture all these spaces
-        if (row.WasWrapForced())
-        {
-            iRight = cOldColsTotal;
-
-            // And a combined special case.
-            // If we wrapped off the end of the row by adding a
-            // piece of padding because of a double byte LEADING
-            // character, then remove one from the "right" to
-            // leave this padding out of the copy process.
-            if (row.WasDoubleBytePadded())
+    try
+    {
+        const auto oldRowsTotal = gsl::narrow_cast<size_t>(cOldRowsTotal);
+        const auto newWidth = newBuffer.GetSize().Width();
+        const auto newHeight = newBuffer.GetSize().Height();
+
+        // The rows are split into chunks of logical lines, which are laid out
+        // in parallel. A logical line ends with the first row that wasn't
+        // wrapped, and every logical line starts on a row of its own.
+        const auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+        const auto rowsPerChunk = std::max(ReflowRowsPerChunk, (oldRowsTotal + threads - 1) / threads);
+
+        // First, fetch the "right" of every row, which is the last printable character.
+        // Frozen rows are thawed on the way, so that the later phases can read
+        // them through the const accessors without thawing copies of them. Every
+        // chunk thaws only its own rows, which doesn't touch any shared state.
+        std::vector<SHORT> rights(oldRowsTotal);
+        std::vector<ReflowChunk> chunks;
+        for (size_t row = 0; row < oldRowsTotal; row += rowsPerChunk)
+        {
+            auto& chunk = chunks.emplace_back();
+            chunk.firstOldRow = row;
+            chunk.endOldRow = std::min(row + rowsPerChunk, oldRowsTotal);
+        }
+
+        ForEachReflowChunk(chunks, [&](ReflowChunk& chunk) noexcept {
+            try
+            {
+                for (auto oldRow = chunk.firstOldRow; oldRow < chunk.endOldRow; ++oldRow)
+                {
+                    // The mutable accessor thaws the row in place.
+                    ROW& row = oldBuffer.GetRowByOffset(oldRow);
+
+                    // If the row has a "wrap" flag on it, but the right isn't
+                    // equal to the width, then there were a bunch of trailing
+                    // spaces in the row, which we want to capture as well.
+                    // Unless the row was wrapped by adding a piece of padding
+                    // because of a double byte LEADING character, which we
+                    // leave out of the copy process.
+                    auto& right = til::at(rights, oldRow);
+                    if (row.WasWrapForced())
+                    {
+                        right = gsl::narrow_cast<SHORT>(oldBuffer.GetLineWidth(oldRow) - (row.WasDoubleBytePadded() ? 1 : 0));
+                    }
+                    else
+                    {
+                        right = gsl::narrow_cast<SHORT>(row.GetCharRow().MeasureRight());
+                    }
+                }
+            }
+            catch (...)
             {
-                iRight--;
+                chunk.hr = wil::ResultFromCaughtException();
             }
+        });
+
+        for (const auto& chunk : chunks)
+        {
+            THROW_IF_FAILED(chunk.hr);
         }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        chunks.clear();
+        size_t firstOldRow = 0;
+        for (size_t oldRow = 0; oldRow < oldRowsTotal; ++oldRow)
         {
-            if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
+            const auto endOfLine = til::at(rights, oldRow) < oldBuffer.GetLineWidth(oldRow) && !oldBuffer.GetRowByOffset(oldRow).WasWrapForced();
+            if ((endOfLine && oldRow + 1 - firstOldRow >= rowsPerChunk) || oldRow + 1 == oldRowsTotal)
             {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
+                auto& chunk = chunks.emplace_back();
+                chunk.firstOldRow = firstOldRow;
+                chunk.endOldRow = oldRow + 1;
+                firstOldRow = oldRow + 1;
             }
+        }
+
+        // If the caller is interested in some rows, we'll note the new
+        // location of the _end_ of the first row at or below each of them.
+        const auto rowOfInterest = [&](const short top) -> std::optional<size_t> {
+            const auto row = gsl::narrow_cast<size_t>(std::max<short>(top, 0));
+            return row < oldRowsTotal ? std::optional{ row } : std::nullopt;
+        };
 
+        ReflowLayout layout{ oldBuffer, rights, cOldCursorPos, oldRowsTotal, std::nullopt, std::nullopt, newWidth, newHeight };
+        if (positionInfo.has_value())
+        {
+            layout.mutableViewportTop = rowOfInterest(positionInfo.value().get().mutableViewportTop);
+            layout.visibleViewportTop = rowOfInterest(positionInfo.value().get().visibleViewportTop);
+        }
+
+        ForEachReflowChunk(chunks, [&](ReflowChunk& chunk) noexcept {
             try
             {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
-                const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
-
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
-                {
-                    hr = E_OUTOFMEMORY;
-                    break;
-                }
+                LayoutReflowChunk(layout, chunk);
             }
-            CATCH_RETURN();
-        }
+            catch (...)
+            {
+                chunk.hr = wil::ResultFromCaughtException();
+            }
+        });
 
-        // If we found the old row that the caller was interested in, set the
-        // out value of that parameter to the cursor's current Y position (the
-        // new location of the _end_ of that row in the buffer).
-        if (positionInfo.has_value())
+        // Now that we know how many rows each chunk takes, place them one after another.
+        // Positions are noted in the coordinates of the moment they were passed,
+        // which means that they stick to the last row once the buffer circles.
+        const auto toNewRow = [&](const size_t row) noexcept {
+            return gsl::narrow_cast<SHORT>(std::min<size_t>(row, gsl::narrow_cast<size_t>(newHeight) - 1));
+        };
+
+        size_t firstNewRow = 0;
+        for (size_t i = 0; i < chunks.size(); ++i)
         {
-            if (!foundOldMutable)
+            auto& chunk = til::at(chunks, i);
+            THROW_IF_FAILED(chunk.hr);
+            chunk.firstNewRow = firstNewRow;
+
+            // The first character of this chunk might break up a double byte
+            // sequence that the previous one ended with.
+            if (i > 0 && newHeight > 1 && chunk.firstInserted && !chunk.firstInserted->IsTrailing())
             {
-                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
+                auto& previous = til::at(chunks, i - 1);
+                if (previous.lastInserted && previous.lastInsertedAttr.IsLeading())
                 {
-                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().Y;
-                    foundOldMutable = true;
+                    const auto [x, y] = *previous.lastInserted;
+                    const auto scale = til::at(previous.rows, y).lineRendition != LineRendition::SingleWidth ? 1 : 0;
+                    if (y + 1 == previous.endY && gsl::narrow_cast<ptrdiff_t>(x) + 1 == newWidth >> scale)
+                    {
+                        previous.erasures.push_back({ y, gsl::narrow_cast<uint16_t>(x) });
+                    }
                 }
             }
 
-            if (!foundOldVisible)
+            if (chunk.cursor)
             {
-                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
-                {
-                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().Y;
-                    foundOldVisible = true;
-                }
+                cNewCursorPos = { gsl::narrow_cast<SHORT>(chunk.cursor->first), toNewRow(firstNewRow + chunk.cursor->second) };
+                fFoundCursorPos = true;
             }
-        }
 
-        if (SUCCEEDED(hr))
-        {
-            // If we didn't have a full row to copy, insert a new
-            // line into the new buffer.
-            // Only do so if we were not forced to wrap. If we did
-            // force a word wrap, then the existing line break was
-            // only because we ran out of space.
-            if (iRight < cOldColsTotal && !row.WasWrapForced())
+            if (positionInfo.has_value())
             {
-                if (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
+                if (chunk.mutableViewportTop)
                 {
-                    cNewCursorPos = newCursor.GetPosition();
-                    fFoundCursorPos = true;
+                    positionInfo.value().get().mutableViewportTop = toNewRow(firstNewRow + *chunk.mutableViewportTop);
                 }
-                // Only do this if it's not the final line in the buffer.
-                // On the final line, we want the cursor to sit
-                // where it is done printing for the cursor
-                // adjustment to follow.
-                if (iOldRow < cOldRowsTotal - 1)
+                if (chunk.visibleViewportTop)
                 {
-                    hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                    positionInfo.value().get().visibleViewportTop = toNewRow(firstNewRow + *chunk.visibleViewportTop);
                 }
-                else
+            }
+
+            firstNewRow += chunk.endY;
+        }
+
+        // The rows that don't fit into the new buffer circle out of it, into the scrollback.
+        const auto& lastChunk = chunks.back();
+        const auto lastNewRow = lastChunk.firstNewRow + lastChunk.endY;
+        const auto circled = lastNewRow - gsl::narrow_cast<size_t>(toNewRow(lastNewRow));
+        const auto rowsOfChunk = [&](const ReflowChunk& chunk) noexcept {
+            // Every chunk but the last ends with a newline onto a row of the next one.
+            return &chunk == &lastChunk ? chunk.rows.size() : chunk.endY;
+        };
+
+        if (circled > 0)
+        {
+            newBuffer._renderTarget.TriggerCircling();
+
+            if (newBuffer._scrollback.GetLimit() != 0)
+            {
+                ROW scratch{ 0, gsl::narrow_cast<unsigned short>(newWidth), newBuffer._currentAttributes, &newBuffer };
+                for (const auto& chunk : chunks)
                 {
-                    // If we are on the final line of the buffer, we have one more check.
-                    // We got into this code path because we are at the right most column of a row in the old buffer
-                    // that had a hard return (no wrap was forced).
-                    // However, as we're inserting, the old row might have just barely fit into the new buffer and
-                    // caused a new soft return (wrap was forced) putting the cursor at x=0 on the line just below.
-                    // We need to preserve the memory of the hard return at this point by inserting one additional
-                    // hard newline, otherwise we've lost that information.
-                    // We only do this when the cursor has just barely poured over onto the next line so the hard return
-                    // isn't covered by the soft one.
-                    // e.g.
-                    // The old line was:
-                    // |aaaaaaaaaaaaaaaaaaa | with no wrap which means there was a newline after that final a.
-                    // The cursor was here ^
-                    // And the new line will be:
-                    // |aaaaaaaaaaaaaaaaaaa| and show a wrap at the end
-                    // |                   |
-                    //  ^ and the cursor is now there.
-                    // If we leave it like this, we've lost the newline information.
-                    // So we insert one more newline so a continued reflow of this buffer by resizing larger will
-                    // continue to look as the original output intended with the newline data.
-                    // After this fix, it looks like this:
-                    // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
-                    // |                   |
-                    //  ^ and the cursor is now here.
-                    const COORD coordNewCursor = newCursor.GetPosition();
-                    if (coordNewCursor.X == 0 && coordNewCursor.Y > 0)
+                    for (size_t i = 0; i < rowsOfChunk(chunk) && chunk.firstNewRow + i < circled; ++i)
                     {
-                        if (newBuffer.GetRowByOffset(gsl::narrow_cast<size_t>(coordNewCursor.Y) - 1).WasWrapForced())
+                        ApplyReflowRow(oldBuffer, chunk, i, scratch);
+                        try
                         {
-                            hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                            newBuffer._scrollback.Append(scratch);
                         }
+                        CATCH_LOG();
+                        scratch.Reset(newBuffer._currentAttributes);
                     }
                 }
             }
         }
+
+        ForEachReflowChunk(chunks, [&](ReflowChunk& chunk) noexcept {
+            try
+            {
+                for (size_t i = 0; i < rowsOfChunk(chunk); ++i)
+                {
+                    if (chunk.firstNewRow + i >= circled)
+                    {
+                        ApplyReflowRow(oldBuffer, chunk, i, newBuffer.GetRowByOffset(chunk.firstNewRow + i - circled));
+                    }
+                }
+            }
+            catch (...)
+            {
+                chunk.hr = wil::ResultFromCaughtException();
+            }
+        });
+
+        for (const auto& chunk : chunks)
+        {
+            THROW_IF_FAILED(chunk.hr);
+        }
+
+        newCursor.SetPosition({ gsl::narrow_cast<SHORT>(lastChunk.endX), toNewRow(lastNewRow) });
+    }
+    catch (...)
+    {
+        hr = wil::ResultFromCaughtException();
     }
+
     if (SUCCEEDED(hr))
     {
         // Finish copying remaining parameters from the old text buffer to the new one
@@ -2402,6 +3260,16 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
         // Set size back to real size as it will be taking over the rendering duties.
         newCursor.SetSize(ulSize);
+
+        // Every row of the new buffer was just written, and thus thawed.
+        newBuffer.FreezeColdRows();
+        newBuffer._NextGeneration();
+    }
+    else
+    {
+        // The old buffer stays in use, with the rows we thawed frozen again.
+        oldBuffer._scrollback = std::move(newBuffer._scrollback);
+        oldBuffer.FreezeColdRows();
     }
 
     return hr;
@@ -2523,7 +3391,8 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
     ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _idsAndPatterns.emplace(_currentPatternId, std::wregex{ regexString.begin(), regexString.end() });
+    _patternCache.clear();
     return _currentPatternId;
 }
 
@@ -2533,6 +3402,7 @@ void TextBuffer::ClearPatternRecognizers() noexcept
 {
     _idsAndPatterns.clear();
     _currentPatternId = 0;
+    _patternCache.clear();
 }
 
 // Method Description:
@@ -2543,73 +3413,153 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
     _idsAndPatterns = OtherBuffer._idsAndPatterns;
     _currentPatternId = OtherBuffer._currentPatternId;
+    _patternCache.clear();
 }
 
 // Method Description:
 // - Finds patterns within the requested region of the text buffer
+// - Text is only joined across rows that wrapped into each other. The matches
+//   of every line are cached until one of its rows changes, so that calling
+//   this repeatedly only scans the lines that were written in the meantime.
 // Arguments:
 // - The firstRow to start searching from
 // - The lastRow to search
 // Return value:
 // - An interval tree containing the patterns found
-PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow) const
+PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow)
 {
     PointTree::interval_vector intervals;
+    if (_idsAndPatterns.empty())
+    {
+        return {};
+    }
 
-    std::wstring concatAll;
-    const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(rowSize * (lastRow - firstRow + 1));
+    // The rows are only read, which doesn't have to thaw frozen ones.
+    const auto& buffer = std::as_const(*this);
+    const auto height = gsl::narrow_cast<size_t>(GetSize().Height());
+    const auto bottom = std::min(lastRow, height - 1);
+    const auto rowSize = gsl::narrow_cast<ptrdiff_t>(GetSize().Width());
 
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (auto i = firstRow; i <= lastRow; ++i)
+    // Lines that wrap into or out of the region are scanned as a whole,
+    // but no further than the height of the region beyond it.
+    const auto reach = bottom - std::min(firstRow, bottom) + 1;
+    const auto limitTop = firstRow - std::min(firstRow, reach);
+    const auto limitBottom = std::min(bottom + reach, height - 1);
+
+    auto lineTop = firstRow;
+    while (lineTop > limitTop && buffer.GetRowByOffset(lineTop - 1).WasWrapForced())
     {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetText();
+        --lineTop;
     }
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    while (lineTop <= bottom)
     {
-        std::wregex regexObj{ idAndPattern.second };
-
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
-
-        size_t lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        auto lineBottom = lineTop;
+        while (lineBottom < limitBottom && buffer.GetRowByOffset(lineBottom).WasWrapForced())
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            size_t prefixSize = 0;
+            ++lineBottom;
+        }
 
-            for (const auto ch : i->prefix().str())
-            {
-                prefixSize += IsGlyphFullWidth(ch) ? 2 : 1;
-            }
-            const auto start = lenUpToThis + prefixSize;
-            size_t matchSize = 0;
-            for (const auto ch : i->str())
+        // NOTE: these intervals are relative to the VIEWPORT not the buffer
+        // Keeping these relative to the viewport for now because its the renderer
+        // that actually uses these locations and the renderer works relative to
+        // the viewport. Lines that started above the viewport thus have
+        // matches that start at negative rows.
+        const auto lineOffset = (gsl::narrow_cast<ptrdiff_t>(lineTop) - gsl::narrow_cast<ptrdiff_t>(firstRow)) * rowSize;
+        const auto regionEnd = (gsl::narrow_cast<ptrdiff_t>(bottom - firstRow) + 1) * rowSize;
+        for (const auto& match : _GetPatternLine(lineTop, lineBottom).matches)
+        {
+            const auto start = lineOffset + gsl::narrow_cast<ptrdiff_t>(match.start);
+            const auto end = lineOffset + gsl::narrow_cast<ptrdiff_t>(match.end);
+            if (end <= 0 || start >= regionEnd)
             {
-                matchSize += IsGlyphFullWidth(ch) ? 2 : 1;
+                continue;
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
 
-            const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(start / rowSize) };
+            // Floor division, so that a match that starts in a row above the viewport gets a negative row.
+            const auto startRow = start >= 0 ? start / rowSize : (start - rowSize + 1) / rowSize;
+            const til::point startCoord{ gsl::narrow<SHORT>(start - startRow * rowSize), gsl::narrow<SHORT>(startRow) };
             const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(end / rowSize) };
-
-            // store the intervals
-            // NOTE: these intervals are relative to the VIEWPORT not the buffer
-            // Keeping these relative to the viewport for now because its the renderer
-            // that actually uses these locations and the renderer works relative to
-            // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            intervals.push_back(PointTree::interval(startCoord, endCoord, match.id));
         }
+
+        lineTop = lineBottom + 1;
     }
+
     PointTree result(std::move(intervals));
     return result;
 }
+
+// Method Description:
+// - Gets the pattern matches of a line of wrapped rows, scanning it only
+//   if it isn't cached yet or any of its rows changed since it was.
+// Arguments:
+// - firstRow - the first row of the line
+// - lastRow - the last row of the line
+// Return value:
+// - The cached matches, with positions relative to the start of the line
+const TextBuffer::PatternLine& TextBuffer::_GetPatternLine(const size_t firstRow, const size_t lastRow)
+{
+    // The rows are only read, which doesn't have to thaw frozen ones.
+    const auto& buffer = std::as_const(*this);
+    const auto height = gsl::narrow_cast<size_t>(GetSize().Height());
+    auto& line = _patternCache[(_firstRow + firstRow) % height];
+
+    const auto rowCount = lastRow - firstRow + 1;
+    auto valid = line.revisions.size() == rowCount;
+    for (size_t i = 0; valid && i < rowCount; ++i)
+    {
+        valid = buffer.GetRowByOffset(firstRow + i).GetRevision() == til::at(line.revisions, i);
+    }
+    if (valid)
+    {
+        return line;
+    }
+
+    line.revisions.clear();
+    line.matches.clear();
+
+    // Join the text of the rows, and remember the column every code unit
+    // came from, so that the matches can be mapped back to cells.
+    _patternText.clear();
+    _patternColumns.clear();
+    const auto rowSize = gsl::narrow_cast<size_t>(GetSize().Width());
+    auto lineEnd = rowSize * (rowCount - 1);
+    for (size_t i = 0; i < rowCount; ++i)
+    {
+        const auto& row = buffer.GetRowByOffset(firstRow + i);
+        line.revisions.push_back(row.GetRevision());
+
+        const auto& charRow = row.GetCharRow();
+        const auto right = i + 1 == rowCount ? charRow.MeasureRight() : charRow.size();
+        for (size_t column = 0; column < right; ++column)
+        {
+            if (charRow.DbcsAttrAt(column).IsTrailing())
+            {
+                continue;
+            }
+            const std::wstring_view glyph = charRow.GlyphAt(column);
+            _patternText.append(glyph);
+            _patternColumns.insert(_patternColumns.end(), glyph.size(), i * rowSize + column);
+        }
+        if (i + 1 == rowCount)
+        {
+            lineEnd += right;
+        }
+    }
+    _patternColumns.push_back(lineEnd);
+
+    const auto textBegin = _patternText.data();
+    const auto textEnd = textBegin + _patternText.size();
+    for (const auto& [id, regex] : _idsAndPatterns)
+    {
+        for (auto it = std::wcregex_iterator{ textBegin, textEnd, regex }; it != std::wcregex_iterator{}; ++it)
+        {
+            const auto position = gsl::narrow_cast<size_t>(it->position());
+            const auto length = gsl::narrow_cast<size_t>(it->length());
+            line.matches.push_back({ til::at(_patternColumns, position), til::at(_patternColumns, position + length), id });
+        }
+    }
+
+    return line;
+}
@@ -53,12 +53,13 @@ filling in the last row, and updating the screen.
 
 #include "cursor.h"
 #include "Row.hpp"
+#include "ScrollbackStore.hpp"
 #include "TextAttribute.hpp"
-#include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
 #include "../buffer/out/textBufferTextIterator.hpp"
+#include "../buffer/out/textBufferRunIterator.hpp"
 
 #include "../renderer/inc/IRenderTarget.hpp"
 
@@ -75,8 +76,8 @@ public:
     void CopyProperties(const TextBuffer& OtherBuffer) noexcept;
 
     // row manipulation
-    const ROW& GetRowByOffset(const size_t index) const;
-    ROW& GetRowByOffset(const size_t index);
+    const ROW& GetRowByOffset(const ptrdiff_t index) const;
+    ROW& GetRowByOffset(const ptrdiff_t index);
 
     TextBufferCellIterator GetCellDataAt(const COORD at) const;
     TextBufferCellIterator GetCellLineDataAt(const COORD at) const;
@@ -84,6 +85,8 @@ public:
     TextBufferTextIterator GetTextDataAt(const COORD at) const;
     TextBufferTextIterator GetTextLineDataAt(const COORD at) const;
     TextBufferTextIterator GetTextDataAt(const COORD at, const Microsoft::Console::Types::Viewport limit) const;
+    TextBufferRunIterator GetRunsAt(const COORD at) const;
+    TextBufferRunIterator GetRunsAt(const COORD at, const Microsoft::Console::Types::Viewport limit) const;
 
     // Text insertion functions
     OutputCellIterator Write(const OutputCellIterator givenIt);
@@ -97,6 +100,19 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    struct WriteStreamResult
+    {
+        COORD cursorPosition{ 0, 0 };
+        size_t charsConsumed{ 0 };
+        size_t cellsWritten{ 0 };
+        SHORT rowsCircled{ 0 };
+    };
+
+    WriteStreamResult WriteStream(const std::wstring_view text,
+                                  const TextAttribute& attr,
+                                  const COORD target,
+                                  const bool allowCircling = true);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -115,6 +131,8 @@ public:
     const Microsoft::Console::Types::Viewport GetSize() const noexcept;
 
     void ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta);
+    void CopyRectangle(const Microsoft::Console::Types::Viewport& source, const COORD targetOrigin);
+    void FillRectangle(const Microsoft::Console::Types::Viewport& rect, const wchar_t wch, const TextAttribute& attr);
 
     UINT TotalRowCount() const noexcept;
 
@@ -124,10 +142,10 @@ public:
 
     void SetCurrentLineRendition(const LineRendition lineRendition);
     void ResetLineRenditionRange(const size_t startRow, const size_t endRow);
-    LineRendition GetLineRendition(const size_t row) const;
-    bool IsDoubleWidthLine(const size_t row) const;
+    LineRendition GetLineRendition(const ptrdiff_t row) const;
+    bool IsDoubleWidthLine(const ptrdiff_t row) const;
 
-    SHORT GetLineWidth(const size_t row) const;
+    SHORT GetLineWidth(const ptrdiff_t row) const;
     COORD ClampPositionWithinLine(const COORD position) const;
     COORD ScreenToBufferPosition(const COORD position) const;
     COORD BufferToScreenPosition(const COORD position) const;
@@ -136,8 +154,20 @@ public:
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
+    const ScrollbackStore& GetScrollback() const noexcept;
+    ScrollbackStore& GetScrollback() noexcept;
+
+    SHORT GetScrollbackWindowHeight() const noexcept;
+    std::optional<ScrollbackStore::row_number> GetScrollbackWindowEnd() const noexcept;
+    void SetScrollbackWindowEnd(const std::optional<ScrollbackStore::row_number> end) noexcept;
+    uint64_t GetGeneration() const noexcept;
+    const Microsoft::Console::Types::Viewport GetSizeWithScrollback() const noexcept;
+    ScrollbackStore::row_number GetRowNumber(const ptrdiff_t row) const noexcept;
+    std::optional<SHORT> GetRowOffset(const ScrollbackStore::row_number rowNumber) const noexcept;
+
+    void SetColdRowDistance(const SHORT distance) noexcept;
+    SHORT GetColdRowDistance() const noexcept;
+    void FreezeColdRows() noexcept;
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
@@ -198,7 +228,7 @@ public:
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void ClearPatternRecognizers() noexcept;
     void CopyPatterns(const TextBuffer& OtherBuffer);
-    interval_tree::IntervalTree<til::point, size_t> GetPatterns(const size_t firstRow, const size_t lastRow) const;
+    interval_tree::IntervalTree<til::point, size_t> GetPatterns(const size_t firstRow, const size_t lastRow);
 
 private:
     void _UpdateSize();
@@ -210,8 +240,39 @@ private:
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
+    // rows that circled out of the buffer
+    ScrollbackStore _scrollback;
+
+    // The row following the part of the scrollback that's mapped above the
+    // first row of the buffer, if that isn't the newest part of it.
+    std::optional<ScrollbackStore::row_number> _scrollbackWindowEnd;
+    // The height of the scrollback window when the generation last changed.
+    SHORT _scrollbackWindowHeight;
+
+    // Changes whenever rows move to other offsets. Unique across all
+    // buffers, so that a buffer that was swapped in never has the
+    // generation of the one it replaced.
+    uint64_t _generation;
+    void _NextGeneration() noexcept;
+
+    // Rows of the scrollback window, thawed for the callers of GetRowByOffset.
+    static constexpr size_t ScrollbackRowCacheSize = 512;
+    mutable std::unordered_map<ScrollbackStore::row_number, ROW> _scrollbackRows;
+    mutable std::deque<ScrollbackStore::row_number> _scrollbackRowOrder;
+
+    ROW& _GetScrollbackRow(const ptrdiff_t index) const;
+
+    // rows this far above the cursor are frozen (0 = never)
+    SHORT _coldRowDistance;
+
+    // Copies of frozen rows, thawed for the const callers of GetRowByOffset,
+    // so that reading a row doesn't undo freezing it. Keyed by the frozen
+    // contents, which the order keeps alive.
+    static constexpr size_t ThawedRowCacheSize = 512;
+    mutable std::unordered_map<const FrozenRow*, ROW> _thawedRows;
+    mutable std::deque<std::shared_ptr<const FrozenRow>> _thawedRowOrder;
+
+    const ROW& _GetThawedRow(const ROW& row) const;
 
     std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
@@ -247,9 +308,33 @@ private:
 
     void _PruneHyperlinks();
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    // A pattern match, in cells relative to the start of its line.
+    struct PatternMatch
+    {
+        size_t start;
+        size_t end;
+        size_t id;
+    };
+
+    // The matches in a line of wrapped rows, valid as long as none of its rows changed.
+    struct PatternLine
+    {
+        std::vector<uint32_t> revisions;
+        std::vector<PatternMatch> matches;
+    };
+
+    const PatternLine& _GetPatternLine(const size_t firstRow, const size_t lastRow);
+
+    std::unordered_map<size_t, std::wregex> _idsAndPatterns;
     size_t _currentPatternId;
 
+    // The patterns found in each line, keyed by the storage index of its first
+    // row. Rows don't move in the storage when the buffer circles, so only
+    // the rows that were actually written need to be scanned again.
+    std::unordered_map<size_t, PatternLine> _patternCache;
+    std::wstring _patternText;
+    std::vector<size_t> _patternColumns;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
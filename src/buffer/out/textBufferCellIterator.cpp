@@ -20,7 +20,7 @@ using namespace Microsoft::Console::Types;
 // - buffer - Text buffer to seek through
 // - pos - Starting position to retrieve text data from (within screen buffer bounds)
 TextBufferCellIterator::TextBufferCellIterator(const TextBuffer& buffer, COORD pos) :
-    TextBufferCellIterator(buffer, pos, buffer.GetSize())
+    TextBufferCellIterator(buffer, pos, buffer.GetSizeWithScrollback())
 {
 }
 
@@ -40,7 +40,7 @@ TextBufferCellIterator::TextBufferCellIterator(const TextBuffer& buffer, COORD p
     _attrIter(s_GetRow(buffer, pos)->GetAttrRow().cbegin())
 {
     // Throw if the bounds rectangle is not limited to the inside of the given buffer.
-    THROW_HR_IF(E_INVALIDARG, !buffer.GetSize().IsInBounds(limits));
+    THROW_HR_IF(E_INVALIDARG, !buffer.GetSizeWithScrollback().IsInBounds(limits));
 
     // Throw if the coordinate is not limited to the inside of the given buffer.
     THROW_HR_IF(E_INVALIDARG, !limits.IsInBounds(pos));
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "textBufferRunIterator.hpp"
+
+#include "textBuffer.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Creates a new read-only iterator over the runs of cells in a row, that share the same attributes.
+// Arguments:
+// - buffer - Text buffer to walk through
+// - pos - The first cell to walk through. Only the row of this cell is walked through.
+// - limits - Viewport limits to restrict the iterator within the buffer bounds. The runs end at the right edge of it.
+TextBufferRunIterator::TextBufferRunIterator(const TextBuffer& buffer, const COORD pos, const Viewport limits) :
+    _charRow{ nullptr },
+    _runIndex{ 0 },
+    _begin{ pos.X },
+    _end{ pos.X },
+    _runBegin{ 0 },
+    _limit{ gsl::narrow<SHORT>(limits.RightExclusive()) }
+{
+    // Throw if the bounds rectangle is not limited to the inside of the given buffer.
+    THROW_HR_IF(E_INVALIDARG, !buffer.GetSizeWithScrollback().IsInBounds(limits));
+
+    // Throw if the coordinate is not limited to the inside of the given buffer.
+    THROW_HR_IF(E_INVALIDARG, !limits.IsInBounds(pos));
+
+    const auto& row = buffer.GetRowByOffset(pos.Y);
+    _charRow = &row.GetCharRow();
+    _runs = row.GetAttrRow().GetRuns();
+
+    // Skip the runs that end before the first cell.
+    while (_runIndex < _runs.size() && _runBegin + til::at(_runs, _runIndex).length <= pos.X)
+    {
+        _runBegin = gsl::narrow_cast<SHORT>(_runBegin + til::at(_runs, _runIndex).length);
+        ++_runIndex;
+    }
+
+    _ClampRun();
+}
+
+// Routine Description:
+// - Tells if the iterator is still valid (hasn't reached the right edge of the limits)
+// Return Value:
+// - True if there's another run of cells. False if we've passed the end and are out of data.
+TextBufferRunIterator::operator bool() const noexcept
+{
+    return _begin < _end;
+}
+
+// Routine Description:
+// - Advances the iterator to the next run of cells
+// Return Value:
+// - Reference to self after movement.
+TextBufferRunIterator& TextBufferRunIterator::operator++() noexcept
+{
+    if (*this)
+    {
+        _begin = _end;
+        _runBegin = gsl::narrow_cast<SHORT>(_runBegin + til::at(_runs, _runIndex).length);
+        ++_runIndex;
+        _ClampRun();
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Gets the first column of the current run
+SHORT TextBufferRunIterator::Begin() const noexcept
+{
+    return _begin;
+}
+
+// Routine Description:
+// - Gets the column past the last column of the current run
+SHORT TextBufferRunIterator::End() const noexcept
+{
+    return _end;
+}
+
+// Routine Description:
+// - Gets the column past the last column that's walked through
+SHORT TextBufferRunIterator::Limit() const noexcept
+{
+    return _limit;
+}
+
+// Routine Description:
+// - Gets the attributes shared by all cells of the current run
+const TextAttribute& TextBufferRunIterator::TextAttr() const noexcept
+{
+    return til::at(_runs, _runIndex).value;
+}
+
+// Routine Description:
+// - Gets the text of a cell of the row
+// Arguments:
+// - column - The column of the cell, which doesn't need to be part of the current run
+// Return Value:
+// - Read only UTF-16 text data
+std::wstring_view TextBufferRunIterator::GlyphAt(const SHORT column) const
+{
+    return _charRow->GlyphAt(column);
+}
+
+// Routine Description:
+// - Gets the double byte attribute of a cell of the row
+// Arguments:
+// - column - The column of the cell, which doesn't need to be part of the current run
+// Return Value:
+// - Whether the cell holds the left or right half of a two column glyph, or a single column glyph
+DbcsAttribute TextBufferRunIterator::DbcsAttrAt(const SHORT column) const
+{
+    return _charRow->DbcsAttrAt(column);
+}
+
+// Routine Description:
+// - Determines where the current run ends, after it was moved to another attribute run.
+void TextBufferRunIterator::_ClampRun() noexcept
+{
+    if (_runIndex < _runs.size())
+    {
+        _end = std::min(gsl::narrow_cast<SHORT>(_runBegin + til::at(_runs, _runIndex).length), _limit);
+    }
+    else
+    {
+        _end = _begin;
+    }
+}
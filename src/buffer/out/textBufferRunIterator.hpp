@@ -0,0 +1,62 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- textBufferRunIterator.hpp
+
+Abstract:
+- This module walks through the cells of a single row in runs of cells that
+  share the same attributes.
+- The runs are taken straight from the run-length encoded attributes of the
+  row, so unlike TextBufferCellIterator it doesn't need to look at the
+  attributes of every cell.
+- It is currently intended for read-only operations
+
+--*/
+
+#pragma once
+
+#include "AttrRow.hpp"
+#include "CharRow.hpp"
+#include "../../types/inc/viewport.hpp"
+
+class TextBuffer;
+
+class TextBufferRunIterator final
+{
+public:
+    TextBufferRunIterator(const TextBuffer& buffer, const COORD pos, const Microsoft::Console::Types::Viewport limits);
+
+    operator bool() const noexcept;
+
+    TextBufferRunIterator& operator++() noexcept;
+
+    SHORT Begin() const noexcept;
+    SHORT End() const noexcept;
+    SHORT Limit() const noexcept;
+    const TextAttribute& TextAttr() const noexcept;
+
+    std::wstring_view GlyphAt(const SHORT column) const;
+    DbcsAttribute DbcsAttrAt(const SHORT column) const;
+
+private:
+    void _ClampRun() noexcept;
+
+    const CharRow* _charRow;
+    gsl::span<const ATTR_ROW::run_type> _runs;
+    size_t _runIndex;
+
+    // The columns covered by the current run, clamped to the limits.
+    SHORT _begin;
+    SHORT _end;
+
+    // The column where the current attribute run starts in the row, which
+    // can be left of _begin, and the column past the end of the limits.
+    SHORT _runBegin;
+    SHORT _limit;
+
+#if UNIT_TESTING
+    friend class TextBufferIteratorTests;
+#endif
+};
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../CharRow.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class CharRowTests
+{
+    TEST_CLASS(CharRowTests);
+
+    TEST_METHOD(CanOverwriteEmoji)
+    {
+        CharRow charRow{ 10 };
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
+
+        // store initial glyph
+        charRow.GlyphAt(1) = newMoon;
+
+        // verify it was stored
+        VERIFY_IS_TRUE(charRow.DbcsAttrAt(1).IsGlyphStored());
+        VERIFY_ARE_EQUAL(newMoon, static_cast<std::wstring_view>(charRow.GlyphAt(1)));
+
+        // overwrite it
+        charRow.GlyphAt(1) = fullMoon;
+
+        // verify the glyph was overwritten
+        VERIFY_IS_TRUE(charRow.DbcsAttrAt(1).IsGlyphStored());
+        VERIFY_ARE_EQUAL(fullMoon, static_cast<std::wstring_view>(charRow.GlyphAt(1)));
+
+        // and replacing it with a single code unit doesn't need the storage anymore
+        charRow.GlyphAt(1) = L"A";
+        VERIFY_IS_FALSE(charRow.DbcsAttrAt(1).IsGlyphStored());
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"A" }, static_cast<std::wstring_view>(charRow.GlyphAt(1)));
+    }
+
+    TEST_METHOD(OverwrittenGlyphsAreReclaimed)
+    {
+        CharRow charRow{ 10 };
+        const std::wstring_view fire{ L"\xD83D\xDD25" };
+        const std::wstring_view cluster{ L"e\x0301\x0302" };
+
+        charRow.GlyphAt(0) = fire;
+        charRow.GlyphAt(9) = cluster;
+
+        // Rewriting the same cells over and over must not grow the storage without bounds.
+        for (auto i = 0; i < 1000; ++i)
+        {
+            charRow.GlyphAt(5) = (i % 2) ? fire : cluster;
+        }
+
+        VERIFY_IS_LESS_THAN(charRow._glyphs.size(), static_cast<size_t>(100));
+        VERIFY_ARE_EQUAL(fire, static_cast<std::wstring_view>(charRow.GlyphAt(0)));
+        VERIFY_ARE_EQUAL(fire, static_cast<std::wstring_view>(charRow.GlyphAt(5)));
+        VERIFY_ARE_EQUAL(cluster, static_cast<std::wstring_view>(charRow.GlyphAt(9)));
+
+        // The cells in between aren't affected.
+        VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, static_cast<std::wstring_view>(charRow.GlyphAt(1)));
+        VERIFY_ARE_EQUAL(std::wstring{ fire }, charRow.GetText().substr(0, 2));
+    }
+
+    TEST_METHOD(ResetAndResizeReleaseGlyphs)
+    {
+        CharRow charRow{ 10 };
+        const std::wstring_view peach{ L"\xD83C\xDF51" };
+
+        charRow.GlyphAt(2) = peach;
+        charRow.GlyphAt(9) = peach;
+
+        // Cutting off the last column drops its glyph, but keeps the other one.
+        VERIFY_SUCCEEDED(charRow.Resize(9));
+        VERIFY_ARE_EQUAL(peach.size() + 1, charRow._glyphs.size());
+        VERIFY_ARE_EQUAL(peach, static_cast<std::wstring_view>(charRow.GlyphAt(2)));
+
+        charRow.Reset();
+        VERIFY_IS_TRUE(charRow._glyphs.empty());
+        VERIFY_IS_FALSE(charRow.ContainsText());
+    }
+};
@@ -352,7 +352,11 @@ HRESULT HwndTerminal::Refresh(const SIZE windowSize, _Out_ COORD* dimensions)
 
     _terminal->ClearSelection();
 
-    RETURN_IF_FAILED(_renderEngine->SetWindowSize(windowSize));
+    {
+        // The renderer paints the engine outside of our lock, while it holds this one.
+        const std::lock_guard engineLock{ *_renderEngine->GetSnapshotPaintLock() };
+        RETURN_IF_FAILED(_renderEngine->SetWindowSize(windowSize));
+    }
 
     // Invalidate everything
     _renderer->TriggerRedrawAll();
@@ -360,7 +364,10 @@ HRESULT HwndTerminal::Refresh(const SIZE windowSize, _Out_ COORD* dimensions)
     // Convert our new dimensions to characters
     const auto viewInPixels = Viewport::FromDimensions({ 0, 0 },
                                                        { gsl::narrow<short>(windowSize.cx), gsl::narrow<short>(windowSize.cy) });
-    const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
+    const auto vp = [&]() {
+        const std::lock_guard engineLock{ *_renderEngine->GetSnapshotPaintLock() };
+        return _renderEngine->GetViewportInCharacters(viewInPixels);
+    }();
 
     // If this function succeeds with S_FALSE, then the terminal didn't
     //      actually change size. No need to notify the connection of this
@@ -467,7 +474,10 @@ HRESULT _stdcall TerminalTriggerResizeWithDimension(_In_ void* terminal, _In_ CO
     const auto publicTerminal = static_cast<const HwndTerminal*>(terminal);
 
     const auto viewInCharacters = Viewport::FromDimensions({ 0, 0 }, { (dimensionsInCharacters.X), (dimensionsInCharacters.Y) });
-    const auto viewInPixels = publicTerminal->_renderEngine->GetViewportInPixels(viewInCharacters);
+    const auto viewInPixels = [&]() {
+        const std::lock_guard engineLock{ *publicTerminal->_renderEngine->GetSnapshotPaintLock() };
+        return publicTerminal->_renderEngine->GetViewportInPixels(viewInCharacters);
+    }();
 
     dimensionsInPixels->cx = viewInPixels.Width();
     dimensionsInPixels->cy = viewInPixels.Height();
@@ -490,7 +500,10 @@ HRESULT _stdcall TerminalCalculateResize(_In_ void* terminal, _In_ short width,
     const auto publicTerminal = static_cast<const HwndTerminal*>(terminal);
 
     const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, { width, height });
-    const auto viewInCharacters = publicTerminal->_renderEngine->GetViewportInCharacters(viewInPixels);
+    const auto viewInCharacters = [&]() {
+        const std::lock_guard engineLock{ *publicTerminal->_renderEngine->GetSnapshotPaintLock() };
+        return publicTerminal->_renderEngine->GetViewportInCharacters(viewInPixels);
+    }();
 
     dimensions->X = viewInCharacters.Width();
     dimensions->Y = viewInCharacters.Height();
@@ -783,7 +796,10 @@ void _stdcall TerminalSetTheme(void* terminal, TerminalTheme theme, LPCWSTR font
 
         publicTerminal->_terminal->SetColorTableEntry(TextColor::DEFAULT_FOREGROUND, theme.DefaultForeground);
         publicTerminal->_terminal->SetColorTableEntry(TextColor::DEFAULT_BACKGROUND, theme.DefaultBackground);
-        publicTerminal->_renderEngine->SetSelectionBackground(theme.DefaultSelectionBackground, theme.SelectionBackgroundAlpha);
+        {
+            const std::lock_guard engineLock{ *publicTerminal->_renderEngine->GetSnapshotPaintLock() };
+            publicTerminal->_renderEngine->SetSelectionBackground(theme.DefaultSelectionBackground, theme.SelectionBackgroundAlpha);
+        }
 
         // Set the font colors
         for (size_t tableIndex = 0; tableIndex < 16; tableIndex++)
@@ -1001,7 +1017,8 @@ double HwndTerminal::GetScaleFactor() const noexcept
 
 void HwndTerminal::ChangeViewport(const SMALL_RECT NewWindow)
 {
-    _terminal->UserScrollViewport(NewWindow.Top);
+    // UIA works with the rows of the buffer, not with scroll positions.
+    _terminal->UserScrollViewport(_terminal->GetScrollOffsetOfRow(NewWindow.Top));
 }
 
 HRESULT HwndTerminal::GetHostUiaProvider(IRawElementProviderSimple** provider) noexcept
@@ -656,6 +656,18 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
+    void TerminalPage::_HandleDumpApiStatistics(const IInspectable& /*sender*/,
+                                                const ActionEventArgs& actionArgs)
+    {
+        if (_settings.GlobalSettings().DebugFeaturesEnabled())
+        {
+            const auto res = _ApplyToActiveControls([](auto& control) {
+                control.DumpApiStatistics();
+            });
+            actionArgs.Handled(res);
+        }
+    }
+
     // Function Description:
     // - Helper to launch a new WT instance. It can either launch the instance
     //   elevated or unelevated.
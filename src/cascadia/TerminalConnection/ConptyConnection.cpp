@@ -21,6 +21,14 @@ using namespace std::string_view_literals;
 // Format is: "DecimalResult (HexadecimalForm)"
 static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
 
+// The output pipe is read in chunks of at least this size. Whenever a read
+// fills the whole chunk, there's more output waiting for us, and the next
+// chunk is twice as large, up to the maximum. Larger chunks mean fewer reads,
+// conversions and TerminalOutput events for the same output, and the terminal
+// parses each of them under a single lock.
+static constexpr size_t _minimumReadSize = 4 * 1024;
+static constexpr size_t _maximumReadSize = 1024 * 1024;
+
 // Notes:
 // There is a number of ways that the Conpty connection can be terminated (voluntarily or not):
 // 1. The connection is Close()d
@@ -538,6 +546,17 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         }
     }
 
+    // Method Description:
+    // - Asks conpty to trace the statistics of the console API calls it
+    //   serviced so far. Used for debugging slow clients.
+    void ConptyConnection::DumpApiStatistics()
+    {
+        if (_isConnected())
+        {
+            THROW_IF_FAILED(ConptyDumpApiStatistics(_hPC.get()));
+        }
+    }
+
     void ConptyConnection::Close() noexcept
     try
     {
@@ -609,6 +628,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // won't wait for us, and the known exit points _do_.
         auto strongThis{ get_strong() };
 
+        _buffer.resize(_minimumReadSize);
+
         // process the data of the output pipe in a loop
         while (true)
         {
@@ -628,24 +649,38 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 // else we call convertUTF8ChunkToUTF16 with an empty string_view to convert possible remaining partials to U+FFFD
             }
 
-            const HRESULT result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
-            if (FAILED(result))
+            // The terminal control parses the output as UTF-8, which is
+            // cheaper than converting all of it to UTF-16 up front. Only
+            // convert it for the handlers that want a String.
+            const bool bytesOnly = _TerminalOutputUtf8Handlers && !_TerminalOutputHandlers;
+            if (bytesOnly)
             {
-                if (_isStateAtOrBeyond(ConnectionState::Closing))
+                if (read == 0)
                 {
-                    // This termination was expected.
                     return 0;
                 }
-
-                // EXIT POINT
-                _indicateExitWithStatus(result); // print a message
-                _transitionToState(ConnectionState::Failed);
-                return gsl::narrow_cast<DWORD>(result);
             }
-
-            if (_u16Str.empty())
+            else
             {
-                return 0;
+                const HRESULT result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
+                if (FAILED(result))
+                {
+                    if (_isStateAtOrBeyond(ConnectionState::Closing))
+                    {
+                        // This termination was expected.
+                        return 0;
+                    }
+
+                    // EXIT POINT
+                    _indicateExitWithStatus(result); // print a message
+                    _transitionToState(ConnectionState::Failed);
+                    return gsl::narrow_cast<DWORD>(result);
+                }
+
+                if (_u16Str.empty())
+                {
+                    return 0;
+                }
             }
 
             if (!_receivedFirstByte)
@@ -664,8 +699,36 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _receivedFirstByte = true;
             }
 
-            // Pass the output to our registered event handlers
-            _TerminalOutputHandlers(_u16Str);
+            // Pass the output to our registered event handlers. The handlers
+            // get a reference to _buffer or _u16Str, which are reused for the next chunk.
+            if (_TerminalOutputUtf8Handlers && read != 0)
+            {
+#pragma warning(suppress : 26490) // The bytes are UTF-8, whether they're typed as char or as uint8_t.
+                _TerminalOutputUtf8Handlers(winrt::array_view<const uint8_t>{ reinterpret_cast<const uint8_t*>(_buffer.data()), read });
+            }
+            if (!bytesOnly)
+            {
+                _TerminalOutputHandlers(_u16Str);
+            }
+
+            // Read more at once while the pipe stays full. Once the output
+            // calms down, give the memory back.
+            size_t readSize = _buffer.size();
+            if (read == readSize && readSize < _maximumReadSize)
+            {
+                readSize *= 2;
+            }
+            else if (read <= _minimumReadSize && readSize > _minimumReadSize)
+            {
+                readSize = _minimumReadSize;
+                _u16Str.clear();
+                _u16Str.shrink_to_fit();
+            }
+            if (readSize != _buffer.size())
+            {
+                // The old contents were passed on already, don't copy them.
+                _buffer = std::vector<char>(readSize);
+            }
         }
 
         return 0;
@@ -36,6 +36,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         void Resize(uint32_t rows, uint32_t columns);
         void Close() noexcept;
         void ClearBuffer();
+        void DumpApiStatistics();
 
         winrt::guid Guid() const noexcept;
         winrt::hstring Commandline() const;
@@ -55,6 +56,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                                                                          winrt::guid const& guid);
 
         WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+        WINRT_CALLBACK(TerminalOutputUtf8, TerminalOutputUtf8Handler);
 
     private:
         static HRESULT NewHandoff(HANDLE in, HANDLE out, HANDLE signal, HANDLE ref, HANDLE server, HANDLE client) noexcept;
@@ -85,7 +87,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         til::u8state _u8State{};
         std::wstring _u16Str{};
-        std::array<char, 4096> _buffer{};
+        // Grows while the output pipe stays full, see _OutputThread.
+        std::vector<char> _buffer;
 
         DWORD _OutputThread();
     };
@@ -32,8 +32,9 @@ constexpr const auto ScrollBarUpdateInterval = std::chrono::milliseconds(8);
 // The minimum delay between updating the TSF input control.
 constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 
-// The minimum delay between updating the locations of regex patterns
-constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
+// The minimum delay between updating the locations of regex patterns.
+// Only the rows that changed get scanned again, so this can keep up with the frame rate.
+constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(16);
 
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
@@ -75,7 +76,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         });
 
         // This event is explicitly revoked in the destructor: does not need weak_ref
-        _connectionOutputEventToken = _connection.TerminalOutput({ this, &ControlCore::_connectionOutputHandler });
+        // A ConptyConnection hands us its output as it read it, so that we can
+        // parse it without converting it to UTF-16 first.
+        if (const auto conpty{ _connection.try_as<TerminalConnection::ConptyConnection>() })
+        {
+            _connectionOutputUtf8EventToken = conpty.TerminalOutputUtf8({ this, &ControlCore::_connectionOutputUtf8Handler });
+        }
+        else
+        {
+            _connectionOutputEventToken = _connection.TerminalOutput({ this, &ControlCore::_connectionOutputHandler });
+        }
 
         _terminal->SetWriteInputCallback([this](std::wstring& wstr) {
             _sendInputToConnection(wstr);
@@ -132,6 +142,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             });
 
             THROW_IF_FAILED(localPointerToThread->Initialize(_renderer.get()));
+            _renderThread = localPointerToThread;
+            _renderThread->SetMaximumFrameRate(gsl::narrow_cast<unsigned int>(std::max(_settings->MaximumFrameRate(), 0)));
         }
 
         // Get our dispatcher. If we're hosted in-proc with XAML, this will get
@@ -153,8 +165,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         //   every time that the cursor moves.
         // * _updatePatternLocations: When there's new output, or we scroll the
         //   viewport, we should re-check if there are any visible hyperlinks.
-        //   But we don't really need to do this every single time text is
-        //   output, we can limit this update to once every 500ms.
+        //   Only the rows that changed are scanned again, but we still don't
+        //   need to do this more often than once a frame.
         // * _updateScrollBar: Same idea as the TSF update - we don't _really_
         //   need to hop across the process boundary every time text is output.
         //   We can throttle this to once every 8ms, which will get us out of
@@ -251,12 +263,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             // Then, using the font, get the number of characters that can fit.
             // Resize our terminal connection to match that size, and initialize the terminal with that size.
             const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, windowSize);
+            auto engineLock = _lockRenderEngine();
             LOG_IF_FAILED(_renderEngine->SetWindowSize({ viewInPixels.Width(), viewInPixels.Height() }));
 
             // Update DxEngine's SelectionBackground
             _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
 
             const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
+            // The terminal calls into the renderer while it's being created.
+            engineLock = {};
             const auto width = vp.Width();
             const auto height = vp.Height();
             _connection.Resize(height, width);
@@ -267,6 +282,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             _terminal->CreateFromSettings(*_settings, *_renderer);
 
+            engineLock = _lockRenderEngine();
+
             // IMPORTANT! Set this callback up sooner than later. If we do it
             // after Enable, then it'll be possible to paint the frame once
             // _before_ the warning handler is set up, and then warnings from
@@ -283,7 +300,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
             _renderEngine->SetIntenseIsBold(_settings->IntenseIsBold());
 
-            _updateAntiAliasingMode();
+            _setAntiAliasingModeUnderEngineLock();
 
             // GH#5098: Inform the engine of the opacity of the default text background.
             // GH#11315: Always do this, even if they don't have acrylic on.
@@ -428,9 +445,6 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::UserScrollViewport(const int viewTop)
     {
-        // Clear the regex pattern tree so the renderer does not try to render them while scrolling
-        _terminal->ClearPatternTree();
-
         // This is a scroll event that wasn't initiated by the terminal
         //      itself - it was initiated by the mouse wheel, or the scrollbar.
         _terminal->UserScrollViewport(viewTop);
@@ -438,6 +452,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _updatePatternLocations->Run();
     }
 
+    // Method Description:
+    // - Converts a row of the buffer into the scroll position it's at. The
+    //   scrollbar also spans the scrollback store above the buffer.
+    // Arguments:
+    // - row: the row of the buffer
+    // Return Value:
+    // - the scroll position to pass to UserScrollViewport
+    int ControlCore::ScrollOffsetOfRow(const int row) const
+    {
+        auto lock = _terminal->LockForReading();
+        return _terminal->GetScrollOffsetOfRow(row);
+    }
+
     void ControlCore::AdjustOpacity(const double adjustment)
     {
         if (adjustment == 0)
@@ -468,6 +495,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // cleartype -> grayscale if the BG is transparent / acrylic.
         if (_renderEngine)
         {
+            const auto engineLock = _lockRenderEngine();
             _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
         }
 
@@ -483,18 +511,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // specify a custom pixel shader, manually enable the legacy retro
         // effect first. This will ensure that a toggle off->on will still work,
         // even if they currently have retro effect off.
-        if (_settings->PixelShaderPath().empty() && !_renderEngine->GetRetroTerminalEffect())
-        {
-            // SetRetroTerminalEffect to true will enable the effect. In this
-            // case, the shader effect will already be disabled (because neither
-            // a pixel shader nor the retro effects were originally requested).
-            // So we _don't_ want to toggle it again below, because that would
-            // toggle it back off.
-            _renderEngine->SetRetroTerminalEffect(true);
-        }
-        else
         {
-            _renderEngine->ToggleShaderEffects();
+            const auto engineLock = _lockRenderEngine();
+            if (_settings->PixelShaderPath().empty() && !_renderEngine->GetRetroTerminalEffect())
+            {
+                // SetRetroTerminalEffect to true will enable the effect. In this
+                // case, the shader effect will already be disabled (because neither
+                // a pixel shader nor the retro effects were originally requested).
+                // So we _don't_ want to toggle it again below, because that would
+                // toggle it back off.
+                _renderEngine->SetRetroTerminalEffect(true);
+            }
+            else
+            {
+                _renderEngine->ToggleShaderEffects();
+            }
         }
         // Always redraw after toggling effects. This way even if the control
         // does not have focus it will update immediately.
@@ -559,7 +590,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
                 _lastHoveredId = newId;
                 _lastHoveredInterval = newInterval;
-                _renderEngine->UpdateHyperlinkHoveredId(newId);
+                {
+                    const auto engineLock = _lockRenderEngine();
+                    _renderEngine->UpdateHyperlinkHoveredId(newId);
+                }
                 _renderer->UpdateLastHoveredInterval(newInterval);
                 _renderer->TriggerRedrawAll();
             }
@@ -626,6 +660,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Update the terminal core with its new Core settings
         _terminal->UpdateSettings(*_settings);
+        _renderThread->SetMaximumFrameRate(gsl::narrow_cast<unsigned int>(std::max(_settings->MaximumFrameRate(), 0)));
 
         if (!_initializedTerminal)
         {
@@ -634,12 +669,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
-        _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
-        // Inform the renderer of our opacity
-        _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
+        {
+            const auto engineLock = _lockRenderEngine();
+            _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
+            _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+            // Inform the renderer of our opacity
+            _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
 
-        _updateAntiAliasingMode();
+            _setAntiAliasingModeUnderEngineLock();
+        }
 
         // Refresh our font with the renderer
         const auto actualFontOldSize = _actualFont.GetSize();
@@ -665,15 +703,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_renderEngine)
         {
             // Update DxEngine settings under the lock
-            _renderEngine->SetSelectionBackground(til::color{ newAppearance->SelectionBackground() });
-            _renderEngine->SetRetroTerminalEffect(newAppearance->RetroTerminalEffect());
-            _renderEngine->SetPixelShaderPath(newAppearance->PixelShaderPath());
-            _renderEngine->SetIntenseIsBold(_settings->IntenseIsBold());
+            {
+                const auto engineLock = _lockRenderEngine();
+                _renderEngine->SetSelectionBackground(til::color{ newAppearance->SelectionBackground() });
+                _renderEngine->SetRetroTerminalEffect(newAppearance->RetroTerminalEffect());
+                _renderEngine->SetPixelShaderPath(newAppearance->PixelShaderPath());
+                _renderEngine->SetIntenseIsBold(_settings->IntenseIsBold());
+            }
             _renderer->TriggerRedrawAll();
         }
     }
 
-    void ControlCore::_updateAntiAliasingMode()
+    // Method Description:
+    // - Tells the render engine about the antialiasing mode from our settings.
+    // - The engine lock (see _lockRenderEngine) should be held when calling this method.
+    void ControlCore::_setAntiAliasingModeUnderEngineLock()
     {
         D2D1_TEXT_ANTIALIAS_MODE mode;
         // Update DxEngine's AntialiasingMode
@@ -735,6 +779,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             // TODO: MSFT:20895307 If the font doesn't exist, this doesn't
             //      actually fail. We need a way to gracefully fallback.
+            const auto engineLock = _lockRenderEngine();
             LOG_IF_FAILED(_renderEngine->UpdateDpi(newDpi));
             LOG_IF_FAILED(_renderEngine->UpdateFont(_desiredFont, _actualFont, featureMap, axesMap));
         }
@@ -850,7 +895,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // Convert our new dimensions to characters
         const auto viewInPixels = Viewport::FromDimensions({ 0, 0 },
                                                            { static_cast<short>(size.cx), static_cast<short>(size.cy) });
-        const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
+        const auto vp = [&]() {
+            const auto engineLock = _lockRenderEngine();
+            return _renderEngine->GetViewportInCharacters(viewInPixels);
+        }();
         const auto currentVP = _terminal->GetViewport();
 
         // Don't actually resize if viewport dimensions didn't change
@@ -862,7 +910,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _terminal->ClearSelection();
 
         // Tell the dx engine that our window is now the new size.
-        THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        {
+            const auto engineLock = _lockRenderEngine();
+            THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        }
 
         // Invalidate everything
         _renderer->TriggerRedrawAll();
@@ -883,7 +934,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _panelHeight = height;
 
         auto lock = _terminal->LockForWriting();
-        const auto currentEngineScale = _renderEngine->GetScaling();
+        const auto currentEngineScale = [&]() {
+            const auto engineLock = _lockRenderEngine();
+            return _renderEngine->GetScaling();
+        }();
 
         auto scaledWidth = width * currentEngineScale;
         auto scaledHeight = height * currentEngineScale;
@@ -897,7 +951,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        const auto currentEngineScale = _renderEngine->GetScaling();
+        const auto currentEngineScale = [&]() {
+            const auto engineLock = _lockRenderEngine();
+            return _renderEngine->GetScaling();
+        }();
         // If we're getting a notification to change to the DPI we already
         // have, then we're probably just beginning the DPI change. Since
         // we'll get _another_ event with the real DPI, do nothing here for
@@ -1216,11 +1273,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                                      const int viewHeight,
                                                      const int bufferSize)
     {
-        // Clear the regex pattern tree so the renderer does not try to render them while scrolling
-        // We're **NOT** taking the lock here unlike _scrollbarChangeHandler because
-        // we are already under lock (since this usually happens as a result of writing).
-        // TODO GH#9617: refine locking around pattern tree
-        _terminal->ClearPatternTree();
+        // The Terminal already moved the regex pattern tree along with the
+        // text, so there's no need to clear it while scrolling.
 
         // Start the throttled update of our scrollbar.
         auto update{ winrt::make<ScrollPositionChangedArgs>(viewTop,
@@ -1306,14 +1360,35 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                                     Search::Sensitivity::CaseSensitive :
                                                     Search::Sensitivity::CaseInsensitive;
 
-        ::Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
         auto lock = _terminal->LockForWriting();
-        if (search.FindNext())
+        if (_searcher)
+        {
+            _searcher->Update(text.c_str(), direction, sensitivity);
+        }
+        else
+        {
+            _searcher = std::make_unique<::Search>(*GetUiaData(), text.c_str(), direction, sensitivity);
+        }
+
+        if (_searcher->FindNext())
         {
             _terminal->SetBlockSelection(false);
-            search.Select();
+            _searcher->Select();
             _renderer->TriggerSelection();
         }
+
+        // The search read every row of the buffer. The matches are in the
+        // haystack of the searcher, so the rows can be frozen again.
+        _terminal->FreezeColdRows();
+    }
+
+    // Method Description:
+    // - Releases the text and the matches of the last search. This is
+    //   triggered when the search box is closed.
+    void ControlCore::ClearSearch()
+    {
+        auto lock = _terminal->LockForWriting();
+        _searcher.reset();
     }
 
     // Method Description:
@@ -1349,9 +1424,29 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             _closing = true;
 
             // Stop accepting new output and state changes before we disconnect everything.
-            _connection.TerminalOutput(_connectionOutputEventToken);
+            if (const auto conpty{ _connection.try_as<TerminalConnection::ConptyConnection>() })
+            {
+                conpty.TerminalOutputUtf8(_connectionOutputUtf8EventToken);
+            }
+            else
+            {
+                _connection.TerminalOutput(_connectionOutputEventToken);
+            }
             _connectionStateChangedRevoker.revoke();
 
+            if (_renderThread)
+            {
+                const auto statistics = _renderThread->GetFrameStatistics();
+                TraceLoggingWrite(g_hTerminalControlProvider,
+                                  "ControlCore_FrameStatistics",
+                                  TraceLoggingDescription("How well the frames kept up with the output over the lifetime of the control"),
+                                  TraceLoggingUInt64(statistics.framesPainted, "framesPainted", "the number of frames that were painted"),
+                                  TraceLoggingUInt64(statistics.framesSkipped, "framesSkipped", "the number of frame requests that were folded into a later frame"),
+                                  TraceLoggingInt64(statistics.paintTime.count(), "paintTimeMicroseconds", "the time spent painting all frames"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+            }
+
             // GH#1996 - Close the connection asynchronously on a background
             // thread.
             // Since TermControl::Close is only ever triggered by the UI, we
@@ -1369,9 +1464,30 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // * TermControl::_InitializeTerminal, after the call to Initialize, for
         //   _AttachDxgiSwapChainToXaml.
         // In both cases, we'll have a _renderEngine by then.
+        const auto engineLock = _lockRenderEngine();
         return reinterpret_cast<uint64_t>(_renderEngine->GetSwapChainHandle());
     }
 
+    // Method Description:
+    // - Locks the render engine, if it can be painted from a snapshot. The
+    //   render thread then paints outside of the terminal lock, while holding
+    //   this one, so we have to take it before we reconfigure the engine.
+    // - Never call into the _renderer while holding this lock. The renderer
+    //   waits for the frame in progress when it's called, and the render
+    //   thread holds this lock until that frame is presented.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - The held lock, or an empty one if the engine is always painted under the terminal lock.
+    std::unique_lock<til::ticket_lock> ControlCore::_lockRenderEngine() const
+    {
+        if (const auto engineLock = _renderEngine ? _renderEngine->GetSnapshotPaintLock() : nullptr)
+        {
+            return std::unique_lock{ *engineLock };
+        }
+        return {};
+    }
+
     void ControlCore::_rendererWarning(const HRESULT hr)
     {
         _RendererWarningHandlers(*this, winrt::make<RendererWarningArgs>(hr));
@@ -1527,6 +1643,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _updatePatternLocations->Run();
     }
 
+    void ControlCore::_connectionOutputUtf8Handler(const winrt::array_view<const uint8_t>& output)
+    {
+#pragma warning(suppress : 26490) // The bytes are UTF-8, whether they're typed as char or as uint8_t.
+        _terminal->Write(std::string_view{ reinterpret_cast<const char*>(output.data()), output.size() });
+
+        // Start the throttled update of where our hyperlinks are.
+        _updatePatternLocations->Run();
+    }
+
     // Method Description:
     // - Clear the contents of the buffer. The region cleared is given by
     //   clearType:
@@ -1558,6 +1683,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Has conpty trace the statistics of the console API calls it serviced.
+    //   Does nothing for connections that aren't backed by a conpty.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::DumpApiStatistics()
+    {
+        if (auto conpty{ _connection.try_as<TerminalConnection::ConptyConnection>() })
+        {
+            conpty.DumpApiStatistics();
+        }
+    }
+
     hstring ControlCore::ReadEntireBuffer() const
     {
         auto terminalLock = _terminal->LockForWriting();
@@ -1699,7 +1839,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _settings->FocusedAppearance()->SetColorTableEntry(15, scheme.BrightWhite);
 
         _terminal->ApplyScheme(scheme);
-        _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
+        {
+            const auto engineLock = _lockRenderEngine();
+            _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
+        }
 
         _renderer->TriggerRedrawAll();
         _BackgroundColorChangedHandlers(*this, nullptr);
@@ -128,8 +128,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                             const short wheelDelta,
                             const ::Microsoft::Console::VirtualTerminal::TerminalInput::MouseButtonState state);
         void UserScrollViewport(const int viewTop);
+        int ScrollOffsetOfRow(const int row) const;
 
         void ClearBuffer(Control::ClearBufferType clearType);
+        void DumpApiStatistics();
 
 #pragma endregion
 
@@ -150,6 +152,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void Search(const winrt::hstring& text,
                     const bool goForward,
                     const bool caseSensitive);
+        void ClearSearch();
 
         void LeftClickOnTerminal(const til::point terminalPosition,
                                  const int numberOfClicks,
@@ -198,6 +201,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         TerminalConnection::ITerminalConnection _connection{ nullptr };
         event_token _connectionOutputEventToken;
+        event_token _connectionOutputUtf8EventToken;
         TerminalConnection::ITerminalConnection::StateChanged_revoker _connectionStateChangedRevoker;
 
         winrt::com_ptr<ControlSettings> _settings{ nullptr };
@@ -211,6 +215,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // (C++ class members are destroyed in reverse order.)
         std::unique_ptr<::Microsoft::Console::Render::IRenderEngine> _renderEngine{ nullptr };
         std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer{ nullptr };
+        // Owned by the _renderer. Kept around to read its frame statistics.
+        ::Microsoft::Console::Render::RenderThread* _renderThread{ nullptr };
 
         FontInfoDesired _desiredFont;
         FontInfo _actualFont;
@@ -238,6 +244,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         std::shared_ptr<ThrottledFuncTrailing<>> _updatePatternLocations;
         std::shared_ptr<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>> _updateScrollBar;
 
+        // Kept around while the search box is open, so that every keystroke
+        // can reuse the text and the matches of the previous one.
+        std::unique_ptr<::Search> _searcher;
+
         winrt::fire_and_forget _asyncCloseConnection();
 
         void _setFontSize(int fontSize);
@@ -267,8 +277,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 #pragma endregion
 
         void _raiseReadOnlyWarning();
-        void _updateAntiAliasingMode();
+        void _setAntiAliasingModeUnderEngineLock();
+        std::unique_lock<til::ticket_lock> _lockRenderEngine() const;
         void _connectionOutputHandler(const hstring& hstr);
+        void _connectionOutputUtf8Handler(const winrt::array_view<const uint8_t>& output);
         void _updateHoveredCell(const std::optional<til::point> terminalPosition);
 
         bool _isBackgroundTransparent();
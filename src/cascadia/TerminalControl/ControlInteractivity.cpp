@@ -554,6 +554,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Scrolls so that the given row of the buffer is at the top of the
+    //   viewport, like UpdateScrollbar does for a scroll position.
+    // Arguments:
+    // - row: the row of the buffer
+    // Return Value:
+    // - <none>
+    void ControlInteractivity::ScrollToRow(const int row)
+    {
+        UpdateScrollbar(_core->ScrollOffsetOfRow(row));
+    }
+
     void ControlInteractivity::_hyperlinkHandler(const std::wstring_view uri)
     {
         _OpenHyperlinkHandlers(*this, winrt::make<OpenHyperlinkEventArgs>(winrt::hstring{ uri }));
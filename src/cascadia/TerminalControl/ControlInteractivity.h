@@ -77,6 +77,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                         const Control::MouseButtonState state);
 
         void UpdateScrollbar(const double newValue);
+        void ScrollToRow(const int row);
 
 #pragma endregion
 
@@ -171,7 +171,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void InteractivityAutomationPeer::ChangeViewport(const SMALL_RECT NewWindow)
     {
-        _interactivity->UpdateScrollbar(NewWindow.Top);
+        // UIA works with the rows of the buffer, not with scroll positions.
+        _interactivity->ScrollToRow(NewWindow.Top);
     }
 #pragma endregion
 
@@ -224,6 +224,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                              RoutedEventArgs const& /*args*/)
     {
         _searchBox->Visibility(Visibility::Collapsed);
+        _core.ClearSearch();
 
         // Set focus back to terminal control
         this->Focus(FocusState::Programmatic);
@@ -328,6 +329,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _core.ClearBuffer(clearType);
     }
 
+    void TermControl::DumpApiStatistics()
+    {
+        _core.DumpApiStatistics();
+    }
+
     void TermControl::ToggleShaderEffects()
     {
         _core.ToggleShaderEffects();
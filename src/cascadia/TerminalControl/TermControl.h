@@ -67,6 +67,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void SendInput(const winrt::hstring& input);
         void ClearBuffer(Control::ClearBufferType clearType);
+        void DumpApiStatistics();
 
         void ToggleShaderEffects();
 
@@ -43,7 +43,9 @@ Terminal::Terminal() :
     _colorTable{},
     _screenReversed{ false },
     _pfnWriteInput{ nullptr },
+    _historySize{ 0 },
     _scrollOffset{ 0 },
+    _patternTreeVisibleTop{ 0 },
     _snapOnInput{ true },
     _altGrAliasing{ true },
     _blockSelection{ false },
@@ -94,6 +96,7 @@ void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget&
     const TextAttribute attr{};
     const UINT cursorSize = 12;
     _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, renderTarget);
+    _buffer->SetColdRowDistance(ColdRowDistance);
 }
 
 // Method Description:
@@ -108,8 +111,20 @@ void Terminal::CreateFromSettings(ICoreSettings settings,
                               Utils::ClampToShortMax(settings.InitialRows(), 1) };
 
     // TODO:MSFT:20642297 - Support infinite scrollback here, if HistorySize is -1
-    Create(viewportSize, Utils::ClampToShortMax(settings.HistorySize(), 0), renderTarget);
+    const auto historySize = std::max(settings.HistorySize(), 0);
+
+    // The buffer can't hold more than SHORT_MAX rows. The rest of the history
+    // is kept by its scrollback store once it circles out of the buffer, and
+    // the store is addressed through a window above the first row of the
+    // buffer. Leave room for that window, so that it's taller than the viewport.
+    auto bufferHistory = historySize;
+    if (historySize > SHORT_MAX - viewportSize.Y)
+    {
+        bufferHistory = std::max(SHORT_MAX - viewportSize.Y - ScrollbackWindowRows, 0);
+    }
+    Create(viewportSize, gsl::narrow_cast<SHORT>(bufferHistory), renderTarget);
 
+    // UpdateSettings sets the limit of the scrollback store.
     UpdateSettings(settings);
 }
 
@@ -155,8 +170,12 @@ void Terminal::UpdateSettings(ICoreSettings settings)
     // size is smaller than where the mutable viewport currently is, we'll want
     // to make sure to rotate the buffer contents upwards, so the mutable viewport
     // remains at the bottom of the buffer.
+    // Until then, only the scrollback store follows the new HistorySize.
+    _historySize = std::max(settings.HistorySize(), 0);
     if (_buffer)
     {
+        _UpdateScrollbackLimit();
+
         // Clear the patterns first
         _buffer->ClearPatternRecognizers();
         if (settings.DetectURLs())
@@ -266,6 +285,14 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
     // bottom in the new buffer as well. Track that case now.
     const bool originalOffsetWasZero = _scrollOffset == 0;
 
+    // Rows of the scrollback store aren't reflowed. If the visible region
+    // starts in there, it'll start at the same row of the store afterwards.
+    std::optional<ScrollbackStore::row_number> visibleRowNumber;
+    if (newVisibleTop < 0)
+    {
+        visibleRowNumber = _buffer->GetRowNumber(newVisibleTop);
+    }
+
     // skip any drawing updates that might occur until we swap _buffer with the new buffer or if we exit early.
     _buffer->GetCursor().StartDeferDrawing();
     // we're capturing _buffer by reference here because when we exit, we want to EndDefer on the current active buffer.
@@ -303,6 +330,7 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
         oldRows.visibleViewportTop = newVisibleTop;
 
         const std::optional<short> oldViewStart{ oldViewportTop };
+        newTextBuffer->CopyPatterns(*_buffer);
         RETURN_IF_FAILED(TextBuffer::Reflow(*_buffer.get(),
                                             *newTextBuffer.get(),
                                             _mutableViewport,
@@ -421,6 +449,9 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
 
     _buffer.swap(newTextBuffer);
 
+    // The text was reflowed, so the old pattern locations don't mean anything anymore.
+    _patternIntervalTree = {};
+
     // GH#3494: Maintain scrollbar position during resize
     // Make sure that we don't scroll past the mutableViewport at the bottom of the buffer
     newVisibleTop = std::min(newVisibleTop, _mutableViewport.Top());
@@ -430,6 +461,17 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
     // If the old scrolloffset was 0, then we weren't scrolled back at all
     // before, and shouldn't be now either.
     _scrollOffset = originalOffsetWasZero ? 0 : static_cast<int>(::base::ClampSub(_mutableViewport.Top(), newVisibleTop));
+    if (!originalOffsetWasZero && visibleRowNumber)
+    {
+        const auto rowsAbove = _buffer->GetScrollback().GetEndRowNumber() - std::min(*visibleRowNumber, _buffer->GetScrollback().GetEndRowNumber());
+        _scrollOffset = ::base::saturated_cast<int>(_mutableViewport.Top() + rowsAbove);
+    }
+
+    try
+    {
+        _UpdateScrollbackLimit();
+    }
+    CATCH_LOG();
 
     // GH#5029 - make sure to InvalidateAll here, so that we'll paint the entire visible viewport.
     try
@@ -449,6 +491,19 @@ void Terminal::Write(std::wstring_view stringView)
     _stateMachine->ProcessString(stringView);
 }
 
+// Method Description:
+// - Writes UTF-8 encoded output, like the one read from a pseudoconsole, to
+//   the terminal. Its escape sequences are parsed without transcoding them.
+// Arguments:
+// - utf8 - the output. A code point that's split at its end is completed
+//   by the next call.
+void Terminal::Write(std::string_view utf8)
+{
+    auto lock = LockForWriting();
+
+    _stateMachine->ProcessString(utf8);
+}
+
 void Terminal::WritePastedText(std::wstring_view stringView)
 {
     auto option = ::Microsoft::Console::Utils::FilterOption::CarriageReturnNewline |
@@ -457,8 +512,14 @@ void Terminal::WritePastedText(std::wstring_view stringView)
     std::wstring filtered = ::Microsoft::Console::Utils::FilterStringForPaste(stringView, option);
     if (IsXtermBracketedPasteModeEnabled())
     {
-        filtered.insert(0, L"\x1b[200~");
-        filtered.append(L"\x1b[201~");
+        // Wrap the paste in a single copy. Inserting the prefix in front of
+        // it would move all of it, and appending the suffix might do so again.
+        static constexpr std::wstring_view prefix{ L"\x1b[200~" };
+        static constexpr std::wstring_view suffix{ L"\x1b[201~" };
+        std::wstring bracketed;
+        bracketed.reserve(prefix.size() + filtered.size() + suffix.size());
+        bracketed.append(prefix).append(filtered).append(suffix);
+        filtered = std::move(bracketed);
     }
 
     if (_pfnWriteInput)
@@ -481,6 +542,7 @@ void Terminal::TrySnapOnInput()
     {
         auto lock = LockForWriting();
         _scrollOffset = 0;
+        _UpdateScrollbackWindow();
         _NotifyScrollEvent();
     }
 }
@@ -736,7 +798,7 @@ void Terminal::_InvalidateFromCoords(const COORD start, const COORD end)
     }
     else
     {
-        const auto rowSize = gsl::narrow<SHORT>(_buffer->GetRowByOffset(0).size());
+        const auto rowSize = _buffer->GetSize().Width();
 
         // invalidate the first line
         SMALL_RECT region{ start.X, start.Y, rowSize - 1, start.Y };
@@ -900,9 +962,26 @@ Viewport Terminal::_GetMutableViewport() const noexcept
     return _mutableViewport;
 }
 
-short Terminal::GetBufferHeight() const noexcept
+// Method Description:
+// - Gets the height of the scrollable area: the rows of the scrollback store,
+//   followed by the rows of the buffer down to the bottom of the viewport.
+//   Scroll positions are counted from the oldest row of the scrollback store.
+int Terminal::GetBufferHeight() const noexcept
+{
+    return _mutableViewport.BottomExclusive() + _ScrollbackStoreRows();
+}
+
+// Method Description:
+// - Converts a row of the buffer into the scroll position it's at.
+// Arguments:
+// - row - the offset of the row, negative ones are in the scrollback window
+// Return Value:
+// - the scroll position of the row
+int Terminal::GetScrollOffsetOfRow(const int row) const noexcept
 {
-    return _mutableViewport.BottomExclusive();
+    const auto rowNumber = _buffer->GetRowNumber(row);
+    const auto first = _buffer->GetScrollback().GetFirstRowNumber();
+    return ::base::saturated_cast<int>(rowNumber - std::min(rowNumber, first));
 }
 
 // ViewStartIndex is also the length of the scrollback
@@ -916,17 +995,135 @@ int Terminal::ViewEndIndex() const noexcept
     return _mutableViewport.BottomInclusive();
 }
 
-// _VisibleStartIndex is the first visible line of the buffer
+// _VisibleStartIndex is the first visible line of the buffer. It's negative
+// if that line is in the scrollback window above the buffer.
 int Terminal::_VisibleStartIndex() const noexcept
 {
-    return std::max(0, ViewStartIndex() - _scrollOffset);
+    const auto top = _VisibleStartRow();
+    if (top >= 0)
+    {
+        return top;
+    }
+
+    // _UpdateScrollbackWindow keeps the visible rows of the scrollback store in the window.
+    const auto rowNumber = _buffer->GetScrollback().GetEndRowNumber() - gsl::narrow_cast<uint64_t>(-top);
+    return _buffer->GetRowOffset(rowNumber).value_or(-_buffer->GetScrollbackWindowHeight());
 }
 
 int Terminal::_VisibleEndIndex() const noexcept
 {
-    return std::max(0, ViewEndIndex() - _scrollOffset);
+    return _VisibleStartIndex() + _mutableViewport.Height() - 1;
+}
+
+// Method Description:
+// - Gets the first visible line, counted from the first row of the buffer,
+//   regardless of where the scrollback window currently is. The rows of the
+//   scrollback store are -1, -2 and so on.
+int Terminal::_VisibleStartRow() const noexcept
+{
+    return std::max(ViewStartIndex() - _scrollOffset, -_ScrollbackStoreRows());
+}
+
+int Terminal::_ScrollbackStoreRows() const noexcept
+{
+    return gsl::narrow_cast<int>(_buffer->GetScrollback().size());
+}
+
+// Method Description:
+// - Gets the largest _scrollOffset, which scrolls to the oldest row of the
+//   scrollback store, or to the top of the buffer if it's empty.
+int Terminal::_MaxScrollOffset() const noexcept
+{
+    if (_buffer->GetScrollback().empty())
+    {
+        return _buffer->GetSize().Height() - _mutableViewport.Height();
+    }
+    return ViewStartIndex() + _ScrollbackStoreRows();
 }
 
+// Method Description:
+// - Lets the scrollback store keep the part of the history that doesn't fit
+//   into the buffer, and makes sure we aren't scrolled to rows it dropped.
+void Terminal::_UpdateScrollbackLimit()
+{
+    const auto bufferHistory = _buffer->GetSize().Height() - _mutableViewport.Height();
+    _buffer->GetScrollback().SetLimit(gsl::narrow_cast<size_t>(std::max(_historySize - bufferHistory, 0)));
+
+    _scrollOffset = std::clamp(_scrollOffset, 0, std::max(_MaxScrollOffset(), 0));
+    _UpdateScrollbackWindow();
+}
+
+// Method Description:
+// - Moves the window of the scrollback store above the buffer so that it
+//   contains the visible rows. The buffer coordinates are SHORTs, so only
+//   a part of a long history can be addressed at once. While the visible rows
+//   are close enough to the buffer, the window ends with the newest row of
+//   the store. Further up, it's detached from the buffer and slides along.
+// - Selections in the window are moved along. The pattern tree is cleared,
+//   as no patterns are detected in the window.
+void Terminal::_UpdateScrollbackWindow() noexcept
+try
+{
+    const auto top = _VisibleStartRow();
+    const auto storeEnd = _buffer->GetScrollback().GetEndRowNumber();
+    const auto oldEnd = _buffer->GetScrollbackWindowEnd();
+    const auto room = gsl::narrow_cast<uint64_t>(SHORT_MAX - _buffer->GetSize().Height());
+
+    std::optional<ScrollbackStore::row_number> newEnd;
+    if (top < 0 && gsl::narrow_cast<uint64_t>(-top) > room)
+    {
+        const auto first = storeEnd - gsl::narrow_cast<uint64_t>(-top);
+        const auto height = gsl::narrow_cast<uint64_t>(_mutableViewport.Height());
+        if (oldEnd && *oldEnd >= first + height && *oldEnd - first <= room)
+        {
+            newEnd = oldEnd;
+        }
+        else
+        {
+            // Center the visible rows in the new window, so that scrolling
+            // either way doesn't slide it again right away.
+            newEnd = std::min(storeEnd, first + height + (room - std::min(room, height)) / 2);
+        }
+    }
+
+    // Note the rows of the selection before they move.
+    const auto selectionInWindow = _selection && _selection->start.Y < 0;
+    const auto startRow = selectionInWindow ? _buffer->GetRowNumber(_selection->start.Y) : 0;
+    const auto endRow = selectionInWindow ? _buffer->GetRowNumber(_selection->end.Y) : 0;
+    const auto pivotRow = selectionInWindow ? _buffer->GetRowNumber(_selection->pivot.Y) : 0;
+
+    _buffer->SetScrollbackWindowEnd(newEnd);
+    if (_buffer->GetScrollbackWindowEnd() == oldEnd)
+    {
+        return;
+    }
+
+    if (selectionInWindow)
+    {
+        const auto start = _buffer->GetRowOffset(startRow);
+        const auto end = _buffer->GetRowOffset(endRow);
+        const auto pivot = _buffer->GetRowOffset(pivotRow);
+        // Unless the window is attached to the buffer, the rows between them
+        // are only contiguous if they're both in the window.
+        if (start && end && (*end < 0 || !_buffer->GetScrollbackWindowEnd()))
+        {
+            _selection->start.Y = *start;
+            _selection->end.Y = *end;
+            _selection->pivot.Y = pivot.value_or(*start);
+        }
+        else
+        {
+            // The selection reaches into rows that can't be addressed anymore.
+            _selection.reset();
+        }
+    }
+
+    _patternIntervalTree = {};
+    _patternTreeVisibleTop = _VisibleStartIndex();
+    _buffer->GetRenderTarget().TriggerRedrawAll();
+}
+CATCH_LOG()
+
 Viewport Terminal::_GetVisibleViewport() const noexcept
 {
     const COORD origin{ 0, gsl::narrow<short>(_VisibleStartIndex()) };
@@ -946,62 +1143,23 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
     auto& cursor = _buffer->GetCursor();
 
-    // Defer the cursor drawing while we are iterating the string, for a better performance.
+    // Defer the cursor drawing while we are writing the string, for a better performance.
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
-    for (size_t i = 0; i < stringView.size(); i++)
-    {
-        const auto wch = stringView.at(i);
-        const COORD cursorPosBefore = cursor.GetPosition();
-        COORD proposedCursorPosition = cursorPosBefore;
-
-        // TODO: MSFT 21006766
-        // This is not great but I need it demoable. Fix by making a buffer stream writer.
-        //
-        // If wch is a surrogate character we need to read 2 code units
-        // from the stringView to form a single code point.
-        const auto isSurrogate = wch >= 0xD800 && wch <= 0xDFFF;
-        const auto view = stringView.substr(i, isSurrogate ? 2 : 1);
-        const OutputCellIterator it{ view, _buffer->GetCurrentAttributes() };
-        const auto end = _buffer->Write(it);
-        const auto cellDistance = end.GetCellDistance(it);
-        const auto inputDistance = end.GetInputDistance(it);
-
-        if (inputDistance > 0)
-        {
-            // If "wch" was a surrogate character, we just consumed 2 code units above.
-            // -> Increment "i" by 1 in that case and thus by 2 in total in this iteration.
-            proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            i += inputDistance - 1;
-        }
-        else
-        {
-            // If _WriteBuffer() is called with a consecutive string longer than the viewport/buffer width
-            // the call to _buffer->Write() will refuse to write anything on the current line.
-            // GetInputDistance() thus returns 0, which would in turn cause i to be
-            // decremented by 1 below and force the outer loop to loop forever.
-            // This if() basically behaves as if "\r\n" had been encountered above and retries the write.
-            // With well behaving shells during normal operation this safeguard should normally not be encountered.
-            proposedCursorPosition.X = 0;
-            proposedCursorPosition.Y++;
-
-            // Try the character again.
-            i--;
-
-            // If we write the last cell of the row here, TextBuffer::Write will
-            // mark this line as wrapped for us. If the next character we
-            // process is a newline, the Terminal::CursorLineFeed will unmark
-            // this line as wrapped.
-
-            // TODO: GH#780 - This should really be a _deferred_ newline. If
-            // the next character to come in is a newline or a cursor
-            // movement or anything, then we should _not_ wrap this line
-            // here.
-        }
-
-        _AdjustCursorPosition(proposedCursorPosition);
-    }
+    // The buffer fills as many cells per row as it can in a single pass and
+    // takes care of wrapping, wide glyphs and circling on its own. We only
+    // need to catch up the cursor, selection and viewport once at the end.
+    //
+    // If we write the last cell of a row here, TextBuffer::WriteStream will
+    // mark this line as wrapped for us. If the next character we process is a
+    // newline, the Terminal::CursorLineFeed will unmark this line as wrapped.
+    //
+    // TODO: GH#780 - This should really be a _deferred_ newline. If the next
+    // character to come in is a newline or a cursor movement or anything,
+    // then we should _not_ wrap this line here.
+    const auto result = _buffer->WriteStream(stringView, _buffer->GetCurrentAttributes(), cursor.GetPosition());
+    _UpdateCursorPosition(result.cursorPosition, result.rowsCircled);
 
     cursor.EndDeferDrawing();
 }
@@ -1010,49 +1168,80 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
 {
 #pragma warning(suppress : 26496) // cpp core checks wants this const but it's modified below.
     auto proposedCursorPosition = proposedPosition;
-    auto& cursor = _buffer->GetCursor();
     const Viewport bufferSize = _buffer->GetSize();
 
     // If we're about to scroll past the bottom of the buffer, instead cycle the
     // buffer.
     SHORT rowsPushedOffTopOfBuffer = 0;
     const auto newRows = std::max(0, proposedCursorPosition.Y - bufferSize.Height() + 1);
-    if (proposedCursorPosition.Y >= bufferSize.Height())
+    for (auto dy = 0; dy < newRows; dy++)
     {
-        for (auto dy = 0; dy < newRows; dy++)
-        {
-            _buffer->IncrementCircularBuffer();
-            proposedCursorPosition.Y--;
-            rowsPushedOffTopOfBuffer++;
+        _buffer->IncrementCircularBuffer();
+        proposedCursorPosition.Y--;
+        rowsPushedOffTopOfBuffer++;
+    }
+
+    _UpdateCursorPosition(proposedCursorPosition, rowsPushedOffTopOfBuffer);
+}
 
-            // Update our selection too, so it doesn't move as the buffer is cycled
-            if (_selection)
+// Method Description:
+// - Moves the cursor to the given position, which must already be within the
+//   buffer, and updates the selection, the viewport and the scroll offset to
+//   account for the rows that were circled out of the buffer to get there.
+// Arguments:
+// - proposedCursorPosition: the new cursor position
+// - rowsPushedOffTopOfBuffer: the number of times the buffer was circled
+// Return Value:
+// - <none>
+void Terminal::_UpdateCursorPosition(const COORD proposedCursorPosition, const SHORT rowsPushedOffTopOfBuffer)
+{
+    auto& cursor = _buffer->GetCursor();
+
+    // The rows that circled out of the buffer went into its scrollback store.
+    // While the scrollback window is attached to the buffer they move on into
+    // the window, otherwise they move into the rows that aren't addressable.
+    const auto windowAttached = !_buffer->GetScrollbackWindowEnd();
+    const auto top = windowAttached ? gsl::narrow_cast<SHORT>(-_buffer->GetScrollbackWindowHeight()) : SHORT{ 0 };
+
+    for (auto dy = 0; dy < rowsPushedOffTopOfBuffer; dy++)
+    {
+        // Update our selection too, so it doesn't move as the buffer is cycled
+        if (_selection && !windowAttached && _selection->start.Y < 0)
+        {
+            // The rows of a detached window don't move. If the selection
+            // reaches into the buffer, its end still does.
+            if (_selection->end.Y > 0)
+            {
+                _selection->end.Y -= 1;
+            }
+            else if (_selection->end.Y == 0)
+            {
+                _selection.reset();
+            }
+        }
+        else if (_selection)
+        {
+            // If the start of the selection is below the top, we can reduce both the start and end by 1
+            if (_selection->start.Y > top)
+            {
+                _selection->start.Y -= 1;
+                _selection->end.Y -= 1;
+            }
+            else
             {
-                // If the start of the selection is above 0, we can reduce both the start and end by 1
-                if (_selection->start.Y > 0)
+                // The start of the selection is at the top, if the end is below it, then only reduce the end
+                if (_selection->end.Y > top)
                 {
-                    _selection->start.Y -= 1;
+                    _selection->start.X = 0;
                     _selection->end.Y -= 1;
                 }
                 else
                 {
-                    // The start of the selection is at 0, if the end is greater than 0, then only reduce the end
-                    if (_selection->end.Y > 0)
-                    {
-                        _selection->start.X = 0;
-                        _selection->end.Y -= 1;
-                    }
-                    else
-                    {
-                        // Both the start and end of the selection are at 0, clear the selection
-                        _selection.reset();
-                    }
+                    // Both the start and end of the selection are at the top, clear the selection
+                    _selection.reset();
                 }
             }
         }
-
-        // manually erase our pattern intervals since the locations have changed now
-        _patternIntervalTree = {};
     }
 
     // Update Cursor Position
@@ -1074,7 +1263,7 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
 
     // If the viewport moved, or we circled the buffer, we might need to update
     // our _scrollOffset
-    if (updatedViewport || newRows != 0)
+    if (updatedViewport || rowsPushedOffTopOfBuffer != 0)
     {
         const auto oldScrollOffset = _scrollOffset;
 
@@ -1083,24 +1272,32 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
         //   - viewport is already at the bottom
         const bool scrollToOutput = !IsSelectionActive() && _scrollOffset == 0;
 
-        _scrollOffset = scrollToOutput ? 0 : _scrollOffset + scrollAmount + newRows;
+        _scrollOffset = scrollToOutput ? 0 : _scrollOffset + scrollAmount + rowsPushedOffTopOfBuffer;
 
         // Clamp the range to make sure that we don't scroll way off the top of the buffer
+        // (or the top of its scrollback store)
         _scrollOffset = std::clamp(_scrollOffset,
                                    0,
-                                   _buffer->GetSize().Height() - _mutableViewport.Height());
+                                   std::max(_MaxScrollOffset(), 0));
 
         // If the new scroll offset is different, then we'll still want to raise a scroll event
         updatedViewport = updatedViewport || (oldScrollOffset != _scrollOffset);
+
+        // The visible rows might have moved beyond the scrollback window.
+        _UpdateScrollbackWindow();
     }
 
+    // Move our pattern intervals along with the text, instead of discarding them.
+    _ShiftPatternTree(rowsPushedOffTopOfBuffer);
+
     // If the viewport moved, then send a scrolling notification.
     if (updatedViewport)
     {
         _NotifyScrollEvent();
     }
 
-    if (rowsPushedOffTopOfBuffer != 0)
+    // If the visible rows are in a detached scrollback window, they didn't move.
+    if (rowsPushedOffTopOfBuffer != 0 && !(_buffer->GetScrollbackWindowEnd() && _VisibleStartIndex() < 0))
     {
         // We have to report the delta here because we might have circled the text buffer.
         // That didn't change the viewport and therefore the TriggerScroll(void)
@@ -1122,12 +1319,15 @@ void Terminal::UserScrollViewport(const int viewTop)
     // we're going to modify state here that the renderer could be reading.
     auto lock = LockForWriting();
 
-    const auto clampedNewTop = std::max(0, viewTop);
+    // viewTop is counted from the oldest row of the scrollback store.
+    const auto clampedNewTop = std::max(0, viewTop) - _ScrollbackStoreRows();
     const auto realTop = ViewStartIndex();
     const auto newDelta = realTop - clampedNewTop;
     // if viewTop > realTop, we want the offset to be 0.
 
     _scrollOffset = std::max(0, newDelta);
+    _UpdateScrollbackWindow();
+    _ShiftPatternTree(0);
 
     // We can use the void variant of TriggerScroll here because
     // we adjusted the viewport so it can detect the difference
@@ -1137,17 +1337,18 @@ void Terminal::UserScrollViewport(const int viewTop)
 
 int Terminal::GetScrollOffset() noexcept
 {
-    return _VisibleStartIndex();
+    return _VisibleStartRow() + _ScrollbackStoreRows();
 }
 
 void Terminal::_NotifyScrollEvent() noexcept
 try
 {
+    _ShiftPatternTree(0);
+
     if (_pfnScrollPositionChanged)
     {
-        const auto visible = _GetVisibleViewport();
-        const auto top = visible.Top();
-        const auto height = visible.Height();
+        const auto top = GetScrollOffset();
+        const auto height = _mutableViewport.Height();
         const auto bottom = this->GetBufferHeight();
         _pfnScrollPositionChanged(top, height, bottom);
     }
@@ -1259,10 +1460,76 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
 void Terminal::UpdatePatternsUnderLock() noexcept
 {
     auto oldTree = _patternIntervalTree;
-    _patternIntervalTree = _buffer->GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
-    _InvalidatePatternTree(oldTree);
-    _InvalidatePatternTree(_patternIntervalTree);
+    const auto visibleTop = _VisibleStartIndex();
+    const auto visibleBottom = _VisibleEndIndex();
+    if (visibleTop >= 0)
+    {
+        _patternIntervalTree = _buffer->GetPatterns(visibleTop, visibleBottom);
+    }
+    else if (visibleBottom < 0)
+    {
+        _patternIntervalTree = {};
+    }
+    else
+    {
+        // Patterns aren't detected in the scrollback window, only in the
+        // rows of the buffer below it. They're found relative to its first row.
+        PointTree::interval_vector intervals;
+        _buffer->GetPatterns(0, visibleBottom).visit_all([&](const auto& interval) {
+            const til::point offset{ 0, -visibleTop };
+            intervals.push_back(PointTree::interval(interval.start + offset, interval.stop + offset, interval.value));
+        });
+        _patternIntervalTree = PointTree{ std::move(intervals) };
+    }
+    _patternTreeVisibleTop = visibleTop;
+
+    // This runs about every frame while there's output. Only redraw the
+    // patterns if they actually changed.
+    PointTree::interval_vector oldIntervals;
+    PointTree::interval_vector newIntervals;
+    oldTree.visit_all([&](const auto& interval) { oldIntervals.push_back(interval); });
+    _patternIntervalTree.visit_all([&](const auto& interval) { newIntervals.push_back(interval); });
+    const auto equal = std::equal(oldIntervals.begin(), oldIntervals.end(), newIntervals.begin(), newIntervals.end(), [](const auto& a, const auto& b) {
+        return a.start == b.start && a.stop == b.stop && a.value == b.value;
+    });
+    if (!equal)
+    {
+        _InvalidatePatternTree(oldTree);
+        _InvalidatePatternTree(_patternIntervalTree);
+    }
+}
+
+// Method Description:
+// - Moves the pattern intervals along with the text, after the visible region
+//   moved or the buffer circled. The rows that scrolled into view don't have
+//   any patterns until the next UpdatePatternsUnderLock, but the ones that
+//   stayed visible keep theirs, instead of flickering off until then.
+// Arguments:
+// - rowsCircled - the number of rows the buffer circled since the last call
+void Terminal::_ShiftPatternTree(const int rowsCircled) noexcept
+try
+{
+    const auto visibleTop = _VisibleStartIndex();
+    const auto delta = _patternTreeVisibleTop - visibleTop - rowsCircled;
+    _patternTreeVisibleTop = visibleTop;
+    if (delta == 0)
+    {
+        return;
+    }
+
+    const auto height = _mutableViewport.Height();
+    PointTree::interval_vector intervals;
+    _patternIntervalTree.visit_all([&](const auto& interval) {
+        const auto start = interval.start + til::point{ 0, delta };
+        const auto stop = interval.stop + til::point{ 0, delta };
+        if (stop.y() >= 0 && start.y() < height)
+        {
+            intervals.push_back(PointTree::interval(start, stop, interval.value));
+        }
+    });
+    _patternIntervalTree = PointTree{ std::move(intervals) };
 }
+CATCH_LOG()
 
 // Method Description:
 // - Clears and invalidates the interval pattern tree
@@ -1272,9 +1539,20 @@ void Terminal::ClearPatternTree() noexcept
 {
     auto oldTree = _patternIntervalTree;
     _patternIntervalTree = {};
+    _patternTreeVisibleTop = _VisibleStartIndex();
     _InvalidatePatternTree(oldTree);
 }
 
+// Method Description:
+// - Freezes the rows far above the cursor that were thawed since they
+//   scrolled out of sight, and drops the copies of the frozen rows that
+//   were thawed to read them. Called after reading through the whole
+//   buffer, like a search does.
+void Terminal::FreezeColdRows() noexcept
+{
+    _buffer->FreezeColdRows();
+}
+
 // Method Description:
 // - Returns the tab color
 // If the starting color exits, it's value is preferred
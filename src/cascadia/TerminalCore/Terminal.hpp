@@ -22,6 +22,11 @@
 
 static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
 static constexpr size_t TaskbarMinProgress{ 10 };
+// Rows this far above the cursor are kept in their compact frozen form.
+static constexpr SHORT ColdRowDistance{ 1000 };
+// If the history doesn't fit into the buffer, this many of its rows are kept
+// free to address the scrollback store through a window above the buffer.
+static constexpr SHORT ScrollbackWindowRows{ 8192 };
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
 // If you include the header, there will be compilation errors with other
@@ -76,6 +81,7 @@ public:
 
     // Write goes through the parser
     void Write(std::wstring_view stringView);
+    void Write(std::string_view utf8);
 
     // WritePastedText goes directly to the connection
     void WritePastedText(std::wstring_view stringView);
@@ -83,7 +89,8 @@ public:
     [[nodiscard]] std::unique_lock<til::ticket_lock> LockForReading();
     [[nodiscard]] std::unique_lock<til::ticket_lock> LockForWriting();
 
-    short GetBufferHeight() const noexcept;
+    int GetBufferHeight() const noexcept;
+    int GetScrollOffsetOfRow(const int row) const noexcept;
 
     int ViewStartIndex() const noexcept;
     int ViewEndIndex() const noexcept;
@@ -179,6 +186,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
     const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    const std::vector<Microsoft::Console::Render::PatternIdRun> GetPatternIdRuns(const COORD location, const SHORT length) const noexcept override;
 #pragma endregion
 
 #pragma region IUiaData
@@ -210,6 +218,8 @@ public:
     void UpdatePatternsUnderLock() noexcept;
     void ClearPatternTree() noexcept;
 
+    void FreezeColdRows() noexcept;
+
     const std::optional<til::color> GetTabColor() const noexcept;
 
     winrt::Microsoft::Terminal::Core::Scheme GetColorScheme() const noexcept;
@@ -327,9 +337,13 @@ private:
     std::unique_ptr<TextBuffer> _buffer;
     Microsoft::Console::Types::Viewport _mutableViewport;
     SHORT _scrollbackLines;
+    // The number of rows of history, which may be more than the buffer can
+    // hold. Its scrollback store keeps the rest.
+    int _historySize;
 
     // _scrollOffset is the number of lines above the viewport that are currently visible
     // If _scrollOffset is 0, then the visible region of the buffer is the viewport.
+    // It can reach above the buffer into its scrollback store, see _VisibleStartIndex.
     int _scrollOffset;
     // TODO this might not be the value we want to store.
     // We might want to store the height in the scrollback that's currently visible.
@@ -345,7 +359,10 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The visible top the rows of _patternIntervalTree are relative to.
+    int _patternTreeVisibleTop;
     void _InvalidatePatternTree(interval_tree::IntervalTree<til::point, size_t>& tree);
+    void _ShiftPatternTree(const int rowsCircled) noexcept;
     void _InvalidateFromCoords(const COORD start, const COORD end);
 
     // Since virtual keys are non-zero, you assume that this field is empty/invalid if it is.
@@ -366,6 +383,11 @@ private:
 
     int _VisibleStartIndex() const noexcept;
     int _VisibleEndIndex() const noexcept;
+    int _VisibleStartRow() const noexcept;
+    int _ScrollbackStoreRows() const noexcept;
+    int _MaxScrollOffset() const noexcept;
+    void _UpdateScrollbackLimit();
+    void _UpdateScrollbackWindow() noexcept;
 
     Microsoft::Console::Types::Viewport _GetMutableViewport() const noexcept;
     Microsoft::Console::Types::Viewport _GetVisibleViewport() const noexcept;
@@ -375,6 +397,7 @@ private:
     void _WriteBuffer(const std::wstring_view& stringView);
 
     void _AdjustCursorPosition(const COORD proposedPosition);
+    void _UpdateCursorPosition(const COORD proposedCursorPosition, const SHORT rowsPushedOffTopOfBuffer);
 
     void _NotifyScrollEvent() noexcept;
 
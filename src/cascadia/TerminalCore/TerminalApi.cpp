@@ -322,6 +322,14 @@ try
             _buffer->GetRowByOffset(i).Reset(_buffer->GetCurrentAttributes());
         }
 
+        // The rows that already circled out of the buffer are part of the scrollback as well.
+        _buffer->GetScrollback().Clear();
+        _buffer->SetScrollbackWindowEnd(std::nullopt);
+        if (_selection && _selection->start.Y < 0)
+        {
+            _selection.reset();
+        }
+
         // Reset the scroll offset now because there's nothing for the user to 'scroll' to
         _scrollOffset = 0;
 
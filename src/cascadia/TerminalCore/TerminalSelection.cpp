@@ -182,7 +182,7 @@ void Terminal::SetSelectionEnd(const COORD viewportPos, std::optional<SelectionE
 // - the new start/end for a selection
 std::pair<COORD, COORD> Terminal::_PivotSelection(const COORD targetPos, bool& targetStart) const
 {
-    if (targetStart = _buffer->GetSize().CompareInBounds(targetPos, _selection->pivot) <= 0)
+    if (targetStart = _buffer->GetSizeWithScrollback().CompareInBounds(targetPos, _selection->pivot) <= 0)
     {
         // target is before pivot
         // treat target as start
@@ -207,7 +207,7 @@ std::pair<COORD, COORD> Terminal::_ExpandSelectionAnchors(std::pair<COORD, COORD
     COORD start = anchors.first;
     COORD end = anchors.second;
 
-    const auto bufferSize = _buffer->GetSize();
+    const auto bufferSize = _buffer->GetSizeWithScrollback();
     switch (_multiClickSelectionMode)
     {
     case SelectionExpansion::Line:
@@ -324,6 +324,8 @@ void Terminal::UpdateSelection(SelectionDirection direction, SelectionExpansion
             const auto amtBelowView = targetPos.Y - viewport.BottomInclusive();
             _scrollOffset -= amtBelowView;
         }
+        _scrollOffset = std::clamp(_scrollOffset, 0, std::max(_MaxScrollOffset(), 0));
+        _UpdateScrollbackWindow();
         _NotifyScrollEvent();
         _buffer->GetRenderTarget().TriggerScroll();
     }
@@ -334,22 +336,22 @@ void Terminal::_MoveByChar(SelectionDirection direction, COORD& pos)
     switch (direction)
     {
     case SelectionDirection::Left:
-        _buffer->GetSize().DecrementInBounds(pos);
+        _buffer->GetSizeWithScrollback().DecrementInBounds(pos);
         pos = _buffer->GetGlyphStart(pos);
         break;
     case SelectionDirection::Right:
-        _buffer->GetSize().IncrementInBounds(pos);
+        _buffer->GetSizeWithScrollback().IncrementInBounds(pos);
         pos = _buffer->GetGlyphEnd(pos);
         break;
     case SelectionDirection::Up:
     {
-        const auto bufferSize{ _buffer->GetSize() };
+        const auto bufferSize{ _buffer->GetSizeWithScrollback() };
         pos = { pos.X, std::clamp(base::ClampSub<short, short>(pos.Y, 1).RawValue(), bufferSize.Top(), bufferSize.BottomInclusive()) };
         break;
     }
     case SelectionDirection::Down:
     {
-        const auto bufferSize{ _buffer->GetSize() };
+        const auto bufferSize{ _buffer->GetSizeWithScrollback() };
         pos = { pos.X, std::clamp(base::ClampAdd<short, short>(pos.Y, 1).RawValue(), bufferSize.Top(), bufferSize.BottomInclusive()) };
         break;
     }
@@ -362,17 +364,17 @@ void Terminal::_MoveByWord(SelectionDirection direction, COORD& pos)
     {
     case SelectionDirection::Left:
         const auto wordStartPos{ _buffer->GetWordStart(pos, _wordDelimiters) };
-        if (_buffer->GetSize().CompareInBounds(_selection->pivot, pos) < 0)
+        if (_buffer->GetSizeWithScrollback().CompareInBounds(_selection->pivot, pos) < 0)
         {
             // If we're moving towards the pivot, move one more cell
             pos = wordStartPos;
-            _buffer->GetSize().DecrementInBounds(pos);
+            _buffer->GetSizeWithScrollback().DecrementInBounds(pos);
         }
         else if (wordStartPos == pos)
         {
             // already at the beginning of the current word,
             // move to the beginning of the previous word
-            _buffer->GetSize().DecrementInBounds(pos);
+            _buffer->GetSizeWithScrollback().DecrementInBounds(pos);
             pos = _buffer->GetWordStart(pos, _wordDelimiters);
         }
         else
@@ -383,17 +385,17 @@ void Terminal::_MoveByWord(SelectionDirection direction, COORD& pos)
         break;
     case SelectionDirection::Right:
         const auto wordEndPos{ _buffer->GetWordEnd(pos, _wordDelimiters) };
-        if (_buffer->GetSize().CompareInBounds(pos, _selection->pivot) < 0)
+        if (_buffer->GetSizeWithScrollback().CompareInBounds(pos, _selection->pivot) < 0)
         {
             // If we're moving towards the pivot, move one more cell
             pos = _buffer->GetWordEnd(pos, _wordDelimiters);
-            _buffer->GetSize().IncrementInBounds(pos);
+            _buffer->GetSizeWithScrollback().IncrementInBounds(pos);
         }
         else if (wordEndPos == pos)
         {
             // already at the end of the current word,
             // move to the end of the next word
-            _buffer->GetSize().IncrementInBounds(pos);
+            _buffer->GetSizeWithScrollback().IncrementInBounds(pos);
             pos = _buffer->GetWordEnd(pos, _wordDelimiters);
         }
         else
@@ -415,7 +417,7 @@ void Terminal::_MoveByWord(SelectionDirection direction, COORD& pos)
 
 void Terminal::_MoveByViewport(SelectionDirection direction, COORD& pos)
 {
-    const auto bufferSize{ _buffer->GetSize() };
+    const auto bufferSize{ _buffer->GetSizeWithScrollback() };
     switch (direction)
     {
     case SelectionDirection::Left:
@@ -444,7 +446,7 @@ void Terminal::_MoveByViewport(SelectionDirection direction, COORD& pos)
 
 void Terminal::_MoveByBuffer(SelectionDirection direction, COORD& pos)
 {
-    const auto bufferSize{ _buffer->GetSize() };
+    const auto bufferSize{ _buffer->GetSizeWithScrollback() };
     switch (direction)
     {
     case SelectionDirection::Left:
@@ -500,7 +502,7 @@ COORD Terminal::_ConvertToBufferCell(const COORD viewportPos) const
 {
     const auto yPos = base::ClampedNumeric<short>(_VisibleStartIndex()) + viewportPos.Y;
     COORD bufferPos = { viewportPos.X, yPos };
-    _buffer->GetSize().Clamp(bufferPos);
+    _buffer->GetSizeWithScrollback().Clamp(bufferPos);
     return bufferPos;
 }
 
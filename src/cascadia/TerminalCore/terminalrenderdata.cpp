@@ -191,6 +191,85 @@ const std::vector<size_t> Terminal::GetPatternId(const COORD location) const noe
     return {};
 }
 
+// Method Description:
+// - Gets the regex pattern ids of a range of cells within a row
+// Arguments:
+// - location - The first cell of the range
+// - length - The number of cells in the range
+// Return value:
+// - The runs of cells that are part of the same patterns, from left to right.
+//   Cells that aren't part of any pattern aren't included.
+const std::vector<PatternIdRun> Terminal::GetPatternIdRuns(const COORD location, const SHORT length) const noexcept
+try
+{
+    const auto begin = location.X;
+    const auto end = gsl::narrow_cast<SHORT>(location.X + length);
+
+    // Clip the intervals to the range. Just like in GetPatternId, a cell is
+    // part of an interval if the interval reaches up to the cell after it.
+    std::vector<std::tuple<SHORT, SHORT, size_t>> ranges;
+    _patternIntervalTree.visit_overlapping(COORD{ gsl::narrow_cast<SHORT>(begin + 1), location.Y }, COORD{ end, location.Y }, [&](const auto& interval) {
+        const auto first = interval.start.y() < location.Y ? begin : std::max(begin, gsl::narrow_cast<SHORT>(interval.start.x()));
+        const auto last = interval.stop.y() > location.Y ? end : std::min(end, gsl::narrow_cast<SHORT>(interval.stop.x()));
+        if (first < last)
+        {
+            ranges.emplace_back(first, last, interval.value);
+        }
+    });
+
+    if (ranges.empty())
+    {
+        return {};
+    }
+
+    // The ids only change at the edges of the ranges.
+    std::vector<SHORT> edges;
+    for (const auto& [first, last, id] : ranges)
+    {
+        edges.push_back(first);
+        edges.push_back(last);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<PatternIdRun> runs;
+    for (size_t i = 1; i < edges.size(); ++i)
+    {
+        const auto first = edges.at(i - 1);
+        const auto last = edges.at(i);
+
+        std::vector<size_t> ids;
+        for (const auto& [rangeFirst, rangeLast, id] : ranges)
+        {
+            if (rangeFirst <= first && last <= rangeLast)
+            {
+                ids.push_back(id);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+
+        if (ids.empty())
+        {
+            continue;
+        }
+
+        if (!runs.empty() && runs.back().end == first && runs.back().ids == ids)
+        {
+            runs.back().end = last;
+        }
+        else
+        {
+            runs.push_back({ first, last, std::move(ids) });
+        }
+    }
+    return runs;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
 std::vector<Microsoft::Console::Types::Viewport> Terminal::GetSelectionRects() noexcept
 try
 {
@@ -217,11 +296,18 @@ void Terminal::SelectNewRegion(const COORD coordStart, const COORD coordEnd)
     COORD realCoordEnd = coordEnd;
 #pragma warning(pop)
 
+    // The region may start in the scrollback window, which might move as we
+    // scroll to it. Hold on to the rows it's in, not to their offsets.
+    const auto startRow = _buffer->GetRowNumber(coordStart.Y);
+    const auto endRow = _buffer->GetRowNumber(coordEnd.Y);
+    // The start of the region, counted from the first row of the buffer.
+    const auto startTop = gsl::narrow_cast<int>(gsl::narrow_cast<int64_t>(startRow - _buffer->GetScrollback().GetEndRowNumber()));
+
     bool notifyScrollChange = false;
     if (coordStart.Y < _VisibleStartIndex())
     {
         // recalculate the scrollOffset
-        _scrollOffset = ViewStartIndex() - coordStart.Y;
+        _scrollOffset = ViewStartIndex() - startTop;
         notifyScrollChange = true;
     }
     else if (coordEnd.Y > _VisibleEndIndex())
@@ -230,14 +316,17 @@ void Terminal::SelectNewRegion(const COORD coordStart, const COORD coordEnd)
         // beneath the current visible viewport, it may be within the
         // current mutableViewport and the scrollOffset will be smaller
         // than 0
-        _scrollOffset = std::max(0, ViewStartIndex() - coordStart.Y);
+        _scrollOffset = std::max(0, ViewStartIndex() - startTop);
         notifyScrollChange = true;
     }
 
     if (notifyScrollChange)
     {
+        _UpdateScrollbackWindow();
         _buffer->GetRenderTarget().TriggerScroll();
         _NotifyScrollEvent();
+        realCoordStart.Y = _buffer->GetRowOffset(startRow).value_or(realCoordStart.Y);
+        realCoordEnd.Y = _buffer->GetRowOffset(endRow).value_or(realCoordEnd.Y);
     }
 
     realCoordStart.Y -= gsl::narrow<short>(_VisibleStartIndex());
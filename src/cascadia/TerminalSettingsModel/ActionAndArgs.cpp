@@ -55,6 +55,7 @@ static constexpr std::string_view LegacyToggleRetroEffectKey{ "toggleRetroEffect
 static constexpr std::string_view ToggleShaderEffectsKey{ "toggleShaderEffects" };
 static constexpr std::string_view MoveTabKey{ "moveTab" };
 static constexpr std::string_view BreakIntoDebuggerKey{ "breakIntoDebugger" };
+static constexpr std::string_view DumpApiStatisticsKey{ "dumpApiStatistics" };
 static constexpr std::string_view FindMatchKey{ "findMatch" };
 static constexpr std::string_view TogglePaneReadOnlyKey{ "toggleReadOnlyMode" };
 static constexpr std::string_view NewWindowKey{ "newWindow" };
@@ -360,6 +361,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
                 { ShortcutAction::ToggleShaderEffects, RS_(L"ToggleShaderEffectsCommandKey") },
                 { ShortcutAction::MoveTab, L"" }, // Intentionally omitted, must be generated by GenerateName
                 { ShortcutAction::BreakIntoDebugger, RS_(L"BreakIntoDebuggerCommandKey") },
+                { ShortcutAction::DumpApiStatistics, RS_(L"DumpApiStatisticsCommandKey") },
                 { ShortcutAction::FindMatch, L"" }, // Intentionally omitted, must be generated by GenerateName
                 { ShortcutAction::TogglePaneReadOnly, RS_(L"TogglePaneReadOnlyCommandKey") },
                 { ShortcutAction::NewWindow, RS_(L"NewWindowCommandKey") },
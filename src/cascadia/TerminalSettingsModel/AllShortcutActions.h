@@ -69,6 +69,7 @@
     ON_ALL_ACTIONS(TabSearch)              \
     ON_ALL_ACTIONS(MoveTab)                \
     ON_ALL_ACTIONS(BreakIntoDebugger)      \
+    ON_ALL_ACTIONS(DumpApiStatistics)      \
     ON_ALL_ACTIONS(TogglePaneReadOnly)     \
     ON_ALL_ACTIONS(FindMatch)              \
     ON_ALL_ACTIONS(NewWindow)              \
@@ -82,6 +82,7 @@ namespace ControlUnitTests
         WINRT_PROPERTY(bool, RetroTerminalEffect, false);
         WINRT_PROPERTY(bool, ForceFullRepaintRendering, false);
         WINRT_PROPERTY(bool, SoftwareRendering, false);
+        WINRT_PROPERTY(int32_t, MaximumFrameRate, 0);
         WINRT_PROPERTY(bool, ForceVTInput, false);
 
         WINRT_PROPERTY(winrt::hstring, PixelShaderPath);
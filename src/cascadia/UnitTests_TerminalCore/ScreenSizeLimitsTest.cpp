@@ -82,17 +82,22 @@ void ScreenSizeLimitsTest::ScrollbackHistorySizeIsClampedToBounds()
     maxHistorySizeTerminal.CreateFromSettings(maxHistorySizeSettings, emptyRenderTarget);
     VERIFY_ARE_EQUAL(maxHistorySizeTerminal.GetTextBuffer().TotalRowCount(), static_cast<unsigned int>(SHRT_MAX), L"History size == SHRT_MAX - initial row count is accepted");
 
-    // History size + initial visible rows == SHRT_MAX + 1 will be clamped slightly.
+    // History size + initial visible rows == SHRT_MAX + 1 doesn't fit. The
+    // buffer leaves room for the window into its scrollback store, which
+    // keeps the rest of the history.
+    const auto bufferRowCount = static_cast<unsigned int>(SHRT_MAX - ScrollbackWindowRows);
     auto justTooBigHistorySizeSettings = winrt::make<MockTermSettings>(SHRT_MAX - visibleRowCount + 1, visibleRowCount, 100);
     Terminal justTooBigHistorySizeTerminal;
     justTooBigHistorySizeTerminal.CreateFromSettings(justTooBigHistorySizeSettings, emptyRenderTarget);
-    VERIFY_ARE_EQUAL(justTooBigHistorySizeTerminal.GetTextBuffer().TotalRowCount(), static_cast<unsigned int>(SHRT_MAX), L"History size == 1 + SHRT_MAX - initial row count is clamped to SHRT_MAX - initial row count");
+    VERIFY_ARE_EQUAL(justTooBigHistorySizeTerminal.GetTextBuffer().TotalRowCount(), bufferRowCount, L"History size == 1 + SHRT_MAX - initial row count is clamped to make room for the scrollback window");
+    VERIFY_ARE_EQUAL(justTooBigHistorySizeTerminal.GetTextBuffer().GetScrollback().GetLimit(), static_cast<size_t>(ScrollbackWindowRows + 1), L"The scrollback store keeps the rest of the history");
 
     // Ridiculously large history sizes are also clamped.
     auto farTooBigHistorySizeSettings = winrt::make<MockTermSettings>(99999999, visibleRowCount, 100);
     Terminal farTooBigHistorySizeTerminal;
     farTooBigHistorySizeTerminal.CreateFromSettings(farTooBigHistorySizeSettings, emptyRenderTarget);
-    VERIFY_ARE_EQUAL(farTooBigHistorySizeTerminal.GetTextBuffer().TotalRowCount(), static_cast<unsigned int>(SHRT_MAX), L"History size that is far too large is clamped to SHRT_MAX - initial row count");
+    VERIFY_ARE_EQUAL(farTooBigHistorySizeTerminal.GetTextBuffer().TotalRowCount(), bufferRowCount, L"History size that is far too large is clamped to make room for the scrollback window");
+    VERIFY_ARE_EQUAL(farTooBigHistorySizeTerminal.GetTextBuffer().GetScrollback().GetLimit(), static_cast<size_t>(99999999 - (SHRT_MAX - ScrollbackWindowRows - visibleRowCount)), L"The scrollback store keeps the rest of the history");
 }
 
 void ScreenSizeLimitsTest::ResizeIsClampedToBounds()
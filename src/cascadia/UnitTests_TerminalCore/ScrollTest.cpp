@@ -87,6 +87,7 @@ class TerminalCoreUnitTests::ScrollTest final
     TEST_CLASS(ScrollTest);
 
     TEST_METHOD(TestNotifyScrolling);
+    TEST_METHOD(TestScrollIntoScrollbackStore);
 
     TEST_METHOD_SETUP(MethodSetup)
     {
@@ -215,3 +216,48 @@ void ScrollTest::TestNotifyScrolling()
         }
     }
 }
+
+void ScrollTest::TestScrollIntoScrollbackStore()
+{
+    auto& termTb = *_term->_buffer;
+    auto& termSm = *_term->_stateMachine;
+    const auto totalBufferSize = termTb.GetSize().Height();
+
+    Log::Comment(L"Keep 100 more rows of history than the buffer holds.");
+    _term->_historySize = TerminalHistoryLength + 100;
+    _term->_UpdateScrollbackLimit();
+    VERIFY_ARE_EQUAL(100u, termTb.GetScrollback().GetLimit());
+
+    WEX::TestExecution::SetVerifyOutput settings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+    for (auto row = 0; row < totalBufferSize + 50; ++row)
+    {
+        termSm.ProcessString(fmt::format(L"row{}\r\n", row));
+    }
+
+    const auto storeRows = gsl::narrow_cast<int>(termTb.GetScrollback().size());
+    VERIFY_IS_GREATER_THAN(storeRows, 0);
+
+    Log::Comment(L"The scroll positions count the rows of the scrollback store as well.");
+    VERIFY_IS_TRUE(_scrollBarNotification->has_value());
+    VERIFY_ARE_EQUAL(_term->ViewStartIndex() + storeRows, _scrollBarNotification->value().ViewportTop);
+    VERIFY_ARE_EQUAL(_term->ViewEndIndex() + 1 + storeRows, _scrollBarNotification->value().BufferHeight);
+
+    Log::Comment(L"Scrolling to the top shows the oldest row, which is in the scrollback store.");
+    _term->UserScrollViewport(0);
+    VERIFY_ARE_EQUAL(0, _term->GetScrollOffset());
+    VERIFY_ARE_EQUAL(-storeRows, _term->_VisibleStartIndex());
+    VERIFY_ARE_EQUAL(L"row0", termTb.GetRowByOffset(_term->_VisibleStartIndex()).GetText().substr(0, 4));
+
+    Log::Comment(L"More output doesn't move the visible rows.");
+    for (auto row = 0; row < 10; ++row)
+    {
+        termSm.ProcessString(L"more\r\n");
+    }
+    VERIFY_ARE_EQUAL(L"row0", termTb.GetRowByOffset(_term->_VisibleStartIndex()).GetText().substr(0, 4));
+
+    Log::Comment(L"Reapplying a history that fits into the buffer empties the scrollback store.");
+    _term->UpdateSettings(winrt::make<MockTermSettings>(TerminalHistoryLength, TerminalViewHeight, TerminalViewWidth));
+    VERIFY_IS_TRUE(termTb.GetScrollback().empty());
+    VERIFY_ARE_EQUAL(0, _term->_VisibleStartIndex());
+    VERIFY_ARE_EQUAL(0, _term->GetScrollOffset());
+}
@@ -66,5 +66,6 @@
     X(winrt::Microsoft::Terminal::Control::TextAntialiasingMode, AntialiasingMode, winrt::Microsoft::Terminal::Control::TextAntialiasingMode::Grayscale) \
     X(bool, ForceFullRepaintRendering, false)                                                                                                            \
     X(bool, SoftwareRendering, false)                                                                                                                    \
+    X(int32_t, MaximumFrameRate, 0)                                                                                                                      \
     X(bool, ForceVTInput, false)                                                                                                                         \
     X(bool, UseAtlasEngine, false)
@@ -55,6 +55,7 @@ public:
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
     bool IsWin32InputModeEnabled() const;
+    bool IsPassthroughModeEnabled() const;
 
 #ifdef UNIT_TESTING
     void EnableConptyModeForTests();
@@ -74,6 +75,7 @@ public:
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
     static const std::wstring_view WIN32_INPUT_MODE;
+    static const std::wstring_view PASSTHROUGH_MODE;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
     static const std::wstring_view COM_SERVER_ARG;
@@ -140,6 +142,7 @@ private:
     bool _inheritCursor;
     bool _resizeQuirk{ false };
     bool _win32InputMode{ false };
+    bool _passthroughMode{ false };
 
     [[nodiscard]] HRESULT _GetClientCommandline(_Inout_ std::vector<std::wstring>& args,
                                                 const size_t index,
@@ -8,6 +8,7 @@
 #include "output.h"
 #include "handle.h"
 #include "../interactivity/inc/ServiceLocator.hpp"
+#include "../server/ApiSorter.h"
 #include "../terminal/adapter/DispatchCommon.hpp"
 
 using namespace Microsoft::Console;
@@ -120,6 +121,13 @@ void PtySignalInputThread::ConnectConsole() noexcept
 
             break;
         }
+        case PtySignal::DumpApiStatistics:
+        {
+            // The statistics are read without the console lock, so that
+            // dumping them doesn't show up in the lock wait times.
+            ApiSorter::TraceStatistics();
+            break;
+        }
         default:
         {
             THROW_HR(E_UNEXPECTED);
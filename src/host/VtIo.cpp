@@ -9,6 +9,7 @@
 #include "../renderer/vt/Xterm256Engine.hpp"
 
 #include "../renderer/base/renderer.hpp"
+#include "../terminal/parser/OutputStateMachineEngine.hpp"
 #include "../types/inc/utils.hpp"
 #include "input.h" // ProcessCtrlEvents
 #include "output.h" // CloseConsoleProcessState
@@ -70,6 +71,7 @@ VtIo::VtIo() :
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
+    _passthroughMode = pArgs->IsPassthroughModeEnabled();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -438,6 +440,18 @@ void VtIo::EnableConptyModeForTests(std::unique_ptr<Microsoft::Console::Render::
     _objectsCreated = true;
     _pVtRenderEngine = std::move(vtRenderEngine);
 }
+
+// Method Description:
+// - This is a test helper method. It can be used to turn passthrough mode on
+//   or off, as if we were started with (or without) the `--passthrough` flag.
+// Arguments:
+// - passthroughMode: true to pass VT output through to the terminal
+// Return Value:
+// - <none>
+void VtIo::SetPassthroughModeForTests(const bool passthroughMode)
+{
+    _passthroughMode = passthroughMode;
+}
 #endif
 
 // Method Description:
@@ -456,6 +470,83 @@ bool VtIo::IsResizeQuirkEnabled() const
     return _resizeQuirk;
 }
 
+// Method Description:
+// - Returns true if the VT that's written to the given buffer can be passed
+//   through to the terminal as it is. This requires the `--passthrough` flag,
+//   and a buffer whose output the terminal would treat just like we do: it
+//   has to be the one that's shown, it mustn't turn LFs into CRLFs, it has to
+//   wrap at the end of the line, and the legacy VT attribute quirk can't be
+//   engaged.
+// Arguments:
+// - screenInfo: the buffer that's written to.
+// Return Value:
+// - true iff the output can be written with WritePassthrough.
+bool VtIo::IsPassthroughPossible(const SCREEN_INFORMATION& screenInfo) const
+{
+    return _passthroughMode &&
+           _pVtRenderEngine &&
+           screenInfo.IsActiveScreenBuffer() &&
+           WI_IsFlagSet(screenInfo.OutputMode, DISABLE_NEWLINE_AUTO_RETURN) &&
+           WI_IsFlagSet(screenInfo.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT) &&
+           !screenInfo.IsIgnoringLegacyEquivalentVTAttributes();
+}
+
+// Method Description:
+// - Processes the given VT into the buffer, and passes it through to the
+//   terminal as it is, instead of painting the changes it made to the buffer.
+//   This saves us from turning the buffer contents back into VT, which is
+//   where most of the time goes when a client writes a lot of VT.
+// - Requests that we answer ourselves, like DSR, are held back from the
+//   terminal. Everything that's still waiting to be painted is painted first,
+//   so that the terminal receives it before the new output.
+// - Must be called while the console is locked, and only if
+//   IsPassthroughPossible returned true.
+// Arguments:
+// - screenInfo: the buffer that's written to.
+// - str: the VT to process.
+// Return Value:
+// - S_OK if we wrote the output successfully, otherwise an appropriate HRESULT
+[[nodiscard]] HRESULT VtIo::WritePassthrough(SCREEN_INFORMATION& screenInfo, const std::wstring_view str)
+try
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    LOG_IF_FAILED(g.pRender->PaintFrame());
+
+    // The engine can be gone if painting found the pipe broken.
+    if (!_pVtRenderEngine)
+    {
+        screenInfo.GetStateMachine().ProcessString(str);
+        return S_OK;
+    }
+
+    auto& machine = screenInfo.GetStateMachine();
+    auto& engine = screenInfo.GetOutputStateMachineEngine();
+
+    RETURN_IF_FAILED(_pVtRenderEngine->BeginPassthrough());
+    engine.SetPassthroughMode(true);
+    auto endPassthrough = wil::scope_exit([&]() {
+        engine.SetPassthroughMode(false);
+
+        // The viewport might have moved with the output. The renderer needs
+        // to know that before the next frame, or it would scroll the terminal
+        // a second time.
+        g.pRender->TriggerScroll();
+
+        // The output can switch to or from the alternate buffer.
+        const auto& activeBuffer = g.getConsoleInformation().GetActiveOutputBuffer();
+        auto cursor = activeBuffer.GetTextBuffer().GetCursor().GetPosition();
+        activeBuffer.GetViewport().ConvertToOrigin(&cursor);
+        if (_pVtRenderEngine)
+        {
+            LOG_IF_FAILED(_pVtRenderEngine->EndPassthrough(cursor, activeBuffer.GetAttributes()));
+        }
+    });
+
+    machine.ProcessString(str);
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Method Description:
 // - Manually tell the renderer that it should emit a "Erase Scrollback"
 //   sequence to the connected terminal. We need to do this in certain cases
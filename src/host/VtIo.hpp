@@ -10,6 +10,7 @@
 #include "PtySignalInputThread.hpp"
 
 class ConsoleArguments;
+class SCREEN_INFORMATION;
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -41,9 +42,13 @@ namespace Microsoft::Console::VirtualTerminal
 
 #ifdef UNIT_TESTING
         void EnableConptyModeForTests(std::unique_ptr<Microsoft::Console::Render::VtEngine> vtRenderEngine);
+        void SetPassthroughModeForTests(const bool passthroughMode);
 #endif
 
         bool IsResizeQuirkEnabled() const;
+        bool IsPassthroughPossible(const SCREEN_INFORMATION& screenInfo) const;
+
+        [[nodiscard]] HRESULT WritePassthrough(SCREEN_INFORMATION& screenInfo, const std::wstring_view str);
 
         [[nodiscard]] HRESULT ManuallyClearScrollback() const noexcept;
 
@@ -63,6 +68,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
+        bool _passthroughMode{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
@@ -302,6 +302,61 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
     return Status;
 }
 
+namespace
+{
+    struct PrintableRun
+    {
+        size_t length;
+        SHORT columns;
+        bool wideGlyphDoesNotFit;
+    };
+}
+
+// Routine Description:
+// - Measures the run of printable characters at the start of the given text, the
+//   way WriteCharsLegacy lays them out. It stops at the first control character,
+//   or once the run doesn't fit into the row or the batch anymore.
+// Arguments:
+// - text - The text to measure.
+// - fUnprocessed - If true, control characters are printed like any other character.
+// - columns - The number of columns left in the row.
+// - maxLength - The number of characters left in the batch.
+// Return Value:
+// - The length of the run and the columns it takes. wideGlyphDoesNotFit is set if the
+//   run ended at a wide glyph that has no room left, which also ends the batch.
+static PrintableRun _MeasurePrintableRun(const std::wstring_view text,
+                                         const bool fUnprocessed,
+                                         const SHORT columns,
+                                         const size_t maxLength) noexcept
+{
+    PrintableRun run{};
+    for (const auto wch : text)
+    {
+        if (run.length >= maxLength || run.columns >= columns || !(IS_GLYPH_CHAR(wch) || fUnprocessed))
+        {
+            break;
+        }
+
+        // Everything below U+0080 is narrow, so only the rest needs to be looked up.
+        // WCL-NOTE: This operates on a single code unit instead of a whole codepoint. It will mis-measure surrogate pairs.
+        if (wch >= 0x80 && IsGlyphFullWidth(wch))
+        {
+            if (run.length + 1 >= maxLength || run.columns + 1 >= columns)
+            {
+                run.wideGlyphDoesNotFit = true;
+                break;
+            }
+            run.columns += 2;
+        }
+        else
+        {
+            run.columns += 1;
+        }
+        run.length++;
+    }
+    return run;
+}
+
 // Routine Description:
 // - This routine writes a string to the screen, processing any embedded
 //   unicode characters.  The string is also copied to the input buffer, if
@@ -388,152 +443,169 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         XPosition = cursor.GetPosition().X;
         size_t i = 0;
         wchar_t* LocalBufPtr = LocalBuffer;
+        // If the batch starts with a run of printable characters, it's written straight
+        // from the input. It's only copied into LocalBuffer once something else is added.
+        const wchar_t* pwchDirect = nullptr;
         while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
+            // Printable characters make up most of the output, so they're measured a run
+            // at a time. Only the control characters in between are handled one by one.
+            const auto run = _MeasurePrintableRun({ lpString, (BufferSize - *pcb) / sizeof(WCHAR) },
+                                                  fUnprocessed,
+                                                  gsl::narrow_cast<SHORT>(coordScreenBufferSize.X - XPosition),
+                                                  LOCAL_BUFFER_SIZE - i);
+            if (run.length != 0)
+            {
+                if (i == 0)
+                {
+                    pwchDirect = lpString;
+                }
+                else
+                {
+                    LocalBufPtr = std::copy_n(lpString, run.length, LocalBufPtr);
+                }
+
+                // WCL-NOTE: We believe RealUnicodeChar to be identical to Char, because we believe pwchRealUnicode
+                // WCL-NOTE: to be identical to lpString. They are incremented in lockstep, never separately, and lpString
+                // WCL-NOTE: is initialized from pwchRealUnicode.
+                lpString += run.length;
+                pwchRealUnicode += run.length;
+                pwchBuffer += run.length;
+                *pcb += run.length * sizeof(WCHAR);
+                XPosition += run.columns;
+                i += run.length;
+            }
+            if (run.wideGlyphDoesNotFit)
+            {
+                goto EndWhile;
+            }
+            if (run.length != 0)
+            {
+                continue;
+            }
+
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
             const wchar_t Char = *lpString;
-            // WCL-NOTE: We believe RealUnicodeChar to be identical to Char, because we believe pwchRealUnicode
-            // WCL-NOTE: to be identical to lpString. They are incremented in lockstep, never separately, and lpString
-            // WCL-NOTE: is initialized from pwchRealUnicode.
             const wchar_t RealUnicodeChar = *pwchRealUnicode;
-            if (IS_GLYPH_CHAR(RealUnicodeChar) || fUnprocessed)
+
+            // Backspaces, carriage returns and line feeds end the batch without adding to it.
+            // Anything else might, so the run it follows has to be copied first.
+            if (pwchDirect &&
+                RealUnicodeChar != UNICODE_BACKSPACE &&
+                RealUnicodeChar != UNICODE_CARRIAGERETURN &&
+                RealUnicodeChar != UNICODE_LINEFEED)
             {
-                // WCL-NOTE: This operates on a single code unit instead of a whole codepoint. It will mis-measure surrogate pairs.
-                if (IsGlyphFullWidth(Char))
-                {
-                    if (i < (LOCAL_BUFFER_SIZE - 1) && XPosition < (coordScreenBufferSize.X - 1))
-                    {
-                        *LocalBufPtr++ = Char;
+                LocalBufPtr = std::copy_n(pwchDirect, i, LocalBuffer);
+                pwchDirect = nullptr;
+            }
 
-                        // cursor adjusted by 2 because the char is double width
-                        XPosition += 2;
-                        i += 1;
-                        pwchBuffer++;
-                    }
-                    else
-                    {
-                        goto EndWhile;
-                    }
+            FAIL_FAST_IF(!(WI_IsFlagSet(screenInfo.OutputMode, ENABLE_PROCESSED_OUTPUT)));
+            switch (RealUnicodeChar)
+            {
+            case UNICODE_BELL:
+                if (dwFlags & WC_PRINTABLE_CONTROL_CHARS)
+                {
+                    goto CtrlChar;
                 }
                 else
                 {
-                    *LocalBufPtr = Char;
-                    LocalBufPtr++;
-                    XPosition++;
-                    i++;
-                    pwchBuffer++;
+                    screenInfo.SendNotifyBeep();
                 }
-            }
-            else
+                break;
+            case UNICODE_BACKSPACE:
+
+                // automatically go to EndWhile.  this is because
+                // backspace is not destructive, so "aBkSp" prints
+                // a with the cursor on the "a". we could achieve
+                // this behavior staying in this loop and figuring out
+                // the string that needs to be printed, but it would
+                // be expensive and it's the exceptional case.
+
+                goto EndWhile;
+                break;
+            case UNICODE_TAB:
             {
-                FAIL_FAST_IF(!(WI_IsFlagSet(screenInfo.OutputMode, ENABLE_PROCESSED_OUTPUT)));
-                switch (RealUnicodeChar)
+                const ULONG TabSize = NUMBER_OF_SPACES_IN_TAB(XPosition);
+                XPosition = (SHORT)(XPosition + TabSize);
+                if (XPosition >= coordScreenBufferSize.X)
                 {
-                case UNICODE_BELL:
-                    if (dwFlags & WC_PRINTABLE_CONTROL_CHARS)
-                    {
-                        goto CtrlChar;
-                    }
-                    else
-                    {
-                        screenInfo.SendNotifyBeep();
-                    }
-                    break;
-                case UNICODE_BACKSPACE:
+                    goto EndWhile;
+                }
 
-                    // automatically go to EndWhile.  this is because
-                    // backspace is not destructive, so "aBkSp" prints
-                    // a with the cursor on the "a". we could achieve
-                    // this behavior staying in this loop and figuring out
-                    // the string that needs to be printed, but it would
-                    // be expensive and it's the exceptional case.
+                for (ULONG j = 0; j < TabSize && i < LOCAL_BUFFER_SIZE; j++, i++)
+                {
+                    *LocalBufPtr = UNICODE_SPACE;
+                    LocalBufPtr++;
+                }
 
-                    goto EndWhile;
-                    break;
-                case UNICODE_TAB:
+                pwchBuffer++;
+                break;
+            }
+            case UNICODE_LINEFEED:
+            case UNICODE_CARRIAGERETURN:
+                goto EndWhile;
+            default:
+
+                // if char is ctrl char, write ^char.
+                if ((dwFlags & WC_PRINTABLE_CONTROL_CHARS) && (IS_CONTROL_CHAR(RealUnicodeChar)))
                 {
-                    const ULONG TabSize = NUMBER_OF_SPACES_IN_TAB(XPosition);
-                    XPosition = (SHORT)(XPosition + TabSize);
-                    if (XPosition >= coordScreenBufferSize.X)
+                CtrlChar:
+                    if (i < (LOCAL_BUFFER_SIZE - 1))
                     {
-                        goto EndWhile;
-                    }
+                        // WCL-NOTE: We do not properly measure that there is space for two characters
+                        // WCL-NOTE: left on the screen.
+                        *LocalBufPtr = (WCHAR)'^';
+                        LocalBufPtr++;
+                        XPosition++;
+                        i++;
 
-                    for (ULONG j = 0; j < TabSize && i < LOCAL_BUFFER_SIZE; j++, i++)
-                    {
-                        *LocalBufPtr = UNICODE_SPACE;
+                        *LocalBufPtr = (WCHAR)(RealUnicodeChar + (WCHAR)'@');
                         LocalBufPtr++;
-                    }
+                        XPosition++;
+                        i++;
 
-                    pwchBuffer++;
-                    break;
+                        pwchBuffer++;
+                    }
+                    else
+                    {
+                        goto EndWhile;
+                    }
                 }
-                case UNICODE_LINEFEED:
-                case UNICODE_CARRIAGERETURN:
-                    goto EndWhile;
-                default:
-
-                    // if char is ctrl char, write ^char.
-                    if ((dwFlags & WC_PRINTABLE_CONTROL_CHARS) && (IS_CONTROL_CHAR(RealUnicodeChar)))
+                else
+                {
+                    if (Char == UNICODE_NULL)
                     {
-                    CtrlChar:
-                        if (i < (LOCAL_BUFFER_SIZE - 1))
-                        {
-                            // WCL-NOTE: We do not properly measure that there is space for two characters
-                            // WCL-NOTE: left on the screen.
-                            *LocalBufPtr = (WCHAR)'^';
-                            LocalBufPtr++;
-                            XPosition++;
-                            i++;
-
-                            *LocalBufPtr = (WCHAR)(RealUnicodeChar + (WCHAR)'@');
-                            LocalBufPtr++;
-                            XPosition++;
-                            i++;
-
-                            pwchBuffer++;
-                        }
-                        else
-                        {
-                            goto EndWhile;
-                        }
+                        *LocalBufPtr = UNICODE_SPACE;
                     }
                     else
                     {
-                        if (Char == UNICODE_NULL)
+                        // As a special favor to incompetent apps that attempt to display control chars,
+                        // convert to corresponding OEM Glyph Chars
+                        WORD CharType;
+
+                        GetStringTypeW(CT_CTYPE1, &RealUnicodeChar, 1, &CharType);
+                        if (WI_IsFlagSet(CharType, C1_CNTRL))
                         {
-                            *LocalBufPtr = UNICODE_SPACE;
+                            ConvertOutputToUnicode(gci.OutputCP,
+                                                   (LPSTR)&RealUnicodeChar,
+                                                   1,
+                                                   LocalBufPtr,
+                                                   1);
                         }
                         else
                         {
-                            // As a special favor to incompetent apps that attempt to display control chars,
-                            // convert to corresponding OEM Glyph Chars
-                            WORD CharType;
-
-                            GetStringTypeW(CT_CTYPE1, &RealUnicodeChar, 1, &CharType);
-                            if (WI_IsFlagSet(CharType, C1_CNTRL))
-                            {
-                                ConvertOutputToUnicode(gci.OutputCP,
-                                                       (LPSTR)&RealUnicodeChar,
-                                                       1,
-                                                       LocalBufPtr,
-                                                       1);
-                            }
-                            else
-                            {
-                                // WCL-NOTE: We should never hit this.
-                                // WCL-NOTE: 1. Normal characters are handled via the early check for IS_GLYPH_CHAR
-                                // WCL-NOTE: 2. Control characters are handled via the CtrlChar label (if WC_PRINTABLE_CONTROL_CHARS is on)
-                                // WCL-NOTE:    And if they are control characters they will trigger the C1_CNTRL check above.
-                                *LocalBufPtr = Char;
-                            }
+                            // WCL-NOTE: We should never hit this.
+                            // WCL-NOTE: 1. Normal characters are handled via the early check for IS_GLYPH_CHAR
+                            // WCL-NOTE: 2. Control characters are handled via the CtrlChar label (if WC_PRINTABLE_CONTROL_CHARS is on)
+                            // WCL-NOTE:    And if they are control characters they will trigger the C1_CNTRL check above.
+                            *LocalBufPtr = Char;
                         }
-
-                        LocalBufPtr++;
-                        XPosition++;
-                        i++;
-                        pwchBuffer++;
                     }
+
+                    LocalBufPtr++;
+                    XPosition++;
+                    i++;
+                    pwchBuffer++;
                 }
             }
             lpString++;
@@ -553,8 +625,8 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
-            const auto itEnd = screenInfo.Write(it);
+            // Scrolling is handled by AdjustCursorPosition below, so the buffer mustn't circle on its own.
+            const auto written = textBuffer.WriteStream(std::wstring_view(pwchDirect ? pwchDirect : LocalBuffer, i), Attributes, CursorPosition, false);
 
             // Notify accessibility
             if (screenInfo.HasAccessibilityEventing())
@@ -564,7 +636,7 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
             // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
             // when/if we need to erase the command line.
-            TempNumSpaces += itEnd.GetCellDistance(it);
+            TempNumSpaces += written.cellsWritten;
             // WCL-NOTE: We are using the "estimated" X position delta instead of the actual delta from
             // WCL-NOTE: the iterator. It is not clear why. If they differ, the cursor ends up in the
             // WCL-NOTE: wrong place (typically inside another character).
@@ -971,8 +1043,19 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
+                const std::wstring_view str{ pwchRealUnicode, cch };
 
-                machine.ProcessString({ pwchRealUnicode, cch });
+                // In conpty passthrough mode, the VT goes to the terminal as it
+                // is, instead of being painted again from the buffer.
+                CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                if (gci.IsInVtIoMode() && gci.GetVtIo()->IsPassthroughPossible(screenInfo))
+                {
+                    Status = NTSTATUS_FROM_HRESULT(gci.GetVtIo()->WritePassthrough(screenInfo, str));
+                }
+                else
+                {
+                    machine.ProcessString(str);
+                }
                 *pcb += BufferSize;
             }
         }
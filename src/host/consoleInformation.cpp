@@ -9,6 +9,7 @@
 #include "srvinit.h"
 
 #include "../interactivity/inc/ServiceLocator.hpp"
+#include "../server/ApiStatistics.h"
 #include "../types/inc/convert.hpp"
 
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -62,7 +63,14 @@ bool CONSOLE_INFORMATION::IsConsoleLocked() const
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
-    EnterCriticalSection(&_csConsoleLock);
+    // Only take the timestamps if we actually have to wait for the lock. On the IO thread, the
+    // time we waited is charged to the API call it's servicing, see ApiSorter::ConsoleDispatchRequest.
+    if (!TryEnterCriticalSection(&_csConsoleLock))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        EnterCriticalSection(&_csConsoleLock);
+        ApiStatistics::s_AddLockWait(std::chrono::steady_clock::now() - start);
+    }
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
@@ -461,6 +461,40 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
 }
 
+// Routine Description:
+// - Writes records to the input buffer as they are, without turning each
+// of them into an IInputEvent first (private call)
+// Arguments:
+// - pInputBuffer - the input buffer to write to
+// - records - the records to write
+// - eventsWritten - on output, the number of events written
+// - append - true if events should be written to the end of the input
+// buffer, false if they should be written to the front
+// Return Value:
+// - HRESULT indicating success or failure
+[[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
+                                                     const gsl::span<const INPUT_RECORD> records,
+                                                     _Out_ size_t& eventsWritten,
+                                                     const bool append) noexcept
+{
+    try
+    {
+        eventsWritten = 0;
+
+        if (append)
+        {
+            eventsWritten = pInputBuffer->Write(records);
+        }
+        else
+        {
+            eventsWritten = pInputBuffer->Prepend(records);
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
 // Routine Description:
 // - Writes events to the input buffer, translating from codepage to unicode first
 // Arguments:
@@ -525,13 +559,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     LockConsole();
     auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-    try
-    {
-        auto events = IInputEvent::Create(buffer);
-
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
-    }
-    CATCH_RETURN();
+    return DoSrvPrivateWriteConsoleInputW(&context, buffer, written, append);
 }
 
 // Function Description:
@@ -214,10 +214,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.erase_if([](const INPUT_RECORD& record) noexcept {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ ITerminalOutputConnection* const pTtyConnection)
@@ -276,10 +275,10 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
+        std::vector<INPUT_RECORD> records(std::min(AmountToRead, _storage.size()));
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(records,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -288,10 +287,9 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
                     Stream);
 
         // copy events to outEvents
-        while (!events.empty())
+        for (size_t i = 0; i < eventsRead; ++i)
         {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
+            OutEvents.push_back(IInputEvent::Create(til::at(records, i)));
         }
 
         if (resetWaitEvent)
@@ -306,6 +304,63 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     }
 }
 
+// Routine Description:
+// - This routine reads from the input buffer into the given records, without
+//   turning them into IInputEvents. Otherwise it's the same as the above.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - records - where to store the read records. Its size is the amount of records to try to read.
+// - recordsRead - on exit, the number of records stored in records
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. records must hold a single record if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> records,
+                                         _Out_ size_t& recordsRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    recordsRead = 0;
+    try
+    {
+        if (_storage.empty())
+        {
+            if (!WaitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        // read from buffer
+        bool resetWaitEvent;
+        _ReadBuffer(records,
+                    records.size(),
+                    recordsRead,
+                    Peek,
+                    resetWaitEvent,
+                    Unicode,
+                    Stream);
+
+        if (resetWaitEvent)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads a single event from the input buffer.
 // - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
@@ -354,7 +409,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are placed. Must hold the lesser of readCount and the number of stored events.
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -365,7 +420,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -379,95 +434,58 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 
     resetWaitEvent = false;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
+    size_t recordsRead = 0;
+    bool splitKeyEvent = false;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (recordsRead < _storage.size() && recordsRead < outRecords.size() && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
-        // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
-        {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
-            {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
-            }
-        }
-
-        if (performNormalRead)
+        auto& record = til::at(outRecords, recordsRead);
+        record = _storage[recordsRead];
+        ++recordsRead;
+
+        // for stream reads we need to split any key events that have been coalesced.
+        // The remaining repeats stay in the buffer.
+        if (streamRead &&
+            record.EventType == KEY_EVENT &&
+            record.Event.KeyEvent.wRepeatCount > 1)
         {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
+            record.Event.KeyEvent.wRepeatCount = 1;
+            splitKeyEvent = true;
         }
 
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            if (record.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(record.Event.KeyEvent.uChar.UnicodeChar))
             {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
+                ++virtualReadCount;
             }
         }
     }
 
     // the amount of events that were actually read
-    eventsRead = readEvents.size();
+    eventsRead = recordsRead;
 
-    // copy the events back if we were supposed to peek
-    if (peek)
+    // leave the events in the buffer if we were supposed to peek
+    if (!peek)
     {
-        if (streamRead)
+        if (splitKeyEvent)
         {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
+            // stream reads only ever read the first record
+            --_storage.front().Event.KeyEvent.wRepeatCount;
         }
         else
         {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
-            {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
-            }
+            _storage.pop_front(recordsRead);
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
-    {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
-    }
-
     // signal if we emptied the buffer
     if (_storage.empty())
     {
@@ -479,19 +497,41 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
 // - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
 // Return Value:
-// S_OK if successful.
+// - The number of events written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = _ToInputRecords(inEvents);
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of records written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -500,18 +540,19 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingStorage(_storage.size());
+        _storage.copy_to(existingStorage);
+        _storage.clear();
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we emptied the storage, it will always return true after the first one
+        // (as it is filling the newly emptied buffer.)
         // Then after the second one, because we've inserted some input, it will always say false.
         bool unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
@@ -524,7 +565,7 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // Because we did interesting manipulation of the wait queue
         // in order to prepend, we can't trust what _WriteBuffer said
         // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
+        // buffer (the one we copied out at the top) was empty
         // when this whole thing started.
         if (existingStorage.empty())
         {
@@ -556,9 +597,8 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto record = inEvent->ToInputRecord();
+        return Write({ &record, 1 });
     }
     catch (...)
     {
@@ -571,19 +611,43 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 // - Writes events to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inEvents - input events to store in the buffer. Empty on exit.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = _ToInputRecords(inEvents);
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of records that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
         {
             return 0;
         }
@@ -591,7 +655,7 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -610,9 +674,29 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Converts events into the records they're stored as.
+// Arguments:
+// - inEvents - The events to convert. Empty on exit.
+// Return Value:
+// - The records.
+// Note:
+// - will throw on failure
+std::vector<INPUT_RECORD> InputBuffer::_ToInputRecords(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    std::vector<INPUT_RECORD> records;
+    records.reserve(inEvents.size());
+    for (const auto& inEvent : inEvents)
+    {
+        records.push_back(inEvent->ToInputRecord());
+    }
+    inEvents.clear();
+    return records;
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
 // Arguments:
-// - inRecords - The events to store.
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -621,77 +705,59 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    if (!vtInputMode && inRecords.size() > 1)
     {
-        // Pop the next event.
-        // If we're in vt mode, try and handle it with the vt input module.
-        // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
-        // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        // Nothing needs to look at the records one at a time,
+        // so they can be copied into the buffer all at once.
+        _storage.append(inRecords);
+        eventsWritten = inRecords.size();
+    }
+    else
+    {
+        for (const auto& record : inRecords)
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            // If we're in vt mode, try and handle it with the vt input module.
+            // If it was handled, do nothing else for it.
+            if (vtInputMode && record.EventType == KEY_EVENT)
             {
-                eventsWritten++;
-                continue;
+                const KeyEvent keyEvent{ record.Event.KeyEvent };
+                if (_termInput.HandleKey(&keyEvent))
+                {
+                    ++eventsWritten;
+                    continue;
+                }
             }
-        }
-
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
-        {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
 
-            bool coalesced = false;
+            // we only check for possible coalescing when storing one
+            // record at a time because this is the original behavior of
+            // the input buffer. Changing this behavior may break stuff
+            // that was depending on it.
+            //
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
+            if (inRecords.size() == 1 &&
+                !_storage.empty() &&
+                (_CoalesceMouseMovedEvents(record) || _CoalesceRepeatedKeyPressEvents(record)))
             {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
+                ++eventsWritten;
+                continue;
             }
+
+            // At this point, the event was neither coalesced, nor processed by VT.
+            _storage.push_back(record);
+            ++eventsWritten;
         }
-        // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
-        ++eventsWritten;
     }
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -699,42 +765,33 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved record and the incoming record are
+// both MOUSE_MOVED events. If they are, the last saved record is
+// updated with the new mouse position.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastRecord.EventType == MOUSE_EVENT)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
+        const MouseEvent inMouseEvent{ inRecord.Event.MouseEvent };
+        const MouseEvent lastMouseEvent{ lastRecord.Event.MouseEvent };
 
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
+        if (inMouseEvent.IsMouseMoveEvent() &&
+            lastMouseEvent.IsMouseMoveEvent())
         {
             // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastRecord.Event.MouseEvent.dwMousePosition = inMouseEvent.GetPosition();
             return true;
         }
     }
@@ -767,44 +824,36 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input record saved and the incoming record are both a
+// keypress down event for the same key, update the repeat count of the
+// saved record.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastRecord.EventType == KEY_EVENT)
+    {
+        const KeyEvent inKeyEvent{ inRecord.Event.KeyEvent };
+        const KeyEvent lastKeyEvent{ lastRecord.Event.KeyEvent };
+
+        if (inKeyEvent.IsKeyDown() &&
+            lastKeyEvent.IsKeyDown() &&
+            !IsGlyphFullWidth(inKeyEvent.GetCharData()) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            const WORD repeatCount = lastKeyEvent.GetRepeatCount() + inKeyEvent.GetRepeatCount();
+            lastRecord.Event.KeyEvent.wRepeatCount = repeatCount;
             return true;
         }
     }
@@ -814,42 +863,68 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - outRecords - receives the remaining records, if any had to be removed
 // Return Value:
-// - None
+// - The records that remain. This is inRecords itself if there was nothing
+//   to remove, which is the usual case, and outRecords otherwise.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+gsl::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                          std::vector<INPUT_RECORD>& outRecords)
 {
-    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    size_t i = 0;
+    while (i < inRecords.size() && !_HandleConsoleSuspensionEvent(til::at(inRecords, i)))
+    {
+        ++i;
+    }
+    if (i == inRecords.size())
+    {
+        return inRecords;
+    }
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    outRecords.assign(inRecords.begin(), inRecords.begin() + i);
+    for (++i; i < inRecords.size(); ++i)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        const auto& record = til::at(inRecords, i);
+        if (!_HandleConsoleSuspensionEvent(record))
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
-            {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
-            }
+            outRecords.push_back(record);
         }
-        outEvents.push_back(std::move(currEvent));
     }
-    inEvents.swap(outEvents);
+    return outRecords;
+}
+
+// Routine Description:
+// - Suspends or resumes the console if the record asks for it.
+// Arguments:
+// - record - record to check for a pause/unpause event
+// Return Value:
+// - true if the record was a pause/unpause event and mustn't be stored.
+// Note:
+// - The console lock must be held when calling this routine.
+bool InputBuffer::_HandleConsoleSuspensionEvent(const INPUT_RECORD& record)
+{
+    if (record.EventType != KEY_EVENT || !record.Event.KeyEvent.bKeyDown)
+    {
+        return false;
+    }
+
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const KeyEvent keyEvent{ record.Event.KeyEvent };
+    if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+        !IsSystemKey(keyEvent.GetVirtualKeyCode()))
+    {
+        UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+        return true;
+    }
+    else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && keyEvent.IsPauseKey())
+    {
+        WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+        return true;
+    }
+    return false;
 }
 
 // Routine Description:
@@ -875,12 +950,11 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        for (const auto& inEvent : inEvents)
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.push_back(inEvent->ToInputRecord());
         }
+        inEvents.clear();
 
         if (!_vtInputShouldSuppress)
         {
@@ -19,6 +19,7 @@ Revision History:
 #pragma once
 
 #include "inputReadHandleData.h"
+#include "inputRecordQueue.hpp"
 #include "readData.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
@@ -64,6 +65,13 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(const gsl::span<INPUT_RECORD> records,
+                                _Out_ size_t& recordsRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     [[nodiscard]] NTSTATUS Read(_Out_ std::unique_ptr<IInputEvent>& inEvent,
                                 const bool Peek,
                                 const bool WaitForData,
@@ -71,9 +79,11 @@ public:
                                 const bool Stream);
 
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
@@ -81,7 +91,7 @@ public:
     void PassThroughWin32MouseRequest(bool enable);
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -93,7 +103,7 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    void _ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -101,14 +111,18 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
+    static std::vector<INPUT_RECORD> _ToInputRecords(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+
     bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    gsl::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                 std::vector<INPUT_RECORD>& outRecords);
+    bool _HandleConsoleSuspensionEvent(const INPUT_RECORD& record);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
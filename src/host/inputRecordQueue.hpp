@@ -0,0 +1,179 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordQueue.hpp
+
+Abstract:
+- A first-in-first-out queue of INPUT_RECORDs, used as the storage of the
+  InputBuffer. The records are stored by value in a single ring buffer, so
+  queueing an event doesn't allocate once the ring is large enough, and a
+  batch of records can be appended or read with a copy or two.
+- The ring's capacity is always a power of two. It grows as needed and is
+  released again once it's empty, if it grew beyond ShrinkThreshold, so that
+  a large paste doesn't pin its memory for the lifetime of the console.
+--*/
+
+#pragma once
+
+#include <memory>
+
+class InputRecordQueue final
+{
+public:
+    static constexpr size_t InitialCapacity = 64;
+    static constexpr size_t ShrinkThreshold = 4096;
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    INPUT_RECORD& operator[](const size_t index) noexcept
+    {
+        return _buffer[(_head + index) & (_capacity - 1)];
+    }
+
+    const INPUT_RECORD& operator[](const size_t index) const noexcept
+    {
+        return _buffer[(_head + index) & (_capacity - 1)];
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    const INPUT_RECORD& front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    const INPUT_RECORD& back() const noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    void push_back(const INPUT_RECORD& record)
+    {
+        _reserve(_size + 1);
+        (*this)[_size] = record;
+        ++_size;
+    }
+
+    void push_front(const INPUT_RECORD& record)
+    {
+        _reserve(_size + 1);
+        _head = (_head + _capacity - 1) & (_capacity - 1);
+        ++_size;
+        front() = record;
+    }
+
+    // Appends the records in at most two copies, one for each side of the
+    // point where the ring wraps around.
+    void append(const gsl::span<const INPUT_RECORD> records)
+    {
+        _reserve(_size + records.size());
+        const auto tail = (_head + _size) & (_capacity - 1);
+        const auto first = std::min(records.size(), _capacity - tail);
+        std::copy_n(records.data(), first, _buffer.get() + tail);
+        std::copy_n(records.data() + first, records.size() - first, _buffer.get());
+        _size += records.size();
+    }
+
+    // Copies the first records.size() records into the given span, which must
+    // not be larger than size(). They aren't removed, see pop_front.
+    void copy_to(const gsl::span<INPUT_RECORD> records) const noexcept
+    {
+        const auto first = std::min(records.size(), _capacity - _head);
+        std::copy_n(_buffer.get() + _head, first, records.data());
+        std::copy_n(_buffer.get(), records.size() - first, records.data() + first);
+    }
+
+    void pop_front(const size_t count = 1) noexcept
+    {
+        _head = (_head + count) & (_capacity - 1);
+        _size -= count;
+        if (_size == 0)
+        {
+            clear();
+        }
+    }
+
+    void clear() noexcept
+    {
+        _head = 0;
+        _size = 0;
+        if (_capacity > ShrinkThreshold)
+        {
+            _buffer.reset();
+            _capacity = 0;
+        }
+    }
+
+    // Removes every record that satisfies the predicate, keeping the order of
+    // the remaining ones.
+    template<typename Predicate>
+    void erase_if(Predicate&& predicate) noexcept(noexcept(predicate(std::declval<const INPUT_RECORD&>())))
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!predicate(record))
+            {
+                (*this)[kept] = record;
+                ++kept;
+            }
+        }
+        _size = kept;
+        if (_size == 0)
+        {
+            clear();
+        }
+    }
+
+private:
+    // Makes room for at least the given number of records. The records are
+    // moved to the start of the new ring, which also unwraps them.
+    void _reserve(const size_t count)
+    {
+        if (count <= _capacity)
+        {
+            return;
+        }
+
+        auto capacity = std::max(_capacity, InitialCapacity);
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+
+        auto buffer = std::make_unique<INPUT_RECORD[]>(capacity);
+        copy_to({ buffer.get(), _size });
+        _buffer = std::move(buffer);
+        _capacity = capacity;
+        _head = 0;
+    }
+
+    std::unique_ptr<INPUT_RECORD[]> _buffer;
+    size_t _capacity{ 0 };
+    size_t _head{ 0 };
+    size_t _size{ 0 };
+};
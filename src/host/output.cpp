@@ -92,24 +92,10 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
-    {
-        const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-
-        do
-        {
-            const auto data = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.Write(OutputCellIterator({ &data, 1 }), targetPos);
-
-            source.WalkInBounds(sourcePos, walkDirection);
-        } while (target.WalkInBounds(targetPos, walkDirection));
-    }
+    // 2. Any other scenario is copied in place, a run of cells per row. The buffer picks the
+    //    order in which the rows are copied, so that it doesn't accidentally erase the source
+    //    material before it can be copied/moved to the new location.
+    screenInfo.GetTextBuffer().CopyRectangle(source, targetOrigin);
 }
 
 // Routine Description:
@@ -382,13 +368,15 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
 
     // Determine the cell we will use to fill in any revealed/uncovered space.
     // We generally use exactly what was given to us.
-    OutputCellIterator fillData(fillCharGiven, fillAttrsGiven);
+    auto fillChar = fillCharGiven;
+    auto fillAttrs = fillAttrsGiven;
 
     // However, if the character is null and we were given a null attribute (represented as legacy 0),
     // then we'll just fill with spaces and whatever the buffer's default colors are.
     if (fillCharGiven == UNICODE_NULL && fillAttrsGiven == TextAttribute{ 0 })
     {
-        fillData = OutputCellIterator(UNICODE_SPACE, screenInfo.GetAttributes());
+        fillChar = UNICODE_SPACE;
+        fillAttrs = screenInfo.GetAttributes();
     }
 
     // ------ 4. PREP TARGET ------
@@ -450,7 +438,17 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
     for (size_t i = 0; i < remaining.size(); i++)
     {
         const auto& view = remaining.at(i);
-        screenInfo.WriteRect(fillData, view);
+
+        // A narrow fill character, which is what's used in practice, can be filled in
+        // a run per row. Wide ones still go through the cell writer, which lays them out.
+        if (IsGlyphFullWidth(fillChar))
+        {
+            screenInfo.WriteRect(OutputCellIterator(fillChar, fillAttrs), view);
+        }
+        else
+        {
+            screenInfo.GetTextBuffer().FillRectangle(view, fillChar, fillAttrs);
+        }
 
         // If we're scrolling an area that encompasses the full buffer width,
         // then the filled rows should also have their line rendition reset.
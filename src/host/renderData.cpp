@@ -353,6 +353,11 @@ const std::vector<size_t> RenderData::GetPatternId(const COORD /*location*/) con
     return {};
 }
 
+const std::vector<Microsoft::Console::Render::PatternIdRun> RenderData::GetPatternIdRuns(const COORD /*location*/, const SHORT /*length*/) const noexcept
+{
+    return {};
+}
+
 // Routine Description:
 // - Converts a text attribute into the RGB values that should be presented, applying
 //   relevant table translation information and preferences.
@@ -60,6 +60,7 @@ public:
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
 
     const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    const std::vector<Microsoft::Console::Render::PatternIdRun> GetPatternIdRuns(const COORD location, const SHORT length) const noexcept override;
 #pragma endregion
 
 #pragma region IUiaData
@@ -47,6 +47,7 @@ SCREEN_INFORMATION::SCREEN_INFORMATION(
     _pConsoleWindowMetrics{ pMetrics },
     _pAccessibilityNotifier{ pNotifier },
     _stateMachine{ nullptr },
+    _outputStateMachineEngine{ nullptr },
     _scrollMargins{ Viewport::FromCoord({ 0 }) },
     _viewport(Viewport::Empty()),
     _psiAlternateBuffer{ nullptr },
@@ -181,6 +182,11 @@ StateMachine& SCREEN_INFORMATION::GetStateMachine()
     return *_stateMachine;
 }
 
+OutputStateMachineEngine& SCREEN_INFORMATION::GetOutputStateMachineEngine()
+{
+    return *_outputStateMachineEngine;
+}
+
 // Routine Description:
 // - This routine inserts the screen buffer pointer into the console's list of screen buffers.
 // Arguments:
@@ -258,10 +264,12 @@ void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
         auto defaults = std::make_unique<WriteBuffer>(*this);
         auto adapter = std::make_unique<AdaptDispatch>(std::move(getset), std::move(defaults));
         auto engine = std::make_unique<OutputStateMachineEngine>(std::move(adapter));
+        auto* const outputEngine = engine.get();
         // Note that at this point in the setup, we haven't determined if we're
         //      in VtIo mode or not yet. We'll set the OutputStateMachine's
         //      TerminalConnection later, in VtIo::StartIfNeeded
         _stateMachine = std::make_shared<StateMachine>(std::move(engine));
+        _outputStateMachineEngine = outputEngine;
     }
     catch (...)
     {
@@ -285,6 +293,7 @@ void SCREEN_INFORMATION::_FreeOutputStateMachine()
         }
 
         _stateMachine.reset();
+        _outputStateMachineEngine = nullptr;
     }
 }
 #pragma endregion
@@ -1900,6 +1909,7 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 
         // Set up the new buffers references to our current state machine, dispatcher, getset, etc.
         createdBuffer->_stateMachine = _stateMachine;
+        createdBuffer->_outputStateMachineEngine = _outputStateMachineEngine;
     }
     return Status;
 }
@@ -2312,7 +2322,7 @@ void SCREEN_INFORMATION::SetViewport(const Viewport& newViewport,
 // - <none>
 void SCREEN_INFORMATION::SetTerminalConnection(_In_ ITerminalOutputConnection* const pTtyConnection)
 {
-    OutputStateMachineEngine& engine = reinterpret_cast<OutputStateMachineEngine&>(_stateMachine->Engine());
+    auto& engine = GetOutputStateMachineEngine();
     if (pTtyConnection)
     {
         engine.SetTerminalConnection(pTtyConnection,
@@ -2770,3 +2780,10 @@ void SCREEN_INFORMATION::ResetIgnoreLegacyEquivalentVTAttributes() noexcept
 {
     _ignoreLegacyEquivalentVTAttributes = false;
 }
+
+// Routine Description:
+// - Returns true if the legacy VT handling quirk is engaged; see TextAttribute::StripErroneousVT16VersionsOfLegacyDefaults
+bool SCREEN_INFORMATION::IsIgnoringLegacyEquivalentVTAttributes() const noexcept
+{
+    return _ignoreLegacyEquivalentVTAttributes;
+}
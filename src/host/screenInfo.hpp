@@ -185,6 +185,7 @@ public:
 
     const Microsoft::Console::VirtualTerminal::StateMachine& GetStateMachine() const;
     Microsoft::Console::VirtualTerminal::StateMachine& GetStateMachine();
+    Microsoft::Console::VirtualTerminal::OutputStateMachineEngine& GetOutputStateMachineEngine();
 
     void SetCursorInformation(const ULONG Size,
                               const bool Visible) noexcept;
@@ -239,6 +240,7 @@ public:
 
     void SetIgnoreLegacyEquivalentVTAttributes() noexcept;
     void ResetIgnoreLegacyEquivalentVTAttributes() noexcept;
+    bool IsIgnoringLegacyEquivalentVTAttributes() const noexcept;
 
 private:
     SCREEN_INFORMATION(_In_ Microsoft::Console::Interactivity::IWindowMetrics* pMetrics,
@@ -276,6 +278,9 @@ private:
     bool _IsInVTMode() const;
 
     std::shared_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _stateMachine;
+    // The engine of the _stateMachine, which owns it. Kept, so that we don't
+    // have to downcast the state machine's IStateMachineEngine.
+    Microsoft::Console::VirtualTerminal::OutputStateMachineEngine* _outputStateMachineEngine;
 
     Microsoft::Console::Types::Viewport _scrollMargins; //The margins of the VT specified scroll region. Left and Right are currently unused, but could be in the future.
 
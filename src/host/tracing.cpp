@@ -84,6 +84,32 @@ Tracing Tracing::s_TraceApiCall(const NTSTATUS& result, PCSTR traceName)
     // clang-format on
 }
 
+// Routine Description:
+// - Writes the aggregated timings of an API call type, see ApiSorter::TraceStatistics.
+// Arguments:
+// - traceName - The name of the API call to list in the trace details
+// - summary - The statistics of the calls to it so far
+// Return Value:
+// - <none>
+void Tracing::s_TraceApiStatistics(PCSTR traceName, const ApiStatistics::Summary& summary)
+{
+    TraceLoggingWrite(
+        g_hConhostV2EventTraceProvider,
+        "ApiStatistics",
+        TraceLoggingString(traceName, "ApiName"),
+        TraceLoggingUInt64(summary.calls, "Calls"),
+        TraceLoggingUInt64(summary.pendedCalls, "PendedCalls"),
+        TraceLoggingInt64(summary.totalTime.count(), "TotalNanoseconds"),
+        TraceLoggingInt64(summary.medianTime.count(), "MedianNanoseconds"),
+        TraceLoggingInt64(summary.p99Time.count(), "P99Nanoseconds"),
+        TraceLoggingInt64(summary.lockWaitTime.count(), "LockWaitNanoseconds"),
+        TraceLoggingUInt64(summary.bytesIn, "BytesIn"),
+        TraceLoggingUInt64(summary.bytesOut, "BytesOut"),
+        TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+        TraceLoggingKeyword(TIL_KEYWORD_TRACE),
+        TraceLoggingKeyword(TraceKeywords::API));
+}
+
 ULONG Tracing::s_ulDebugFlag = 0x0;
 
 void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_GETLARGESTWINDOWSIZE_MSG* const a)
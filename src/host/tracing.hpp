@@ -20,6 +20,7 @@ Author(s):
 #include <functional>
 
 #include "../types/inc/Viewport.hpp"
+#include "../server/ApiStatistics.h"
 
 #if DBG
 #define DBGCHARS(_params_)              \
@@ -41,6 +42,7 @@ public:
     ~Tracing();
 
     static Tracing s_TraceApiCall(const NTSTATUS& result, PCSTR traceName);
+    static void s_TraceApiStatistics(PCSTR traceName, const ApiStatistics::Summary& summary);
 
     static void s_TraceApi(const NTSTATUS status, const CONSOLE_GETLARGESTWINDOWSIZE_MSG* const a);
     static void s_TraceApi(const NTSTATUS status, const CONSOLE_SCREENBUFFERINFO_MSG* const a, const bool fSet);
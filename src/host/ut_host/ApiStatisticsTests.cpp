@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../server/ApiStatistics.h"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ApiStatisticsTests
+{
+    TEST_CLASS(ApiStatisticsTests);
+
+    TEST_METHOD(BucketsCoverEveryLatency)
+    {
+        Log::Comment(L"Every latency has to fall into the bucket whose bounds enclose it.");
+        for (const uint64_t nanoseconds : { 0ull, 1ull, 3ull, 4ull, 7ull, 8ull, 9ull, 1000ull, 1023ull, 1024ull, 123456789ull, 7516192767ull })
+        {
+            const auto index = ApiStatistics::s_BucketIndex(nanoseconds);
+            VERIFY_IS_LESS_THAN_OR_EQUAL(nanoseconds, ApiStatistics::s_BucketUpperBound(index));
+            if (index != 0)
+            {
+                VERIFY_IS_GREATER_THAN(nanoseconds, ApiStatistics::s_BucketUpperBound(index - 1));
+            }
+        }
+
+        Log::Comment(L"Latencies beyond the last bucket are clamped into it.");
+        VERIFY_ARE_EQUAL(ApiStatistics::BucketCount - 1, ApiStatistics::s_BucketIndex(7516192768ull));
+        VERIFY_ARE_EQUAL(ApiStatistics::BucketCount - 1, ApiStatistics::s_BucketIndex(UINT64_MAX));
+    }
+
+    TEST_METHOD(EmptyStatisticsSummarizeToZero)
+    {
+        ApiStatistics statistics;
+        const auto summary = statistics.Summarize();
+
+        VERIFY_ARE_EQUAL(0u, summary.calls);
+        VERIFY_ARE_EQUAL(0, summary.totalTime.count());
+        VERIFY_ARE_EQUAL(0, summary.medianTime.count());
+        VERIFY_ARE_EQUAL(0, summary.p99Time.count());
+    }
+
+    TEST_METHOD(SummaryHasTotalsAndPercentiles)
+    {
+        ApiStatistics statistics;
+        for (auto i = 0; i < 98; ++i)
+        {
+            statistics.Record(1us, 0ns, 10, 20, false);
+        }
+        statistics.Record(1ms, 200us, 10, 0, true);
+        statistics.Record(1ms, 0ns, 10, 20, false);
+
+        const auto summary = statistics.Summarize();
+        VERIFY_ARE_EQUAL(100u, summary.calls);
+        VERIFY_ARE_EQUAL(1u, summary.pendedCalls);
+        VERIFY_ARE_EQUAL(std::chrono::nanoseconds{ 98us + 2ms }.count(), summary.totalTime.count());
+        VERIFY_ARE_EQUAL(std::chrono::nanoseconds{ 200us }.count(), summary.lockWaitTime.count());
+        VERIFY_ARE_EQUAL(1000u, summary.bytesIn);
+        VERIFY_ARE_EQUAL(1980u, summary.bytesOut);
+
+        Log::Comment(L"The percentiles are the upper bounds of the buckets they fall into.");
+        const auto medianBound = ApiStatistics::s_BucketUpperBound(ApiStatistics::s_BucketIndex(1000));
+        const auto p99Bound = ApiStatistics::s_BucketUpperBound(ApiStatistics::s_BucketIndex(1000000));
+        VERIFY_ARE_EQUAL(medianBound, gsl::narrow_cast<uint64_t>(summary.medianTime.count()));
+        VERIFY_ARE_EQUAL(p99Bound, gsl::narrow_cast<uint64_t>(summary.p99Time.count()));
+        VERIFY_IS_LESS_THAN(p99Bound, 1250000u);
+    }
+
+    TEST_METHOD(LockWaitIsCountedPerThread)
+    {
+        const auto before = ApiStatistics::s_GetLockWait();
+        ApiStatistics::s_AddLockWait(5us);
+        VERIFY_ARE_EQUAL(std::chrono::nanoseconds{ 5us }.count(), (ApiStatistics::s_GetLockWait() - before).count());
+
+        std::chrono::nanoseconds otherThread{ -1 };
+        std::thread{ [&]() { otherThread = ApiStatistics::s_GetLockWait(); } }.join();
+        VERIFY_ARE_EQUAL(0, otherThread.count());
+    }
+};
@@ -80,22 +80,44 @@ class CodepointWidthDetectorTests
         CodepointWidthDetector widthDetector;
         widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
 
+        const auto& entry = widthDetector._fallbackCache.at(0x414 % CodepointWidthDetector::FallbackCacheSize);
+
         // Ensure fallback cache is empty.
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, entry.codepoint);
 
         // Lookup ambiguous width character.
         widthDetector.IsWide(ambiguous);
 
-        // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
-
-        // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
+        // Cache should hold it, and the cached item should match what we expect.
+        VERIFY_ARE_EQUAL(0x414u, entry.codepoint);
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), entry.isWide);
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, entry.codepoint);
+    }
+
+    TEST_METHOD(CanGetWidthsOfRuns)
+    {
+        CodepointWidthDetector widthDetector;
+
+        std::wstring text;
+        std::vector<CodepointWidth> expected;
+        for (const auto& data : testData)
+        {
+            text += std::get<1>(data);
+            expected.emplace_back(std::get<2>(data));
+        }
+
+        std::vector<CodepointWidth> widths(expected.size());
+        VERIFY_ARE_EQUAL(expected.size(), widthDetector.GetWidths(text, widths));
+        VERIFY_IS_TRUE(expected == widths);
+
+        Log::Comment(L"Measuring stops once there's no room for more widths.");
+        VERIFY_ARE_EQUAL(2u, widthDetector.GetWidths(text, gsl::make_span(widths).first(2)));
+
+        Log::Comment(L"A lone surrogate is measured on its own.");
+        const std::wstring loneSurrogate{ L"\xD83D" L"a" };
+        VERIFY_ARE_EQUAL(2u, widthDetector.GetWidths(loneSurrogate, widths));
     }
 };
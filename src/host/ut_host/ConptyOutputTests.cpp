@@ -10,6 +10,7 @@
 #include "../../renderer/vt/Xterm256Engine.hpp"
 #include "../../renderer/vt/XtermEngine.hpp"
 #include "../Settings.hpp"
+#include "../_stream.h"
 
 #include "CommonState.hpp"
 
@@ -121,6 +122,9 @@ class ConptyOutputTests
     TEST_METHOD(WriteAFewSimpleLines);
     TEST_METHOD(InvalidateUntilOneBeforeEnd);
     TEST_METHOD(SetConsoleTitleWithControlChars);
+    TEST_METHOD(DeferInvalidationsWhilePaintingSnapshot);
+    TEST_METHOD(OnlyPaintCellsThatChanged);
+    TEST_METHOD(PassthroughWritesVtUnmodified);
 
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
@@ -400,3 +404,123 @@ void ConptyOutputTests::SetConsoleTitleWithControlChars()
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
+
+void ConptyOutputTests::DeferInvalidationsWhilePaintingSnapshot()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Write some output while a frame is painted from a snapshot. The "
+        L"invalidations should be held back until the frame is done, and "
+        L"the output should be painted in the next frame."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+    VERIFY_IS_FALSE(renderer._paintingSnapshot);
+    VERIFY_IS_TRUE(renderer._deferredInvalidations.empty());
+
+    // Pretend the render thread is still busy painting the previous frame.
+    renderer._paintingSnapshot = true;
+
+    sm.ProcessString(L"Hello World");
+    VERIFY_IS_FALSE(renderer._deferredInvalidations.empty());
+
+    expectedOutput.push_back("Hello World");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    VERIFY_IS_FALSE(renderer._paintingSnapshot);
+    VERIFY_IS_TRUE(renderer._deferredInvalidations.empty());
+}
+
+void ConptyOutputTests::OnlyPaintCellsThatChanged()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Redraw a whole line, where only a single character changed, like a "
+        L"progress bar would. Only that character should be sent to the "
+        L"terminal, since it already shows the rest of the line."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    expectedOutput.push_back("Progress: 10%");
+    sm.ProcessString(L"Progress: 10%");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    sm.ProcessString(L"\r");
+    sm.ProcessString(L"Progress: 20%");
+
+    expectedOutput.push_back("\x1b[1;11H");
+    expectedOutput.push_back("2");
+    expectedOutput.push_back("\x1b[2C"); // Put the cursor back after the line.
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Redrawing the very same line shouldn't send anything.");
+    sm.ProcessString(L"\r");
+    sm.ProcessString(L"Progress: 20%");
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
+
+void ConptyOutputTests::PassthroughWritesVtUnmodified()
+{
+    Log::Comment(NoThrowString().Format(
+        L"In passthrough mode, VT written by the client should be sent to the "
+        L"terminal as it is, except for requests that we answer ourselves. "
+        L"The buffer should still be updated, and nothing should be painted "
+        L"from it afterwards."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+    auto& tb = si.GetTextBuffer();
+
+    _flushFirstFrame();
+
+    const auto originalOutputMode = si.OutputMode;
+    si.OutputMode = ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN;
+    gci.GetVtIo()->SetPassthroughModeForTests(true);
+    auto restore = wil::scope_exit([&]() {
+        gci.GetVtIo()->SetPassthroughModeForTests(false);
+        si.OutputMode = originalOutputMode;
+        gci.pInputBuffer->Flush();
+    });
+
+    expectedOutput.push_back("\x1b[31m");
+    expectedOutput.push_back("Hello");
+    expectedOutput.push_back("\r");
+    expectedOutput.push_back("\n");
+    expectedOutput.push_back("World");
+
+    // The DSR is answered by us, and mustn't reach the terminal.
+    std::unique_ptr<WriteData> waiter;
+    std::wstring seq = L"\x1b[31mHello\r\nWorld\x1b[6n";
+    size_t seqCb = 2 * seq.size();
+    VERIFY_SUCCEEDED(DoWriteConsole(&seq[0], &seqCb, si, false, waiter));
+
+    {
+        auto iter = tb.GetCellDataAt({ 0, 1 });
+        VERIFY_ARE_EQUAL(L"W", iter->Chars());
+        auto expectedAttr = TextAttribute{};
+        expectedAttr.SetIndexedForeground(TextColor::DARK_RED);
+        VERIFY_ARE_EQUAL(expectedAttr, iter->TextAttr());
+    }
+    VERIFY_ARE_EQUAL(COORD({ 5, 1 }), tb.GetCursor().GetPosition());
+
+    Log::Comment(L"The terminal already shows the output, so there's nothing to paint.");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Painted output continues where the passed through output left off.");
+    sm.ProcessString(L"!");
+    expectedOutput.push_back("!");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +98,86 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
+        }
+    }
+
+    TEST_METHOD(CanBulkInsertRecordsIntoInputBuffer)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            records.push_back(MakeKeyEvent(true, 1, static_cast<WORD>(L'a' + i), 0, static_cast<wchar_t>(L'a' + i), 0));
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.Write(records), RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(inputBuffer.Prepend({ records.data(), 1 }), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
+
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), records[0]);
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], records[i]);
+        }
+    }
+
+    TEST_METHOD(RecordQueueKeepsOrderAcrossWrapAround)
+    {
+        InputRecordQueue queue;
+        auto makeRecord = [](const size_t id) {
+            INPUT_RECORD record{};
+            record.EventType = MENU_EVENT;
+            record.Event.MenuEvent.dwCommandId = gsl::narrow<UINT>(id);
+            return record;
+        };
+        auto verifyOrder = [&](const size_t firstId) {
+            std::vector<INPUT_RECORD> copy(queue.size());
+            queue.copy_to(copy);
+            for (size_t i = 0; i < queue.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(queue[i], makeRecord(firstId + i));
+                VERIFY_ARE_EQUAL(copy[i], makeRecord(firstId + i));
+            }
+        };
+
+        // Move the head close to the end of the ring, so that the next
+        // records wrap around to its beginning.
+        for (size_t i = 0; i < 50; ++i)
+        {
+            queue.push_back(makeRecord(i));
+        }
+        queue.pop_front(40);
+        VERIFY_ARE_EQUAL(queue.capacity(), InputRecordQueue::InitialCapacity);
+
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 50; i < 80; ++i)
+        {
+            records.push_back(makeRecord(i));
+        }
+        queue.append(records);
+        queue.push_front(makeRecord(39));
+        VERIFY_ARE_EQUAL(queue.capacity(), InputRecordQueue::InitialCapacity);
+        VERIFY_ARE_EQUAL(queue.size(), 41u);
+        verifyOrder(39);
+
+        // Growing the ring has to unwrap the records.
+        records.clear();
+        for (size_t i = 80; i < 180; ++i)
+        {
+            records.push_back(makeRecord(i));
+        }
+        queue.append(records);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(queue.capacity(), 141u);
+        VERIFY_ARE_EQUAL(queue.size(), 141u);
+        verifyOrder(39);
+
+        queue.erase_if([](const INPUT_RECORD& record) {
+            return record.Event.MenuEvent.dwCommandId % 2 == 0;
+        });
+        VERIFY_ARE_EQUAL(queue.size(), 71u);
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(queue[i], makeRecord(39 + i * 2));
         }
     }
 
@@ -121,10 +200,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MouseEvent mouseEvent{ inputBuffer._storage.front().Event.MouseEvent };
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +240,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +299,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +317,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +460,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(RECORD_INSERT_COUNT);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +474,7 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +508,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(recordInsertCount);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +521,9 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +665,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +696,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +716,39 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(CanReadRecordsIntoSpan)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> inRecords;
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            inRecords.push_back(MakeKeyEvent(true, 1, static_cast<WORD>(L'A' + i), 0, static_cast<wchar_t>(L'A' + i), 0));
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.Write(inRecords), RECORD_INSERT_COUNT);
+
+        // peeking leaves the records in the buffer
+        std::array<INPUT_RECORD, 5> outRecords;
+        size_t recordsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, recordsRead, true, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, outRecords.size());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
+
+        // reading removes them
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, recordsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, outRecords.size());
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT - outRecords.size());
+        for (size_t i = 0; i < recordsRead; ++i)
+        {
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
+        }
+
+        // a stream read returns a single record
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read({ outRecords.data(), 1 }, recordsRead, false, false, true, true));
+        VERIFY_ARE_EQUAL(recordsRead, 1u);
+        VERIFY_ARE_EQUAL(outRecords[0], inRecords[outRecords.size()]);
+    }
 };
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../renderer/base/thread.hpp"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Render;
+
+// A renderer that only counts its frames. Painting a frame blocks for as long
+// as the test holds paintRelease reset, so that it can queue up requests.
+class FrameCountingRenderer final : public IRenderer
+{
+public:
+    FrameCountingRenderer() :
+        paintStarted{ wil::EventOptions::None },
+        paintRelease{ wil::EventOptions::ManualReset | wil::EventOptions::Signaled }
+    {
+    }
+
+    [[nodiscard]] HRESULT PaintFrame() override
+    {
+        ++frames;
+        paintStarted.SetEvent();
+        paintRelease.wait();
+        return S_OK;
+    }
+
+    void TriggerSystemRedraw(const RECT* const) override {}
+    void TriggerRedraw(const Microsoft::Console::Types::Viewport&) override {}
+    void TriggerRedraw(const COORD* const) override {}
+    void TriggerRedrawCursor(const COORD* const) override {}
+    void TriggerRedrawAll() override {}
+    void TriggerTeardown() noexcept override {}
+    void TriggerSelection() override {}
+    void TriggerScroll() override {}
+    void TriggerScroll(const COORD* const) override {}
+    void TriggerCircling() override {}
+    void TriggerTitleChange() override {}
+    void TriggerFontChange(const int, const FontInfoDesired&, FontInfo&) override {}
+    void UpdateSoftFont(const gsl::span<const uint16_t>, const SIZE, const size_t) override {}
+    [[nodiscard]] HRESULT GetProposedFont(const int, const FontInfoDesired&, FontInfo&) override { return S_OK; }
+    bool IsGlyphWideByFont(const std::wstring_view) override { return false; }
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD) override {}
+    void WaitUntilCanRender() override {}
+    void AddRenderEngine(IRenderEngine* const) override {}
+
+    std::atomic<uint64_t> frames{ 0 };
+    wil::unique_event paintStarted;
+    wil::unique_event paintRelease;
+};
+
+class RenderThreadTests
+{
+    TEST_CLASS(RenderThreadTests);
+
+    TEST_METHOD(IdleRequestPaintsOneFrame)
+    {
+        FrameCountingRenderer renderer;
+        RenderThread thread;
+        VERIFY_SUCCEEDED(thread.Initialize(&renderer));
+        thread.EnablePainting();
+
+        thread.NotifyPaint();
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+        thread.WaitForPaintCompletionAndDisable(INFINITE);
+
+        const auto statistics = thread.GetFrameStatistics();
+        VERIFY_ARE_EQUAL(1u, renderer.frames.load());
+        VERIFY_ARE_EQUAL(1u, statistics.framesPainted);
+        VERIFY_ARE_EQUAL(0u, statistics.framesSkipped);
+    }
+
+    TEST_METHOD(BacklogIsCoalescedIntoOneFrame)
+    {
+        FrameCountingRenderer renderer;
+        RenderThread thread;
+        VERIFY_SUCCEEDED(thread.Initialize(&renderer));
+        thread.EnablePainting();
+
+        Log::Comment(L"Hold the first frame while ten more are requested.");
+        renderer.paintRelease.ResetEvent();
+        thread.NotifyPaint();
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+        for (auto i = 0; i < 10; ++i)
+        {
+            thread.NotifyPaint();
+        }
+        Sleep(20);
+        renderer.paintRelease.SetEvent();
+
+        Log::Comment(L"The ten requests have to be handled by a single frame.");
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+        thread.WaitForPaintCompletionAndDisable(INFINITE);
+
+        const auto statistics = thread.GetFrameStatistics();
+        VERIFY_ARE_EQUAL(2u, renderer.frames.load());
+        VERIFY_ARE_EQUAL(2u, statistics.framesPainted);
+        VERIFY_ARE_EQUAL(9u, statistics.framesSkipped);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(statistics.paintTime.count(), std::chrono::microseconds{ 10ms }.count());
+    }
+
+    TEST_METHOD(ContinuousOutputKeepsPainting)
+    {
+        FrameCountingRenderer renderer;
+        RenderThread thread;
+        VERIFY_SUCCEEDED(thread.Initialize(&renderer));
+        thread.EnablePainting();
+
+        Log::Comment(L"Get the thread backlogged, then keep requesting frames without a pause.");
+        renderer.paintRelease.ResetEvent();
+        thread.NotifyPaint();
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+
+        std::atomic<bool> keepRequesting{ true };
+        std::thread output{ [&]() {
+            while (keepRequesting.load())
+            {
+                thread.NotifyPaint();
+            }
+        } };
+        auto stopOutput = wil::scope_exit([&]() {
+            keepRequesting.store(false);
+            output.join();
+        });
+
+        renderer.paintRelease.SetEvent();
+
+        Log::Comment(L"Output never settles, but frames still have to be painted.");
+        for (auto i = 0; i < 3; ++i)
+        {
+            VERIFY_IS_TRUE(renderer.paintStarted.wait(1000));
+        }
+
+        stopOutput.reset();
+        thread.WaitForPaintCompletionAndDisable(INFINITE);
+
+        const auto statistics = thread.GetFrameStatistics();
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(statistics.framesPainted, 4u);
+        VERIFY_IS_GREATER_THAN(statistics.framesSkipped, 0u);
+    }
+
+    TEST_METHOD(MaximumFrameRateSpacesFrames)
+    {
+        FrameCountingRenderer renderer;
+        RenderThread thread;
+        VERIFY_SUCCEEDED(thread.Initialize(&renderer));
+        thread.SetMaximumFrameRate(10);
+        thread.EnablePainting();
+
+        thread.NotifyPaint();
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+        const auto firstFrame = std::chrono::steady_clock::now();
+
+        thread.NotifyPaint();
+        VERIFY_IS_TRUE(renderer.paintStarted.wait(5000));
+        const auto secondFrame = std::chrono::steady_clock::now();
+        thread.WaitForPaintCompletionAndDisable(INFINITE);
+
+        Log::Comment(L"At 10 frames per second, frames start 100ms apart. Leave some room for the time it took us to notice the first one.");
+        VERIFY_ARE_EQUAL(2u, renderer.frames.load());
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(std::chrono::duration_cast<std::chrono::milliseconds>(secondFrame - firstFrame).count(), std::chrono::milliseconds{ 80ms }.count());
+    }
+};
@@ -151,6 +151,7 @@ class ScreenBufferTests
 
     TEST_METHOD(BackspaceDefaultAttrs);
     TEST_METHOD(BackspaceDefaultAttrsWriteCharsLegacy);
+    TEST_METHOD(WriteCharsLegacyMixesRunsAndControls);
 
     TEST_METHOD(BackspaceDefaultAttrsInPrompt);
 
@@ -2611,6 +2612,31 @@ void ScreenBufferTests::BackspaceDefaultAttrsWriteCharsLegacy()
     VERIFY_ARE_EQUAL(magenta, gci.LookupAttributeColors(attrB).second);
 }
 
+void ScreenBufferTests::WriteCharsLegacyMixesRunsAndControls()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const TextBuffer& tbi = si.GetTextBuffer();
+    Cursor& cursor = si.GetTextBuffer().GetCursor();
+
+    Log::Comment(NoThrowString().Format(L"Make sure the viewport is at 0,0"));
+    VERIFY_SUCCEEDED(si.SetViewportOrigin(true, COORD({ 0, 0 }), true));
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(NoThrowString().Format(L"Write printable runs separated by a tab, a CR/LF and a wide glyph."));
+    const std::wstring_view content = L"abc\tdefgh\r\nij\x3042k";
+    size_t numBytes = content.size() * sizeof(wchar_t);
+    size_t numSpaces = 0;
+    VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, content.data(), content.data(), content.data(), &numBytes, &numSpaces, 0, 0, nullptr));
+
+    VERIFY_ARE_EQUAL(content.size() * sizeof(wchar_t), numBytes);
+    VERIFY_ARE_EQUAL(18u, numSpaces);
+    VERIFY_ARE_EQUAL(COORD({ 5, 1 }), cursor.GetPosition());
+
+    VERIFY_ARE_EQUAL(String(L"abc     defgh "), String(tbi.GetRowByOffset(0).GetText().substr(0, 14).c_str()));
+    VERIFY_ARE_EQUAL(String(L"ij\x3042k "), String(tbi.GetRowByOffset(1).GetText().substr(0, 5).c_str()));
+}
+
 void ScreenBufferTests::BackspaceDefaultAttrsInPrompt()
 {
     // Tests MSFT:19853701 - when you edit the prompt line at a bash prompt,
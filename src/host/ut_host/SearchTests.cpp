@@ -156,4 +156,62 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(FindAllAtOnce)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"\x304b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        const auto locations = s.GetAllFoundLocations();
+        VERIFY_ARE_EQUAL(4u, locations.size());
+        for (SHORT y = 0; y < 4; ++y)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 2, y }), locations.at(y).first);
+            VERIFY_ARE_EQUAL((COORD{ 3, y }), locations.at(y).second);
+        }
+    }
+
+    TEST_METHOD(ForwardRegularExpression)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Log::Comment(L"The wide glyph in the middle of the match still takes up two cells.");
+        Search s(gci.renderData, L"c.d", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, Search::Syntax::RegularExpression);
+        for (SHORT y = 0; y < 4; ++y)
+        {
+            VERIFY_IS_TRUE(s.FindNext());
+            VERIFY_ARE_EQUAL((COORD{ 4, y }), s._coordSelStart);
+            VERIFY_ARE_EQUAL((COORD{ 7, y }), s._coordSelEnd);
+        }
+        VERIFY_IS_FALSE(s.FindNext());
+
+        Log::Comment(L"An invalid expression doesn't match anything.");
+        s.Update(L"c(", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, Search::Syntax::RegularExpression);
+        VERIFY_IS_FALSE(s.FindNext());
+        VERIFY_ARE_EQUAL(0u, s.GetAllFoundLocations().size());
+    }
+
+    TEST_METHOD(UpdateRefinesMatches)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"a", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        VERIFY_ARE_EQUAL(4u, s.GetAllFoundLocations().size());
+
+        Log::Comment(L"Typing more of the term only keeps the matches that still match.");
+        s.Update(L"ab", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        const auto locations = s.GetAllFoundLocations();
+        VERIFY_ARE_EQUAL(4u, locations.size());
+        VERIFY_ARE_EQUAL((COORD{ 1, 3 }), locations.at(3).second);
+
+        s.Update(L"abc", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        VERIFY_ARE_EQUAL(0u, s.GetAllFoundLocations().size());
+        VERIFY_IS_FALSE(s.FindNext());
+
+        Log::Comment(L"Any other term is searched for again.");
+        s.Update(L"AB", Search::Direction::Backward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(4u, s.GetAllFoundLocations().size());
+        COORD coordStartExpected = { 0, 3 };
+        DoFoundChecks(s, coordStartExpected, -1);
+    }
 };
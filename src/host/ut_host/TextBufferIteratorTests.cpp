@@ -11,6 +11,7 @@
 #include "../buffer/out/textBuffer.hpp"
 #include "../buffer/out/textBufferCellIterator.hpp"
 #include "../buffer/out/textBufferTextIterator.hpp"
+#include "../buffer/out/textBufferRunIterator.hpp"
 #include "../buffer/out/CharRow.hpp"
 
 #include "input.h"
@@ -266,6 +267,8 @@ class TextBufferIteratorTests
 
     TEST_METHOD(ConstructedNoLimit);
     TEST_METHOD(ConstructedLimits);
+
+    TEST_METHOD(RunIteratorFollowsAttributeRuns);
 };
 
 template<typename T>
@@ -587,3 +590,54 @@ void TextBufferIteratorTests::ConstructedLimits()
                            wil::ResultException,
                            [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
 }
+
+void TextBufferIteratorTests::RunIteratorFollowsAttributeRuns()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& outputBuffer = gci.GetActiveOutputBuffer();
+    auto& textBuffer = outputBuffer.GetTextBuffer();
+
+    auto& row = textBuffer.GetRowByOffset(1);
+    const auto defaultAttr = row.GetAttrRow().GetAttrByColumn(0);
+    const TextAttribute red{ FOREGROUND_RED };
+    row.GetAttrRow().Replace(3, 6, red);
+
+    SMALL_RECT limits;
+    limits.Top = 1;
+    limits.Bottom = 1;
+    limits.Left = 1;
+    limits.Right = 7;
+    const auto viewport = Microsoft::Console::Types::Viewport::FromInclusive(limits);
+
+    auto it = textBuffer.GetRunsAt({ 2, 1 }, viewport);
+    VERIFY_ARE_EQUAL(8, it.Limit());
+
+    Log::Comment(L"The first run starts at the given position, not at the start of the attribute run.");
+    VERIFY_IS_TRUE(it);
+    VERIFY_ARE_EQUAL(2, it.Begin());
+    VERIFY_ARE_EQUAL(3, it.End());
+    VERIFY_IS_TRUE(defaultAttr == it.TextAttr());
+
+    ++it;
+    VERIFY_IS_TRUE(it);
+    VERIFY_ARE_EQUAL(3, it.Begin());
+    VERIFY_ARE_EQUAL(6, it.End());
+    VERIFY_IS_TRUE(red == it.TextAttr());
+
+    Log::Comment(L"The last run ends at the right edge of the limits, not at the end of the row.");
+    ++it;
+    VERIFY_IS_TRUE(it);
+    VERIFY_ARE_EQUAL(6, it.Begin());
+    VERIFY_ARE_EQUAL(8, it.End());
+    VERIFY_IS_TRUE(defaultAttr == it.TextAttr());
+
+    ++it;
+    VERIFY_IS_FALSE(it, L"Iterator invalid now.");
+
+    Log::Comment(L"Without limits, the runs reach the end of the row.");
+    it = textBuffer.GetRunsAt({ 4, 1 });
+    VERIFY_ARE_EQUAL(4, it.Begin());
+    VERIFY_ARE_EQUAL(6, it.End());
+    ++it;
+    VERIFY_ARE_EQUAL(textBuffer.GetSize().Width(), it.End());
+}
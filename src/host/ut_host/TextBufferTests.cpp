@@ -79,6 +79,14 @@ class TextBufferTests
 
     TEST_METHOD(TestWrapThroughWriteLine);
 
+    TEST_METHOD(TestWriteStream);
+    TEST_METHOD(TestScrollbackStore);
+    TEST_METHOD(TestScrollbackWindow);
+    TEST_METHOD(TestColdRows);
+    TEST_METHOD(TestGeneration);
+    TEST_METHOD(TestGetPatterns);
+    TEST_METHOD(TestReflowChunks);
+
     TEST_METHOD(TestDoubleBytePadFlag);
 
     void DoBoundaryTest(PWCHAR const pwszInputString,
@@ -140,6 +148,7 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(CopyRectangleOverlappingPreservesHighUnicode);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -282,6 +291,519 @@ void TextBufferTests::TestWrapThroughWriteLine()
     }
 }
 
+void TextBufferTests::TestWriteStream()
+{
+    // Set up a small text buffer for us
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const TextAttribute red{ FOREGROUND_RED };
+
+    Log::Comment(L"Text that fits into the row leaves the cursor right after it.");
+    {
+        const auto result = buffer->WriteStream(L"abc", red, { 0, 0 });
+        VERIFY_ARE_EQUAL(COORD({ 3, 0 }), result.cursorPosition);
+        VERIFY_ARE_EQUAL(3u, result.charsConsumed);
+        VERIFY_ARE_EQUAL(3u, result.cellsWritten);
+        VERIFY_ARE_EQUAL(0, result.rowsCircled);
+        VERIFY_IS_FALSE(buffer->GetRowByOffset(0).WasWrapForced());
+        VERIFY_ARE_EQUAL(red, buffer->GetRowByOffset(0).GetAttrRow().GetAttrByColumn(2));
+    }
+
+    Log::Comment(L"Filling the row exactly leaves the cursor at the row width.");
+    {
+        const auto result = buffer->WriteStream(L"defghij", red, { 3, 0 });
+        VERIFY_ARE_EQUAL(COORD({ 10, 0 }), result.cursorPosition);
+        VERIFY_ARE_EQUAL(7u, result.cellsWritten);
+    }
+
+    Log::Comment(L"Writing from the row width continues on the next row and wraps the previous one.");
+    {
+        const auto result = buffer->WriteStream(L"klmnopqrstuv", red, { 10, 0 });
+        VERIFY_ARE_EQUAL(COORD({ 2, 2 }), result.cursorPosition);
+        VERIFY_ARE_EQUAL(12u, result.cellsWritten);
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(0).WasWrapForced());
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(1).WasWrapForced());
+        VERIFY_IS_FALSE(buffer->GetRowByOffset(2).WasWrapForced());
+        VERIFY_ARE_EQUAL(L"klmnopqrst", buffer->GetRowByOffset(1).GetText());
+    }
+
+    Log::Comment(L"A wide glyph in the last column is padded onto the next row, circling the buffer.");
+    {
+        const auto result = buffer->WriteStream(L"wxyzabc\x3042", red, { 2, 2 });
+        VERIFY_ARE_EQUAL(COORD({ 2, 2 }), result.cursorPosition);
+        VERIFY_ARE_EQUAL(8u, result.charsConsumed);
+        VERIFY_ARE_EQUAL(9u, result.cellsWritten);
+        VERIFY_ARE_EQUAL(1, result.rowsCircled);
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(1).WasDoubleBytePadded());
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(2).GetCharRow().DbcsAttrAt(0).IsLeading());
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(2).GetCharRow().DbcsAttrAt(1).IsTrailing());
+    }
+
+    Log::Comment(L"Without circling, writing stops at the bottom of the buffer.");
+    {
+        const auto result = buffer->WriteStream(L"0123456789abc", red, { 0, 2 }, false);
+        VERIFY_ARE_EQUAL(COORD({ 10, 2 }), result.cursorPosition);
+        VERIFY_ARE_EQUAL(10u, result.charsConsumed);
+        VERIFY_ARE_EQUAL(0, result.rowsCircled);
+    }
+}
+
+void TextBufferTests::TestScrollbackStore()
+{
+    // Set up a small text buffer for us
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    auto& scrollback = buffer->GetScrollback();
+
+    const TextAttribute red{ FOREGROUND_RED };
+
+    Log::Comment(L"Rows that circle out of the buffer are discarded by default.");
+    {
+        buffer->WriteStream(L"discarded", red, { 0, 0 }, false);
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        VERIFY_IS_TRUE(scrollback.empty());
+    }
+
+    Log::Comment(L"Once enabled, rows are numbered in the order they left the buffer and the oldest ones are dropped beyond the limit.");
+    {
+        scrollback.SetLimit(4);
+        for (auto i = 0; i < 6; ++i)
+        {
+            buffer->WriteStream(L"row" + std::to_wstring(i), red, { 0, 0 }, false);
+            VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        }
+
+        VERIFY_ARE_EQUAL(4u, scrollback.size());
+        VERIFY_ARE_EQUAL(2u, scrollback.GetFirstRowNumber());
+        VERIFY_ARE_EQUAL(6u, scrollback.GetEndRowNumber());
+        VERIFY_ARE_EQUAL(L"row2", scrollback.GetText(2));
+        VERIFY_ARE_EQUAL(L"row5", scrollback.GetText(5));
+        VERIFY_THROWS_SPECIFIC(scrollback.GetText(1), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+        VERIFY_THROWS_SPECIFIC(scrollback.GetText(6), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    Log::Comment(L"A row with wide and surrogate pair glyphs is thawed with the same layout and attributes.");
+    {
+        auto& original = buffer->GetRowByOffset(0);
+        buffer->WriteStream(L"a\x304b\xD83D\xDD25z", red, { 0, 0 }, false);
+        original.GetAttrRow().Replace(0, 1, attr);
+        original.SetWrapForced(true);
+
+        std::vector<std::wstring> glyphs;
+        std::vector<DbcsAttribute> dbcsAttrs;
+        std::vector<TextAttribute> textAttrs;
+        for (size_t column = 0; column < original.size(); ++column)
+        {
+            glyphs.emplace_back(original.GetCharRow().GlyphAt(column));
+            dbcsAttrs.push_back(original.GetCharRow().DbcsAttrAt(column));
+            textAttrs.push_back(original.GetAttrRow().GetAttrByColumn(gsl::narrow_cast<uint16_t>(column)));
+        }
+
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        const auto rowNumber = scrollback.GetEndRowNumber() - 1;
+
+        auto& thawed = buffer->GetRowByOffset(0);
+        scrollback.CopyTo(rowNumber, thawed);
+
+        VERIFY_IS_TRUE(thawed.WasWrapForced());
+        for (size_t column = 0; column < thawed.size(); ++column)
+        {
+            VERIFY_ARE_EQUAL(glyphs.at(column), std::wstring{ thawed.GetCharRow().GlyphAt(column) });
+            VERIFY_ARE_EQUAL(dbcsAttrs.at(column), thawed.GetCharRow().DbcsAttrAt(column));
+            VERIFY_ARE_EQUAL(textAttrs.at(column), thawed.GetAttrRow().GetAttrByColumn(gsl::narrow_cast<uint16_t>(column)));
+        }
+    }
+
+    Log::Comment(L"Clearing the scrollback keeps counting the rows.");
+    {
+        scrollback.Clear();
+        VERIFY_IS_TRUE(scrollback.empty());
+        VERIFY_ARE_EQUAL(7u, scrollback.GetFirstRowNumber());
+        VERIFY_ARE_EQUAL(7u, scrollback.GetEndRowNumber());
+    }
+}
+
+void TextBufferTests::TestScrollbackWindow()
+{
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    buffer->GetScrollback().SetLimit(100);
+
+    const TextAttribute red{ FOREGROUND_RED };
+    const auto rowText = [&](const ptrdiff_t row) {
+        return buffer->GetRowByOffset(row).GetText().substr(0, 4);
+    };
+
+    Log::Comment(L"Without any scrollback, there's nothing above the buffer.");
+    {
+        VERIFY_ARE_EQUAL(0, buffer->GetScrollbackWindowHeight());
+        VERIFY_ARE_EQUAL(buffer->GetSize().ToInclusive(), buffer->GetSizeWithScrollback().ToInclusive());
+        VERIFY_THROWS_SPECIFIC(buffer->GetRowByOffset(-1), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    for (auto i = 0; i < 5; ++i)
+    {
+        buffer->WriteStream(L"row" + std::to_wstring(i), red, { 0, 0 }, false);
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+    }
+
+    Log::Comment(L"The rows of the scrollback are mapped above the buffer, the newest one at -1.");
+    {
+        VERIFY_ARE_EQUAL(5, buffer->GetScrollbackWindowHeight());
+        VERIFY_ARE_EQUAL(-5, buffer->GetSizeWithScrollback().Top());
+        VERIFY_ARE_EQUAL(8, buffer->GetSizeWithScrollback().Height());
+        VERIFY_ARE_EQUAL(L"row4", rowText(-1));
+        VERIFY_ARE_EQUAL(L"row0", rowText(-5));
+        VERIFY_THROWS_SPECIFIC(buffer->GetRowByOffset(-6), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    Log::Comment(L"Offsets and logical row numbers convert both ways.");
+    {
+        VERIFY_ARE_EQUAL(0u, buffer->GetRowNumber(-5));
+        VERIFY_ARE_EQUAL(5u, buffer->GetRowNumber(0));
+        for (ptrdiff_t row = -5; row < bufferSize.Y; ++row)
+        {
+            VERIFY_ARE_EQUAL(gsl::narrow_cast<SHORT>(row), buffer->GetRowOffset(buffer->GetRowNumber(row)).value());
+        }
+        VERIFY_IS_FALSE(buffer->GetRowOffset(8).has_value());
+    }
+
+    Log::Comment(L"Cell iterators walk from the scrollback into the buffer.");
+    {
+        buffer->WriteStream(L"top", red, { 0, 0 }, false);
+        auto it = buffer->GetTextDataAt({ bufferSize.X - 1, -1 });
+        ++it;
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(L"t", std::wstring{ *it });
+    }
+
+    Log::Comment(L"The window can only be as tall as the buffer leaves room for. It can slide up into older rows.");
+    {
+        const COORD tallSize{ 10, SHORT_MAX - 4 };
+        auto tall = std::make_unique<TextBuffer>(tallSize, attr, cursorSize, _renderTarget);
+        tall->GetScrollback().SetLimit(100);
+        for (auto i = 0; i < 10; ++i)
+        {
+            tall->WriteStream(L"row" + std::to_wstring(i), red, { 0, 0 }, false);
+            VERIFY_IS_TRUE(tall->IncrementCircularBuffer());
+        }
+
+        VERIFY_ARE_EQUAL(4, tall->GetScrollbackWindowHeight());
+        VERIFY_IS_FALSE(tall->GetScrollbackWindowEnd().has_value());
+        VERIFY_ARE_EQUAL(L"row6", tall->GetRowByOffset(-4).GetText().substr(0, 4));
+        VERIFY_IS_FALSE(tall->GetRowOffset(5).has_value());
+
+        tall->SetScrollbackWindowEnd(5);
+        VERIFY_ARE_EQUAL(5u, tall->GetScrollbackWindowEnd().value());
+        VERIFY_ARE_EQUAL(4, tall->GetScrollbackWindowHeight());
+        VERIFY_ARE_EQUAL(L"row4", tall->GetRowByOffset(-1).GetText().substr(0, 4));
+        VERIFY_ARE_EQUAL(L"row1", tall->GetRowByOffset(-4).GetText().substr(0, 4));
+        VERIFY_ARE_EQUAL(SHORT{ -1 }, tall->GetRowOffset(4).value());
+        VERIFY_IS_FALSE(tall->GetRowOffset(6).has_value());
+        VERIFY_ARE_EQUAL(10u, tall->GetRowNumber(0));
+
+        Log::Comment(L"Near the start of the scrollback, the window is only as tall as the rows before its end.");
+        tall->SetScrollbackWindowEnd(2);
+        VERIFY_ARE_EQUAL(2, tall->GetScrollbackWindowHeight());
+        VERIFY_ARE_EQUAL(L"row0", tall->GetRowByOffset(-2).GetText().substr(0, 4));
+
+        Log::Comment(L"A window that reaches the newest row is attached to the buffer again.");
+        tall->SetScrollbackWindowEnd(10);
+        VERIFY_IS_FALSE(tall->GetScrollbackWindowEnd().has_value());
+        VERIFY_ARE_EQUAL(L"row9", tall->GetRowByOffset(-1).GetText().substr(0, 4));
+    }
+}
+
+void TextBufferTests::TestColdRows()
+{
+    const COORD bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    auto& cursor = buffer->GetCursor();
+
+    const TextAttribute red{ FOREGROUND_RED };
+
+    // Accessing a row through the buffer would thaw it.
+    const auto storedRow = [&](const SHORT y) -> ROW& {
+        return buffer->_storage.at((buffer->_firstRow + y) % buffer->TotalRowCount());
+    };
+
+    Log::Comment(L"Rows are frozen once they're the cold distance above the last row.");
+    {
+        buffer->SetColdRowDistance(2);
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            buffer->WriteStream(L"row" + std::to_wstring(y), red, { 0, y }, false);
+        }
+        buffer->GetRowByOffset(1).SetWrapForced(true);
+        VERIFY_IS_FALSE(storedRow(2).IsFrozen());
+
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            VERIFY_ARE_EQUAL(y == 2, storedRow(y).IsFrozen());
+        }
+    }
+
+    Log::Comment(L"Reading a frozen row gets a thawed copy of it and leaves it frozen.");
+    {
+        const auto& row = std::as_const(*buffer).GetRowByOffset(2);
+        VERIFY_ARE_EQUAL(L"row3", row.GetText().substr(0, 4));
+        VERIFY_ARE_EQUAL(red, row.GetAttrRow().GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(4));
+        VERIFY_ARE_EQUAL(storedRow(2).GetRevision(), row.GetRevision());
+        VERIFY_IS_TRUE(storedRow(2).IsFrozen());
+
+        Log::Comment(L"Its text and hyperlinks can be read without a copy, too.");
+        VERIFY_ARE_EQUAL(row.GetText(), storedRow(2).GetText());
+        VERIFY_ARE_EQUAL(row.GetHyperlinks().size(), storedRow(2).GetHyperlinks().size());
+    }
+
+    Log::Comment(L"Accessing a frozen row to change it thaws it for good, with its contents intact.");
+    {
+        auto& row = buffer->GetRowByOffset(2);
+        VERIFY_IS_FALSE(row.IsFrozen());
+        VERIFY_ARE_EQUAL(L"row3", row.GetText().substr(0, 4));
+        VERIFY_ARE_EQUAL(red, row.GetAttrRow().GetAttrByColumn(0));
+        VERIFY_IS_FALSE(storedRow(2).IsFrozen());
+    }
+
+    Log::Comment(L"Resetting a frozen row doesn't bring back its contents.");
+    {
+        auto& row = storedRow(2);
+        row.Freeze();
+        VERIFY_IS_TRUE(row.Reset(attr));
+        VERIFY_IS_FALSE(row.IsFrozen());
+        VERIFY_IS_FALSE(row.GetCharRow().ContainsText());
+    }
+
+    Log::Comment(L"FreezeColdRows freezes the rows the cold distance above the cursor again.");
+    {
+        cursor.SetPosition({ 0, 4 });
+        buffer->FreezeColdRows();
+        VERIFY_IS_TRUE(storedRow(0).IsFrozen());
+        VERIFY_IS_TRUE(storedRow(1).IsFrozen());
+        VERIFY_IS_FALSE(storedRow(2).IsFrozen());
+        VERIFY_IS_TRUE(storedRow(0).WasWrapForced());
+        VERIFY_IS_TRUE(buffer->_thawedRows.empty());
+    }
+
+    Log::Comment(L"Rows that are frozen in the buffer are shared with the scrollback as they circle out.");
+    {
+        buffer->GetScrollback().SetLimit(1);
+        const auto frozen = storedRow(0).GetFrozen();
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        VERIFY_ARE_EQUAL(L"row1", buffer->GetScrollback().GetText(0));
+        VERIFY_IS_TRUE(buffer->GetScrollback().WasWrapForced(0));
+        VERIFY_ARE_EQUAL(L"row1", frozen->GetText());
+    }
+}
+
+void TextBufferTests::TestGeneration()
+{
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    buffer->GetScrollback().SetLimit(100);
+
+    const TextAttribute red{ FOREGROUND_RED };
+
+    Log::Comment(L"Writing into a row doesn't move any rows.");
+    auto generation = buffer->GetGeneration();
+    buffer->WriteStream(L"row0", red, { 0, 0 }, false);
+    VERIFY_ARE_EQUAL(generation, buffer->GetGeneration());
+
+    Log::Comment(L"Circling moves every row.");
+    VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+    VERIFY_ARE_NOT_EQUAL(generation, buffer->GetGeneration());
+    VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(2, buffer->GetScrollbackWindowHeight());
+
+    Log::Comment(L"Setting the scrollback window where it already is doesn't.");
+    generation = buffer->GetGeneration();
+    buffer->SetScrollbackWindowEnd(std::nullopt);
+    VERIFY_ARE_EQUAL(generation, buffer->GetGeneration());
+
+    Log::Comment(L"Sliding the window up into older rows does.");
+    buffer->SetScrollbackWindowEnd(1);
+    VERIFY_ARE_NOT_EQUAL(generation, buffer->GetGeneration());
+
+    Log::Comment(L"So does clearing the scrollback below a window that's already at its end.");
+    buffer->SetScrollbackWindowEnd(std::nullopt);
+    generation = buffer->GetGeneration();
+    buffer->GetScrollback().Clear();
+    buffer->SetScrollbackWindowEnd(std::nullopt);
+    VERIFY_ARE_EQUAL(0, buffer->GetScrollbackWindowHeight());
+    VERIFY_ARE_NOT_EQUAL(generation, buffer->GetGeneration());
+
+    Log::Comment(L"Another buffer never has the same generation.");
+    auto other = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    VERIFY_ARE_NOT_EQUAL(buffer->GetGeneration(), other->GetGeneration());
+}
+
+void TextBufferTests::TestGetPatterns()
+{
+    const COORD bufferSize{ 20, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const auto id = buffer->AddPatternRecognizer(LR"([a-z]+://[a-z.]+)");
+
+    const auto getIntervals = [&]() {
+        std::vector<std::pair<til::point, til::point>> intervals;
+        buffer->GetPatterns(0, bufferSize.Y - 1).visit_all([&](const auto& interval) {
+            VERIFY_ARE_EQUAL(id, interval.value);
+            intervals.emplace_back(interval.start, interval.stop);
+        });
+        std::sort(intervals.begin(), intervals.end(), [](const auto& a, const auto& b) { return a.first.y() < b.first.y(); });
+        return intervals;
+    };
+
+    Log::Comment(L"A match within a single row.");
+    {
+        buffer->WriteStream(L"see http://a.b.c", attr, { 0, 1 }, false);
+        const auto intervals = getIntervals();
+        VERIFY_ARE_EQUAL(1u, intervals.size());
+        VERIFY_ARE_EQUAL(til::point(4, 1), intervals.at(0).first);
+        VERIFY_ARE_EQUAL(til::point(16, 1), intervals.at(0).second);
+    }
+
+    Log::Comment(L"Rows that wrapped into each other are joined.");
+    {
+        buffer->WriteStream(L"xxxxxxxxxxxxxxxhttp://foo.bar", attr, { 0, 2 }, false);
+        VERIFY_IS_TRUE(buffer->GetRowByOffset(2).WasWrapForced());
+        const auto intervals = getIntervals();
+        VERIFY_ARE_EQUAL(2u, intervals.size());
+        VERIFY_ARE_EQUAL(til::point(15, 2), intervals.at(1).first);
+        VERIFY_ARE_EQUAL(til::point(9, 3), intervals.at(1).second);
+    }
+
+    Log::Comment(L"Rows that didn't wrap aren't.");
+    {
+        buffer->GetRowByOffset(2).SetWrapForced(false);
+        VERIFY_ARE_EQUAL(1u, getIntervals().size());
+        buffer->GetRowByOffset(2).SetWrapForced(true);
+        VERIFY_ARE_EQUAL(2u, getIntervals().size());
+    }
+
+    Log::Comment(L"Rows that were written are scanned again.");
+    {
+        buffer->WriteStream(L"no link here        ", attr, { 0, 1 }, false);
+        const auto intervals = getIntervals();
+        VERIFY_ARE_EQUAL(1u, intervals.size());
+        VERIFY_ARE_EQUAL(til::point(15, 2), intervals.at(0).first);
+    }
+
+    Log::Comment(L"Matches move along with the rows as the buffer circles.");
+    {
+        VERIFY_IS_TRUE(buffer->IncrementCircularBuffer());
+        const auto intervals = getIntervals();
+        VERIFY_ARE_EQUAL(1u, intervals.size());
+        VERIFY_ARE_EQUAL(til::point(15, 1), intervals.at(0).first);
+        VERIFY_ARE_EQUAL(til::point(9, 2), intervals.at(0).second);
+    }
+
+    Log::Comment(L"A line that wraps into the region is scanned from its start.");
+    {
+        std::vector<std::pair<til::point, til::point>> intervals;
+        buffer->GetPatterns(2, 4).visit_all([&](const auto& interval) {
+            intervals.emplace_back(interval.start, interval.stop);
+        });
+        VERIFY_ARE_EQUAL(1u, intervals.size());
+        VERIFY_ARE_EQUAL(til::point(15, -1), intervals.at(0).first);
+        VERIFY_ARE_EQUAL(til::point(9, 0), intervals.at(0).second);
+    }
+}
+
+void TextBufferTests::TestReflowChunks()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    const TextAttribute red{ FOREGROUND_RED };
+
+    // Enough rows for the reflow to be split into several chunks.
+    const COORD oldSize{ 20, 4000 };
+    const COORD newSize{ 7, 4000 };
+    auto oldBuffer = std::make_unique<TextBuffer>(oldSize, attr, cursorSize, _renderTarget);
+    auto newBuffer = std::make_unique<TextBuffer>(newSize, attr, cursorSize, _renderTarget);
+
+    Log::Comment(L"Write lines of all lengths, some of them wrapped and some ending in a wide glyph.");
+    std::vector<std::wstring> lines;
+    COORD position{ 0, 0 };
+    for (auto i = 0; i < 1200; ++i)
+    {
+        const auto wide = i % 5 == 0;
+        auto length = i % 30 + 1;
+
+        // A row that's filled exactly isn't wrapped, and would be joined with the next one.
+        if ((length + (wide ? 2 : 0)) % oldSize.X == 0)
+        {
+            ++length;
+        }
+
+        auto& line = lines.emplace_back();
+        for (auto j = 0; j < length; ++j)
+        {
+            line.push_back(gsl::narrow_cast<wchar_t>(L'a' + (i + j) % 26));
+        }
+        if (wide)
+        {
+            line.push_back(L'\x6f22');
+        }
+
+        const auto result = oldBuffer->WriteStream(line, red, position, false);
+        VERIFY_ARE_EQUAL(line.size(), result.charsConsumed);
+        position = { 0, gsl::narrow<SHORT>(result.cursorPosition.Y + 1) };
+    }
+    oldBuffer->GetCursor().SetPosition(position);
+
+    Log::Comment(L"Freeze more rows than the buffer keeps thawed copies of, across several chunks.");
+    oldBuffer->SetColdRowDistance(100);
+    oldBuffer->FreezeColdRows();
+    const auto frozenRows = std::count_if(oldBuffer->_storage.begin(), oldBuffer->_storage.end(), [](const ROW& row) {
+        return row.IsFrozen();
+    });
+    VERIFY_IS_GREATER_THAN(gsl::narrow_cast<size_t>(frozenRows), TextBuffer::ThawedRowCacheSize * 2);
+
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(*oldBuffer, *newBuffer, std::nullopt, std::nullopt));
+
+    Log::Comment(L"Every line has to come out of the new buffer just like it went in.");
+    SHORT y = 0;
+    for (const auto& expected : lines)
+    {
+        std::wstring actual;
+        for (;;)
+        {
+            const auto& row = newBuffer->GetRowByOffset(y++);
+            auto text = row.GetText();
+            if (row.WasDoubleBytePadded())
+            {
+                text.pop_back();
+            }
+
+            if (!row.WasWrapForced())
+            {
+                actual.append(text.substr(0, text.find_last_not_of(L' ') + 1));
+                break;
+            }
+            actual.append(text);
+        }
+        VERIFY_ARE_EQUAL(expected, actual);
+    }
+
+    VERIFY_ARE_EQUAL(red, newBuffer->GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(COORD({ 0, y }), newBuffer->GetCursor().GetPosition());
+}
+
 void TextBufferTests::TestDoubleBytePadFlag()
 {
     TextBuffer& textBuffer = GetTbi();
@@ -1822,7 +2344,7 @@ void TextBufferTests::ResizeTraditional()
 }
 
 // This tests that when buffer storage rows are rotated around during a resize traditional operation,
-// that the Unicode Storage-held high unicode items like emoji rotate properly with it.
+// that the high unicode items like emoji stored by the rows rotate properly with them.
 void TextBufferTests::ResizeTraditionalRotationPreservesHighUnicode()
 {
     // Set up a text buffer for us
@@ -1864,7 +2386,7 @@ void TextBufferTests::ResizeTraditionalRotationPreservesHighUnicode()
 }
 
 // This tests that when buffer storage rows are rotated around during a scroll buffer operation,
-// that the Unicode Storage-held high unicode items like emoji rotate properly with it.
+// that the high unicode items like emoji stored by the rows rotate properly with them.
 void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
 {
     // Set up a text buffer for us
@@ -1903,8 +2425,39 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+void TextBufferTests::CopyRectangleOverlappingPreservesHighUnicode()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 20, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Fill two rows with text, including the fire emoji, which has to hit the high unicode storage.
+    const std::wstring_view fire = L"\xD83D\xDD25";
+    for (SHORT y = 1; y < 3; ++y)
+    {
+        _buffer->Write(OutputCellIterator{ std::wstring_view{ L"abcdef" } }, { 0, y });
+        _buffer->GetRowByOffset(y).GetCharRow().GlyphAt(1) = fire;
+    }
+
+    Log::Comment(L"Move both rows down and to the right, so that the second row is both source and target.");
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 1 }, { 6, 2 }), { 2, 2 });
+
+    const auto textAt = [&](const SHORT y, const size_t length) {
+        return _buffer->GetRowByOffset(y).GetText().substr(0, length);
+    };
+    VERIFY_ARE_EQUAL(String(L"a\xD83D\xDD25cdef"), String(textAt(1, 7).c_str()));
+    VERIFY_ARE_EQUAL(String(L"a\xD83D\xDD25a\xD83D\xDD25cdef"), String(textAt(2, 10).c_str()));
+    VERIFY_ARE_EQUAL(String(L"  a\xD83D\xDD25cdef"), String(textAt(3, 9).c_str()));
+
+    Log::Comment(L"Move part of a row to the left within the row.");
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 1, 1 }, { 5, 1 }), { 0, 1 });
+    VERIFY_ARE_EQUAL(String(L"\xD83D\xDD25cdeff"), String(textAt(1, 7).c_str()));
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
-// characters from the Unicode Storage buffer
+// characters from the glyph storage of the rows
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
 {
     // Set up a text buffer for us
@@ -1928,18 +2481,21 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_IS_FALSE(_buffer->_storage[pos.Y].GetCharRow()._glyphs.empty(), L"The row should store the glyph.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetCharRow()._glyphs.empty(), L"No row should store a glyph now.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
-// characters from the Unicode Storage buffer
+// characters from the glyph storage of the rows
 void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
 {
     // Set up a text buffer for us
@@ -1963,14 +2519,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_IS_FALSE(_buffer->_storage[pos.Y].GetCharRow()._glyphs.empty(), L"The row should store the glyph.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetCharRow()._glyphs.empty(), L"The row should have dropped the glyph.");
 }
 
 void TextBufferTests::TestBurrito()
@@ -83,6 +83,8 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(PipeWriterMergesFramesWhileBlocked);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -416,8 +418,7 @@ void VtRendererTest::Xterm256TestColors()
     Log::Comment(NoThrowString().Format(
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({ 0x00030201, 0x00070605 },
                                                   &renderData,
                                                   false,
@@ -694,55 +695,58 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     VERIFY_SUCCEEDED(TestData::TryGetValue(L"crossedOut", crossedOut));
 
     TextAttribute desiredAttrs;
-    std::vector<std::string> onSequences, offSequences;
+    std::vector<std::string> onParameters;
 
-    // Collect up a VT sequence to set the state given the method properties
+    // Collect up the SGR parameters to set the state given the method properties
     if (faint)
     {
         desiredAttrs.SetFaint(true);
-        onSequences.push_back("\x1b[2m");
-        offSequences.push_back("\x1b[22m");
+        onParameters.push_back("2");
     }
     if (underlined)
     {
         desiredAttrs.SetUnderlined(true);
-        onSequences.push_back("\x1b[4m");
-        offSequences.push_back("\x1b[24m");
+        onParameters.push_back("4");
     }
     if (doublyUnderlined)
     {
         desiredAttrs.SetDoublyUnderlined(true);
-        onSequences.push_back("\x1b[21m");
-        // The two underlines share the same off sequence, so we
-        // only add it here if that hasn't already been done.
-        if (!underlined)
-        {
-            offSequences.push_back("\x1b[24m");
-        }
+        onParameters.push_back("21");
     }
     if (italics)
     {
         desiredAttrs.SetItalic(true);
-        onSequences.push_back("\x1b[3m");
-        offSequences.push_back("\x1b[23m");
+        onParameters.push_back("3");
     }
     if (blink)
     {
         desiredAttrs.SetBlinking(true);
-        onSequences.push_back("\x1b[5m");
-        offSequences.push_back("\x1b[25m");
+        onParameters.push_back("5");
     }
     if (invisible)
     {
         desiredAttrs.SetInvisible(true);
-        onSequences.push_back("\x1b[8m");
-        offSequences.push_back("\x1b[28m");
+        onParameters.push_back("8");
     }
     if (crossedOut)
     {
         desiredAttrs.SetCrossedOut(true);
-        onSequences.push_back("\x1b[9m");
-        offSequences.push_back("\x1b[29m");
+        onParameters.push_back("9");
+    }
+
+    // All the parameters are set in a single sequence. Turning them off again
+    // is shortest with a reset, since the colors are the defaults anyways.
+    std::vector<std::string> onSequences, offSequences;
+    if (!onParameters.empty())
+    {
+        std::string onSequence = "\x1b[";
+        for (const auto& parameter : onParameters)
+        {
+            onSequence += parameter + ";";
+        }
+        onSequence.back() = 'm';
+        onSequences.push_back(onSequence);
+        offSequences.push_back("\x1b[m");
     }
 
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -762,26 +766,33 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     Log::Comment(NoThrowString().Format(
         L"Test changing the text attributes"));
 
+    Log::Comment(NoThrowString().Format(
+        L"----Start with the default attributes----"));
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[m");
+        VERIFY_SUCCEEDED(engine->_UpdateRendition({}));
+    });
+
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes on----"));
     TestPaint(*engine, [&]() {
         // Merge the "on" sequences into expected input.
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->_UpdateRendition(desiredAttrs));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes off----"));
     TestPaint(*engine, [&]() {
         std::copy(offSequences.cbegin(), offSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs({}));
+        VERIFY_SUCCEEDED(engine->_UpdateRendition({}));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes back on----"));
     TestPaint(*engine, [&]() {
         std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        VERIFY_SUCCEEDED(engine->_UpdateRendition(desiredAttrs));
     });
 
     VerifyExpectedInputsDrained();
@@ -865,8 +876,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back("\x1b[39m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -876,8 +886,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back("\x1b[49m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, &renderData, false, false));
 
     VerifyExpectedInputsDrained();
@@ -1611,3 +1620,49 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormatted(bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::PipeWriterMergesFramesWhileBlocked()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 4096));
+
+    std::string expected;
+    PipeWriter writer{ writePipe.get() };
+
+    Log::Comment(L"The first frame doesn't fit into the pipe. Nobody reads it, so it stays queued.");
+    std::string frame(64 * 1024, 'a');
+    expected += frame;
+    VERIFY_SUCCEEDED(writer.Write(frame));
+    VERIFY_IS_TRUE(frame.empty());
+
+    Log::Comment(L"Fill the queue, then keep writing. The writes mustn't block.");
+    for (auto i = 0; i < 6; ++i)
+    {
+        frame.assign(16, static_cast<char>('b' + i));
+        expected += frame;
+        VERIFY_SUCCEEDED(writer.Write(frame));
+    }
+
+    auto stats = writer.GetStatistics();
+    VERIFY_ARE_EQUAL(uint64_t{ 3 }, stats.merges);
+    VERIFY_ARE_EQUAL(expected.size(), stats.queuedBytes);
+    VERIFY_ARE_EQUAL(expected.size(), stats.peakQueuedBytes);
+
+    Log::Comment(L"Once the terminal reads, everything arrives in the order it was written.");
+    std::string actual(expected.size(), '\0');
+    size_t read = 0;
+    while (read < actual.size())
+    {
+        DWORD dwRead = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), actual.data() + read, gsl::narrow_cast<DWORD>(actual.size() - read), &dwRead, nullptr));
+        read += dwRead;
+    }
+    VERIFY_ARE_EQUAL(expected, actual);
+
+    VERIFY_SUCCEEDED(writer.Drain());
+    stats = writer.GetStatistics();
+    VERIFY_ARE_EQUAL(uint64_t{ expected.size() }, stats.bytesWritten);
+    VERIFY_ARE_EQUAL(uint64_t{ 4 }, stats.writes);
+    VERIFY_ARE_EQUAL(size_t{ 0 }, stats.queuedBytes);
+}
@@ -9,6 +9,7 @@
 
 const unsigned int PTY_SIGNAL_CLEAR_WINDOW = 2u;
 const unsigned int PTY_SIGNAL_RESIZE_WINDOW = 8u;
+const unsigned int PTY_SIGNAL_DUMP_API_STATISTICS = 16u;
 
 HRESULT CreateConPty(const std::wstring& cmdline, // _In_
                      const unsigned short w, // _In_
@@ -13,7 +13,11 @@ Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+functions MultiByteToWideChar and WideCharToMultiByte for everything but
+ASCII. Runs of ASCII are copied with SSE2 (or NEON) instead, which is
+several times faster for the mostly-ASCII output of console applications.
+Splitting the text at ASCII characters doesn't change how invalid sequences
+are replaced, since an ASCII character always ends a sequence.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -23,6 +27,222 @@ Author(s):
 
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26481) // pointer arithmetic
+        // Once a run of non-ASCII text is followed by at least this many ASCII
+        // characters, we switch back to copying ASCII ourselves. Shorter gaps
+        // (like the spaces between words) go to the platform function along
+        // with the surrounding text, so that we don't call it for every word.
+        inline constexpr size_t asciiBlock = 16;
+
+        // Routine Description:
+        // - Copies the ASCII characters at the start of the given UTF-8 text as UTF-16.
+        // Arguments:
+        // - in - the UTF-8 text
+        // - count - the length of the text
+        // - out - receives count UTF-16 code units at most
+        // Return Value:
+        // - the number of characters copied
+        inline size_t u8u16_ascii(const char* const in, const size_t count, wchar_t* const out) noexcept
+        {
+            size_t i = 0;
+#if defined(_M_AMD64) || defined(_M_IX86)
+            const auto zero = _mm_setzero_si128();
+            for (; count - i >= 16; i += 16)
+            {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                if (_mm_movemask_epi8(v))
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(v, zero));
+            }
+#elif defined(_M_ARM64)
+            for (; count - i >= 16; i += 16)
+            {
+                const auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i));
+                if (vmaxvq_u8(v) >= 0x80)
+                {
+                    break;
+                }
+                vst1q_u16(reinterpret_cast<uint16_t*>(out + i), vmovl_u8(vget_low_u8(v)));
+                vst1q_u16(reinterpret_cast<uint16_t*>(out + i + 8), vmovl_u8(vget_high_u8(v)));
+            }
+#endif
+            for (; i < count && static_cast<uint8_t>(in[i]) < 0x80; ++i)
+            {
+                out[i] = static_cast<wchar_t>(in[i]);
+            }
+            return i;
+        }
+
+        // Routine Description:
+        // - Copies the ASCII characters at the start of the given UTF-16 text as UTF-8.
+        // Arguments:
+        // - in - the UTF-16 text
+        // - count - the length of the text
+        // - out - receives count UTF-8 code units at most
+        // Return Value:
+        // - the number of characters copied
+        inline size_t u16u8_ascii(const wchar_t* const in, const size_t count, char* const out) noexcept
+        {
+            size_t i = 0;
+#if defined(_M_AMD64) || defined(_M_IX86)
+            const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const auto zero = _mm_setzero_si128();
+            for (; count - i >= 16; i += 16)
+            {
+                const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+                const auto test = _mm_and_si128(_mm_or_si128(lo, hi), nonAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, zero)) != 0xFFFF)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+            }
+#elif defined(_M_ARM64)
+            for (; count - i >= 16; i += 16)
+            {
+                const auto lo = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+                const auto hi = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i + 8));
+                if (vmaxvq_u16(vorrq_u16(lo, hi)) >= 0x80)
+                {
+                    break;
+                }
+                vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+            }
+#endif
+            for (; i < count && in[i] < 0x80; ++i)
+            {
+                out[i] = static_cast<char>(in[i]);
+            }
+            return i;
+        }
+
+        // Routine Description:
+        // - Finds the end of the non-ASCII text at the start of the given text,
+        //   which is where asciiBlock ASCII characters in a row begin.
+        // Arguments:
+        // - in - the text, starting with a non-ASCII character
+        // - count - the length of the text
+        // Return Value:
+        // - the length of the non-ASCII run, or count if it reaches the end
+        template<typename T>
+        size_t non_ascii_run(const T* const in, const size_t count) noexcept
+        {
+            using unsigned_type = std::make_unsigned_t<T>;
+            size_t i = 1;
+            while (count - i >= asciiBlock)
+            {
+                size_t ascii = 0;
+                while (ascii < asciiBlock && static_cast<unsigned_type>(in[i + ascii]) < 0x80)
+                {
+                    ++ascii;
+                }
+                if (ascii == asciiBlock)
+                {
+                    return i;
+                }
+                // Continue right after the non-ASCII character we found.
+                i += ascii + 1;
+            }
+            return count;
+        }
+
+        // Routine Description:
+        // - Converts complete UTF-8 text to UTF-16 like MultiByteToWideChar does.
+        // Arguments:
+        // - in - the UTF-8 text
+        // - len8 - the length of the text
+        // - out - receives the UTF-16 text
+        // - capa16 - the size of out, at least len8
+        // Return Value:
+        // - the number of UTF-16 code units written, or 0 if the conversion failed
+        inline int u8u16(const char* const in, const int len8, wchar_t* const out, const int capa16) noexcept
+        {
+            const auto count = gsl::narrow_cast<size_t>(len8);
+            size_t pos8 = 0;
+            size_t pos16 = 0;
+            while (pos8 < count)
+            {
+                const auto ascii = u8u16_ascii(in + pos8, count - pos8, out + pos16);
+                pos8 += ascii;
+                pos16 += ascii;
+                if (pos8 == count)
+                {
+                    break;
+                }
+
+                const auto run = non_ascii_run(in + pos8, count - pos8);
+                const auto converted = MultiByteToWideChar(CP_UTF8, 0UL, in + pos8, gsl::narrow_cast<int>(run), out + pos16, capa16 - gsl::narrow_cast<int>(pos16));
+                if (!converted)
+                {
+                    return 0;
+                }
+                pos8 += run;
+                pos16 += gsl::narrow_cast<size_t>(converted);
+            }
+            return gsl::narrow_cast<int>(pos16);
+        }
+
+        // Routine Description:
+        // - Converts complete UTF-16 text to UTF-8 like WideCharToMultiByte does.
+        // Arguments:
+        // - in - the UTF-16 text
+        // - len16 - the length of the text
+        // - out - receives the UTF-8 text
+        // - capa8 - the size of out, at least 3 times len16
+        // Return Value:
+        // - the number of UTF-8 code units written, or 0 if the conversion failed
+        inline int u16u8(const wchar_t* const in, const int len16, char* const out, const int capa8) noexcept
+        {
+            const auto count = gsl::narrow_cast<size_t>(len16);
+            size_t pos16 = 0;
+            size_t pos8 = 0;
+            while (pos16 < count)
+            {
+                const auto ascii = u16u8_ascii(in + pos16, count - pos16, out + pos8);
+                pos16 += ascii;
+                pos8 += ascii;
+                if (pos16 == count)
+                {
+                    break;
+                }
+
+                const auto run = non_ascii_run(in + pos16, count - pos16);
+                const auto converted = WideCharToMultiByte(CP_UTF8, 0UL, in + pos16, gsl::narrow_cast<int>(run), out + pos8, capa8 - gsl::narrow_cast<int>(pos8), nullptr, nullptr);
+                if (!converted)
+                {
+                    return 0;
+                }
+                pos16 += run;
+                pos8 += gsl::narrow_cast<size_t>(converted);
+            }
+            return gsl::narrow_cast<int>(pos8);
+        }
+
+        // Routine Description:
+        // - Makes the string at least the given size. Unlike resize, this
+        //   doesn't overwrite what's left over from an earlier conversion,
+        //   since the conversion is going to overwrite it anyway.
+        // Arguments:
+        // - out - the string to grow
+        // - size - the size it needs to have at least
+        template<class outT>
+        void grow(outT& out, const size_t size)
+        {
+            if (out.size() < size)
+            {
+                out.resize(size);
+            }
+        }
+#pragma warning(pop)
+    }
+
     // state structure for maintenance of UTF-8 partials
     struct u8state
     {
@@ -63,14 +283,17 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     {
         try
         {
-            out.clear();
-            RETURN_HR_IF(S_OK, in.empty());
+            if (in.empty())
+            {
+                out.clear();
+                return S_OK;
+            }
 
             int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
+            details::grow(out, in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
+            const int lengthOut = details::u8u16(in.data(), lengthRequired, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -97,14 +320,17 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     {
         try
         {
-            out.clear();
-            RETURN_HR_IF(S_OK, in.empty());
+            if (in.empty())
+            {
+                out.clear();
+                return S_OK;
+            }
 
             int capa16{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::CheckAdd(in.length(), state.have).AssignIfValid(&capa16));
 
-            out.resize(gsl::narrow_cast<size_t>(capa16));
+            details::grow(out, gsl::narrow_cast<size_t>(capa16));
             auto len8{ gsl::narrow_cast<int>(in.length()) };
             int len16{};
             auto cursor8{ in.data() };
@@ -158,7 +384,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
+                const auto convLen{ details::u8u16(cursor8, len8, out.data() + len16, capa16) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len16 += convLen;
@@ -187,8 +413,11 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     {
         try
         {
-            out.clear();
-            RETURN_HR_IF(S_OK, in.empty());
+            if (in.empty())
+            {
+                out.clear();
+                return S_OK;
+            }
 
             int lengthIn{};
             int lengthRequired{};
@@ -196,8 +425,8 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Code Points >U+FFFF: 2 UTF-16 code units --> 4 UTF-8 code units.
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
-            out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
+            details::grow(out, gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
+            const int lengthOut = details::u16u8(in.data(), lengthIn, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -224,15 +453,18 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     {
         try
         {
-            out.clear();
-            RETURN_HR_IF(S_OK, in.empty());
+            if (in.empty())
+            {
+                out.clear();
+                return S_OK;
+            }
 
             int len16{};
             int capa8{};
             // The worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&len16) || !base::CheckAdd(len16, gsl::narrow_cast<int>(state.partials[0]) != 0).AssignIfValid(&capa8) || !base::CheckMul(capa8, 3).AssignIfValid(&capa8));
 
-            out.resize(gsl::narrow_cast<size_t>(capa8));
+            details::grow(out, gsl::narrow_cast<size_t>(capa8));
             int len8{};
             auto cursor16{ in.data() };
             if (state.partials[0])
@@ -259,7 +491,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len16)
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
+                const auto convLen{ details::u16u8(cursor16, len16, out.data() + len8, capa8) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len8 += convLen;
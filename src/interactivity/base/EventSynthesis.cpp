@@ -44,8 +44,47 @@ static CodepointWidth GetQuickCharWidthLegacyForNumpadEventSynthesis(const wchar
     return CodepointWidth::Invalid;
 }
 
+// Routine Description:
+// - wraps the key events synthesized for a wchar_t as KeyEvents
+// Arguments:
+// - records - the key event records to wrap
+// Return Value:
+// - deque of KeyEvents with the same contents
+// Note:
+// - will throw exception on error
+static std::deque<std::unique_ptr<KeyEvent>> _ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
                                                                                          const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyEvents(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key events as if it was typed,
+// either using the keyboard or Alt + numpad if the keyboard layout
+// doesn't have a key for it
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to use for Alt + numpad
+// - keyEvents - the records of the key events are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
+                                                        const unsigned int codepage,
+                                                        std::vector<INPUT_RECORD>& keyEvents)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -65,13 +104,14 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
                 // It wasn't alphanumeric or determined to be wide by the old algorithm
                 // if VkKeyScanW fails (char is not in kbd layout), we must
                 // emulate the key being input through the numpad
-                return SynthesizeNumpadEvents(wch, codepage);
+                SynthesizeNumpadEvents(wch, codepage, keyEvents);
+                return;
             }
         }
         keyState = 0; // SynthesizeKeyboardEvents would rather get 0 than -1
     }
 
-    return SynthesizeKeyboardEvents(wch, keyState);
+    SynthesizeKeyboardEvents(wch, keyState, keyEvents);
 }
 
 // Routine Description:
@@ -84,33 +124,54 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardEvents(wch, keyState, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key events as if it was typed
+// using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the key and modifiers to type it with, as returned by VkKeyScanW
+// - keyEvents - the records of the key events are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch,
+                                                                 const short keyState,
+                                                                 std::vector<INPUT_RECORD>& keyEvents)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        keyEvents.push_back(KeyEvent{ true,
+                                      1ui16,
+                                      static_cast<WORD>(VK_MENU),
+                                      altScanCode,
+                                      UNICODE_NULL,
+                                      (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED) }
+                                .ToInputRecord());
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        keyEvents.push_back(KeyEvent{ true,
+                                      1ui16,
+                                      static_cast<WORD>(VK_SHIFT),
+                                      leftShiftScanCode,
+                                      UNICODE_NULL,
+                                      SHIFT_PRESSED }
+                                .ToInputRecord());
     }
 
     const auto vk = LOBYTE(keyState);
@@ -132,31 +193,31 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents.push_back(keyEvent.ToInputRecord());
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents.push_back(keyEvent.ToInputRecord());
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        keyEvents.push_back(KeyEvent{ false,
+                                      1ui16,
+                                      static_cast<WORD>(VK_MENU),
+                                      altScanCode,
+                                      UNICODE_NULL,
+                                      ENHANCED_KEY }
+                                .ToInputRecord());
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        keyEvents.push_back(KeyEvent{ false,
+                                      1ui16,
+                                      static_cast<WORD>(VK_SHIFT),
+                                      leftShiftScanCode,
+                                      UNICODE_NULL,
+                                      0 }
+                                .ToInputRecord());
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -171,15 +232,34 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadEvents(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into a series of key events as if it was typed
+// using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to convert the wchar_t to for the numpad
+// - keyEvents - the records of the key events are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch,
+                                                               const unsigned int codepage,
+                                                               std::vector<INPUT_RECORD>& keyEvents)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    keyEvents.push_back(KeyEvent{ true,
+                                  1ui16,
+                                  static_cast<WORD>(VK_MENU),
+                                  altScanCode,
+                                  UNICODE_NULL,
+                                  LEFT_ALT_PRESSED }
+                            .ToInputRecord());
 
     std::wstring wstr{ wch };
     const auto convertedChars = ConvertToA(codepage, wstr);
@@ -206,27 +286,29 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            keyEvents.push_back(KeyEvent{ true,
+                                          1ui16,
+                                          virtualKey,
+                                          virtualScanCode,
+                                          UNICODE_NULL,
+                                          LEFT_ALT_PRESSED }
+                                    .ToInputRecord());
+            keyEvents.push_back(KeyEvent{ false,
+                                          1ui16,
+                                          virtualKey,
+                                          virtualScanCode,
+                                          UNICODE_NULL,
+                                          LEFT_ALT_PRESSED }
+                                    .ToInputRecord());
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    keyEvents.push_back(KeyEvent{ false,
+                                  1ui16,
+                                  static_cast<WORD>(VK_MENU),
+                                  altScanCode,
+                                  wch,
+                                  0 }
+                            .ToInputRecord());
 }
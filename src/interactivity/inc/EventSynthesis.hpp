@@ -16,6 +16,7 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <vector>
 #include "../../types/inc/IInputEvent.hpp"
 
 namespace Microsoft::Console::Interactivity
@@ -26,4 +27,18 @@ namespace Microsoft::Console::Interactivity
                                                                    const short keyState);
 
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
+
+    // These append the records of the key events to the given vector instead,
+    // which saves allocating each of them when converting a lot of text.
+    void CharToKeyEvents(const wchar_t wch,
+                         const unsigned int codepage,
+                         std::vector<INPUT_RECORD>& keyEvents);
+
+    void SynthesizeKeyboardEvents(const wchar_t wch,
+                                  const short keyState,
+                                  std::vector<INPUT_RECORD>& keyEvents);
+
+    void SynthesizeNumpadEvents(const wchar_t wch,
+                                const unsigned int codepage,
+                                std::vector<INPUT_RECORD>& keyEvents);
 }
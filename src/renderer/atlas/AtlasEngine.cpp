@@ -427,6 +427,13 @@ void AtlasEngine::WaitUntilCanRender() noexcept
     }
 }
 
+[[nodiscard]] til::ticket_lock* AtlasEngine::GetSnapshotPaintLock() noexcept
+{
+    // ControlCore takes this lock before it reconfigures us directly,
+    // so we can be painted outside of the terminal lock.
+    return &_snapshotPaintLock;
+}
+
 [[nodiscard]] HRESULT AtlasEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
@@ -24,6 +24,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
         void WaitUntilCanRender() noexcept override;
+        [[nodiscard]] til::ticket_lock* GetSnapshotPaintLock() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
@@ -755,6 +756,9 @@ namespace Microsoft::Console::Render
             ApiInvalidations invalidations = ApiInvalidations::Device;
         } _api;
 
+        // Held by the renderer while it paints a frame from a snapshot.
+        til::ticket_lock _snapshotPaintLock;
+
 #undef ATLAS_POD_OPS
 #undef ATLAS_FLAG_OPS
     };
@@ -77,3 +77,13 @@ void RenderEngineBase::WaitUntilCanRender() noexcept
     // Throttle the render loop a bit by default (~60 FPS), improving throughput.
     Sleep(8);
 }
+
+// Method Description:
+// - By default, engines are painted while the console is locked, because
+//   the console is free to call into them directly while it holds the lock.
+// Return Value:
+// - nullptr, meaning that the engine can't be painted from a snapshot.
+[[nodiscard]] til::ticket_lock* RenderEngineBase::GetSnapshotPaintLock() noexcept
+{
+    return nullptr;
+}
@@ -0,0 +1,386 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "RenderSnapshot.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+RenderSnapshot::RenderSnapshot() :
+    _buffer{ std::make_unique<TextBuffer>(COORD{ 1, 1 }, TextAttribute{}, 0, _renderTarget) },
+    _bufferEndPosition{},
+    _cursorPosition{},
+    _cursorHeight{ 0 },
+    _cursorPixelWidth{ 0 },
+    _cursorStyle{ CursorType::Legacy },
+    _cursorColor{ INVALID_COLOR },
+    _cursorVisible{ false },
+    _cursorOn{ false },
+    _cursorDoubleWidth{ false },
+    _screenReversed{ false },
+    _gridLineDrawingAllowed{ false }
+{
+}
+
+// Routine Description:
+// - Copies the state the renderer needs for painting the given dirty areas out
+//   of the console. Must be called while the console is locked.
+// - The snapshot is reused from frame to frame, so that copying the rows
+//   doesn't have to allocate memory, unless the viewport got larger.
+// Arguments:
+// - data - the console to take the snapshot of
+// - dirtyAreas - the areas of the viewport that are about to be painted
+// Return Value:
+// - <none>
+void RenderSnapshot::Capture(IRenderData& data, const gsl::span<const til::rectangle> dirtyAreas)
+{
+    const auto view = data.GetViewport();
+    const auto top = view.Top();
+
+    // The snapshot only holds the rows of the viewport, with the top of the
+    // viewport being the first row, but every row is as wide as the buffer.
+    _viewport = Viewport::FromDimensions({ view.Left(), 0 }, view.Dimensions());
+
+    _bufferEndPosition = data.GetTextBufferEndPosition();
+    _bufferEndPosition.Y -= top;
+    _fontInfo = data.GetFontInfo();
+
+    _cursorPosition = data.GetCursorPosition();
+    _cursorPosition.Y -= top;
+    _cursorHeight = data.GetCursorHeight();
+    _cursorPixelWidth = data.GetCursorPixelWidth();
+    _cursorStyle = data.GetCursorStyle();
+    _cursorColor = data.GetCursorColor();
+    _cursorVisible = data.IsCursorVisible();
+    _cursorOn = data.IsCursorOn();
+    _cursorDoubleWidth = data.IsCursorDoubleWidth();
+
+    _screenReversed = data.IsScreenReversed();
+    _gridLineDrawingAllowed = data.IsGridLineDrawingAllowed();
+    _title = data.GetConsoleTitle();
+
+    _selectionRects = data.GetSelectionRects();
+    for (auto& rect : _selectionRects)
+    {
+        rect = Viewport::Offset(rect, { 0, gsl::narrow_cast<SHORT>(-top) });
+    }
+
+    _attributeColors.clear();
+    _hyperlinks.clear();
+    _defaultBrushColors = data.GetDefaultBrushColors();
+    _CaptureAttribute(data, _defaultBrushColors);
+
+    _CaptureRows(data, top, dirtyAreas);
+}
+
+// Routine Description:
+// - Copies the dirty rows of the viewport, along with the colors, hyperlinks
+//   and patterns they use. Only the line rendition of the other rows is
+//   copied, which is needed to place the cursor.
+// Arguments:
+// - data - the console to take the snapshot of
+// - top - the first row of the viewport in the buffer of the console
+// - dirtyAreas - the areas of the viewport that are about to be painted
+// Return Value:
+// - <none>
+void RenderSnapshot::_CaptureRows(IRenderData& data, const SHORT top, const gsl::span<const til::rectangle> dirtyAreas)
+{
+    const auto& source = data.GetTextBuffer();
+    const auto width = source.GetSize().Width();
+    const auto height = _viewport.Height();
+
+    const auto bufferSize = _buffer->GetSize();
+    if (bufferSize.Width() != width || bufferSize.Height() != height)
+    {
+        _buffer = std::make_unique<TextBuffer>(COORD{ width, height }, TextAttribute{}, 0, _renderTarget);
+    }
+
+    _dirtyRows.assign(height, false);
+    for (const auto& rect : dirtyAreas)
+    {
+        const auto begin = std::clamp<ptrdiff_t>(rect.top(), 0, height);
+        const auto end = std::clamp<ptrdiff_t>(rect.bottom(), 0, height);
+        std::fill(_dirtyRows.begin() + begin, _dirtyRows.begin() + end, true);
+    }
+
+    _patterns.clear();
+    for (SHORT row = 0; row < height; ++row)
+    {
+        const auto& sourceRow = source.GetRowByOffset(top + row);
+        auto& targetRow = _buffer->GetRowByOffset(row);
+
+        if (!_dirtyRows.at(row))
+        {
+            targetRow.SetLineRendition(sourceRow.GetLineRendition());
+            continue;
+        }
+
+        targetRow.CopyFrom(sourceRow);
+
+        for (const auto& run : std::as_const(targetRow).GetAttrRow().GetRuns())
+        {
+            _CaptureAttribute(data, run.value);
+        }
+
+        // Pattern ids are looked up by viewport row, but by buffer column.
+        for (auto& run : data.GetPatternIdRuns({ 0, row }, width))
+        {
+            _patterns.push_back({ row, std::move(run) });
+        }
+    }
+}
+
+// Routine Description:
+// - Remembers the colors of an attribute and the hyperlink it refers to.
+// Arguments:
+// - data - the console to take the snapshot of
+// - attr - an attribute used by one of the captured rows
+// Return Value:
+// - <none>
+void RenderSnapshot::_CaptureAttribute(IRenderData& data, const TextAttribute& attr)
+{
+    // Consecutive runs often share their attributes, so check the last one first.
+    if (!_attributeColors.empty() && _attributeColors.back().first == attr)
+    {
+        return;
+    }
+
+    const auto it = std::find_if(_attributeColors.begin(), _attributeColors.end(), [&](const auto& entry) {
+        return entry.first == attr;
+    });
+    if (it != _attributeColors.end())
+    {
+        return;
+    }
+
+    _attributeColors.emplace_back(attr, data.GetAttributeColors(attr));
+
+    if (attr.IsHyperlink())
+    {
+        const auto id = attr.GetHyperlinkId();
+        if (_hyperlinks.find(id) == _hyperlinks.end())
+        {
+            _hyperlinks.emplace(id, std::make_pair(data.GetHyperlinkUri(id), data.GetHyperlinkCustomId(id)));
+        }
+    }
+}
+
+#pragma region IBaseData
+
+Viewport RenderSnapshot::GetViewport() noexcept
+{
+    return _viewport;
+}
+
+COORD RenderSnapshot::GetTextBufferEndPosition() const noexcept
+{
+    return _bufferEndPosition;
+}
+
+const TextBuffer& RenderSnapshot::GetTextBuffer() noexcept
+{
+    return *_buffer;
+}
+
+const FontInfo& RenderSnapshot::GetFontInfo() noexcept
+{
+    return *_fontInfo;
+}
+
+// Method Description:
+// - Gets the colors of an attribute of the captured rows.
+// Arguments:
+// - attr - the attribute to look up
+// Return Value:
+// - the foreground and background color of the attribute. Attributes that
+//   weren't captured get the colors of the default attribute.
+std::pair<COLORREF, COLORREF> RenderSnapshot::GetAttributeColors(const TextAttribute& attr) const noexcept
+{
+    for (const auto& [captured, colors] : _attributeColors)
+    {
+        if (captured == attr)
+        {
+            return colors;
+        }
+    }
+    return _attributeColors.empty() ? std::pair<COLORREF, COLORREF>{} : _attributeColors.front().second;
+}
+
+std::vector<Viewport> RenderSnapshot::GetSelectionRects() noexcept
+try
+{
+    return _selectionRects;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+void RenderSnapshot::LockConsole() noexcept
+{
+    // The snapshot doesn't change while it's being painted. There's nothing to lock.
+}
+
+void RenderSnapshot::UnlockConsole() noexcept
+{
+}
+
+#pragma endregion
+
+#pragma region IRenderData
+
+const TextAttribute RenderSnapshot::GetDefaultBrushColors() noexcept
+{
+    return _defaultBrushColors;
+}
+
+COORD RenderSnapshot::GetCursorPosition() const noexcept
+{
+    return _cursorPosition;
+}
+
+bool RenderSnapshot::IsCursorVisible() const noexcept
+{
+    return _cursorVisible;
+}
+
+bool RenderSnapshot::IsCursorOn() const noexcept
+{
+    return _cursorOn;
+}
+
+ULONG RenderSnapshot::GetCursorHeight() const noexcept
+{
+    return _cursorHeight;
+}
+
+CursorType RenderSnapshot::GetCursorStyle() const noexcept
+{
+    return _cursorStyle;
+}
+
+ULONG RenderSnapshot::GetCursorPixelWidth() const noexcept
+{
+    return _cursorPixelWidth;
+}
+
+COLORREF RenderSnapshot::GetCursorColor() const noexcept
+{
+    return _cursorColor;
+}
+
+bool RenderSnapshot::IsCursorDoubleWidth() const
+{
+    return _cursorDoubleWidth;
+}
+
+bool RenderSnapshot::IsScreenReversed() const noexcept
+{
+    return _screenReversed;
+}
+
+const std::vector<RenderOverlay> RenderSnapshot::GetOverlays() const noexcept
+{
+    // Overlays refer to buffers of the console, which can't be painted outside
+    // of the console lock. The renderer doesn't take snapshots if there are any.
+    return {};
+}
+
+const bool RenderSnapshot::IsGridLineDrawingAllowed() noexcept
+{
+    return _gridLineDrawingAllowed;
+}
+
+const std::wstring_view RenderSnapshot::GetConsoleTitle() const noexcept
+{
+    return _title;
+}
+
+const std::wstring RenderSnapshot::GetHyperlinkUri(uint16_t id) const noexcept
+try
+{
+    const auto it = _hyperlinks.find(id);
+    return it != _hyperlinks.end() ? it->second.first : std::wstring{};
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+const std::wstring RenderSnapshot::GetHyperlinkCustomId(uint16_t id) const noexcept
+try
+{
+    const auto it = _hyperlinks.find(id);
+    return it != _hyperlinks.end() ? it->second.second : std::wstring{};
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+// Method Description:
+// - Gets the ids of the patterns at the given position of a captured row.
+// Arguments:
+// - location - the position, relative to the top of the viewport
+// Return Value:
+// - the ids of the patterns, if any
+const std::vector<size_t> RenderSnapshot::GetPatternId(const COORD location) const noexcept
+try
+{
+    // The runs are captured row by row, so they're sorted by their position.
+    // Find the first run that ends after the location.
+    const auto it = std::lower_bound(_patterns.begin(), _patterns.end(), location, [](const PatternRow& pattern, const COORD position) {
+        return std::tie(pattern.row, pattern.run.end) <= std::tie(position.Y, position.X);
+    });
+    if (it != _patterns.end() && it->row == location.Y && it->run.begin <= location.X)
+    {
+        return it->run.ids;
+    }
+    return {};
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+// Method Description:
+// - Gets the ids of the patterns in a range of cells of a captured row.
+// Arguments:
+// - location - the first cell of the range, relative to the top of the viewport
+// - length - the number of cells in the range
+// Return Value:
+// - the runs of cells that are part of the same patterns, from left to right
+const std::vector<PatternIdRun> RenderSnapshot::GetPatternIdRuns(const COORD location, const SHORT length) const noexcept
+try
+{
+    const auto end = gsl::narrow_cast<SHORT>(location.X + length);
+
+    auto it = std::lower_bound(_patterns.begin(), _patterns.end(), location.Y, [](const PatternRow& pattern, const SHORT row) {
+        return pattern.row < row;
+    });
+
+    std::vector<PatternIdRun> runs;
+    for (; it != _patterns.end() && it->row == location.Y; ++it)
+    {
+        if (it->run.end > location.X && it->run.begin < end)
+        {
+            runs.push_back({ std::max(it->run.begin, location.X), std::min(it->run.end, end), it->run.ids });
+        }
+    }
+    return runs;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+#pragma endregion
@@ -0,0 +1,112 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RenderSnapshot.hpp
+
+Abstract:
+- A copy of everything the renderer needs to paint the dirty parts of one frame.
+- It's captured while the console is locked, at the start of the frame. The
+  frame is then painted from the snapshot after the lock was released, so the
+  console can keep processing output while the frame is being drawn.
+- Only the dirty rows of the viewport are copied. Their coordinates are
+  relative to the top of the viewport: row 0 of the snapshot's buffer is the
+  first row of the viewport.
+
+--*/
+
+#pragma once
+
+#include "../inc/IRenderData.hpp"
+#include "../inc/DummyRenderTarget.hpp"
+#include "../inc/FontInfo.hpp"
+
+#include "../../buffer/out/textBuffer.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class RenderSnapshot final : public IRenderData
+    {
+    public:
+        RenderSnapshot();
+
+        void Capture(IRenderData& data, const gsl::span<const til::rectangle> dirtyAreas);
+
+#pragma region IBaseData
+        Microsoft::Console::Types::Viewport GetViewport() noexcept override;
+        COORD GetTextBufferEndPosition() const noexcept override;
+        const TextBuffer& GetTextBuffer() noexcept override;
+        const FontInfo& GetFontInfo() noexcept override;
+        std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
+
+        std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
+
+        void LockConsole() noexcept override;
+        void UnlockConsole() noexcept override;
+#pragma endregion
+
+#pragma region IRenderData
+        const TextAttribute GetDefaultBrushColors() noexcept override;
+
+        COORD GetCursorPosition() const noexcept override;
+        bool IsCursorVisible() const noexcept override;
+        bool IsCursorOn() const noexcept override;
+        ULONG GetCursorHeight() const noexcept override;
+        CursorType GetCursorStyle() const noexcept override;
+        ULONG GetCursorPixelWidth() const noexcept override;
+        COLORREF GetCursorColor() const noexcept override;
+        bool IsCursorDoubleWidth() const override;
+
+        bool IsScreenReversed() const noexcept override;
+
+        const std::vector<RenderOverlay> GetOverlays() const noexcept override;
+
+        const bool IsGridLineDrawingAllowed() noexcept override;
+        const std::wstring_view GetConsoleTitle() const noexcept override;
+
+        const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
+        const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
+
+        const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+        const std::vector<PatternIdRun> GetPatternIdRuns(const COORD location, const SHORT length) const noexcept override;
+#pragma endregion
+
+    private:
+        void _CaptureRows(IRenderData& data, const SHORT top, const gsl::span<const til::rectangle> dirtyAreas);
+        void _CaptureAttribute(IRenderData& data, const TextAttribute& attr);
+
+        // The pattern ids of the cells of a captured row.
+        struct PatternRow
+        {
+            SHORT row;
+            PatternIdRun run;
+        };
+
+        DummyRenderTarget _renderTarget;
+        std::unique_ptr<TextBuffer> _buffer;
+        Microsoft::Console::Types::Viewport _viewport;
+        COORD _bufferEndPosition;
+        std::optional<FontInfo> _fontInfo;
+
+        TextAttribute _defaultBrushColors;
+        std::vector<std::pair<TextAttribute, std::pair<COLORREF, COLORREF>>> _attributeColors;
+        std::unordered_map<uint16_t, std::pair<std::wstring, std::wstring>> _hyperlinks;
+        std::vector<PatternRow> _patterns;
+        std::vector<Microsoft::Console::Types::Viewport> _selectionRects;
+        std::vector<bool> _dirtyRows;
+        std::wstring _title;
+
+        COORD _cursorPosition;
+        ULONG _cursorHeight;
+        ULONG _cursorPixelWidth;
+        CursorType _cursorStyle;
+        COLORREF _cursorColor;
+        bool _cursorVisible;
+        bool _cursorOn;
+        bool _cursorDoubleWidth;
+
+        bool _screenReversed;
+        bool _gridLineDrawingAllowed;
+    };
+}
@@ -34,6 +34,7 @@ Renderer::Renderer(IRenderData* pData,
                    const size_t cEngines,
                    std::unique_ptr<IRenderThread> thread) :
     _pData(THROW_HR_IF_NULL(E_INVALIDARG, pData)),
+    _pFrameData(pData),
     _pThread{ std::move(thread) },
     _viewport{ pData->GetViewport() }
 {
@@ -114,6 +115,10 @@ try
         _pData->UnlockConsole();
     });
 
+    // If the previous frame was painted outside of the console lock, wait for
+    // it to finish and tell the engines what changed in the meantime.
+    _WaitForSnapshotPaint();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
@@ -129,6 +134,12 @@ try
         return S_OK;
     }
 
+    // These are declared ahead of EndPaint, so that they're held until the
+    // frame was presented, if the frame is painted from a snapshot.
+    std::unique_lock<til::ticket_lock> snapshotPaintLock;
+    std::unique_lock<til::ticket_lock> engineLock;
+    _pFrameData = _pData;
+
     auto endPaint = wil::scope_exit([&]() {
         LOG_IF_FAILED(pEngine->EndPaint());
 
@@ -141,8 +152,24 @@ try
         }
     });
 
+    // If the engine allows it, copy what it needs to paint the frame and let
+    // go of the console, so that output can be processed while we paint.
+    // Overlays are part of the console and can only be painted under its lock.
+    if (const auto pEngineLock = pEngine->GetSnapshotPaintLock(); pEngineLock && _pData->GetOverlays().empty())
+    {
+        gsl::span<const til::rectangle> dirtyAreas;
+        RETURN_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
+        _snapshot.Capture(*_pData, dirtyAreas);
+        _pFrameData = &_snapshot;
+
+        snapshotPaintLock = std::unique_lock{ _snapshotPaintLock };
+        engineLock = std::unique_lock{ *pEngineLock };
+        _paintingSnapshot = true;
+        unlock.reset();
+    }
+
     // A. Prep Colors
-    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pData->GetDefaultBrushColors(), false, true));
+    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pFrameData->GetDefaultBrushColors(), false, true));
 
     // B. Perform Scroll Operations
     RETURN_IF_FAILED(_PerformScrolling(pEngine));
@@ -177,6 +204,20 @@ try
     // Trigger out-of-lock presentation for renderers that can support it
     RETURN_IF_FAILED(pEngine->Present());
 
+    // Hand the invalidations that came in while we were painting to the engine
+    // right away, instead of holding them back until the next frame.
+    if (engineLock)
+    {
+        engineLock.unlock();
+        snapshotPaintLock.unlock();
+
+        _pData->LockConsole();
+        auto unlockAgain = wil::scope_exit([&]() {
+            _pData->UnlockConsole();
+        });
+        _WaitForSnapshotPaint();
+    }
+
     // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
 }
@@ -192,6 +233,95 @@ void Renderer::_NotifyPaintFrame()
     }
 }
 
+// Routine Description:
+// - Waits for a frame that's being painted from a snapshot, outside of the
+//   console lock, to finish. Then hands the invalidations that were held back
+//   in the meantime to the engines.
+// - Must be called while the console is locked, before calling into the engines.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_WaitForSnapshotPaint()
+{
+    if (!_paintingSnapshot)
+    {
+        return;
+    }
+
+    // The lock is only held for the duration of the paint. Acquiring it is how we wait.
+    _snapshotPaintLock.lock();
+    _snapshotPaintLock.unlock();
+
+    _paintingSnapshot = false;
+
+    for (const auto& invalidation : _deferredInvalidations)
+    {
+        _ApplyInvalidation(invalidation);
+    }
+    _deferredInvalidations.clear();
+}
+
+// Routine Description:
+// - Tells the engines about a change, unless a frame might still be painted
+//   from a snapshot. The invalidation is held back until the next frame then.
+// Arguments:
+// - invalidation - the change to tell the engines about
+// Return Value:
+// - <none>
+void Renderer::_Invalidate(Invalidation&& invalidation)
+{
+    if (_paintingSnapshot)
+    {
+        _deferredInvalidations.emplace_back(std::move(invalidation));
+    }
+    else
+    {
+        _ApplyInvalidation(invalidation);
+    }
+}
+
+// Routine Description:
+// - Tells all engines about a change.
+// Arguments:
+// - invalidation - the change to tell the engines about
+// Return Value:
+// - <none>
+void Renderer::_ApplyInvalidation(const Invalidation& invalidation)
+{
+    FOREACH_ENGINE(pEngine)
+    {
+        switch (invalidation.kind)
+        {
+        case Invalidation::Kind::System:
+            LOG_IF_FAILED(pEngine->InvalidateSystem(&invalidation.dirtyClient));
+            break;
+        case Invalidation::Kind::Region:
+            LOG_IF_FAILED(pEngine->Invalidate(&invalidation.region));
+            break;
+        case Invalidation::Kind::Cursor:
+            LOG_IF_FAILED(pEngine->InvalidateCursor(&invalidation.region));
+            break;
+        case Invalidation::Kind::Selection:
+            LOG_IF_FAILED(pEngine->InvalidateSelection(invalidation.rectangles));
+            break;
+        case Invalidation::Kind::Scroll:
+            LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.delta));
+            break;
+        case Invalidation::Kind::Viewport:
+            LOG_IF_FAILED(pEngine->UpdateViewport(invalidation.region));
+            LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.delta));
+            break;
+        case Invalidation::Kind::All:
+            LOG_IF_FAILED(pEngine->InvalidateAll());
+            break;
+        case Invalidation::Kind::Title:
+            LOG_IF_FAILED(pEngine->InvalidateTitle(invalidation.title));
+            break;
+        }
+    }
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -200,9 +330,11 @@ void Renderer::_NotifyPaintFrame()
 // - <none>
 void Renderer::TriggerSystemRedraw(const RECT* const prcDirtyClient)
 {
-    FOREACH_ENGINE(pEngine)
+    if (prcDirtyClient)
     {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
+        Invalidation invalidation{ Invalidation::Kind::System };
+        invalidation.dirtyClient = *prcDirtyClient;
+        _Invalidate(std::move(invalidation));
     }
 
     _NotifyPaintFrame();
@@ -234,10 +366,10 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        }
+
+        Invalidation invalidation{ Invalidation::Kind::Region };
+        invalidation.region = srUpdateRegion;
+        _Invalidate(std::move(invalidation));
 
         _NotifyPaintFrame();
     }
@@ -285,11 +417,9 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 
         if (cursorView.IsValid())
         {
-            const SMALL_RECT updateRect = view.ConvertToOrigin(cursorView).ToExclusive();
-            FOREACH_ENGINE(pEngine)
-            {
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateRect));
-            }
+            Invalidation invalidation{ Invalidation::Kind::Cursor };
+            invalidation.region = view.ConvertToOrigin(cursorView).ToExclusive();
+            _Invalidate(std::move(invalidation));
 
             _NotifyPaintFrame();
         }
@@ -305,10 +435,7 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll()
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
-    }
+    _Invalidate({ Invalidation::Kind::All });
 
     _NotifyPaintFrame();
 }
@@ -350,7 +477,7 @@ void Renderer::TriggerSelection()
     try
     {
         // Get selection rectangles
-        auto rects = _GetSelectionRects();
+        auto rects = _GetSelectionRects(*_pData);
 
         // Restrict all previous selection rectangles to inside the current viewport bounds
         for (auto& sr : _previousSelection)
@@ -368,11 +495,13 @@ void Renderer::TriggerSelection()
             sr = Viewport::FromInclusive(rc).ToExclusive();
         }
 
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        }
+        Invalidation previous{ Invalidation::Kind::Selection };
+        previous.rectangles = _previousSelection;
+        _Invalidate(std::move(previous));
+
+        Invalidation current{ Invalidation::Kind::Selection };
+        current.rectangles = rects;
+        _Invalidate(std::move(current));
 
         _previousSelection = std::move(rects);
 
@@ -403,11 +532,10 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.X = srOldViewport.Left - srNewViewport.Left;
     coordDelta.Y = srOldViewport.Top - srNewViewport.Top;
 
-    FOREACH_ENGINE(engine)
-    {
-        LOG_IF_FAILED(engine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(engine->InvalidateScroll(&coordDelta));
-    }
+    Invalidation invalidation{ Invalidation::Kind::Viewport };
+    invalidation.region = srNewViewport;
+    invalidation.delta = coordDelta;
+    _Invalidate(std::move(invalidation));
 
     _ScrollPreviousSelection(coordDelta);
     return true;
@@ -439,10 +567,9 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    }
+    Invalidation invalidation{ Invalidation::Kind::Scroll };
+    invalidation.delta = *pcoordDelta;
+    _Invalidate(std::move(invalidation));
 
     _ScrollPreviousSelection(*pcoordDelta);
 
@@ -458,7 +585,11 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 // - <none>
 void Renderer::TriggerCircling()
 {
-    const auto rects = _GetSelectionRects();
+    const auto rects = _GetSelectionRects(*_pData);
+
+    // The engines may want to paint the rows before they circle out of the
+    // buffer, so this can't be held back like the other invalidations.
+    _WaitForSnapshotPaint();
 
     FOREACH_ENGINE(pEngine)
     {
@@ -484,11 +615,9 @@ void Renderer::TriggerCircling()
 // - <none>
 void Renderer::TriggerTitleChange()
 {
-    const auto newTitle = _pData->GetConsoleTitle();
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
-    }
+    Invalidation invalidation{ Invalidation::Kind::Title };
+    invalidation.title = _pData->GetConsoleTitle();
+    _Invalidate(std::move(invalidation));
     _NotifyPaintFrame();
 }
 
@@ -500,7 +629,7 @@ void Renderer::TriggerTitleChange()
 // - the HRESULT of the underlying engine's UpdateTitle call.
 HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 {
-    const auto newTitle = _pData->GetConsoleTitle();
+    const auto newTitle = _pFrameData->GetConsoleTitle();
     return pEngine->UpdateTitle(newTitle);
 }
 
@@ -514,6 +643,8 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    _WaitForSnapshotPaint();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
@@ -537,6 +668,8 @@ void Renderer::UpdateSoftFont(const gsl::span<const uint16_t> bitPattern, const
     // that we test for in _IsSoftFontChar will depend on the size of the active
     // bitPattern. If it's empty (i.e. no soft font is set), then nothing will
     // match, and those code points will be treated the same as everything else.
+    _WaitForSnapshotPaint();
+
     const auto softFontCharCount = cellSize.cy ? bitPattern.size() / cellSize.cy : 0;
     _lastSoftFontChar = _firstSoftFontChar + softFontCharCount - 1;
 
@@ -570,6 +703,7 @@ bool Renderer::s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSo
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    _WaitForSnapshotPaint();
     FOREACH_ENGINE(pEngine)
     {
         const HRESULT hr = LOG_IF_FAILED(pEngine->GetProposedFont(FontInfoDesired, FontInfo, iDpi));
@@ -601,6 +735,7 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     //      renderer. We won't know which is which, so iterate over them.
     //      Only return the result of the successful one if it's not S_FALSE (which is the VT renderer)
     // TODO: 14560740 - The Window might be able to get at this info in a more sane manner
+    _WaitForSnapshotPaint();
     FOREACH_ENGINE(pEngine)
     {
         const HRESULT hr = LOG_IF_FAILED(pEngine->IsGlyphWideByFont(glyph, &fIsFullWidth));
@@ -662,7 +797,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
-    const auto view = _pData->GetViewport();
+    const auto view = _pFrameData->GetViewport();
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
@@ -694,7 +829,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         const auto redraw = Viewport::Intersect(dirty, view);
 
         // Retrieve the text buffer so we can read information out of it.
-        const auto& buffer = _pData->GetTextBuffer();
+        const auto& buffer = _pFrameData->GetTextBuffer();
 
         // Now walk through each row of text that we need to redraw.
         for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
@@ -715,8 +850,8 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - COORD{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            // Retrieve the runs of cells limited to just this line we want to redraw.
+            auto runs = buffer.GetRunsAt(bufferLine.Origin(), bufferLine);
 
             // Calculate if two things are true:
             // 1. this row wrapped
@@ -729,7 +864,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.Y, view.Left()));
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _PaintBufferOutputHelper(pEngine, runs, screenPosition, lineWrapped);
         }
     }
 }
@@ -741,152 +876,183 @@ static bool _IsAllSpaces(const std::wstring_view v)
 }
 
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        TextBufferRunIterator runs,
                                         const COORD target,
                                         const bool lineWrapped)
 {
-    auto globalInvert{ _pData->IsScreenReversed() };
+    // If we have no data, there's nothing to draw.
+    if (!runs)
+    {
+        return;
+    }
 
-    // If we have valid data, let's figure out how to draw it.
-    if (it)
+    const auto globalInvert{ _pFrameData->IsScreenReversed() };
+
+    // The columns of the buffer are where the runs are, the columns of the
+    // screen are where they're painted and where the patterns are.
+    const auto screenOffset = gsl::narrow_cast<SHORT>(target.X - runs.Begin());
+
+    // The runs of cells we get from the buffer share their attributes, so the
+    // attributes only have to be compared when we move on to the next run.
+    // They're cut into smaller runs wherever the patterns or the soft font usage
+    // change, which are checked for every cell.
+    // The patterns are retrieved for the whole line at once. Since neighboring
+    // pattern runs never share their ids, the index of the run is all we need to compare.
+    const auto patternRuns = _pFrameData->GetPatternIdRuns(target, gsl::narrow_cast<SHORT>(runs.Limit() - runs.Begin()));
+    size_t patternIndex = 0;
+    const auto patternRunAt = [&](const SHORT bufferColumn) noexcept {
+        const auto column = bufferColumn + screenOffset;
+        while (patternIndex < patternRuns.size() && til::at(patternRuns, patternIndex).end <= column)
+        {
+            ++patternIndex;
+        }
+        const auto inRun = patternIndex < patternRuns.size() && til::at(patternRuns, patternIndex).begin <= column;
+        return inRun ? patternIndex : patternRuns.size();
+    };
+
+    auto column = runs.Begin();
+
+    // Retrieve the first color.
+    auto color = runs.TextAttr();
+    // Whether the run we're in has a different color than the one we're painting with.
+    auto changedColor = false;
+    // Retrieve the first pattern run
+    auto patternRun = patternRunAt(column);
+    // Determine whether we're using a soft font.
+    auto usingSoftFont = s_IsSoftFontChar(runs.GlyphAt(column), _firstSoftFontChar, _lastSoftFontChar);
+
+    // This outer loop will continue until we reach the end of the text we are trying to draw.
+    while (runs)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        size_t cols = 0;
-
-        // Retrieve the first color.
-        auto color = it->TextAttr();
-        // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
-        // Determine whether we're using a soft font.
-        auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
+        // Hold onto the current run color right here for the length of the outer loop.
+        // We'll be changing the persistent one as we run through the inner loops to detect
+        // when a run changes, but we will still need to know this color at the bottom
+        // when we go to draw gridlines for the length of the run.
+        const auto currentRunColor = color;
+
+        // Update the drawing brushes with our color and font usage.
+        THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
+
+        // Hold onto the start of this run in case we need to do some special
+        // work to paint the line drawing characters.
+        const auto currentRunStart = column;
+        const auto currentRuns = runs;
 
         // And hold the point where we should start drawing.
-        auto screenPoint = target;
+        COORD screenPoint{ gsl::narrow_cast<SHORT>(column + screenOffset), target.Y };
+
+        // Ensure that our cluster vector is clear.
+        _clusterBuffer.clear();
+
+        // Reset our flag to know when we're in the special circumstance
+        // of attempting to draw only the right-half of a two-column character
+        // as the first item in our run.
+        bool trimLeft = false;
+
+        // Run contains wide character (>1 columns)
+        bool containsWideCharacter = false;
 
-        // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        // This inner loop will accumulate clusters until the color changes.
+        // When the color changes, it will save the new color off and break.
+        // We also accumulate clusters according to regex patterns
+        do
         {
-            // Hold onto the current run color right here for the length of the outer loop.
-            // We'll be changing the persistent one as we run through the inner loops to detect
-            // when a run changes, but we will still need to know this color at the bottom
-            // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
-
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
-            // Update the drawing brushes with our color and font usage.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
-
-            // Advance the point by however many columns we've just outputted and reset the accumulator.
-            screenPoint.X += gsl::narrow<SHORT>(cols);
-            cols = 0;
-
-            // Hold onto the start of this run iterator and the target location where we started
-            // in case we need to do some special work to paint the line drawing characters.
-            const auto currentRunItStart = it;
-            const auto currentRunTargetStart = screenPoint;
-
-            // Ensure that our cluster vector is clear.
-            _clusterBuffer.clear();
-
-            // Reset our flag to know when we're in the special circumstance
-            // of attempting to draw only the right-half of a two-column character
-            // as the first item in our run.
-            bool trimLeft = false;
-
-            // Run contains wide character (>1 columns)
-            bool containsWideCharacter = false;
-
-            // This inner loop will accumulate clusters until the color changes.
-            // When the color changes, it will save the new color off and break.
-            // We also accumulate clusters according to regex patterns
-            do
+            // Move on to the run that holds this cell. Two column glyphs can
+            // reach into the next run, whose first cell is skipped then.
+            while (runs && runs.End() <= column)
             {
-                COORD thisPoint{ screenPoint.X + gsl::narrow<SHORT>(cols), screenPoint.Y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
-                const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
-                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
-                if (color != it->TextAttr() || changedPatternOrFont)
-                {
-                    auto newAttr{ it->TextAttr() };
-                    // foreground doesn't matter for runs of spaces (!)
-                    // if we trick it . . . we call Paint far fewer times for cmatrix
-                    if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
-                    {
-                        color = newAttr;
-                        patternIds = thisPointPatterns;
-                        usingSoftFont = thisUsingSoftFont;
-                        break; // vend this run
-                    }
-                }
+                ++runs;
+                changedColor = runs && color != runs.TextAttr();
+            }
 
-                // Walk through the text data and turn it into rendering clusters.
-                // Keep the columnCount as we go to improve performance over digging it out of the vector at the end.
-                size_t columnCount = it->Columns();
+            if (!runs)
+            {
+                break;
+            }
 
-                // If we're on the first cluster to be added and it's marked as "trailing"
-                // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr().IsTrailing())
+            const auto glyph = runs.GlyphAt(column);
+            const auto thisPatternRun = patternRunAt(column);
+            const auto thisUsingSoftFont = s_IsSoftFontChar(glyph, _firstSoftFontChar, _lastSoftFontChar);
+            const auto changedPatternOrFont = patternRun != thisPatternRun || usingSoftFont != thisUsingSoftFont;
+            if (changedColor || changedPatternOrFont)
+            {
+                const auto& newAttr = runs.TextAttr();
+                // foreground doesn't matter for runs of spaces (!)
+                // if we trick it . . . we call Paint far fewer times for cmatrix
+                if (!_IsAllSpaces(glyph) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                 {
-                    // Move left to the one so the whole character can be struck correctly.
-                    --screenPoint.X;
-                    // And tell the next function to trim off the left half of it.
-                    trimLeft = true;
-                    // And add one to the number of columns we expect it to take as we insert it.
-                    ++columnCount;
+                    color = newAttr;
+                    changedColor = false;
+                    patternRun = thisPatternRun;
+                    usingSoftFont = thisUsingSoftFont;
+                    break; // vend this run
                 }
+            }
 
-                if (columnCount > 1)
-                {
-                    containsWideCharacter = true;
-                }
+            // Walk through the text data and turn it into rendering clusters.
+            const auto dbcsAttr = runs.DbcsAttrAt(column);
+            const auto advance = dbcsAttr.IsLeading() ? 2u : 1u;
+            size_t columnCount = advance;
 
-                // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
-                it += std::max<size_t>(it->Columns(), 1); // prevent infinite loop for no visible columns
-                cols += columnCount;
+            // If we're on the first cluster to be added and it's marked as "trailing"
+            // (a.k.a. the right half of a two column character), then we need some special handling.
+            if (_clusterBuffer.empty() && dbcsAttr.IsTrailing())
+            {
+                // Move left to the one so the whole character can be struck correctly.
+                --screenPoint.X;
+                // And tell the next function to trim off the left half of it.
+                trimLeft = true;
+                // And add one to the number of columns we expect it to take as we insert it.
+                ++columnCount;
+            }
 
-            } while (it);
+            if (columnCount > 1)
+            {
+                containsWideCharacter = true;
+            }
 
-            // Do the painting.
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
+            // Advance the cluster and the column.
+            _clusterBuffer.emplace_back(glyph, columnCount);
+            column = gsl::narrow_cast<SHORT>(column + advance);
 
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            // We're only allowed to draw the grid lines under certain circumstances.
-            if (_pData->IsGridLineDrawingAllowed())
+        } while (runs);
+
+        // Do the painting.
+        THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
+
+        // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+        // We're only allowed to draw the grid lines under certain circumstances.
+        if (_pFrameData->IsGridLineDrawingAllowed())
+        {
+            // See GH: 803
+            // If we found a wide character while we looped above, it's possible we skipped over the right half
+            // attribute that could have contained different line information than the left half.
+            if (containsWideCharacter)
             {
-                // See GH: 803
-                // If we found a wide character while we looped above, it's possible we skipped over the right half
-                // attribute that could have contained different line information than the left half.
-                if (containsWideCharacter)
+                // We need to go through the runs again to ensure we get the lines associated with each
+                // exact column. The code above will condense two-column characters into one, but it is possible
+                // (like with the IME) that the line drawing characters will vary from the left to right half
+                // of a wider character.
+                auto lineRuns = currentRuns;
+                for (auto lineColumn = currentRunStart; lineColumn < column; ++lineColumn)
                 {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
-                    // Start from the original target in this run.
-                    auto lineTarget = currentRunTargetStart;
-
-                    // We need to go through the iterators again to ensure we get the lines associated with each
-                    // exact column. The code above will condense two-column characters into one, but it is possible
-                    // (like with the IME) that the line drawing characters will vary from the left to right half
-                    // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (auto colsPainted = 0u; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.X)
+                    while (lineRuns && lineRuns.End() <= lineColumn)
                     {
-                        auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
+                        ++lineRuns;
                     }
+
+                    if (!lineRuns)
+                    {
+                        break;
+                    }
+
+                    _PaintBufferOutputGridLineHelper(pEngine, lineRuns.TextAttr(), 1, { gsl::narrow_cast<SHORT>(lineColumn + screenOffset), target.Y });
                 }
-                else
-                {
-                    // If nothing exciting is going on, draw the lines in bulk.
-                    _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
-                }
+            }
+            else
+            {
+                // If nothing exciting is going on, draw the lines in bulk.
+                _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, gsl::narrow_cast<size_t>(column - currentRunStart), screenPoint);
             }
         }
     }
@@ -973,7 +1139,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
         if (_hoveredInterval->start <= coordTargetTil &&
             coordTargetTil <= _hoveredInterval->stop)
         {
-            if (_pData->GetPatternId(coordTarget).size() > 0)
+            if (_pFrameData->GetPatternId(coordTarget).size() > 0)
             {
                 lines.set(IRenderEngine::GridLines::Underline);
             }
@@ -984,7 +1150,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
     if (lines.any())
     {
         // Get the current foreground color to render the lines.
-        const COLORREF rgb = _pData->GetAttributeColors(textAttribute).first;
+        const COLORREF rgb = _pFrameData->GetAttributeColors(textAttribute).first;
         // Draw the lines
         LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
     }
@@ -1002,10 +1168,10 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 // - nullopt if the cursor is off or out-of-frame, otherwise a CursorOptions
 [[nodiscard]] std::optional<CursorOptions> Renderer::_GetCursorInfo()
 {
-    if (_pData->IsCursorVisible())
+    if (_pFrameData->IsCursorVisible())
     {
         // Get cursor position in buffer
-        COORD coordCursor = _pData->GetCursorPosition();
+        COORD coordCursor = _pFrameData->GetCursorPosition();
 
         // GH#3166: Only draw the cursor if it's actually in the viewport. It
         // might be on the line that's in that partially visible row at the
@@ -1015,12 +1181,12 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 
         // The cursor is never rendered as double height, so we don't care about
         // the exact line rendition - only whether it's double width or not.
-        const auto doubleWidth = _pData->GetTextBuffer().IsDoubleWidthLine(coordCursor.Y);
+        const auto doubleWidth = _pFrameData->GetTextBuffer().IsDoubleWidthLine(coordCursor.Y);
         const auto lineRendition = doubleWidth ? LineRendition::DoubleWidth : LineRendition::SingleWidth;
 
         // We need to convert the screen coordinates of the viewport to an
         // equivalent range of buffer cells, taking line rendition into account.
-        const auto view = ScreenToBufferLine(_pData->GetViewport().ToInclusive(), lineRendition);
+        const auto view = ScreenToBufferLine(_pFrameData->GetViewport().ToInclusive(), lineRendition);
 
         // Note that we allow the X coordinate to be outside the left border by 1 position,
         // because the cursor could still be visible if the focused character is double width.
@@ -1032,21 +1198,21 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
             // The viewport X offset is saved in the options and handled with a transform.
             coordCursor.Y -= view.Top;
 
-            COLORREF cursorColor = _pData->GetCursorColor();
+            COLORREF cursorColor = _pFrameData->GetCursorColor();
             bool useColor = cursorColor != INVALID_COLOR;
 
             // Build up the cursor parameters including position, color, and drawing options
             CursorOptions options;
             options.coordCursor = coordCursor;
-            options.viewportLeft = _pData->GetViewport().Left();
+            options.viewportLeft = _pFrameData->GetViewport().Left();
             options.lineRendition = lineRendition;
-            options.ulCursorHeightPercent = _pData->GetCursorHeight();
-            options.cursorPixelWidth = _pData->GetCursorPixelWidth();
-            options.fIsDoubleWidth = _pData->IsCursorDoubleWidth();
-            options.cursorType = _pData->GetCursorStyle();
+            options.ulCursorHeightPercent = _pFrameData->GetCursorHeight();
+            options.cursorPixelWidth = _pFrameData->GetCursorPixelWidth();
+            options.fIsDoubleWidth = _pFrameData->IsCursorDoubleWidth();
+            options.cursorType = _pFrameData->GetCursorStyle();
             options.fUseColor = useColor;
             options.cursorColor = cursorColor;
-            options.isOn = _pData->IsCursorOn();
+            options.isOn = _pFrameData->IsCursorOn();
 
             return { options };
         }
@@ -1101,7 +1267,7 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
     try
     {
         // First get the screen buffer's viewport.
-        Viewport view = _pData->GetViewport();
+        Viewport view = _pFrameData->GetViewport();
 
         // Now get the overlay's viewport and adjust it to where it is supposed to be relative to the window.
 
@@ -1132,9 +1298,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                     const COORD target{ viewDirty.Left(), iRow };
                     const auto source = target - overlay.origin;
 
-                    auto it = overlay.buffer.GetCellLineDataAt(source);
+                    auto runs = overlay.buffer.GetRunsAt(source);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _PaintBufferOutputHelper(&engine, runs, target, false);
                 }
             }
         }
@@ -1154,7 +1320,7 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 {
     try
     {
-        const auto overlays = _pData->GetOverlays();
+        const auto overlays = _pFrameData->GetOverlays();
 
         for (const auto& overlay : overlays)
         {
@@ -1178,7 +1344,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
         LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
 
         // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
+        const auto rectangles = _GetSelectionRects(*_pFrameData);
         for (auto rect : rectangles)
         {
             for (auto& dirtyRect : dirtyAreas)
@@ -1216,7 +1382,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 {
     // The last color needs to be each engine's responsibility. If it's local to this function,
     //      then on the next engine we might not update the color.
-    return pEngine->UpdateDrawingBrushes(textAttributes, _pData, usingSoftFont, isSettingDefaultBrushes);
+    return pEngine->UpdateDrawingBrushes(textAttributes, _pFrameData, usingSoftFont, isSettingDefaultBrushes);
 }
 
 // Routine Description:
@@ -1236,12 +1402,12 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 // - Helper to determine the selected region of the buffer.
 // Return Value:
 // - A vector of rectangles representing the regions to select, line by line.
-std::vector<SMALL_RECT> Renderer::_GetSelectionRects() const
+std::vector<SMALL_RECT> Renderer::_GetSelectionRects(IRenderData& data) const
 {
-    const auto& buffer = _pData->GetTextBuffer();
-    auto rects = _pData->GetSelectionRects();
+    const auto& buffer = data.GetTextBuffer();
+    auto rects = data.GetSelectionRects();
     // Adjust rectangles to viewport
-    Viewport view = _pData->GetViewport();
+    Viewport view = data.GetViewport();
 
     std::vector<SMALL_RECT> result;
     result.reserve(rects.size());
@@ -1305,6 +1471,8 @@ void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pEngine);
 
+    _WaitForSnapshotPaint();
+
     for (auto& p : _engines)
     {
         if (!p)
@@ -1339,6 +1507,7 @@ void Renderer::ResetErrorStateAndResume()
 
 void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval>& newInterval)
 {
+    _WaitForSnapshotPaint();
     _hoveredInterval = newInterval;
 }
 
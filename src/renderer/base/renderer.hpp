@@ -21,6 +21,7 @@ Author(s):
 #include "../inc/IRenderData.hpp"
 
 #include "thread.hpp"
+#include "RenderSnapshot.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
@@ -79,15 +80,43 @@ namespace Microsoft::Console::Render
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
 
     private:
+        // A change that the engines need to be told about. While an engine is
+        // painted outside of the console lock, these are held back until the
+        // console is locked for the next frame.
+        struct Invalidation
+        {
+            enum class Kind
+            {
+                System,
+                Region,
+                Cursor,
+                Selection,
+                Scroll,
+                Viewport,
+                All,
+                Title
+            };
+
+            Kind kind;
+            RECT dirtyClient{};
+            SMALL_RECT region{};
+            COORD delta{};
+            std::vector<SMALL_RECT> rectangles;
+            std::wstring title;
+        };
+
         static IRenderEngine::GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         void _NotifyPaintFrame();
+        void _WaitForSnapshotPaint();
+        void _Invalidate(Invalidation&& invalidation);
+        void _ApplyInvalidation(const Invalidation& invalidation);
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
         bool _CheckViewportAndScroll();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const COORD target, const bool lineWrapped);
+        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferRunIterator runs, const COORD target, const bool lineWrapped);
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const COORD coordTarget);
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
         void _PaintCursor(_In_ IRenderEngine* const pEngine);
@@ -95,7 +124,7 @@ namespace Microsoft::Console::Render
         void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
         [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool usingSoftFont, const bool isSettingDefaultBrushes);
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
-        std::vector<SMALL_RECT> _GetSelectionRects() const;
+        std::vector<SMALL_RECT> _GetSelectionRects(IRenderData& data) const;
         void _ScrollPreviousSelection(const til::point delta);
         [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
         [[nodiscard]] std::optional<CursorOptions> _GetCursorInfo();
@@ -103,6 +132,7 @@ namespace Microsoft::Console::Render
 
         std::array<IRenderEngine*, 2> _engines{};
         IRenderData* _pData = nullptr; // Non-ownership pointer
+        IRenderData* _pFrameData = nullptr; // Either _pData or _snapshot, for the frame being painted
         std::unique_ptr<IRenderThread> _pThread;
         static constexpr size_t _firstSoftFontChar = 0xEF20;
         size_t _lastSoftFontChar = 0;
@@ -113,6 +143,14 @@ namespace Microsoft::Console::Render
         std::function<void()> _pfnRendererEnteredErrorState;
         bool _destructing = false;
 
+        // The engines that allow it are painted from this snapshot, after the
+        // console was unlocked. _snapshotPaintLock is held while doing so and
+        // _paintingSnapshot is only changed while the console is locked.
+        RenderSnapshot _snapshot;
+        til::ticket_lock _snapshotPaintLock;
+        bool _paintingSnapshot = false;
+        std::vector<Invalidation> _deferredInvalidations;
+
 #ifdef UNIT_TESTING
         friend class ConptyOutputTests;
 #endif
@@ -9,15 +9,49 @@
 
 using namespace Microsoft::Console::Render;
 
+// Routine Description:
+// - Arms a waitable timer to fire once, after the given time.
+// Arguments:
+// - timer - The timer to arm.
+// - duration - The time until it fires. Rounded up to the timer's 100ns units.
+// Return Value:
+// - false if the timer couldn't be set.
+static bool SetTimerToFireIn(const HANDLE timer, const std::chrono::steady_clock::duration duration) noexcept
+{
+    // Negative due times are relative, in 100ns intervals.
+    LARGE_INTEGER dueTime{};
+    dueTime.QuadPart = -std::max<LONGLONG>(std::chrono::ceil<std::chrono::duration<LONGLONG, std::ratio<1, 10'000'000>>>(duration).count(), 1);
+    if (!SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE))
+    {
+        LOG_LAST_ERROR();
+        return false;
+    }
+    return true;
+}
+
+// While output keeps requesting frames faster than we paint them, the next
+// frame is held back until no frame was requested for this long...
+static constexpr std::chrono::milliseconds CoalesceQuietPeriod{ 1 };
+// ...but no longer than this, so that the screen keeps updating during long bursts.
+static constexpr std::chrono::milliseconds MaximumCoalesceDelay{ 16 };
+
 RenderThread::RenderThread() :
     _pRenderer(nullptr),
     _hThread(nullptr),
     _hEvent(nullptr),
+    _hTimer(nullptr),
     _hPaintCompletedEvent(nullptr),
     _fKeepRunning(true),
     _hPaintEnabledEvent(nullptr),
     _fNextFrameRequested(false),
-    _fWaiting(false)
+    _fWaiting(false),
+    _minFrameInterval(0),
+    _lastFrameStart(),
+    _paintRequests(0),
+    _paintRequestsAtLastFrame(0),
+    _framesPainted(0),
+    _framesSkipped(0),
+    _paintTime(0)
 {
 }
 
@@ -39,6 +73,12 @@ RenderThread::~RenderThread()
         _hEvent = nullptr;
     }
 
+    if (_hTimer)
+    {
+        CloseHandle(_hTimer);
+        _hTimer = nullptr;
+    }
+
     if (_hPaintEnabledEvent)
     {
         CloseHandle(_hPaintEnabledEvent);
@@ -85,6 +125,27 @@ RenderThread::~RenderThread()
         }
     }
 
+    if (SUCCEEDED(hr))
+    {
+        // Output settles within a millisecond or two, which is below the
+        // resolution of a regular timer. High resolution timers are only
+        // available on 1803 and higher, so fall back to a regular one.
+        HANDLE hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (hTimer == nullptr)
+        {
+            hTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+
+        if (hTimer == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hTimer = hTimer;
+        }
+    }
+
     if (SUCCEEDED(hr))
     {
         HANDLE hPaintEnabledEvent = CreateEventW(nullptr,
@@ -170,8 +231,14 @@ DWORD WINAPI RenderThread::_ThreadProc()
     {
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
 
+        // If the next frame was already requested while we painted the
+        // previous one, output is coming in faster than we can paint it.
+        auto backlogged = true;
+
         if (!_fNextFrameRequested.exchange(false, std::memory_order_acq_rel))
         {
+            backlogged = false;
+
             // <--
             // If `NotifyPaint` is called at this point, then it will not
             // set the event because `_fWaiting` is not `true` yet so we have
@@ -209,8 +276,41 @@ DWORD WINAPI RenderThread::_ThreadProc()
 
         ResetEvent(_hPaintCompletedEvent);
 
+        // Don't paint intermediate states nobody gets to see.
+        if (backlogged)
+        {
+            _WaitForOutputToSettle();
+        }
+        _WaitForNextFrameTime();
+
+        // Painting might have been disabled while we were waiting.
+        // Keep the frame around until it's enabled again.
+        if (WaitForSingleObject(_hPaintEnabledEvent, 0) != WAIT_OBJECT_0)
+        {
+            _fNextFrameRequested.store(true, std::memory_order_release);
+            SetEvent(_hPaintCompletedEvent);
+            continue;
+        }
+
+        _lastFrameStart = std::chrono::steady_clock::now();
+
         _pRenderer->WaitUntilCanRender();
+
+        // All requests since the last frame are handled by this one. Every
+        // request beyond the first one would have been a frame of its own.
+        const auto paintRequests = _paintRequests.load(std::memory_order_relaxed);
+        if (paintRequests - _paintRequestsAtLastFrame > 1)
+        {
+            _framesSkipped.fetch_add(paintRequests - _paintRequestsAtLastFrame - 1, std::memory_order_relaxed);
+        }
+        _paintRequestsAtLastFrame = paintRequests;
+
+        const auto paintStart = std::chrono::steady_clock::now();
         LOG_IF_FAILED(_pRenderer->PaintFrame());
+        const auto paintTime = std::chrono::steady_clock::now() - paintStart;
+
+        _framesPainted.fetch_add(1, std::memory_order_relaxed);
+        _paintTime.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(paintTime).count(), std::memory_order_relaxed);
 
         SetEvent(_hPaintCompletedEvent);
     }
@@ -218,8 +318,76 @@ DWORD WINAPI RenderThread::_ThreadProc()
     return S_OK;
 }
 
+// Routine Description:
+// - Holds the next frame back while output keeps requesting frames. Returns
+//   once no frame was requested for a moment, or once we've waited long enough.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::_WaitForOutputToSettle()
+{
+    const auto deadline = std::chrono::steady_clock::now() + MaximumCoalesceDelay;
+    const std::array<HANDLE, 2> handles{ _hEvent, _hTimer };
+
+    // Have NotifyPaint signal the event, so that every request restarts the quiet period.
+    _fWaiting.store(true, std::memory_order_release);
+
+    while (_fKeepRunning)
+    {
+        const auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+        {
+            break;
+        }
+
+        const auto quietPeriod = std::min<std::chrono::steady_clock::duration>(CoalesceQuietPeriod, remaining);
+        if (!SetTimerToFireIn(_hTimer, quietPeriod))
+        {
+            break;
+        }
+
+        // If the timer fires first, no frame was requested for the whole quiet period.
+        if (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE) != WAIT_OBJECT_0)
+        {
+            break;
+        }
+    }
+
+    CancelWaitableTimer(_hTimer);
+    _fWaiting.store(false, std::memory_order_release);
+
+    // The requests we waited for are all handled by the coming frame.
+    _fNextFrameRequested.store(false, std::memory_order_release);
+    ResetEvent(_hEvent);
+}
+
+// Routine Description:
+// - Waits until the next frame may be painted, if the frame rate is limited.
+//   The requests that come in meanwhile are handled by that frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::_WaitForNextFrameTime()
+{
+    const std::chrono::steady_clock::duration interval{ _minFrameInterval.load(std::memory_order_relaxed) };
+    if (interval.count() == 0 || !_fKeepRunning)
+    {
+        return;
+    }
+
+    const auto remaining = _lastFrameStart + interval - std::chrono::steady_clock::now();
+    if (remaining > std::chrono::steady_clock::duration::zero() && SetTimerToFireIn(_hTimer, remaining))
+    {
+        WaitForSingleObject(_hTimer, INFINITE);
+    }
+}
+
 void RenderThread::NotifyPaint()
 {
+    _paintRequests.fetch_add(1, std::memory_order_relaxed);
+
     if (_fWaiting.load(std::memory_order_acquire))
     {
         SetEvent(_hEvent);
@@ -230,6 +398,36 @@ void RenderThread::NotifyPaint()
     }
 }
 
+// Method Description:
+// - Limits how many frames are painted per second. Frames that are requested
+//   sooner are painted once it's time for the next frame. The frame rate
+//   isn't limited by default, beyond what the render engines allow.
+// Arguments:
+// - framesPerSecond: the maximum frame rate, or 0 to paint as soon as the
+//      render engines allow.
+// Return Value:
+// - <none>
+void RenderThread::SetMaximumFrameRate(const unsigned int framesPerSecond) noexcept
+{
+    const auto interval = framesPerSecond ? std::chrono::steady_clock::duration{ std::chrono::seconds{ 1 } } / framesPerSecond : std::chrono::steady_clock::duration::zero();
+    _minFrameInterval.store(interval.count(), std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Gets the counters that tell how well the frames keep up with the output.
+// Arguments:
+// - <none>
+// Return Value:
+// - The frames painted and skipped so far, and the time spent painting them.
+RenderThread::FrameStatistics RenderThread::GetFrameStatistics() const noexcept
+{
+    return {
+        _framesPainted.load(std::memory_order_relaxed),
+        _framesSkipped.load(std::memory_order_relaxed),
+        std::chrono::microseconds{ _paintTime.load(std::memory_order_relaxed) }
+    };
+}
+
 void RenderThread::EnablePainting()
 {
     SetEvent(_hPaintEnabledEvent);
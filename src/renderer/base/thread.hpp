@@ -17,11 +17,22 @@ Author(s):
 #include "../inc/IRenderer.hpp"
 #include "../inc/IRenderThread.hpp"
 
+#include <chrono>
+
 namespace Microsoft::Console::Render
 {
     class RenderThread final : public IRenderThread
     {
     public:
+        // How many frames were painted, how many frame requests were folded
+        // into a later frame, and how long painting took altogether.
+        struct FrameStatistics
+        {
+            uint64_t framesPainted;
+            uint64_t framesSkipped;
+            std::chrono::microseconds paintTime;
+        };
+
         RenderThread();
         virtual ~RenderThread() override;
 
@@ -33,12 +44,19 @@ namespace Microsoft::Console::Render
         void DisablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
+        void SetMaximumFrameRate(const unsigned int framesPerSecond) noexcept;
+        FrameStatistics GetFrameStatistics() const noexcept;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
+        void _WaitForOutputToSettle();
+        void _WaitForNextFrameTime();
 
         HANDLE _hThread;
         HANDLE _hEvent;
+        // Times both the quiet period of the output and the frame rate limit.
+        HANDLE _hTimer;
 
         HANDLE _hPaintEnabledEvent;
         HANDLE _hPaintCompletedEvent;
@@ -48,5 +66,17 @@ namespace Microsoft::Console::Render
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+
+        // The minimum time between the start of two frames, 0 if the frame rate isn't limited.
+        std::atomic<std::chrono::steady_clock::duration::rep> _minFrameInterval;
+        std::chrono::steady_clock::time_point _lastFrameStart;
+
+        // Counts the calls to NotifyPaint, to tell if output is still coming in.
+        std::atomic<uint64_t> _paintRequests;
+        uint64_t _paintRequestsAtLastFrame;
+
+        std::atomic<uint64_t> _framesPainted;
+        std::atomic<uint64_t> _framesSkipped;
+        std::atomic<std::chrono::microseconds::rep> _paintTime;
     };
 }
@@ -1510,6 +1510,20 @@ void DxEngine::WaitUntilCanRender() noexcept
     }
 }
 
+// Routine Description:
+// - Gets the lock the renderer holds while it paints us from a snapshot.
+//   We only ever get our frame data from the renderer, so we can be painted
+//   outside of the console lock. Whoever calls us directly instead of going
+//   through the renderer (ControlCore, HwndTerminal) has to take this lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - The lock the renderer holds while painting outside of the console lock.
+[[nodiscard]] til::ticket_lock* DxEngine::GetSnapshotPaintLock() noexcept
+{
+    return &_snapshotPaintLock;
+}
+
 // Routine Description:
 // - Takes queued drawing information and presents it to the screen.
 // - This is separated out so it can be done outside the lock as it's expensive.
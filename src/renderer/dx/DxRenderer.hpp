@@ -88,6 +88,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
 
         void WaitUntilCanRender() noexcept override;
+        [[nodiscard]] til::ticket_lock* GetSnapshotPaintLock() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
 
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
@@ -156,6 +157,10 @@ namespace Microsoft::Console::Render
         std::function<void()> _pfn;
         std::function<void(const HRESULT)> _pfnWarningCallback;
 
+        // Held by the renderer while it paints us from a snapshot, outside of
+        // the console lock. Our hosts take it before they reconfigure us.
+        til::ticket_lock _snapshotPaintLock;
+
         bool _isEnabled;
         bool _isPainting;
 
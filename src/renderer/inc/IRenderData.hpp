@@ -37,6 +37,20 @@ namespace Microsoft::Console::Render
         const Microsoft::Console::Types::Viewport region;
     };
 
+    // The ids of the regex patterns that a range of cells within a row is part of.
+    // Neighboring runs never have the same ids, they'd be a single run instead.
+    struct PatternIdRun final
+    {
+        // The first column of the range
+        SHORT begin;
+
+        // The column past the last column of the range
+        SHORT end;
+
+        // The ids of the patterns, in ascending order
+        std::vector<size_t> ids;
+    };
+
     class IRenderData : public Microsoft::Console::Types::IBaseData
     {
     public:
@@ -68,6 +82,7 @@ namespace Microsoft::Console::Render
         virtual const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept = 0;
 
         virtual const std::vector<size_t> GetPatternId(const COORD location) const noexcept = 0;
+        virtual const std::vector<PatternIdRun> GetPatternIdRuns(const COORD location, const SHORT length) const noexcept = 0;
 
     protected:
         IRenderData() = default;
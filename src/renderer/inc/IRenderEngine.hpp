@@ -22,6 +22,8 @@ Author(s):
 #include "IRenderData.hpp"
 #include "../../buffer/out/LineRendition.hpp"
 
+#include <til/ticket_lock.h>
+
 #pragma warning(push)
 #pragma warning(disable : 4100) // '...': unreferenced formal parameter
 namespace Microsoft::Console::Render
@@ -57,6 +59,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT EndPaint() noexcept = 0;
         [[nodiscard]] virtual bool RequiresContinuousRedraw() noexcept = 0;
         virtual void WaitUntilCanRender() noexcept = 0;
+        [[nodiscard]] virtual til::ticket_lock* GetSnapshotPaintLock() noexcept = 0;
         [[nodiscard]] virtual HRESULT Present() noexcept = 0;
         [[nodiscard]] virtual HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept = 0;
         [[nodiscard]] virtual HRESULT ScrollFrame() noexcept = 0;
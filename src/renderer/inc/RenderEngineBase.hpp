@@ -53,6 +53,8 @@ namespace Microsoft::Console::Render
 
         void WaitUntilCanRender() noexcept override;
 
+        [[nodiscard]] til::ticket_lock* GetSnapshotPaintLock() noexcept override;
+
     protected:
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept = 0;
 
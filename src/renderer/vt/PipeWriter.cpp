@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "PipeWriter.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a new writer for the given pipe. The thread that writes to the
+//   pipe is started once there's something to write.
+// Arguments:
+// - pipe: The pipe to write to. It's owned by the caller and has to outlive us.
+PipeWriter::PipeWriter(const HANDLE pipe) noexcept :
+    _pipe{ pipe }
+{
+}
+
+// Routine Description:
+// - Stops the writing thread. Output that wasn't written yet is discarded,
+//   use Drain first to make sure it's written.
+PipeWriter::~PipeWriter()
+{
+    {
+        const std::lock_guard lock{ _mutex };
+        _shutdown = true;
+    }
+    _queued.notify_all();
+
+    if (_thread.joinable())
+    {
+        // The thread might be blocked in a write to a terminal that doesn't
+        // read anymore. Keep cancelling the write until the thread is gone.
+        while (WaitForSingleObject(_thread.native_handle(), 10) == WAIT_TIMEOUT)
+        {
+            CancelSynchronousIo(_thread.native_handle());
+        }
+        _thread.join();
+    }
+}
+
+// Routine Description:
+// - Queues the contents of the given buffer to be written to the pipe. This
+//   only blocks if the terminal has fallen so far behind that more than
+//   MaximumQueuedBytes are queued, or once Drain was called.
+// - The buffer's contents are moved into the queue without copying them,
+//   unless the queue is full, in which case they're appended to the last
+//   queued frame. The buffer is cleared either way.
+// Arguments:
+// - buffer: The output to write. Receives an empty buffer in return.
+// Return Value:
+// - S_OK, or the error that writing to the pipe failed with earlier.
+[[nodiscard]] HRESULT PipeWriter::Write(std::string& buffer) noexcept
+try
+{
+    if (buffer.empty())
+    {
+        return S_OK;
+    }
+
+    std::unique_lock lock{ _mutex };
+    RETURN_IF_FAILED(_error);
+
+    if (!_thread.joinable())
+    {
+        RETURN_IF_FAILED(_StartThread());
+    }
+
+    _written.wait(lock, [&]() { return _queuedBytes < MaximumQueuedBytes || FAILED(_error); });
+    RETURN_IF_FAILED(_error);
+
+    const auto size = buffer.size();
+    if (_count < QueueCapacity)
+    {
+        // The free slot is empty, but kept the capacity of the frame it held
+        // before. Swap it in, so that the caller can reuse that capacity.
+        auto& slot = til::at(_queue, (_head + _count) % QueueCapacity);
+        slot.swap(buffer);
+        ++_count;
+    }
+    else
+    {
+        // The queue is full, because the terminal doesn't keep up. Write this
+        // along with the last queued frame. The oldest frame is being written,
+        // so it's never the one we merge into.
+        til::at(_queue, (_head + _count - 1) % QueueCapacity).append(buffer);
+        buffer.clear();
+        ++_merges;
+    }
+
+    _queuedBytes += size;
+    _peakQueuedBytes = std::max(_peakQueuedBytes, _queuedBytes);
+    _queued.notify_one();
+
+    if (_synchronous)
+    {
+        _written.wait(lock, [&]() { return _count == 0 || FAILED(_error); });
+        RETURN_IF_FAILED(_error);
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Waits until the terminal caught up with the output, meaning that no more
+//   than BackpressureThreshold bytes are queued.
+// Arguments:
+// - timeout: How long to wait at most.
+// Return Value:
+// - true if the terminal caught up, false if we ran out of time.
+bool PipeWriter::WaitUntilWritable(const std::chrono::milliseconds timeout) noexcept
+try
+{
+    std::unique_lock lock{ _mutex };
+    return _written.wait_for(lock, timeout, [&]() { return _queuedBytes <= BackpressureThreshold || FAILED(_error); });
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+// Routine Description:
+// - Waits until everything that's queued was written. Every later Write waits
+//   for its output to be written as well. Used when we're about to exit, and
+//   have to get our last frame out before we do.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or the error that writing to the pipe failed with.
+[[nodiscard]] HRESULT PipeWriter::Drain() noexcept
+try
+{
+    std::unique_lock lock{ _mutex };
+    _synchronous = true;
+    _written.wait(lock, [&]() { return _count == 0 || FAILED(_error); });
+    return _error;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Gets the counters that tell how well the terminal keeps up with us.
+// Arguments:
+// - <none>
+// Return Value:
+// - The bytes written so far and the number of writes they took, the number of
+//   frames that were merged into a queued frame, and the bytes that are queued
+//   now and were queued at most.
+PipeWriter::Statistics PipeWriter::GetStatistics() const noexcept
+{
+    const std::lock_guard lock{ _mutex };
+    return { _bytesWritten, _writes, _merges, _queuedBytes, _peakQueuedBytes };
+}
+
+// Routine Description:
+// - Starts the thread that writes to the pipe. Must be called with the
+//   _mutex held.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or an appropriate HRESULT if the thread couldn't be started.
+[[nodiscard]] HRESULT PipeWriter::_StartThread() noexcept
+try
+{
+    _thread = std::thread{ [this]() { _ThreadProc(); } };
+
+    // SetThreadDescription only works on 1607 and higher. If we cannot find it,
+    // then it's no big deal. Just skip setting the description.
+    auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
+    if (func)
+    {
+        LOG_IF_FAILED(func(_thread.native_handle(), L"VT Output Thread"));
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Writes the queued frames to the pipe, oldest first, until we're shut down
+//   or writing fails.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void PipeWriter::_ThreadProc() noexcept
+{
+    std::unique_lock lock{ _mutex };
+
+    for (;;)
+    {
+        _queued.wait(lock, [&]() { return _count != 0 || _shutdown; });
+        if (_shutdown)
+        {
+            break;
+        }
+
+        // Nobody else touches the oldest frame while it's queued, so it can
+        // be written without holding the lock.
+        auto& frame = til::at(_queue, _head);
+        lock.unlock();
+        const auto succeeded = !!WriteFile(_pipe, frame.data(), gsl::narrow_cast<DWORD>(frame.size()), nullptr, nullptr);
+        const auto error = succeeded ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+        lock.lock();
+
+        if (succeeded)
+        {
+            _bytesWritten += frame.size();
+            ++_writes;
+        }
+        _queuedBytes -= frame.size();
+        frame.clear();
+        _head = (_head + 1) % QueueCapacity;
+        --_count;
+
+        if (FAILED(error))
+        {
+            // Nobody's going to read the rest. Let the writers find out.
+            _error = error;
+            for (auto& queued : _queue)
+            {
+                queued.clear();
+            }
+            _count = 0;
+            _queuedBytes = 0;
+        }
+
+        _written.notify_all();
+
+        if (FAILED(error))
+        {
+            break;
+        }
+    }
+}
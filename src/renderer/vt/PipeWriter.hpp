@@ -0,0 +1,95 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PipeWriter.hpp
+
+Abstract:
+- Writes the output of the VT renderer to the pipe on a thread of its own, so
+  that a terminal that doesn't read its output fast enough doesn't block the
+  thread that produced it.
+- Frames are queued in a small ring of buffers. When the ring is full, new
+  frames are merged into the last queued one instead. Once too much is queued,
+  WaitUntilWritable lets the renderer hold its next frame back, so that a slow
+  terminal gets fewer (but larger) frames.
+--*/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Microsoft::Console::Render
+{
+    class PipeWriter
+    {
+    public:
+        // How much output was written, and how much had to wait for the pipe.
+        struct Statistics
+        {
+            uint64_t bytesWritten;
+            uint64_t writes;
+            uint64_t merges;
+            size_t queuedBytes;
+            size_t peakQueuedBytes;
+        };
+
+        // The number of frames that can be queued before new ones are merged
+        // into the last queued frame.
+        static constexpr size_t QueueCapacity = 4;
+
+        // WaitUntilWritable waits until no more than this is queued.
+        static constexpr size_t BackpressureThreshold = 128 * 1024;
+
+        // Write blocks until no more than this is queued. This only bounds our
+        // memory usage for output that isn't paced by the renderer.
+        static constexpr size_t MaximumQueuedBytes = 16 * 1024 * 1024;
+
+        explicit PipeWriter(const HANDLE pipe) noexcept;
+        ~PipeWriter();
+
+        PipeWriter(const PipeWriter&) = delete;
+        PipeWriter(PipeWriter&&) = delete;
+        PipeWriter& operator=(const PipeWriter&) = delete;
+        PipeWriter& operator=(PipeWriter&&) = delete;
+
+        [[nodiscard]] HRESULT Write(std::string& buffer) noexcept;
+        bool WaitUntilWritable(const std::chrono::milliseconds timeout) noexcept;
+        [[nodiscard]] HRESULT Drain() noexcept;
+        Statistics GetStatistics() const noexcept;
+
+    private:
+        void _ThreadProc() noexcept;
+        [[nodiscard]] HRESULT _StartThread() noexcept;
+
+        HANDLE _pipe;
+        std::thread _thread;
+
+        mutable std::mutex _mutex;
+        // Signalled when a frame was queued, or when we're shutting down.
+        std::condition_variable _queued;
+        // Signalled when a frame was written, or when writing failed.
+        std::condition_variable _written;
+
+        // The queued frames, oldest first, starting at _head. The oldest one
+        // is the one that's being written to the pipe.
+        std::array<std::string, QueueCapacity> _queue;
+        size_t _head{ 0 };
+        size_t _count{ 0 };
+        size_t _queuedBytes{ 0 };
+
+        bool _synchronous{ false };
+        bool _shutdown{ false };
+        HRESULT _error{ S_OK };
+
+        uint64_t _bytesWritten{ 0 };
+        uint64_t _writes{ 0 };
+        uint64_t _merges{ 0 };
+        size_t _peakQueuedBytes{ 0 };
+    };
+}
@@ -30,107 +30,242 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
                                                            const bool /*usingSoftFont*/,
                                                            const bool /*isSettingDefaultBrushes*/) noexcept
 {
-    RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
-
-    RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
-
     // Only do extended attributes in xterm-256color, as to not break telnet.exe.
-    return _UpdateExtendedAttrs(textAttributes);
+    // They're sent in the same sequence as the colors.
+    RETURN_IF_FAILED(_UpdateRendition(textAttributes));
+
+    return _UpdateHyperlinkAttr(textAttributes, pData);
 }
 
 // Routine Description:
-// - Write a VT sequence to update the character rendition attributes.
+// - Write a VT sequence to change the colors and the character rendition
+//      attributes (bold, italic, underline, etc.) of text, all at once.
+// - The sequence either changes only the parameters that differ from the
+//      last attributes, or resets everything and sets what's needed again,
+//      whichever is shorter. Programs tend to switch between the same few
+//      attributes over and over again (think syntax highlighting), so the
+//      sequences for the last few changes are cached.
 // Arguments:
-// - textAttributes - text attributes (bold, italic, underline, etc.) to use.
+// - textAttributes - Text attributes to use for the colors and character rendition
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT Xterm256Engine::_UpdateExtendedAttrs(const TextAttribute& textAttributes) noexcept
+[[nodiscard]] HRESULT Xterm256Engine::_UpdateRendition(const TextAttribute& textAttributes) noexcept
+try
 {
-    // Turning off Bold and Faint must be handled at the same time,
-    // since there is only one sequence that resets both of them.
-    const auto boldTurnedOff = !textAttributes.IsBold() && _lastTextAttributes.IsBold();
-    const auto faintTurnedOff = !textAttributes.IsFaint() && _lastTextAttributes.IsFaint();
-    if (boldTurnedOff || faintTurnedOff)
+    const auto from = _RenditionOf(_lastTextAttributes);
+    const auto to = _RenditionOf(textAttributes);
+    if (from == to)
+    {
+        return S_OK;
+    }
+
+    // Unused cache entries go from and to the same attributes, so they never
+    // match, since we've already returned in that case.
+    auto change = std::find_if(_renditionCache.begin(), _renditionCache.end(), [&](const auto& entry) {
+        return entry.from == from && entry.to == to;
+    });
+    if (change == _renditionCache.end())
     {
-        RETURN_IF_FAILED(_SetBold(false));
-        _lastTextAttributes.SetBold(false);
-        _lastTextAttributes.SetFaint(false);
+        change = _renditionCache.begin() + gsl::narrow_cast<ptrdiff_t>(_nextRenditionCacheEntry);
+        _nextRenditionCacheEntry = (_nextRenditionCacheEntry + 1) % _renditionCache.size();
+
+        change->from = from;
+        change->to = to;
+        _EncodeRendition(from, to, change->sequence);
     }
 
-    // Once we've handled the cases where they need to be turned off,
+    RETURN_IF_FAILED(_Write(change->sequence));
+
+    // SGR sequences (even a reset) don't affect the hyperlink.
+    const auto hyperlinkId = _lastTextAttributes.GetHyperlinkId();
+    _lastTextAttributes = to;
+    _lastTextAttributes.SetHyperlinkId(hyperlinkId);
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Gets the parts of the given attributes that SGR sequences can change. The
+//      attributes also hold things we don't send to the terminal with them,
+//      like the hyperlink and the grid lines.
+// Arguments:
+// - textAttributes - The attributes to take the rendition of.
+// Return Value:
+// - The colors and rendition attributes of textAttributes, and nothing else.
+TextAttribute Xterm256Engine::_RenditionOf(const TextAttribute& textAttributes) noexcept
+{
+    TextAttribute rendition;
+    rendition.SetForeground(textAttributes.GetForeground());
+    rendition.SetBackground(textAttributes.GetBackground());
+    rendition.SetBold(textAttributes.IsBold());
+    rendition.SetFaint(textAttributes.IsFaint());
+    rendition.SetUnderlined(textAttributes.IsUnderlined());
+    rendition.SetDoublyUnderlined(textAttributes.IsDoublyUnderlined());
+    rendition.SetOverlined(textAttributes.IsOverlined());
+    rendition.SetItalic(textAttributes.IsItalic());
+    rendition.SetBlinking(textAttributes.IsBlinking());
+    rendition.SetInvisible(textAttributes.IsInvisible());
+    rendition.SetCrossedOut(textAttributes.IsCrossedOut());
+    rendition.SetReverseVideo(textAttributes.IsReverseVideo());
+    return rendition;
+}
+
+// Routine Description:
+// - Builds the shortest single SGR sequence that changes the rendition of the
+//      text from one set of attributes to another. That's either a sequence of
+//      the parameters that changed, or a reset followed by the parameters that
+//      aren't the default.
+// Arguments:
+// - from - The rendition the terminal uses right now.
+// - to - The rendition we want the terminal to use.
+// - sequence - Receives the SGR sequence.
+// Return Value:
+// - <none>
+void Xterm256Engine::_EncodeRendition(const TextAttribute& from, const TextAttribute& to, std::string& sequence)
+{
+    std::string changed;
+    std::string reset;
+    const auto append = [](std::string& parameters, const int parameter) {
+        fmt::format_to(std::back_inserter(parameters), FMT_COMPILE("{};"), parameter);
+    };
+
+    // Turning off Bold and Faint must be handled at the same time, since
+    // there is only one parameter that resets both of them. Once that's done,
     // we can then check if either should be turned back on again.
-    if (textAttributes.IsBold() && !_lastTextAttributes.IsBold())
+    const auto boldOrFaintTurnedOff = (from.IsBold() && !to.IsBold()) || (from.IsFaint() && !to.IsFaint());
+    if (boldOrFaintTurnedOff)
     {
-        RETURN_IF_FAILED(_SetBold(true));
-        _lastTextAttributes.SetBold(true);
+        append(changed, 22);
     }
-    if (textAttributes.IsFaint() && !_lastTextAttributes.IsFaint())
+    if (to.IsBold() && (boldOrFaintTurnedOff || !from.IsBold()))
     {
-        RETURN_IF_FAILED(_SetFaint(true));
-        _lastTextAttributes.SetFaint(true);
+        append(changed, 1);
     }
-
-    // Turning off the underline styles must be handled at the same time,
-    // since there is only one sequence that resets both of them.
-    const auto singleTurnedOff = !textAttributes.IsUnderlined() && _lastTextAttributes.IsUnderlined();
-    const auto doubleTurnedOff = !textAttributes.IsDoublyUnderlined() && _lastTextAttributes.IsDoublyUnderlined();
-    if (singleTurnedOff || doubleTurnedOff)
+    if (to.IsFaint() && (boldOrFaintTurnedOff || !from.IsFaint()))
     {
-        RETURN_IF_FAILED(_SetUnderlined(false));
-        _lastTextAttributes.SetUnderlined(false);
-        _lastTextAttributes.SetDoublyUnderlined(false);
+        append(changed, 2);
     }
 
-    // Once we've handled the cases where they need to be turned off,
-    // we can then check if either should be turned back on again.
-    if (textAttributes.IsUnderlined() && !_lastTextAttributes.IsUnderlined())
+    // The same goes for the two underline styles.
+    const auto underlineTurnedOff = (from.IsUnderlined() && !to.IsUnderlined()) || (from.IsDoublyUnderlined() && !to.IsDoublyUnderlined());
+    if (underlineTurnedOff)
     {
-        RETURN_IF_FAILED(_SetUnderlined(true));
-        _lastTextAttributes.SetUnderlined(true);
+        append(changed, 24);
     }
-    if (textAttributes.IsDoublyUnderlined() && !_lastTextAttributes.IsDoublyUnderlined())
+    if (to.IsUnderlined() && (underlineTurnedOff || !from.IsUnderlined()))
     {
-        RETURN_IF_FAILED(_SetDoublyUnderlined(true));
-        _lastTextAttributes.SetDoublyUnderlined(true);
+        append(changed, 4);
     }
-
-    if (textAttributes.IsOverlined() != _lastTextAttributes.IsOverlined())
+    if (to.IsDoublyUnderlined() && (underlineTurnedOff || !from.IsDoublyUnderlined()))
     {
-        RETURN_IF_FAILED(_SetOverlined(textAttributes.IsOverlined()));
-        _lastTextAttributes.SetOverlined(textAttributes.IsOverlined());
+        append(changed, 21);
     }
 
-    if (textAttributes.IsItalic() != _lastTextAttributes.IsItalic())
+    const std::array<std::tuple<bool, bool, int, int>, 6> toggles{ {
+        { from.IsOverlined(), to.IsOverlined(), 53, 55 },
+        { from.IsItalic(), to.IsItalic(), 3, 23 },
+        { from.IsBlinking(), to.IsBlinking(), 5, 25 },
+        { from.IsInvisible(), to.IsInvisible(), 8, 28 },
+        { from.IsCrossedOut(), to.IsCrossedOut(), 9, 29 },
+        { from.IsReverseVideo(), to.IsReverseVideo(), 7, 27 },
+    } };
+    for (const auto& [wasOn, isOn, on, off] : toggles)
     {
-        RETURN_IF_FAILED(_SetItalic(textAttributes.IsItalic()));
-        _lastTextAttributes.SetItalic(textAttributes.IsItalic());
+        if (wasOn != isOn)
+        {
+            append(changed, isOn ? on : off);
+        }
     }
 
-    if (textAttributes.IsBlinking() != _lastTextAttributes.IsBlinking())
+    if (from.GetForeground() != to.GetForeground())
     {
-        RETURN_IF_FAILED(_SetBlinking(textAttributes.IsBlinking()));
-        _lastTextAttributes.SetBlinking(textAttributes.IsBlinking());
+        _AppendColorParameters(to.GetForeground(), true, changed);
+    }
+    if (from.GetBackground() != to.GetBackground())
+    {
+        _AppendColorParameters(to.GetBackground(), false, changed);
     }
 
-    if (textAttributes.IsInvisible() != _lastTextAttributes.IsInvisible())
+    // The same attributes again, after a reset to the defaults.
+    append(reset, 0);
+    const std::array<std::pair<bool, int>, 10> renditions{ {
+        { to.IsBold(), 1 },
+        { to.IsFaint(), 2 },
+        { to.IsUnderlined(), 4 },
+        { to.IsDoublyUnderlined(), 21 },
+        { to.IsOverlined(), 53 },
+        { to.IsItalic(), 3 },
+        { to.IsBlinking(), 5 },
+        { to.IsInvisible(), 8 },
+        { to.IsCrossedOut(), 9 },
+        { to.IsReverseVideo(), 7 },
+    } };
+    for (const auto& [isOn, on] : renditions)
     {
-        RETURN_IF_FAILED(_SetInvisible(textAttributes.IsInvisible()));
-        _lastTextAttributes.SetInvisible(textAttributes.IsInvisible());
+        if (isOn)
+        {
+            append(reset, on);
+        }
+    }
+    if (!to.GetForeground().IsDefault())
+    {
+        _AppendColorParameters(to.GetForeground(), true, reset);
+    }
+    if (!to.GetBackground().IsDefault())
+    {
+        _AppendColorParameters(to.GetBackground(), false, reset);
     }
 
-    if (textAttributes.IsCrossedOut() != _lastTextAttributes.IsCrossedOut())
+    // A reset on its own doesn't need the 0 parameter.
+    if (reset == "0;")
     {
-        RETURN_IF_FAILED(_SetCrossedOut(textAttributes.IsCrossedOut()));
-        _lastTextAttributes.SetCrossedOut(textAttributes.IsCrossedOut());
+        reset.clear();
     }
 
-    if (textAttributes.IsReverseVideo() != _lastTextAttributes.IsReverseVideo())
+    // Prefer the changes when it's a tie, they're easier on the terminal.
+    // Both have a trailing separator that's replaced by the final 'm'.
+    const auto& parameters = (reset.size() < changed.size()) ? reset : changed;
+    sequence = "\x1b[";
+    if (!parameters.empty())
     {
-        RETURN_IF_FAILED(_SetReverseVideo(textAttributes.IsReverseVideo()));
-        _lastTextAttributes.SetReverseVideo(textAttributes.IsReverseVideo());
+        sequence.append(parameters, 0, parameters.size() - 1);
     }
+    sequence.push_back('m');
+}
 
-    return S_OK;
+// Routine Description:
+// - Appends the SGR parameters that select the given color, followed by a
+//      separator.
+// Arguments:
+// - color - The color to select.
+// - isForeground - true to select the foreground color, false for the background.
+// - parameters - The parameters to append to.
+// Return Value:
+// - <none>
+void Xterm256Engine::_AppendColorParameters(const TextColor& color, const bool isForeground, std::string& parameters)
+{
+    auto out = std::back_inserter(parameters);
+    if (color.IsDefault())
+    {
+        fmt::format_to(out, FMT_COMPILE("{};"), isForeground ? 39 : 49);
+    }
+    else if (color.IsIndex16())
+    {
+        // See _SetGraphicsRendition16Color for the bright colors.
+        const auto index = color.GetIndex();
+        const auto prefix = WI_IsFlagSet(index, FOREGROUND_INTENSITY) ? (isForeground ? 90 : 100) : (isForeground ? 30 : 40);
+        fmt::format_to(out, FMT_COMPILE("{};"), prefix + (index & 7));
+    }
+    else if (color.IsIndex256())
+    {
+        fmt::format_to(out, FMT_COMPILE("{}8;5;{};"), isForeground ? '3' : '4', color.GetIndex());
+    }
+    else if (color.IsRgb())
+    {
+        const auto rgb = color.GetRGB();
+        fmt::format_to(out, FMT_COMPILE("{}8;2;{};{};{};"), isForeground ? '3' : '4', GetRValue(rgb), GetGValue(rgb), GetBValue(rgb));
+    }
 }
 
 // Routine Description:
@@ -172,5 +307,6 @@ HRESULT Microsoft::Console::Render::Xterm256Engine::_UpdateHyperlinkAttr(const T
 // - S_OK if we wrote the sequences successfully, otherwise an appropriate HRESULT
 [[nodiscard]] HRESULT Xterm256Engine::ManuallyClearScrollback() noexcept
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     return _ClearScrollback();
 }
@@ -36,7 +36,22 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT ManuallyClearScrollback() noexcept override;
 
     private:
-        [[nodiscard]] HRESULT _UpdateExtendedAttrs(const TextAttribute& textAttributes) noexcept;
+        // An SGR sequence we emitted to change the rendition of the text
+        // between two attributes. See _UpdateRendition.
+        struct RenditionChange
+        {
+            TextAttribute from;
+            TextAttribute to;
+            std::string sequence;
+        };
+
+        std::array<RenditionChange, 16> _renditionCache;
+        size_t _nextRenditionCacheEntry{ 0 };
+
+        [[nodiscard]] HRESULT _UpdateRendition(const TextAttribute& textAttributes) noexcept;
+        static TextAttribute _RenditionOf(const TextAttribute& textAttributes) noexcept;
+        static void _EncodeRendition(const TextAttribute& from, const TextAttribute& to, std::string& sequence);
+        static void _AppendColorParameters(const TextColor& color, const bool isForeground, std::string& parameters);
         [[nodiscard]] HRESULT _UpdateHyperlinkAttr(const TextAttribute& textAttributes,
                                                    const gsl::not_null<IRenderData*> pData) noexcept;
 
@@ -54,6 +54,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         RETURN_IF_FAILED(_ClearScreen());
         _clearedAllThisFrame = true;
         _firstPaint = false;
+        _ResetShadow();
     }
     else
     {
@@ -395,6 +396,9 @@ try
         RETURN_IF_FAILED(_InsertLine(absDy));
     }
 
+    // The rows the terminal shows moved along with the scrolling.
+    _ScrollShadow(dy);
+
     // Restore our wrap state.
     _wrappedRow = oldWrappedRow;
     _delayedEolWrap = oldDelayedEolWrap;
@@ -472,7 +476,8 @@ try
 {
     const til::point delta{ *pcoordDelta };
 
-    if (delta != til::point{ 0, 0 })
+    // The terminal scrolls by itself while output is passed through.
+    if (delta != til::point{ 0, 0 } && !_passthrough)
     {
         _trace.TraceInvalidateScroll(delta);
 
@@ -520,6 +525,19 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // Declared ahead of the lock, so that it runs after it was released.
+    auto closeOutput = wil::scope_exit([&]() noexcept { _CloseOutputIfBroken(); });
+    const std::lock_guard lock{ _snapshotPaintLock };
+    // While the client's output is passed through, the strings are collected
+    // and sent all at once by EndPassthrough.
+    if (_passthrough)
+    {
+        return _fUseAsciiOnly ?
+                   VtEngine::_WriteTerminalAscii(wstr) :
+                   VtEngine::_WriteTerminalUtf8(wstr);
+    }
+    // We can't tell what this string does to the terminal's contents.
+    _ResetShadow();
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
@@ -49,6 +49,12 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 try
 {
+    // The terminal already shows the output that's being passed through.
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     const til::rectangle rect{ Viewport::FromExclusive(*psrRegion).ToInclusive() };
     _trace.TraceInvalidate(rect);
     _invalidMap.set(rect);
@@ -64,6 +70,12 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept
 {
+    // EndPassthrough updates the cursor position once the output is through.
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     // If we just inherited the cursor, we're going to get an InvalidateCursor
     //      for both where the old cursor was, and where the new cursor is
     //      (the inherited location). (See Cursor.cpp:Cursor::SetPosition)
@@ -91,8 +103,16 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToInclusive());
     _invalidMap.set_all();
+    // Whoever asked for this might know better than us what the terminal
+    // shows, so really paint everything again.
+    _ResetShadow();
     return S_OK;
 }
 CATCH_RETURN();
@@ -108,7 +128,8 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
 {
     // If we're in the middle of a resize request, don't try to immediately start a frame.
-    if (_inResizeRequest)
+    // The same goes for output that's passed through, as it's already on the terminal.
+    if (_inResizeRequest || _passthrough)
     {
         *pForcePaint = false;
     }
@@ -130,6 +151,8 @@ CATCH_RETURN();
 // - Notifies us that we're about to be torn down. This gives us a last chance
 //      to force a repaint before the buffer contents are lost. The VT renderer
 //      needs to be able to render all text before it's lost, so we return true.
+// - We're about to exit after that repaint, so from now on we wait for our
+//      output to be written, instead of leaving that to the pipe writer.
 // Arguments:
 // - Receives a bool indicating if we should force the repaint.
 // Return Value:
@@ -137,5 +160,19 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
+    LOG_IF_FAILED(_pipeWriter.Drain());
     return S_OK;
 }
+
+// Method Description:
+// - If the pipe broke while we were painted from a snapshot, we ask for one
+//      more frame, so that StartPaint gets to close the output with the
+//      console locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the pipe broke and the terminal owner wasn't told yet.
+[[nodiscard]] bool VtEngine::RequiresContinuousRedraw() noexcept
+{
+    return _pipeBroken && !_outputClosed;
+}
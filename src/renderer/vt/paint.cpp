@@ -20,8 +20,12 @@ using namespace Microsoft::Console::Types;
 //      HRESULT error code if painting didn't start successfully.
 [[nodiscard]] HRESULT VtEngine::StartPaint() noexcept
 {
+    // The renderer calls us with the console locked, before it takes
+    // _snapshotPaintLock, so this is where a pipe that broke while we were
+    // painted from a snapshot can be closed.
     if (_pipeBroken)
     {
+        _CloseOutputIfBroken();
         return S_FALSE;
     }
 
@@ -54,6 +58,7 @@ using namespace Microsoft::Console::Types;
 [[nodiscard]] HRESULT VtEngine::EndPaint() noexcept
 {
     _trace.TraceEndPaint();
+    _trace.TraceOutputStatistics(_pipeWriter);
 
     _invalidMap.reset_all();
 
@@ -87,6 +92,25 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Throttles the render loop like every engine does. If the terminal doesn't
+//      read our output as fast as we write it, this also holds the next frame
+//      back until it caught up. The output that arrives in the meantime is
+//      painted with that frame, so a slow terminal gets fewer frames, instead
+//      of blocking the console.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::WaitUntilCanRender() noexcept
+{
+    RenderEngineBase::WaitUntilCanRender();
+
+    // Don't wait forever, the render thread has to notice when it's stopped.
+    static constexpr std::chrono::milliseconds maximumWait{ 100 };
+    _pipeWriter.WaitUntilWritable(maximumWait);
+}
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
@@ -181,80 +205,6 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
-// Routine Description:
-// - Write a VT sequence to change the current colors of text. Writes true RGB
-//      color sequences.
-// Arguments:
-// - textAttributes: Text attributes to use for the colors.
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept
-{
-    const auto fg = textAttributes.GetForeground();
-    const auto bg = textAttributes.GetBackground();
-    auto lastFg = _lastTextAttributes.GetForeground();
-    auto lastBg = _lastTextAttributes.GetBackground();
-
-    // If both the FG and BG should be the defaults, emit a SGR reset.
-    if (fg.IsDefault() && bg.IsDefault() && !(lastFg.IsDefault() && lastBg.IsDefault()))
-    {
-        // SGR Reset will clear all attributes (except hyperlink ID) - which means
-        // we cannot reset _lastTextAttributes by simply doing
-        // _lastTextAttributes = {};
-        // because we want to retain the last hyperlink ID
-        RETURN_IF_FAILED(_SetGraphicsDefault());
-        _lastTextAttributes.SetDefaultBackground();
-        _lastTextAttributes.SetDefaultForeground();
-        _lastTextAttributes.SetDefaultMetaAttrs();
-        lastFg = {};
-        lastBg = {};
-    }
-
-    if (fg != lastFg)
-    {
-        if (fg.IsDefault())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(true));
-        }
-        else if (fg.IsIndex16())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(fg.GetIndex(), true));
-        }
-        else if (fg.IsIndex256())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition256Color(fg.GetIndex(), true));
-        }
-        else if (fg.IsRgb())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(fg.GetRGB(), true));
-        }
-        _lastTextAttributes.SetForeground(fg);
-    }
-
-    if (bg != lastBg)
-    {
-        if (bg.IsDefault())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(false));
-        }
-        else if (bg.IsIndex16())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(bg.GetIndex(), false));
-        }
-        else if (bg.IsIndex256())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition256Color(bg.GetIndex(), false));
-        }
-        else if (bg.IsRgb())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(bg.GetRGB(), false));
-        }
-        _lastTextAttributes.SetBackground(bg);
-    }
-
-    return S_OK;
-}
-
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. It will try to
 //      find ANSI colors that are nearest to the input colors, and write those
@@ -368,13 +318,15 @@ using namespace Microsoft::Console::Types;
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8.
+// - Cells at either end of the run that the terminal already shows, with the
+//      same attributes, are skipped. See _TrimToShadowDifference.
 // Arguments:
 // - clusters - text and column widths to be written
 // - coord - character coordinate target to render within viewport
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(gsl::span<const Cluster> const clusters,
-                                                     const COORD coord,
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(gsl::span<const Cluster> clusters,
+                                                     COORD coord,
                                                      const bool lineWrapped) noexcept
 {
     if (coord.Y < _virtualTop)
@@ -382,6 +334,14 @@ using namespace Microsoft::Console::Types;
         return S_OK;
     }
 
+    // Only paint the part of the run that differs from what the terminal
+    // already shows. If nothing differs, we don't even need to move the cursor.
+    _TrimToShadowDifference(clusters, coord, lineWrapped);
+    if (clusters.empty())
+    {
+        return S_OK;
+    }
+
     _bufferLine.clear();
     _bufferLine.reserve(clusters.size());
     short totalWidth = 0;
@@ -524,6 +484,11 @@ using namespace Microsoft::Console::Types;
     {
         _lastText.X += static_cast<short>(columnsActual);
     }
+
+    // Remember what the terminal shows now. The spaces we didn't write (or
+    // erased instead) are left unknown.
+    _UpdateShadow(clusters, coord, columnsActual);
+
     // GH#1245: If we wrote the exactly last char of the row, then we're in the
     // "delayed EOL wrap" state. Different terminals (conhost, gnome-terminal,
     // wt) all behave differently with how the cursor behaves at an end of line.
@@ -590,6 +555,240 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Method Description:
+// - Forgets everything we know about what the terminal shows. Used whenever
+//      the terminal's contents might have changed in a way we can't follow,
+//      so that the next frame is painted in full.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_ResetShadow() noexcept
+try
+{
+    const auto size = _lastViewport.Dimensions();
+    _shadow.assign(gsl::narrow_cast<size_t>(size.X) * gsl::narrow_cast<size_t>(size.Y), ShadowCell{});
+}
+catch (...)
+{
+    // A shadow that doesn't fit the viewport is never used.
+    _shadow.clear();
+}
+
+// Method Description:
+// - Moves the rows of our shadow of the terminal's contents, after we've
+//      scrolled the terminal. The rows that scroll into view are unknown.
+// Arguments:
+// - rows - how far the rows moved. Negative if they moved up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollShadow(const short rows) noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    const auto height = gsl::narrow_cast<size_t>(_lastViewport.Height());
+    const auto distance = gsl::narrow_cast<size_t>(std::abs(rows));
+    if (_shadow.size() != width * height || distance >= height)
+    {
+        _ResetShadow();
+        return;
+    }
+
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(distance * width);
+    if (rows < 0)
+    {
+        std::move(_shadow.begin() + shift, _shadow.end(), _shadow.begin());
+        std::fill(_shadow.end() - shift, _shadow.end(), ShadowCell{});
+    }
+    else if (rows > 0)
+    {
+        std::move_backward(_shadow.begin(), _shadow.end() - shift, _shadow.end());
+        std::fill(_shadow.begin(), _shadow.begin() + shift, ShadowCell{});
+    }
+}
+
+// Method Description:
+// - Tells if the terminal already shows the given cluster at the given
+//      position, drawn with the attributes we're currently painting with.
+// Arguments:
+// - cluster - the text and width of the cells to look for
+// - coord - the position of the first cell of the cluster
+// Return Value:
+// - true if nothing would change by painting the cluster again.
+bool VtEngine::_ShadowMatches(const Cluster& cluster, const COORD coord) const noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = cluster.GetColumns();
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (text.empty() || columns == 0 ||
+        coord.X < 0 || coord.X + gsl::narrow_cast<SHORT>(columns) > width ||
+        coord.Y < 0 || coord.Y >= height ||
+        _shadow.size() != gsl::narrow_cast<size_t>(width) * gsl::narrow_cast<size_t>(height))
+    {
+        return false;
+    }
+
+    const auto offset = gsl::narrow_cast<size_t>(coord.Y) * width + coord.X;
+    const auto& cell = til::at(_shadow, offset);
+    if (cell.trailing ||
+        cell.length != text.size() ||
+        cell.columns != columns ||
+        cell.attributes != _lastTextAttributes ||
+        !std::equal(text.begin(), text.end(), cell.text.begin()))
+    {
+        return false;
+    }
+
+    for (size_t i = 1; i < columns; ++i)
+    {
+        const auto& trailing = til::at(_shadow, offset + i);
+        if (!trailing.trailing || trailing.attributes != _lastTextAttributes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Method Description:
+// - Narrows a run of clusters down to the part that differs from what the
+//      terminal already shows, according to our shadow of the last frame we
+//      sent it. Renderers invalidate whole regions at a time, while programs
+//      often only change a few cells in them (a progress bar that redraws the
+//      whole line, for example).
+// - The end of a wrapped line is always painted, as is the start of the line
+//      following one that we just wrapped. Painting the last cell of a row is
+//      what puts the terminal into the wrapped state, and we need to continue
+//      writing at the start of the next row to keep it in that state.
+// Arguments:
+// - clusters - the run to narrow down
+// - coord - the position of the first cell of the run. Moved to the first cell
+//      of the narrowed run.
+// - lineWrapped - true if this run is the end of a line that wrapped.
+// Return Value:
+// - <none>
+void VtEngine::_TrimToShadowDifference(gsl::span<const Cluster>& clusters,
+                                       COORD& coord,
+                                       const bool lineWrapped) const noexcept
+{
+    if (clusters.empty())
+    {
+        return;
+    }
+
+    const bool continuesWrappedRow = coord.X == 0 &&
+                                     _wrappedRow.has_value() &&
+                                     _wrappedRow.value() + 1 == coord.Y;
+
+    size_t first = 0;
+    SHORT firstColumn = coord.X;
+    if (!continuesWrappedRow)
+    {
+        while (first < clusters.size() && _ShadowMatches(til::at(clusters, first), { firstColumn, coord.Y }))
+        {
+            firstColumn += gsl::narrow_cast<SHORT>(til::at(clusters, first).GetColumns());
+            ++first;
+        }
+    }
+
+    size_t last = clusters.size();
+    if (lineWrapped)
+    {
+        if (first == last)
+        {
+            --first;
+            firstColumn -= gsl::narrow_cast<SHORT>(til::at(clusters, first).GetColumns());
+        }
+    }
+    else
+    {
+        SHORT lastColumn = firstColumn;
+        for (size_t i = first; i < last; ++i)
+        {
+            lastColumn += gsl::narrow_cast<SHORT>(til::at(clusters, i).GetColumns());
+        }
+
+        // Keep the first cluster of a continued row, for the reason above.
+        const size_t keep = continuesWrappedRow ? 1 : 0;
+        while (last > first + keep)
+        {
+            const auto& cluster = til::at(clusters, last - 1);
+            const auto columns = gsl::narrow_cast<SHORT>(cluster.GetColumns());
+            if (!_ShadowMatches(cluster, { gsl::narrow_cast<SHORT>(lastColumn - columns), coord.Y }))
+            {
+                break;
+            }
+            lastColumn -= columns;
+            --last;
+        }
+    }
+
+    clusters = clusters.subspan(first, last - first);
+    coord.X = firstColumn;
+}
+
+// Method Description:
+// - Records the cells we just painted in our shadow of the terminal's
+//      contents. Cells of the run past the columns we actually wrote become
+//      unknown, since they were either left as they were, or erased.
+// Arguments:
+// - clusters - the run we painted
+// - coord - the position of the first cell of the run
+// - columnsWritten - how many columns of the run we wrote text to
+// Return Value:
+// - <none>
+void VtEngine::_UpdateShadow(gsl::span<const Cluster> const clusters,
+                             const COORD coord,
+                             const size_t columnsWritten) noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (coord.Y < 0 || coord.Y >= height ||
+        _shadow.size() != gsl::narrow_cast<size_t>(width) * gsl::narrow_cast<size_t>(height))
+    {
+        return;
+    }
+
+    const auto rowOffset = gsl::narrow_cast<size_t>(coord.Y) * width;
+    SHORT column = coord.X;
+    size_t written = 0;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        const auto columns = cluster.GetColumns();
+        written += columns;
+
+        ShadowCell lead{};
+        if (written <= columnsWritten && !text.empty() && text.size() <= lead.text.size() && columns <= UINT8_MAX)
+        {
+            std::copy(text.begin(), text.end(), lead.text.begin());
+            lead.length = gsl::narrow_cast<uint8_t>(text.size());
+            lead.columns = gsl::narrow_cast<uint8_t>(columns);
+            lead.attributes = _lastTextAttributes;
+        }
+
+        for (size_t i = 0; i < columns; ++i, ++column)
+        {
+            if (column < 0 || column >= width)
+            {
+                continue;
+            }
+
+            auto& cell = til::at(_shadow, rowOffset + column);
+            if (i == 0 || lead.length == 0)
+            {
+                cell = lead;
+            }
+            else
+            {
+                cell = ShadowCell{};
+                cell.trailing = true;
+                cell.attributes = lead.attributes;
+            }
+        }
+    }
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
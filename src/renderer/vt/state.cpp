@@ -29,6 +29,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
                    const Viewport initialViewport) :
     RenderEngineBase(),
     _hFile(std::move(pipe)),
+    _pipeWriter(_hFile.get()),
     _lastTextAttributes(INVALID_COLOR, INVALID_COLOR),
     _lastViewport(initialViewport),
     _pool(til::pmr::get_default_resource()),
@@ -45,6 +46,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     _firstPaint(true),
     _skipCursor(false),
     _pipeBroken(false),
+    _outputClosed(false),
     _exitResult{ S_OK },
     _terminalOwner{ nullptr },
     _newBottomLine{ false },
@@ -56,6 +58,8 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     _formatBuffer{},
     _conversionBuffer{}
 {
+    _ResetShadow();
+
 #ifndef UNIT_TESTING
     // When unit testing, we can instantiate a VtEngine without a pipe.
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
@@ -115,16 +119,17 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        // The writer takes the buffer's contents and returns right away. If it
+        // fails, it's because an earlier write to the pipe failed.
+        const auto hr = _pipeWriter.Write(_buffer);
         _buffer.clear();
-        if (!fSuccess)
+        if (FAILED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
+            // We might be painted from a snapshot right now, without the
+            // console lock, which closing the output needs. The owner is told
+            // by _CloseOutputIfBroken, once the console is locked again.
+            _exitResult = hr;
             _pipeBroken = true;
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
             return _exitResult;
         }
     }
@@ -132,10 +137,42 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     return S_OK;
 }
 
+// Method Description:
+// - Tells the terminal owner that the pipe broke, if it did, and if we didn't
+//      tell it already. The owner tears down the connection, which needs the
+//      console lock. So this has to be called with the console locked, and
+//      without holding _snapshotPaintLock, which is acquired after it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_CloseOutputIfBroken() noexcept
+{
+    ITerminalOwner* terminalOwner = nullptr;
+    {
+        // The renderer reads these in RequiresContinuousRedraw during a paint.
+        const std::lock_guard lock{ _snapshotPaintLock };
+        if (!_pipeBroken || _outputClosed)
+        {
+            return;
+        }
+        _outputClosed = true;
+        terminalOwner = _terminalOwner;
+    }
+
+    if (terminalOwner)
+    {
+        terminalOwner->CloseOutput();
+    }
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
+    // We can't tell what this string does to the terminal's contents.
+    _ResetShadow();
     return _Write(str);
 }
 
@@ -227,6 +264,10 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
             hr = _ResizeWindow(newView.Width(), newView.Height());
         }
         _resized = true;
+
+        // The terminal might reflow its contents when it's resized, so we
+        // can't know what it shows anymore.
+        _ResetShadow();
     }
 
     // See MSFT:19408543
@@ -335,6 +376,7 @@ bool VtEngine::_AllIsInvalid() const
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::SuppressResizeRepaint() noexcept
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _suppressResizeRepaint = true;
     return S_OK;
 }
@@ -351,6 +393,7 @@ bool VtEngine::_AllIsInvalid() const
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InheritCursor(const COORD coordCursor) noexcept
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _virtualTop = coordCursor.Y;
     _lastText = coordCursor;
     _skipCursor = true;
@@ -359,8 +402,53 @@ bool VtEngine::_AllIsInvalid() const
     return S_OK;
 }
 
+// Method Description:
+// - Starts passing the client's output through to the terminal. Until
+//      EndPassthrough is called, the strings given to WriteTerminalW are
+//      collected without being flushed, and the invalidations that the output
+//      causes are ignored, because the terminal is going to apply that output
+//      itself.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT VtEngine::BeginPassthrough() noexcept
+{
+    const std::lock_guard lock{ _snapshotPaintLock };
+    _passthrough = true;
+    return S_OK;
+}
+
+// Method Description:
+// - Stops passing the client's output through to the terminal and sends what
+//      was collected. The terminal has moved its cursor and changed its
+//      attributes the same way the buffer did, so we take those from the
+//      buffer, instead of moving the cursor back to where we last left it.
+// Arguments:
+// - coordCursor: The position of the cursor in the viewport.
+// - attributes: The attributes that the buffer is going to write with.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::EndPassthrough(const COORD coordCursor, const TextAttribute& attributes) noexcept
+{
+    // Declared ahead of the lock, so that it runs after it was released.
+    auto closeOutput = wil::scope_exit([&]() noexcept { _CloseOutputIfBroken(); });
+    const std::lock_guard lock{ _snapshotPaintLock };
+    _passthrough = false;
+    _lastText = coordCursor;
+    _lastTextAttributes = attributes;
+    _delayedEolWrap = false;
+    _wrappedRow = std::nullopt;
+    // Don't clear the terminal, which already shows the output, on the next frame.
+    _firstPaint = false;
+    // We can't tell what the output did to the terminal's contents.
+    _ResetShadow();
+    return _Flush();
+}
+
 void VtEngine::SetTerminalOwner(Microsoft::Console::ITerminalOwner* const terminalOwner)
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _terminalOwner = terminalOwner;
 }
 
@@ -374,6 +462,9 @@ void VtEngine::SetTerminalOwner(Microsoft::Console::ITerminalOwner* const termin
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 HRESULT VtEngine::RequestCursor() noexcept
 {
+    // Declared ahead of the lock, so that it runs after it was released.
+    auto closeOutput = wil::scope_exit([&]() noexcept { _CloseOutputIfBroken(); });
+    const std::lock_guard lock{ _snapshotPaintLock };
     RETURN_IF_FAILED(_RequestCursor());
     RETURN_IF_FAILED(_Flush());
     return S_OK;
@@ -391,6 +482,7 @@ HRESULT VtEngine::RequestCursor() noexcept
 // - <none>
 void VtEngine::BeginResizeRequest()
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _inResizeRequest = true;
 }
 
@@ -404,6 +496,7 @@ void VtEngine::BeginResizeRequest()
 // - <none>
 void VtEngine::EndResizeRequest()
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _inResizeRequest = false;
 }
 
@@ -420,6 +513,7 @@ void VtEngine::EndResizeRequest()
 // - true iff we were started with the `--resizeQuirk` flag enabled.
 void VtEngine::SetResizeQuirk(const bool resizeQuirk)
 {
+    const std::lock_guard lock{ _snapshotPaintLock };
     _resizeQuirk = resizeQuirk;
 }
 
@@ -451,7 +545,24 @@ void VtEngine::SetResizeQuirk(const bool resizeQuirk)
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 HRESULT VtEngine::RequestWin32Input() noexcept
 {
+    // Declared ahead of the lock, so that it runs after it was released.
+    auto closeOutput = wil::scope_exit([&]() noexcept { _CloseOutputIfBroken(); });
+    const std::lock_guard lock{ _snapshotPaintLock };
     RETURN_IF_FAILED(_RequestWin32Input());
     RETURN_IF_FAILED(_Flush());
     return S_OK;
 }
+
+// Method Description:
+// - The renderer paints us from a snapshot, outside of the console lock, so
+//   that the console doesn't have to wait for us to format and write a frame.
+//   The methods that the console calls directly, while it holds its lock,
+//   take this lock as well, to not interfere with a frame in progress.
+// Arguments:
+// - <none>
+// Return Value:
+// - The lock the renderer holds while painting outside of the console lock.
+[[nodiscard]] til::ticket_lock* VtEngine::GetSnapshotPaintLock() noexcept
+{
+    return &_snapshotPaintLock;
+}
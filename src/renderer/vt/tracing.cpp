@@ -212,6 +212,34 @@ void RenderTracing::TraceEndPaint() const
 #endif UNIT_TESTING
 }
 
+// Method Description:
+// - Traces how well the terminal keeps up with our output. The statistics are
+//   only collected if someone's listening, since that takes the writer's lock.
+// Arguments:
+// - pipeWriter: the writer that writes our output to the terminal.
+// Return Value:
+// - <none>
+void RenderTracing::TraceOutputStatistics(const Microsoft::Console::Render::PipeWriter& pipeWriter) const
+{
+#ifndef UNIT_TESTING
+    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    {
+        const auto statistics = pipeWriter.GetStatistics();
+        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                          "VtEngine_TraceOutputStatistics",
+                          TraceLoggingUInt64(statistics.bytesWritten, "bytesWritten"),
+                          TraceLoggingUInt64(statistics.writes, "writes"),
+                          TraceLoggingUInt64(statistics.merges, "merges"),
+                          TraceLoggingUInt64(statistics.queuedBytes, "queuedBytes"),
+                          TraceLoggingUInt64(statistics.peakQueuedBytes, "peakQueuedBytes"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+#else
+    UNREFERENCED_PARAMETER(pipeWriter);
+#endif UNIT_TESTING
+}
+
 void RenderTracing::TraceLastText(const til::point lastTextPos) const
 {
 #ifndef UNIT_TESTING
@@ -16,6 +16,7 @@ Abstract:
 #include <TraceLoggingProvider.h>
 #include <telemetry/ProjectTelemetry.h>
 #include "../../types/inc/Viewport.hpp"
+#include "PipeWriter.hpp"
 
 TRACELOGGING_DECLARE_PROVIDER(g_hConsoleVtRendererTraceProvider);
 
@@ -45,5 +46,6 @@ namespace Microsoft::Console::VirtualTerminal
                              const bool cursorMoved,
                              const std::optional<short>& wrappedRow) const;
         void TraceEndPaint() const;
+        void TraceOutputStatistics(const Microsoft::Console::Render::PipeWriter& pipeWriter) const;
     };
 }
@@ -19,6 +19,7 @@ Author(s):
 #include "../../inc/ITerminalOutputConnection.hpp"
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
+#include "PipeWriter.hpp"
 #include "tracing.hpp"
 #include <string>
 #include <functional>
@@ -48,6 +49,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
+        [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
+        void WaitUntilCanRender() noexcept override;
         [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* psrRegion) noexcept override;
         [[nodiscard]] HRESULT InvalidateCursor(const SMALL_RECT* psrRegion) noexcept override;
         [[nodiscard]] HRESULT InvalidateSystem(const RECT* prcDirtyClient) noexcept override;
@@ -66,11 +69,14 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT GetDirtyArea(gsl::span<const til::rectangle>& area) noexcept override;
         [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* pFontSize) noexcept override;
         [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view glyph, _Out_ bool* pResult) noexcept override;
+        [[nodiscard]] til::ticket_lock* GetSnapshotPaintLock() noexcept override;
 
         // VtEngine
         [[nodiscard]] HRESULT SuppressResizeRepaint() noexcept;
         [[nodiscard]] HRESULT RequestCursor() noexcept;
         [[nodiscard]] HRESULT InheritCursor(const COORD coordCursor) noexcept;
+        [[nodiscard]] HRESULT BeginPassthrough() noexcept;
+        [[nodiscard]] HRESULT EndPassthrough(const COORD coordCursor, const TextAttribute& attributes) noexcept;
         [[nodiscard]] HRESULT WriteTerminalUtf8(const std::string_view str) noexcept;
         [[nodiscard]] virtual HRESULT WriteTerminalW(const std::wstring_view str) noexcept = 0;
         void SetTerminalOwner(Microsoft::Console::ITerminalOwner* const terminalOwner);
@@ -82,6 +88,8 @@ namespace Microsoft::Console::Render
 
     protected:
         wil::unique_hfile _hFile;
+        // Writes our output to _hFile, without waiting for the terminal to read it.
+        PipeWriter _pipeWriter;
         std::string _buffer;
 
         std::string _formatBuffer;
@@ -112,9 +120,14 @@ namespace Microsoft::Console::Render
         COORD _deferredCursorPos;
 
         bool _pipeBroken;
+        // Set once the terminal owner was told that the pipe broke.
+        bool _outputClosed;
         HRESULT _exitResult;
         Microsoft::Console::ITerminalOwner* _terminalOwner;
 
+        // Held by the renderer while it paints us outside of the console lock.
+        til::ticket_lock _snapshotPaintLock;
+
         Microsoft::Console::VirtualTerminal::RenderTracing _trace;
         bool _inResizeRequest{ false };
 
@@ -125,8 +138,29 @@ namespace Microsoft::Console::Render
         bool _resizeQuirk{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        // Set while the console passes the client's output through to the
+        // terminal. The changes it makes to the buffer are already on the
+        // terminal then, so we don't need to paint them.
+        bool _passthrough{ false };
+
+        // A cell of the last frame we sent to the terminal. Cells that we
+        // don't know the contents of (because they were erased, or were never
+        // painted) have no text, and never match anything we're asked to paint.
+        struct ShadowCell
+        {
+            std::array<wchar_t, 2> text{};
+            uint8_t length{ 0 };
+            uint8_t columns{ 0 };
+            bool trailing{ false };
+            TextAttribute attributes{};
+        };
+
+        // The viewport as we think the terminal shows it, one row after the other.
+        std::vector<ShadowCell> _shadow;
+
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        void _CloseOutputIfBroken() noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -187,7 +221,6 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _RequestWin32Input() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
-        [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
 
         bool _WillWriteSingleChar() const;
@@ -195,13 +228,23 @@ namespace Microsoft::Console::Render
         // buffer space for these two functions to build their lines
         // so they don't have to alloc/free in a tight loop
         std::wstring _bufferLine;
-        [[nodiscard]] HRESULT _PaintUtf8BufferLine(gsl::span<const Cluster> const clusters,
-                                                   const COORD coord,
+        [[nodiscard]] HRESULT _PaintUtf8BufferLine(gsl::span<const Cluster> clusters,
+                                                   COORD coord,
                                                    const bool lineWrapped) noexcept;
 
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(gsl::span<const Cluster> const clusters,
                                                     const COORD coord) noexcept;
 
+        void _ResetShadow() noexcept;
+        void _ScrollShadow(const short rows) noexcept;
+        bool _ShadowMatches(const Cluster& cluster, const COORD coord) const noexcept;
+        void _TrimToShadowDifference(gsl::span<const Cluster>& clusters,
+                                     COORD& coord,
+                                     const bool lineWrapped) const noexcept;
+        void _UpdateShadow(gsl::span<const Cluster> const clusters,
+                           const COORD coord,
+                           const size_t columnsWritten) noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
 
@@ -6,6 +6,7 @@
 #include "ApiSorter.h"
 
 #include "ApiDispatchers.h"
+#include "ApiStatistics.h"
 
 #include "../host/tracing.hpp"
 
@@ -37,6 +38,7 @@ typedef struct _CONSOLE_API_DESCRIPTOR
 typedef struct _CONSOLE_API_LAYER_DESCRIPTOR
 {
     const CONSOLE_API_DESCRIPTOR* Descriptor;
+    ApiStatistics* Statistics;
     ULONG Count;
 } CONSOLE_API_LAYER_DESCRIPTOR, *PCONSOLE_API_LAYER_DESCRIPTOR;
 
@@ -126,10 +128,15 @@ const CONSOLE_API_DESCRIPTOR ConsoleApiLayer3[] = {
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleCurrentFont, CONSOLE_CURRENTFONT_MSG, "SetConsoleCurrentFont")
 };
 
+// The timings of each API, in the same order as its descriptor. See ApiSorter::TraceStatistics.
+ApiStatistics ConsoleApiLayer1Statistics[RTL_NUMBER_OF(ConsoleApiLayer1)];
+ApiStatistics ConsoleApiLayer2Statistics[RTL_NUMBER_OF(ConsoleApiLayer2)];
+ApiStatistics ConsoleApiLayer3Statistics[RTL_NUMBER_OF(ConsoleApiLayer3)];
+
 const CONSOLE_API_LAYER_DESCRIPTOR ConsoleApiLayerTable[] = {
-    { ConsoleApiLayer1, RTL_NUMBER_OF(ConsoleApiLayer1) },
-    { ConsoleApiLayer2, RTL_NUMBER_OF(ConsoleApiLayer2) },
-    { ConsoleApiLayer3, RTL_NUMBER_OF(ConsoleApiLayer3) },
+    { ConsoleApiLayer1, ConsoleApiLayer1Statistics, RTL_NUMBER_OF(ConsoleApiLayer1) },
+    { ConsoleApiLayer2, ConsoleApiLayer2Statistics, RTL_NUMBER_OF(ConsoleApiLayer2) },
+    { ConsoleApiLayer3, ConsoleApiLayer3Statistics, RTL_NUMBER_OF(ConsoleApiLayer3) },
 };
 
 // Routine Description:
@@ -152,6 +159,7 @@ PCONSOLE_API_MSG ApiSorter::ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Mess
     }
 
     CONSOLE_API_DESCRIPTOR const* Descriptor = &ConsoleApiLayerTable[LayerNumber].Descriptor[ApiNumber];
+    ApiStatistics* Statistics = &ConsoleApiLayerTable[LayerNumber].Statistics[ApiNumber];
 
     // Validate the argument size and call the API.
     if ((Message->Descriptor.InputSize < sizeof(CONSOLE_MSG_HEADER)) ||
@@ -175,7 +183,18 @@ PCONSOLE_API_MSG ApiSorter::ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Mess
     // alias API.
     {
         const auto trace = Tracing::s_TraceApiCall(Status, Descriptor->TraceName);
+        const auto lockWaitStart = ApiStatistics::s_GetLockWait();
+        const auto start = std::chrono::steady_clock::now();
+
         Status = (*Descriptor->Routine)(Message, &ReplyPending);
+
+        // The payload is whatever follows the API's message in the input. The reply information holds the number
+        // of bytes we returned, once the call is complete.
+        Statistics->Record(std::chrono::steady_clock::now() - start,
+                           ApiStatistics::s_GetLockWait() - lockWaitStart,
+                           Message->Descriptor.InputSize - Message->msgHeader.ApiDescriptorSize - sizeof(CONSOLE_MSG_HEADER),
+                           ReplyPending ? 0 : Message->Complete.IoStatus.Information,
+                           ReplyPending);
     }
     if (Status != STATUS_BUFFER_TOO_SMALL)
     {
@@ -195,3 +214,52 @@ Complete:
 
     return Message;
 }
+
+// Routine Description:
+// - Writes the statistics of every API that was called so far to the trace log, and as a table to the debugger.
+//   The statistics are read without taking a lock, so this can be called from any thread, at any time.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ApiSorter::TraceStatistics() noexcept
+try
+{
+    using namespace std::chrono;
+
+    static const auto format = FMT_COMPILE("{:<32} {:>10} {:>8} {:>12} {:>11} {:>11} {:>12} {:>12} {:>12}\n");
+
+    fmt::memory_buffer table;
+    fmt::format_to(std::back_inserter(table),
+                   format,
+                   "API", "calls", "pended", "total us", "p50 ns", "p99 ns", "lock wait us", "bytes in", "bytes out");
+
+    for (const auto& Layer : ConsoleApiLayerTable)
+    {
+        for (ULONG i = 0; i < Layer.Count; ++i)
+        {
+            const auto summary = Layer.Statistics[i].Summarize();
+            if (summary.calls == 0)
+            {
+                continue;
+            }
+
+            Tracing::s_TraceApiStatistics(Layer.Descriptor[i].TraceName, summary);
+            fmt::format_to(std::back_inserter(table),
+                           format,
+                           Layer.Descriptor[i].TraceName,
+                           summary.calls,
+                           summary.pendedCalls,
+                           duration_cast<microseconds>(summary.totalTime).count(),
+                           summary.medianTime.count(),
+                           summary.p99Time.count(),
+                           duration_cast<microseconds>(summary.lockWaitTime).count(),
+                           summary.bytesIn,
+                           summary.bytesOut);
+        }
+    }
+
+    table.push_back('\0');
+    OutputDebugStringA(table.data());
+}
+CATCH_LOG()
@@ -41,4 +41,8 @@ public:
     // Return Value:
     // - A pointer to the reply message, if this message is to be completed inline; nullptr if this message will pend now and complete later.
     static PCONSOLE_API_MSG ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Message);
+
+    // Routine Description:
+    // - Writes the statistics of every API that was called so far to the trace log and the debugger.
+    static void TraceStatistics() noexcept;
 };
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiStatistics.h"
+
+// The time this thread spent waiting for the console lock so far. The IO
+// thread takes the lock inside the API routines, so ApiSorter compares this
+// before and after each call to find out how much of it was spent waiting.
+static thread_local uint64_t s_lockWaitNanoseconds = 0;
+
+// Routine Description:
+// - Records a call to this API. Only called by the IO thread.
+// Arguments:
+// - time - How long the API routine took.
+// - lockWaitTime - How much of that was spent waiting for the console lock.
+// - bytesIn - The size of the payload the client sent along with the call.
+// - bytesOut - The number of bytes returned to the client.
+// - pended - True if the call was put on a wait queue to be completed later.
+//            The time and bytes of the later completion aren't counted.
+// Return Value:
+// - <none>
+void ApiStatistics::Record(const std::chrono::nanoseconds time,
+                           const std::chrono::nanoseconds lockWaitTime,
+                           const uint64_t bytesIn,
+                           const uint64_t bytesOut,
+                           const bool pended) noexcept
+{
+    const auto nanoseconds = gsl::narrow_cast<uint64_t>(std::max<int64_t>(time.count(), 0));
+
+    _calls.fetch_add(1, std::memory_order_relaxed);
+    _pendedCalls.fetch_add(pended ? 1 : 0, std::memory_order_relaxed);
+    _totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    _lockWaitNanoseconds.fetch_add(gsl::narrow_cast<uint64_t>(lockWaitTime.count()), std::memory_order_relaxed);
+    _bytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+    _bytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+    til::at(_buckets, s_BucketIndex(nanoseconds)).fetch_add(1, std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - Takes a snapshot of the counters. Safe to call from any thread while the
+//   IO thread keeps recording calls, but then the counters may be off from
+//   each other by the calls that were recorded while we read them.
+// Arguments:
+// - <none>
+// Return Value:
+// - The totals of all calls recorded so far, and the median and 99th
+//   percentile of their latencies.
+ApiStatistics::Summary ApiStatistics::Summarize() const noexcept
+{
+    std::array<uint64_t, BucketCount> buckets;
+    uint64_t count = 0;
+    for (size_t i = 0; i < BucketCount; ++i)
+    {
+        til::at(buckets, i) = til::at(_buckets, i).load(std::memory_order_relaxed);
+        count += til::at(buckets, i);
+    }
+
+    Summary summary{};
+    summary.calls = _calls.load(std::memory_order_relaxed);
+    summary.pendedCalls = _pendedCalls.load(std::memory_order_relaxed);
+    summary.totalTime = std::chrono::nanoseconds{ _totalNanoseconds.load(std::memory_order_relaxed) };
+    summary.medianTime = s_Percentile(buckets, count, 50);
+    summary.p99Time = s_Percentile(buckets, count, 99);
+    summary.lockWaitTime = std::chrono::nanoseconds{ _lockWaitNanoseconds.load(std::memory_order_relaxed) };
+    summary.bytesIn = _bytesIn.load(std::memory_order_relaxed);
+    summary.bytesOut = _bytesOut.load(std::memory_order_relaxed);
+    return summary;
+}
+
+// Routine Description:
+// - Adds to the time the calling thread spent waiting for the console lock.
+//   Only called when the lock was contended, so that we don't pay for the
+//   timestamps when it wasn't.
+// Arguments:
+// - time - How long the thread waited.
+// Return Value:
+// - <none>
+void ApiStatistics::s_AddLockWait(const std::chrono::nanoseconds time) noexcept
+{
+    s_lockWaitNanoseconds += gsl::narrow_cast<uint64_t>(std::max<int64_t>(time.count(), 0));
+}
+
+// Routine Description:
+// - Gets the time the calling thread spent waiting for the console lock so far.
+// Arguments:
+// - <none>
+// Return Value:
+// - The total time this thread waited.
+std::chrono::nanoseconds ApiStatistics::s_GetLockWait() noexcept
+{
+    return std::chrono::nanoseconds{ s_lockWaitNanoseconds };
+}
+
+// Routine Description:
+// - Finds the histogram bucket for a latency. Latencies below BucketsPerOctave
+//   nanoseconds get a bucket each, after that every power of two is split into
+//   BucketsPerOctave buckets of equal width.
+// Arguments:
+// - nanoseconds - The latency.
+// Return Value:
+// - The index of the bucket, no larger than BucketCount - 1.
+size_t ApiStatistics::s_BucketIndex(const uint64_t nanoseconds) noexcept
+{
+    if (nanoseconds < BucketsPerOctave)
+    {
+        return gsl::narrow_cast<size_t>(nanoseconds);
+    }
+
+    // _BitScanReverse64 isn't available on x86.
+    unsigned long msb = 0;
+    const auto high = gsl::narrow_cast<unsigned long>(nanoseconds >> 32);
+    if (high != 0)
+    {
+        _BitScanReverse(&msb, high);
+        msb += 32;
+    }
+    else
+    {
+        _BitScanReverse(&msb, gsl::narrow_cast<unsigned long>(nanoseconds));
+    }
+
+    // msb is at least 2 here, because BucketsPerOctave is 4.
+    const auto shift = msb - 2;
+    const size_t index = (shift + 1) * BucketsPerOctave + ((nanoseconds >> shift) & (BucketsPerOctave - 1));
+    return std::min(index, BucketCount - 1);
+}
+
+// Routine Description:
+// - Gets the largest latency that falls into the given bucket.
+// Arguments:
+// - index - The index of the bucket.
+// Return Value:
+// - The upper bound of the bucket in nanoseconds, inclusive.
+uint64_t ApiStatistics::s_BucketUpperBound(const size_t index) noexcept
+{
+    if (index < BucketsPerOctave)
+    {
+        return index;
+    }
+
+    const auto shift = index / BucketsPerOctave - 1;
+    const uint64_t lower = uint64_t{ BucketsPerOctave + index % BucketsPerOctave } << shift;
+    return lower + (uint64_t{ 1 } << shift) - 1;
+}
+
+// Routine Description:
+// - Finds the latency that the given percentage of the calls didn't exceed.
+// Arguments:
+// - buckets - A snapshot of the histogram.
+// - count - The number of calls counted in the snapshot.
+// - percent - The percentile to find, from 1 to 100.
+// Return Value:
+// - The upper bound of the bucket the percentile falls into, or 0 if there
+//   weren't any calls.
+std::chrono::nanoseconds ApiStatistics::s_Percentile(const std::array<uint64_t, BucketCount>& buckets,
+                                                     const uint64_t count,
+                                                     const uint64_t percent) noexcept
+{
+    // The rank of the call we're looking for, rounded up, so that the median
+    // of a single call is that call.
+    const auto rank = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i)
+    {
+        seen += til::at(buckets, i);
+        if (seen >= rank && seen != 0)
+        {
+            return std::chrono::nanoseconds{ s_BucketUpperBound(i) };
+        }
+    }
+    return std::chrono::nanoseconds{ 0 };
+}
@@ -0,0 +1,69 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiStatistics.h
+
+Abstract:
+- Aggregated timings of a console API: how often it was called, how long the
+  calls took and how much of that was spent waiting for the console lock, and
+  how many bytes they read from and returned to the client.
+- The IO thread records every call it services. The counters are atomics, so
+  they can be read at any time, from any thread, without taking a lock.
+- Latencies are counted in a histogram with BucketsPerOctave buckets for each
+  power of two. The percentiles we report are the upper bound of the bucket
+  they fall into, so they're at most a quarter too high.
+--*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+class ApiStatistics final
+{
+public:
+    struct Summary
+    {
+        uint64_t calls;
+        uint64_t pendedCalls;
+        std::chrono::nanoseconds totalTime;
+        std::chrono::nanoseconds medianTime;
+        std::chrono::nanoseconds p99Time;
+        std::chrono::nanoseconds lockWaitTime;
+        uint64_t bytesIn;
+        uint64_t bytesOut;
+    };
+
+    static constexpr size_t BucketsPerOctave = 4;
+    // The last bucket starts at 7.5 seconds and takes everything longer than that.
+    static constexpr size_t BucketCount = 128;
+
+    void Record(const std::chrono::nanoseconds time,
+                const std::chrono::nanoseconds lockWaitTime,
+                const uint64_t bytesIn,
+                const uint64_t bytesOut,
+                const bool pended) noexcept;
+    Summary Summarize() const noexcept;
+
+    static void s_AddLockWait(const std::chrono::nanoseconds time) noexcept;
+    static std::chrono::nanoseconds s_GetLockWait() noexcept;
+
+    static size_t s_BucketIndex(const uint64_t nanoseconds) noexcept;
+    static uint64_t s_BucketUpperBound(const size_t index) noexcept;
+
+private:
+    static std::chrono::nanoseconds s_Percentile(const std::array<uint64_t, BucketCount>& buckets,
+                                                 const uint64_t count,
+                                                 const uint64_t percent) noexcept;
+
+    std::atomic<uint64_t> _calls{ 0 };
+    std::atomic<uint64_t> _pendedCalls{ 0 };
+    std::atomic<uint64_t> _totalNanoseconds{ 0 };
+    std::atomic<uint64_t> _lockWaitNanoseconds{ 0 };
+    std::atomic<uint64_t> _bytesIn{ 0 };
+    std::atomic<uint64_t> _bytesOut{ 0 };
+    std::array<std::atomic<uint64_t>, BucketCount> _buckets{};
+};
@@ -68,18 +68,19 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     bool success = _pConApi->GetConsoleOutputCP(codepage);
     if (success)
     {
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        // Pasted text arrives here in large chunks. Synthesize the records of
+        // all of its key events into one buffer and write them at once,
+        // instead of allocating an IInputEvent for each of them.
+        std::vector<INPUT_RECORD> keyEvents;
+        keyEvents.reserve(string.size() * 2);
 
         for (const auto& wch : string)
         {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = Microsoft::Console::Interactivity::CharToKeyEvents(wch, codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
+            Microsoft::Console::Interactivity::CharToKeyEvents(wch, codepage, keyEvents);
         }
 
-        success = WriteInput(keyEvents);
+        size_t written = 0;
+        success = _pConApi->PrivateWriteConsoleInputW(keyEvents, written);
     }
     return success;
 }
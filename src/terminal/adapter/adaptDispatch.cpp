@@ -71,13 +71,8 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
     {
         if (_termOutput.NeedToTranslate())
         {
-            std::wstring buffer;
-            buffer.reserve(string.size());
-            for (auto& wch : string)
-            {
-                buffer.push_back(_termOutput.TranslateKey(wch));
-            }
-            _pDefaults->PrintString(buffer);
+            _termOutput.TranslateString(string, _translationBuffer);
+            _pDefaults->PrintString(_translationBuffer);
         }
         else
         {
@@ -20,6 +20,7 @@ TerminalOutput::TerminalOutput() noexcept
     _gsetTranslationTables.at(1) = Ascii;
     _gsetTranslationTables.at(2) = Ascii;
     _gsetTranslationTables.at(3) = Ascii;
+    _UpdateTranslationTable();
 }
 
 bool TerminalOutput::Designate94Charset(size_t gsetNumber, const VTID charset)
@@ -60,6 +61,7 @@ bool TerminalOutput::LockingShift(const size_t gsetNumber)
     {
         _glTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -73,6 +75,7 @@ bool TerminalOutput::LockingShiftRight(const size_t gsetNumber)
     {
         _grTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -109,31 +112,41 @@ void TerminalOutput::EnableGrTranslation(boolean enabled)
 
 wchar_t TerminalOutput::TranslateKey(const wchar_t wch) const noexcept
 {
-    wchar_t wchFound = wch;
     if (!_ssTranslationTable.empty())
     {
-        if (wch - 0x20u < _ssTranslationTable.size())
-        {
-            wchFound = _ssTranslationTable.at(wch - 0x20u);
-        }
-        else if (wch - 0xA0u < _ssTranslationTable.size())
-        {
-            wchFound = _ssTranslationTable.at(wch - 0xA0u);
-        }
-        _ssTranslationTable = {};
+        return _TranslateSingleShift(wch);
     }
-    else
+    return wch < _translationTable.size() ? til::at(_translationTable, wch) : wch;
+}
+
+// Routine Description:
+// - Translates a whole string through the active character sets. A pending
+//   single shift only applies to the first character, like it would when the
+//   characters are translated one at a time with TranslateKey.
+// Arguments:
+// - string - The characters to translate.
+// - buffer - Receives the translated characters. Its capacity is reused, so
+//            that a caller that keeps the buffer around doesn't allocate for
+//            every string it translates.
+// Return Value:
+// - <none>
+void TerminalOutput::TranslateString(const std::wstring_view string, std::wstring& buffer) const
+{
+    buffer.resize(string.size());
+    if (string.empty())
     {
-        if (wch - 0x20u < _glTranslationTable.size())
-        {
-            wchFound = _glTranslationTable.at(wch - 0x20u);
-        }
-        else if (wch - 0xA0u < _grTranslationTable.size())
-        {
-            wchFound = _grTranslationTable.at(wch - 0xA0u);
-        }
+        return;
     }
-    return wchFound;
+
+    auto in = string.begin();
+    auto out = buffer.begin();
+    if (!_ssTranslationTable.empty())
+    {
+        *out++ = _TranslateSingleShift(*in++);
+    }
+    std::transform(in, string.end(), out, [&](const wchar_t wch) noexcept {
+        return wch < _translationTable.size() ? til::at(_translationTable, wch) : wch;
+    });
 }
 
 const std::wstring_view TerminalOutput::_LookupTranslationTable94(const VTID charset) const
@@ -246,6 +259,52 @@ bool TerminalOutput::_SetTranslationTable(const size_t gsetNumber, const std::ws
     return LockingShift(_glSetNumber) && LockingShiftRight(_grSetNumber);
 }
 
+// Routine Description:
+// - Rebuilds the combined translation table from the active GL and GR sets.
+//   This has to be called whenever either of them changes.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TerminalOutput::_UpdateTranslationTable() noexcept
+{
+    for (size_t i = 0; i < _translationTable.size(); i++)
+    {
+        auto wch = gsl::narrow_cast<wchar_t>(i);
+        if (i - 0x20u < _glTranslationTable.size())
+        {
+            wch = til::at(_glTranslationTable, i - 0x20u);
+        }
+        else if (i - 0xA0u < _grTranslationTable.size())
+        {
+            wch = til::at(_grTranslationTable, i - 0xA0u);
+        }
+        til::at(_translationTable, i) = wch;
+    }
+}
+
+// Routine Description:
+// - Translates a character through the set selected by a single shift, and
+//   clears the single shift, since it only applies to one character.
+// Arguments:
+// - wch - The character to translate.
+// Return Value:
+// - The translated character.
+wchar_t TerminalOutput::_TranslateSingleShift(const wchar_t wch) const noexcept
+{
+    auto wchFound = wch;
+    if (wch - 0x20u < _ssTranslationTable.size())
+    {
+        wchFound = til::at(_ssTranslationTable, wch - 0x20u);
+    }
+    else if (wch - 0xA0u < _ssTranslationTable.size())
+    {
+        wchFound = til::at(_ssTranslationTable, wch - 0xA0u);
+    }
+    _ssTranslationTable = {};
+    return wchFound;
+}
+
 void TerminalOutput::_ReplaceDrcsTable(const std::wstring_view oldTable, const std::wstring_view newTable)
 {
     if (newTable.data() != oldTable.data())
@@ -259,6 +259,30 @@ public:
         return _privateWriteConsoleInputWResult;
     }
 
+    bool PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
+                                   size_t& eventsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleInputW MOCK called...");
+
+        if (_privateWriteConsoleInputWResult)
+        {
+            // copy all the input records we were given into local storage so we can test against them
+            Log::Comment(NoThrowString().Format(L"Copying %zu input records into local storage...", records.size()));
+
+            if (!_retainInput)
+            {
+                _events.clear();
+            }
+            for (const auto& record : records)
+            {
+                _events.push_back(IInputEvent::Create(record));
+            }
+            eventsWritten = _events.size();
+        }
+
+        return _privateWriteConsoleInputWResult;
+    }
+
     bool PrivateWriteConsoleControlInput(_In_ KeyEvent key) override
     {
         Log::Comment(L"PrivateWriteConsoleControlInput MOCK called...");
@@ -724,17 +748,22 @@ private:
 
 class DummyAdapter : public AdaptDefaults
 {
-    void Print(const wchar_t /*wch*/) override
+public:
+    void Print(const wchar_t wch) override
     {
+        _printed.push_back(wch);
     }
 
-    void PrintString(const std::wstring_view /*string*/) override
+    void PrintString(const std::wstring_view string) override
     {
+        _printed.append(string);
     }
 
     void Execute(const wchar_t /*wch*/) override
     {
     }
+
+    std::wstring _printed;
 };
 
 class AdapterTest
@@ -754,6 +783,7 @@ public:
 
             // give AdaptDispatch ownership of _testGetSet
             _testGetSet = api.get(); // keep a copy for us but don't manage its lifetime anymore.
+            _testAdapter = adapter.get();
             _pDispatch = std::make_unique<AdaptDispatch>(std::move(api), std::move(adapter));
             fSuccess = _pDispatch != nullptr;
         }
@@ -764,6 +794,7 @@ public:
     {
         _pDispatch.reset();
         _testGetSet = nullptr;
+        _testAdapter = nullptr;
         return true;
     }
 
@@ -2632,7 +2663,43 @@ public:
         VERIFY_IS_TRUE(_pDispatch.get()->DesignateCodingSystem(DispatchTypes::CodingSystem::UTF8));
     }
 
+    TEST_METHOD(TranslatingPrintedStrings)
+    {
+        Log::Comment(L"1. Strings are printed unmodified in the default character sets");
+        _pDispatch.get()->PrintString(L"lqk");
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"lqk" }, std::wstring_view{ _testAdapter->_printed });
+
+        Log::Comment(L"2. DEC Special Graphics in GL translates the whole string");
+        _testAdapter->_printed.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->Designate94Charset(1, VTID("0")));
+        VERIFY_IS_TRUE(_pDispatch.get()->LockingShift(1));
+        _pDispatch.get()->PrintString(L"lqk x");
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u250c\u2500\u2510 \u2502" }, std::wstring_view{ _testAdapter->_printed });
+
+        Log::Comment(L"3. A single shift only applies to the first character");
+        _testAdapter->_printed.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->Designate94Charset(2, VTID("A")));
+        VERIFY_IS_TRUE(_pDispatch.get()->SingleShift(2));
+        _pDispatch.get()->PrintString(L"#q#");
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u00a3\u2500#" }, std::wstring_view{ _testAdapter->_printed });
+
+        Log::Comment(L"4. Printing a character at a time matches printing the string");
+        _testAdapter->_printed.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->SingleShift(2));
+        for (const auto wch : std::wstring_view{ L"#q#" })
+        {
+            _pDispatch.get()->Print(wch);
+        }
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u00a3\u2500#" }, std::wstring_view{ _testAdapter->_printed });
+
+        Log::Comment(L"5. Characters outside the GL and GR ranges are left alone");
+        _testAdapter->_printed.clear();
+        _pDispatch.get()->PrintString(L"\u3042q");
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\u3042\u2500" }, std::wstring_view{ _testAdapter->_printed });
+    }
+
 private:
     TestGetSet* _testGetSet; // non-ownership pointer
+    DummyAdapter* _testAdapter; // non-ownership pointer
     std::unique_ptr<AdaptDispatch> _pDispatch;
 };
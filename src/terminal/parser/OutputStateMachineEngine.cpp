@@ -21,6 +21,7 @@ OutputStateMachineEngine::OutputStateMachineEngine(std::unique_ptr<ITermDispatch
     _dispatch(std::move(pDispatch)),
     _pfnFlushToTerminal(nullptr),
     _pTtyConnection(nullptr),
+    _passthroughMode(false),
     _lastPrintedChar(AsciiChars::NUL)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, _dispatch.get());
@@ -87,6 +88,13 @@ bool OutputStateMachineEngine::ActionExecute(const wchar_t wch)
         break;
     }
 
+    // In passthrough mode the terminal gets every control character we
+    // execute, except for the NULs we filter and the BEL we already sent.
+    if (_passthroughMode && wch != AsciiChars::NUL && wch != AsciiChars::BEL)
+    {
+        ActionPassThroughString({ &wch, 1 });
+    }
+
     _ClearLastChar();
 
     return true;
@@ -124,6 +132,11 @@ bool OutputStateMachineEngine::ActionPrint(const wchar_t wch)
 
     _dispatch->Print(wch); // call print
 
+    if (_passthroughMode)
+    {
+        ActionPassThroughString({ &wch, 1 });
+    }
+
     return true;
 }
 
@@ -150,6 +163,11 @@ bool OutputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 
     _dispatch->PrintString(string); // call print
 
+    if (_passthroughMode)
+    {
+        ActionPassThroughString(string);
+    }
+
     return true;
 }
 
@@ -190,6 +208,7 @@ bool OutputStateMachineEngine::ActionPassThroughString(const std::wstring_view s
 bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
 {
     bool success = false;
+    bool isRequest = false;
 
     switch (id)
     {
@@ -231,6 +250,7 @@ bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
         break;
     case EscActionCodes::DECID_IdentifyDevice:
         success = _dispatch->DeviceAttributes();
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DA);
         break;
     case EscActionCodes::RIS_ResetToInitialState:
@@ -335,7 +355,9 @@ bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
 
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !success)
+    // In passthrough mode, the terminal gets the sequences we did process as
+    //      well, unless they're requests that are meant for us alone.
+    if (_pfnFlushToTerminal != nullptr && (!success || (_passthroughMode && !isRequest)))
     {
         success = _pfnFlushToTerminal();
     }
@@ -357,6 +379,7 @@ bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
 bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTParameters parameters)
 {
     bool success = false;
+    bool isRequest = false;
 
     switch (id)
     {
@@ -397,6 +420,7 @@ bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTPara
         break;
     case Vt52ActionCodes::Identify:
         success = _dispatch->Vt52DeviceAttributes();
+        isRequest = true;
         break;
     case Vt52ActionCodes::EnterAlternateKeypadMode:
         success = _dispatch->SetKeypadMode(true);
@@ -413,6 +437,12 @@ bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTPara
         break;
     }
 
+    // In passthrough mode, the terminal is in VT52 mode as well.
+    if (_pfnFlushToTerminal != nullptr && _passthroughMode && !isRequest)
+    {
+        _pfnFlushToTerminal();
+    }
+
     _ClearLastChar();
 
     return success;
@@ -430,6 +460,7 @@ bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTPara
 bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameters parameters)
 {
     bool success = false;
+    bool isRequest = false;
 
     switch (id)
     {
@@ -522,22 +553,27 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
         break;
     case CsiActionCodes::DSR_DeviceStatusReport:
         success = _dispatch->DeviceStatusReport(parameters.at(0));
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DSR);
         break;
     case CsiActionCodes::DA_DeviceAttributes:
         success = parameters.at(0).value_or(0) == 0 && _dispatch->DeviceAttributes();
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DA);
         break;
     case CsiActionCodes::DA2_SecondaryDeviceAttributes:
         success = parameters.at(0).value_or(0) == 0 && _dispatch->SecondaryDeviceAttributes();
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DA2);
         break;
     case CsiActionCodes::DA3_TertiaryDeviceAttributes:
         success = parameters.at(0).value_or(0) == 0 && _dispatch->TertiaryDeviceAttributes();
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DA3);
         break;
     case CsiActionCodes::DECREQTPARM_RequestTerminalParameters:
         success = _dispatch->RequestTerminalParameters(parameters.at(0));
+        isRequest = true;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DECREQTPARM);
         break;
     case CsiActionCodes::SU_ScrollUp:
@@ -584,6 +620,10 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
         break;
     case CsiActionCodes::DTTERM_WindowManipulation:
         success = _dispatch->WindowManipulation(parameters.at(0), parameters.at(1), parameters.at(2));
+        // Functions 11 to 21 report the window state, size and title. The
+        // others, like resizing and refreshing the window, concern the
+        // terminal as well.
+        isRequest = parameters.at(0).value_or(0) >= 11 && parameters.at(0).value_or(0) <= 21;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
         break;
     case CsiActionCodes::REP_RepeatCharacter:
@@ -630,7 +670,9 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
 
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !success)
+    // In passthrough mode, the terminal gets the sequences we did process as
+    //      well, unless they're requests that are meant for us alone.
+    if (_pfnFlushToTerminal != nullptr && (!success || (_passthroughMode && !isRequest)))
     {
         success = _pfnFlushToTerminal();
     }
@@ -718,6 +760,7 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
                                                  const std::wstring_view string)
 {
     bool success = false;
+    bool isRequest = false;
 
     switch (parameter)
     {
@@ -803,6 +846,7 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
         {
             success = _dispatch->SetClipboard(setClipboardContent);
         }
+        isRequest = queryClipboard;
         TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCSCB);
         break;
     }
@@ -840,7 +884,9 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
 
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !success)
+    // In passthrough mode, the terminal gets the sequences we did process as
+    //      well, unless they're requests that are meant for us alone.
+    if (_pfnFlushToTerminal != nullptr && (!success || (_passthroughMode && !isRequest)))
     {
         success = _pfnFlushToTerminal();
     }
@@ -1092,6 +1138,20 @@ void OutputStateMachineEngine::SetTerminalConnection(ITerminalOutputConnection*
     this->_pfnFlushToTerminal = pfnFlushToTerminal;
 }
 
+// Method Description:
+// - Turns passthrough mode on or off. In passthrough mode, everything we
+//      process is also written to the terminal connection, as it was given to
+//      us. Only the requests that are meant for us alone (like DSR or DA) are
+//      held back, so that the terminal doesn't answer them a second time.
+// Arguments:
+// - passthroughMode: true to write the processed text to the terminal.
+// Return Value:
+// - <none>
+void OutputStateMachineEngine::SetPassthroughMode(const bool passthroughMode) noexcept
+{
+    _passthroughMode = passthroughMode;
+}
+
 // Routine Description:
 // - Parse OscSetClipboard parameters with the format `Pc;Pd`. Currently the first parameter `Pc` is
 // ignored. The second parameter `Pd` should be a valid base64 string or character `?`.
@@ -58,6 +58,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         void SetTerminalConnection(Microsoft::Console::ITerminalOutputConnection* const pTtyConnection,
                                    std::function<bool()> pfnFlushToTerminal);
+        void SetPassthroughMode(const bool passthroughMode) noexcept;
 
         const ITermDispatch& Dispatch() const noexcept;
         ITermDispatch& Dispatch() noexcept;
@@ -66,6 +67,7 @@ namespace Microsoft::Console::VirtualTerminal
         std::unique_ptr<ITermDispatch> _dispatch;
         Microsoft::Console::ITerminalOutputConnection* _pTtyConnection;
         std::function<bool()> _pfnFlushToTerminal;
+        bool _passthroughMode;
         wchar_t _lastPrintedChar;
 
         enum EscActionCodes : uint64_t
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "groundScanner.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// Routine Description:
+// - Finds the first character in the given string that's actionable from the
+//   ground state (see GroundScanner::IsActionable).
+// - The string is checked 16 (AVX2) or 8 (SSE2) code units at a time. The
+//   remaining tail, and platforms without SSE2, use the scalar loop.
+// Arguments:
+// - string - The string to scan.
+// Return Value:
+// - The index of the first actionable character, or string.size() if there is none.
+size_t GroundScanner::FindActionable(const std::wstring_view string) noexcept
+{
+    const auto beg = string.data();
+    const auto end = beg + string.size();
+    auto it = beg;
+
+    // Both vectorized implementations below use the same trick to test 2 ranges
+    // with unsigned 16-bit arithmetic, for which SSE2 has no direct comparison:
+    // * wch <= 0x1F: A saturated subtraction (wch -sat 0x1F) is 0 only if wch <= 0x1F.
+    // * 0x7F <= wch <= 0x9F: Subtracting 0x7F with wrap-around moves the range to
+    //   [0x00, 0x20] and everything below 0x7F up to [0xFF81, 0xFFFF].
+    //   Then the same saturated subtraction trick is applied with 0x20.
+    // The comparison with zero results in 0xFFFF for each matching code unit.
+    // _mm_movemask_epi8 extracts one bit per *byte*, which is why the
+    // index returned by _BitScanForward must be divided by 2.
+#ifdef __AVX2__
+    {
+        const auto zero = _mm256_setzero_si256();
+        const auto c0Max = _mm256_set1_epi16(0x1F);
+        const auto delMin = _mm256_set1_epi16(0x7F);
+        const auto delRange = _mm256_set1_epi16(0x9F - 0x7F);
+
+        for (; end - it >= 16; it += 16)
+        {
+            const auto wch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto c0 = _mm256_cmpeq_epi16(_mm256_subs_epu16(wch, c0Max), zero);
+            const auto c1 = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(wch, delMin), delRange), zero);
+            const auto mask = static_cast<unsigned long>(_mm256_movemask_epi8(_mm256_or_si256(c0, c1)));
+            unsigned long index;
+            if (_BitScanForward(&index, mask))
+            {
+                return gsl::narrow_cast<size_t>(it - beg) + index / 2;
+            }
+        }
+    }
+#endif
+#if defined(__AVX2__) || defined(_M_AMD64)
+    {
+        const auto zero = _mm_setzero_si128();
+        const auto c0Max = _mm_set1_epi16(0x1F);
+        const auto delMin = _mm_set1_epi16(0x7F);
+        const auto delRange = _mm_set1_epi16(0x9F - 0x7F);
+
+        for (; end - it >= 8; it += 8)
+        {
+            const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto c0 = _mm_cmpeq_epi16(_mm_subs_epu16(wch, c0Max), zero);
+            const auto c1 = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(wch, delMin), delRange), zero);
+            const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_or_si128(c0, c1)));
+            unsigned long index;
+            if (_BitScanForward(&index, mask))
+            {
+                return gsl::narrow_cast<size_t>(it - beg) + index / 2;
+            }
+        }
+    }
+#endif
+
+    const auto offset = gsl::narrow_cast<size_t>(it - beg);
+    return offset + FindActionableScalar(std::wstring_view{ it, gsl::narrow_cast<size_t>(end - it) });
+}
+
+// Routine Description:
+// - The scalar implementation of FindActionable. It's used for the tail of the
+//   string that doesn't fill a whole vector and serves as the reference
+//   implementation for tests and benchmarks.
+// Arguments:
+// - string - The string to scan.
+// Return Value:
+// - The index of the first actionable character, or string.size() if there is none.
+size_t GroundScanner::FindActionableScalar(const std::wstring_view string) noexcept
+{
+    const auto it = std::find_if(string.begin(), string.end(), IsActionable);
+    return gsl::narrow_cast<size_t>(it - string.begin());
+}
+
+// Routine Description:
+// - Finds the first C0 control character or DEL in the given UTF-8 string
+//   (see GroundScanner::IsActionableUtf8).
+// - The string is checked 32 (AVX2) or 16 (SSE2) bytes at a time. The
+//   remaining tail, and platforms without SSE2, use the scalar loop.
+// Arguments:
+// - string - The UTF-8 string to scan.
+// Return Value:
+// - The index of the first actionable byte, or string.size() if there is none.
+size_t GroundScanner::FindActionable(const std::string_view string) noexcept
+{
+    const auto beg = string.data();
+    const auto end = beg + string.size();
+    auto it = beg;
+
+    // Same as above, but with bytes: (ch -sat 0x1F) is 0 only if ch <= 0x1F
+    // and DEL is a single value that can be compared directly.
+    // Since _mm_movemask_epi8 extracts one bit per byte, the index is exact.
+#ifdef __AVX2__
+    {
+        const auto zero = _mm256_setzero_si256();
+        const auto c0Max = _mm256_set1_epi8(0x1F);
+        const auto del = _mm256_set1_epi8(0x7F);
+
+        for (; end - it >= 32; it += 32)
+        {
+            const auto ch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const auto c0 = _mm256_cmpeq_epi8(_mm256_subs_epu8(ch, c0Max), zero);
+            const auto d = _mm256_cmpeq_epi8(ch, del);
+            const auto mask = static_cast<unsigned long>(_mm256_movemask_epi8(_mm256_or_si256(c0, d)));
+            unsigned long index;
+            if (_BitScanForward(&index, mask))
+            {
+                return gsl::narrow_cast<size_t>(it - beg) + index;
+            }
+        }
+    }
+#endif
+#if defined(__AVX2__) || defined(_M_AMD64)
+    {
+        const auto zero = _mm_setzero_si128();
+        const auto c0Max = _mm_set1_epi8(0x1F);
+        const auto del = _mm_set1_epi8(0x7F);
+
+        for (; end - it >= 16; it += 16)
+        {
+            const auto ch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const auto c0 = _mm_cmpeq_epi8(_mm_subs_epu8(ch, c0Max), zero);
+            const auto d = _mm_cmpeq_epi8(ch, del);
+            const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(_mm_or_si128(c0, d)));
+            unsigned long index;
+            if (_BitScanForward(&index, mask))
+            {
+                return gsl::narrow_cast<size_t>(it - beg) + index;
+            }
+        }
+    }
+#endif
+
+    const auto offset = gsl::narrow_cast<size_t>(it - beg);
+    return offset + FindActionableScalar(std::string_view{ it, gsl::narrow_cast<size_t>(end - it) });
+}
+
+// Routine Description:
+// - The scalar implementation of FindActionable for UTF-8 strings.
+// Arguments:
+// - string - The UTF-8 string to scan.
+// Return Value:
+// - The index of the first actionable byte, or string.size() if there is none.
+size_t GroundScanner::FindActionableScalar(const std::string_view string) noexcept
+{
+    const auto it = std::find_if(string.begin(), string.end(), IsActionableUtf8);
+    return gsl::narrow_cast<size_t>(it - string.begin());
+}
+
+#pragma warning(pop)
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*
+Module Name:
+- groundScanner.hpp
+
+Abstract:
+- A vectorized scanner for the ground state of the state machine.
+- In the ground state every code unit is printed, unless it's a C0 control
+  character (including ESC), DEL or a C1 control character. Those are the
+  only ones that need the attention of the state machine. Since most output
+  consists of long printable runs, we look for the next one of them 8 or 16
+  code units at a time with SSE2/AVX2 and fall back to a scalar loop otherwise.
+- UTF-8 input is scanned the same way, 16 or 32 bytes at a time. C1 control
+  characters are multi-byte sequences in UTF-8 and are left for the UTF-16
+  scanner to find after the text has been transcoded.
+*/
+
+#pragma once
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class GroundScanner
+    {
+    public:
+        // Returns true if the given character can't be printed as part of a
+        // run from the ground state and needs to be handled by the state machine.
+        static constexpr bool IsActionable(const wchar_t wch) noexcept
+        {
+            // C0 control characters (including ESC), DEL and C1 control characters.
+            return wch <= L'\x1F' || (wch >= L'\x7F' && wch <= L'\x9F');
+        }
+
+        // Returns true if the given UTF-8 code unit is a C0 control character
+        // (including ESC) or DEL. Every other byte is part of printable text.
+        static constexpr bool IsActionableUtf8(const char ch) noexcept
+        {
+            return static_cast<unsigned char>(ch) <= 0x1F || ch == '\x7F';
+        }
+
+        static size_t FindActionable(const std::wstring_view string) noexcept;
+        static size_t FindActionableScalar(const std::wstring_view string) noexcept;
+        static size_t FindActionable(const std::string_view string) noexcept;
+        static size_t FindActionableScalar(const std::string_view string) noexcept;
+    };
+}
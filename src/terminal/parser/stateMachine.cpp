@@ -4,6 +4,7 @@
 #include "precomp.h"
 
 #include "stateMachine.hpp"
+#include "groundScanner.hpp"
 
 #include "ascii.hpp"
 
@@ -364,18 +365,6 @@ static constexpr bool _isApcIndicator(const wchar_t wch) noexcept
     return wch == L'_'; // 0x5F
 }
 
-// Routine Description:
-// - Determines if a character indicates an action that should be taken in the ground state -
-//     These are C0 characters and the C1 [single-character] CSI.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
-{
-    return (wch <= AsciiChars::US) || _isC1ControlCharacter(wch) || _isDelete(wch);
-}
-
 #pragma warning(pop)
 
 // Routine Description:
@@ -1875,14 +1864,19 @@ void StateMachine::ProcessString(const std::wstring_view string)
         }
         else
         {
-            if (_isActionableFromGround(til::at(string, current))) // If the current char is the start of an escape sequence, or should be executed in ground state...
+            // Skip over all the printable characters, adding them to the current run.
+            // The scanner checks multiple characters at a time, so the cost of this
+            // depends on the number of escape sequences and not on the length of the text.
+            current += GroundScanner::FindActionable(string.substr(current));
+
+            if (current < string.size()) // If the current char is the start of an escape sequence, or should be executed in ground state...
             {
+                // The run above was composed INCLUDING the first char, but we've
+                // now determined that current is actionable. Only pass through
+                // everything before it.
+                _runSize = current - start;
                 if (_runSize > 0)
                 {
-                    // Because the run above is composed INCLUDING current, we must
-                    // trim it off here since we just determined it's actionable
-                    // and only pass through everything before it.
-                    _runSize -= 1;
                     const auto allLeadingUpTo = _CurrentRun();
 
                     _engine->ActionPrintString(allLeadingUpTo); // ... print all the chars leading up to it as part of the run...
@@ -1891,11 +1885,6 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
                 _processingIndividually = true; // begin processing future characters individually...
                 start = current;
-                continue;
-            }
-            else
-            {
-                ++current; // Otherwise, add this char to the current run to be printed.
             }
         }
     }
@@ -1999,6 +1988,161 @@ void StateMachine::ProcessString(const std::wstring_view string)
     }
 }
 
+// Routine Description:
+// - Entry point for UTF-8 encoded output, like the one read from a pseudoconsole.
+//   Instead of converting all of it to UTF-16 first, the escape sequences are
+//   parsed on the bytes directly and only the printable text is transcoded.
+// - In the ground state, the bytes are scanned for the next C0 control
+//   character or DEL. Everything in front of it is printable text, which is
+//   transcoded and handed to the UTF-16 ProcessString above as a whole.
+// - From there on, the bytes are fed into the state machine one at a time,
+//   until it's back in the ground state. Escape sequences are ASCII, except
+//   for the contents of strings like the title of an OSC, so only non-ASCII
+//   runs within them have to be transcoded first.
+// - A code point split across calls is completed on the next call. Within the
+//   string an incomplete code point is replaced with U+FFFD, just like a
+//   conversion of the entire string would do.
+// - C1 control characters are multi-byte sequences in UTF-8. They're found
+//   by the UTF-16 ProcessString after the text has been transcoded.
+// - NOTE: This is meant for output engines. An engine that FlushAtEndOfString
+//   would treat the end of every run of text like the end of a write.
+// Arguments:
+// - string - UTF-8 encoded characters to operate upon
+// Return Value:
+// - <none>
+void StateMachine::ProcessString(const std::string_view string)
+{
+    auto remaining = string;
+
+    // The sequence that was started by a previous call is already cached.
+    _utf8Buffer.clear();
+
+    // Finish the code point that the previous call ended in the middle of.
+    if (_utf8State.have)
+    {
+        const auto completion = remaining.substr(0, _utf8State.want);
+        remaining.remove_prefix(completion.size());
+
+        THROW_IF_FAILED(til::u8u16(completion, _utf8Text, _utf8State));
+        _ProcessUtf8Text(_utf8Text);
+    }
+
+    while (!remaining.empty())
+    {
+        if (!_processingIndividually)
+        {
+            const auto textSize = GroundScanner::FindActionable(remaining);
+            if (textSize > 0)
+            {
+                _TranscodeUtf8(remaining, textSize);
+                _ProcessUtf8Text(_utf8Text);
+                continue;
+            }
+
+            _processingIndividually = true;
+        }
+
+        const auto first = til::at(remaining, 0);
+        if ((first & 0x80) == 0)
+        {
+            remaining.remove_prefix(1);
+            _ProcessUtf8Character(static_cast<wchar_t>(first));
+        }
+        else
+        {
+            const auto textEnd = std::find_if(remaining.begin(), remaining.end(), [](const char ch) noexcept {
+                return (ch & 0x80) == 0;
+            });
+            _TranscodeUtf8(remaining, gsl::narrow_cast<size_t>(textEnd - remaining.begin()));
+            _ProcessUtf8Text(_utf8Text);
+        }
+    }
+
+    // If the string ended in the middle of a sequence, cache it, in case
+    // we have to flush the whole thing to the terminal later. The same as
+    // the UTF-16 ProcessString does.
+    if (_processingIndividually && !_utf8Buffer.empty())
+    {
+        if (!_cachedSequence)
+        {
+            _cachedSequence.emplace(std::wstring{});
+        }
+        _cachedSequence->append(_utf8Buffer);
+        _utf8Buffer.clear();
+    }
+}
+
+// Routine Description:
+// - Transcodes the first bytes of a UTF-8 string into _utf8Text and removes
+//   them from it. If that's all of the string, a code point at its end that's
+//   incomplete is kept in _utf8State, to be completed by the next call.
+// Arguments:
+// - string - the UTF-8 string
+// - size - the number of bytes to transcode
+// Return Value:
+// - <none>
+void StateMachine::_TranscodeUtf8(std::string_view& string, const size_t size)
+{
+    const auto text = string.substr(0, size);
+    string.remove_prefix(size);
+
+    if (string.empty())
+    {
+        THROW_IF_FAILED(til::u8u16(text, _utf8Text, _utf8State));
+    }
+    else
+    {
+        THROW_IF_FAILED(til::u8u16(text, _utf8Text));
+    }
+}
+
+// Routine Description:
+// - Processes text that was transcoded from UTF-8. If we're in the middle of
+//   a sequence, it's fed into the state machine one character at a time,
+//   and whatever follows the end of the sequence is handed to the UTF-16
+//   ProcessString.
+// Arguments:
+// - text - the transcoded text
+// Return Value:
+// - <none>
+void StateMachine::_ProcessUtf8Text(std::wstring_view text)
+{
+    while (_processingIndividually && !text.empty())
+    {
+        _ProcessUtf8Character(til::at(text, 0));
+        text.remove_prefix(1);
+    }
+
+    if (!text.empty())
+    {
+        ProcessString(text);
+    }
+}
+
+// Routine Description:
+// - Feeds a character of a sequence from UTF-8 input into the state machine.
+//   The sequence so far is kept in _utf8Buffer, so that the engine can pass
+//   it through with FlushToTerminal.
+// Arguments:
+// - wch - the character
+// Return Value:
+// - <none>
+void StateMachine::_ProcessUtf8Character(const wchar_t wch)
+{
+    _utf8Buffer.push_back(wch);
+    _currentString = _utf8Buffer;
+    _runOffset = 0;
+    _runSize = _utf8Buffer.size();
+
+    ProcessCharacter(wch);
+
+    if (_state == VTStates::Ground)
+    {
+        _processingIndividually = false;
+        _utf8Buffer.clear();
+    }
+}
+
 // Routine Description:
 // - Wherever the state machine is, whatever it's going, go back to ground.
 //     This is used by conhost to "jiggle the handle" - when VT support is
@@ -53,6 +53,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
+        void ProcessString(const std::string_view string);
 
         void ResetState() noexcept;
 
@@ -122,6 +123,10 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _AccumulateTo(const wchar_t wch, size_t& value) noexcept;
 
+        void _TranscodeUtf8(std::string_view& string, const size_t size);
+        void _ProcessUtf8Text(std::wstring_view text);
+        void _ProcessUtf8Character(const wchar_t wch);
+
         enum class VTStates
         {
             Ground,
@@ -177,6 +182,13 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::optional<std::wstring> _cachedSequence;
 
+        // UTF-8 input is transcoded chunk by chunk into these buffers, which are
+        // reused between calls. A code point split across calls is kept in _utf8State.
+        // _utf8Buffer holds the part of the current sequence that's in this call.
+        til::u8state _utf8State;
+        std::wstring _utf8Buffer;
+        std::wstring _utf8Text;
+
         // This is tracked per state machine instance so that separate calls to Process*
         //   can start and finish a sequence.
         bool _processingIndividually;
@@ -49,6 +49,30 @@ public:
     }
 };
 
+// Handles every window manipulation, like a console that implemented them all would.
+class WindowManipulationDispatch final : public TermDispatch
+{
+public:
+    virtual void Execute(const wchar_t /*wchControl*/) override
+    {
+    }
+
+    virtual void Print(const wchar_t /*wchPrintable*/) override
+    {
+    }
+
+    virtual void PrintString(const std::wstring_view /*string*/) override
+    {
+    }
+
+    bool WindowManipulation(const DispatchTypes::WindowManipulationType /*function*/,
+                            const VTParameter /*parameter1*/,
+                            const VTParameter /*parameter2*/) noexcept override
+    {
+        return true;
+    }
+};
+
 class Microsoft::Console::VirtualTerminal::OutputEngineTest final
 {
     TEST_CLASS(OutputEngineTest);
@@ -3436,4 +3460,29 @@ class StateMachineExternalTest final
 
         pDispatch->ClearState();
     }
+
+    TEST_METHOD(TestPassthroughWindowManipulation)
+    {
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::make_unique<WindowManipulationDispatch>());
+        auto pEngine = engine.get();
+        StateMachine mach(std::move(engine));
+
+        size_t flushes = 0;
+        pEngine->SetTerminalConnection(nullptr, [&]() {
+            ++flushes;
+            return true;
+        });
+        pEngine->SetPassthroughMode(true);
+
+        Log::Comment(L"Resizing and refreshing the window concerns the terminal as well");
+        mach.ProcessString(L"\x1b[8;24;80t");
+        VERIFY_ARE_EQUAL(1u, flushes);
+        mach.ProcessString(L"\x1b[7t");
+        VERIFY_ARE_EQUAL(2u, flushes);
+
+        Log::Comment(L"Reports are answered by us, and aren't passed through");
+        mach.ProcessString(L"\x1b[18t");
+        mach.ProcessString(L"\x1b[21t");
+        VERIFY_ARE_EQUAL(2u, flushes);
+    }
 };
@@ -6,7 +6,9 @@
 #include "../../inc/consoletaeftemplates.hpp"
 
 #include "stateMachine.hpp"
+#include "groundScanner.hpp"
 
+using namespace std::string_view_literals;
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -161,6 +163,12 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(BulkTextPrint);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
+    TEST_METHOD(GroundScannerFindsActionable);
+    TEST_METHOD(BulkTextPrintAroundControls);
+    TEST_METHOD(Utf8TextPrintAroundControls);
+    TEST_METHOD(Utf8PartialsSplitAcrossWrites);
+    TEST_METHOD(Utf8PassThroughSplitAcrossWrites);
+
     TEST_METHOD(DcsDataStringsReceivedByHandler);
 };
 
@@ -234,6 +242,155 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::GroundScannerFindsActionable()
+{
+    // The vectorized scanner works on blocks of 8 or 16 characters, so we
+    // test every interesting character at every offset of a string that's
+    // long enough to span multiple blocks and a scalar tail.
+    // The literal starts with NUL, so its length has to come from the literal, not from wcslen.
+    const auto actionable = L"\x00\x07\x0A\x1B\x1F\x7F\x80\x90\x9B\x9F"sv;
+    const auto printable = L" ~\xA0\x3042\xD83D\xDE00\xFFFF"sv;
+    VERIFY_ARE_EQUAL(10u, actionable.size());
+
+    for (const auto background : printable)
+    {
+        std::wstring string(37, background);
+
+        VERIFY_ARE_EQUAL(string.size(), GroundScanner::FindActionable(string));
+        VERIFY_ARE_EQUAL(string.size(), GroundScanner::FindActionableScalar(string));
+
+        for (const auto wch : actionable)
+        {
+            VERIFY_IS_TRUE(GroundScanner::IsActionable(wch));
+
+            for (size_t offset = 0; offset < string.size(); ++offset)
+            {
+                string[offset] = wch;
+                VERIFY_ARE_EQUAL(offset, GroundScanner::FindActionable(string));
+                VERIFY_ARE_EQUAL(offset, GroundScanner::FindActionableScalar(string));
+
+                // Only the first one counts.
+                string.back() = wch;
+                VERIFY_ARE_EQUAL(offset, GroundScanner::FindActionable(string));
+
+                string.back() = background;
+                string[offset] = background;
+            }
+        }
+    }
+
+    for (const auto wch : printable)
+    {
+        VERIFY_IS_FALSE(GroundScanner::IsActionable(wch));
+    }
+}
+
+void StateMachineTest::BulkTextPrintAroundControls()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Runs longer than a vector, shorter than one, and empty ones between controls.
+    const std::wstring_view line{ L"The quick brown fox jumps over the lazy dog" };
+    std::wstring input;
+    std::wstring expectedPrinted;
+    std::wstring expectedExecuted;
+    for (auto i = 0; i < 10; ++i)
+    {
+        input.append(line.substr(i));
+        input.append(L"\r\n\a");
+        input.append(line.substr(0, i));
+        input.append(L"\x1b[m");
+        expectedPrinted.append(line.substr(i));
+        expectedPrinted.append(line.substr(0, i));
+        expectedExecuted.append(L"\r\n\a");
+    }
+
+    machine.ProcessString(input);
+
+    VERIFY_ARE_EQUAL(expectedPrinted, engine.printed);
+    VERIFY_ARE_EQUAL(expectedExecuted, engine.executed);
+}
+
+void StateMachineTest::Utf8TextPrintAroundControls()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+    machine.SetParserMode(StateMachine::Mode::AcceptC1, true);
+
+    // ASCII, Latin-1 (U+00E9), CJK (U+4E2D) and a surrogate pair (U+1F600),
+    // mixed with controls, an SGR sequence and a UTF-8 encoded C1 CSI (U+009B).
+    machine.ProcessString(std::string_view{ "caf\xC3\xA9\r\n\x1b[31m\xE4\xB8\xAD\xF0\x9F\x98\x80 text\a\xC2\x9B""1;2m\xC3\xA9" });
+
+    VERIFY_ARE_EQUAL(L"caf\x00E9\x4E2D\xD83D\xDE00 text\x00E9", engine.printed);
+    VERIFY_ARE_EQUAL(L"\r\n\a", engine.executed);
+    VERIFY_ARE_EQUAL(VTID("m"), engine.csiId);
+    VERIFY_ARE_EQUAL(2u, engine.csiParams.size());
+
+    engine.ResetTestState();
+
+    // An incomplete code point in front of a control character is invalid.
+    machine.ProcessString(std::string_view{ "a\xE4\xB8\nb" });
+    VERIFY_ARE_EQUAL(L"a\xFFFDb", engine.printed);
+    VERIFY_ARE_EQUAL(L"\n", engine.executed);
+}
+
+void StateMachineTest::Utf8PartialsSplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    const std::string_view input{ "\xE4\xB8\xAD\x1b[1;2m\xF0\x9F\x98\x80\xC3\xA9!" };
+
+    // Split the input at every possible position, cutting through code points and the sequence.
+    for (size_t split = 0; split <= input.size(); ++split)
+    {
+        Log::Comment(NoThrowString().Format(L"Split at %zu", split));
+        engine.ResetTestState();
+
+        machine.ProcessString(input.substr(0, split));
+        machine.ProcessString(input.substr(split));
+
+        VERIFY_ARE_EQUAL(L"\x4E2D\xD83D\xDE00\x00E9!", engine.printed);
+        VERIFY_ARE_EQUAL(VTID("m"), engine.csiId);
+        VERIFY_ARE_EQUAL(2u, engine.csiParams.size());
+    }
+}
+
+void StateMachineTest::Utf8PassThroughSplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Hook up the passthrough function.
+    engine.pfnFlushToTerminal = std::bind(&StateMachine::FlushToTerminal, &machine);
+
+    // An OSC with a non-ASCII title, which is parsed on the bytes and passed
+    // through as a whole, between two runs of text.
+    const std::string_view input{ "a\xC3\xA9\x1b]2;t\xE4\xB8\xAD\xF0\x9F\x98\x80\x07b" };
+
+    // Split the input at every possible position, cutting through code points and the sequence.
+    for (size_t split = 0; split <= input.size(); ++split)
+    {
+        Log::Comment(NoThrowString().Format(L"Split at %zu", split));
+        engine.ResetTestState();
+
+        machine.ProcessString(input.substr(0, split));
+        machine.ProcessString(input.substr(split));
+
+        VERIFY_ARE_EQUAL(L"a\x00E9b", engine.printed);
+        VERIFY_ARE_EQUAL(L"\x1b]2;t\x4E2D\xD83D\xDE00\x07", engine.passedThrough);
+    }
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
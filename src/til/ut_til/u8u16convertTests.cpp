@@ -17,6 +17,8 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16MixedText);
+    TEST_METHOD(TestU16ToU8MixedText);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +193,73 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16MixedText()
+{
+    // ASCII runs long enough to be copied with SIMD, separated by non-ASCII
+    // text with short ASCII gaps, and invalid sequences right before ASCII.
+    const std::string ascii8(40, 'a');
+    const std::wstring ascii16(40, L'a');
+
+    const std::string u8String{
+        ascii8 +
+        "\xC3\xB6 x \xE2\x82\xAC" + // LATIN SMALL LETTER O WITH DIAERESIS, " x ", EURO SIGN
+        ascii8 +
+        "\xFF" + // not UTF-8 at all
+        ascii8 +
+        "\xE2\x82" + // EURO SIGN, cut short
+        ascii8
+    };
+
+    const std::wstring u16StringComp{
+        ascii16 +
+        L"\x00f6 x \x20ac" +
+        ascii16 +
+        L"\xFFFD" +
+        ascii16 +
+        L"\xFFFD" +
+        ascii16
+    };
+
+    std::wstring u16Out{};
+    VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+    VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+
+    Log::Comment(L"Reusing the output string mustn't leave anything behind.");
+    VERIFY_SUCCEEDED(til::u8u16(ascii8, u16Out));
+    VERIFY_ARE_EQUAL(ascii16, u16Out);
+
+    til::u8state state{};
+    VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out, state));
+    VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8MixedText()
+{
+    const std::string ascii8(40, 'a');
+    const std::wstring ascii16(40, L'a');
+
+    const std::wstring u16String{
+        ascii16 +
+        L"\x00f6 x \x20ac" + // LATIN SMALL LETTER O WITH DIAERESIS, " x ", EURO SIGN
+        ascii16 +
+        L"\xDF5C" + // a low surrogate on its own
+        ascii16
+    };
+
+    const std::string u8StringComp{
+        ascii8 +
+        "\xC3\xB6 x \xE2\x82\xAC" +
+        ascii8 +
+        "\xEF\xBF\xBD" + // REPLACEMENT CHARACTER
+        ascii8
+    };
+
+    std::string u8Out{};
+    VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+    VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+
+    til::u16state state{};
+    VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out, state));
+    VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+}
@@ -0,0 +1,6 @@
+:: TEST TOOL PasteBench
+@echo off &setlocal
+cd /d "%~dp0"
+..\..\..\x64\Release\PasteBench.exe
+echo(
+pause
@@ -0,0 +1,174 @@
+// TEST TOOL PasteBench
+// End-to-end benchmark for pasting text into an application that waits in a cooked read.
+// A copy of this tool is started in a pseudoconsole, hosted by the OpenConsole.exe next to
+// it if there is one. The copy reads lines with ReadConsoleW, with line input and echo on,
+// while we write 1, 10 and 100 MB of text to the pseudoconsole's input, the way a terminal
+// writes a paste to it. The time is measured until the copy has read the last line.
+
+#define NOMINMAX
+#include <Windows.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gsl/gsl>
+#include <wil/resource.h>
+#include <wil/result.h>
+#include <wil/stl.h>
+#include <wil/win32_helpers.h>
+
+#include "../../inc/conpty-static.h"
+
+// helper functions
+double GetDuration();
+void PrintHeader(const char* const funcName);
+
+constexpr COORD ConsoleSize{ 120, 30 };
+constexpr size_t LineLength{ 80 };
+
+// Generates lines of text of LineLength characters each, including the carriage
+// return that Enter would produce, adding up to the given size.
+std::string MakePaste(const size_t megabytes, size_t& lines)
+{
+    static constexpr std::string_view log{ "[ 42%] Building CXX object src/host/CMakeFiles/host.dir/inputBuffer.cpp.obj " };
+
+    std::string line;
+    while (line.size() < LineLength - 1)
+    {
+        line.append(log);
+    }
+    line.resize(LineLength - 1);
+    line.push_back('\r');
+
+    lines = megabytes * 1024 * 1024 / LineLength;
+    std::string paste;
+    paste.reserve(lines * LineLength);
+    for (size_t i = 0; i < lines; ++i)
+    {
+        paste.append(line);
+    }
+    return paste;
+}
+
+// Runs in the pseudoconsole. Reads until the given number of lines was read.
+int ReadLines(const size_t lines)
+{
+    const auto input = GetStdHandle(STD_INPUT_HANDLE);
+    RETURN_IF_WIN32_BOOL_FALSE(SetConsoleMode(input, ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT | ENABLE_PROCESSED_INPUT));
+
+    std::vector<wchar_t> buffer(4096);
+    size_t linesRead = 0;
+    while (linesRead < lines)
+    {
+        DWORD read = 0;
+        RETURN_IF_WIN32_BOOL_FALSE(ReadConsoleW(input, buffer.data(), gsl::narrow_cast<DWORD>(buffer.size()), &read, nullptr));
+        linesRead += std::count(buffer.data(), buffer.data() + read, L'\n');
+    }
+    return 0;
+}
+
+void PasteIntoCookedRead(const std::wstring& self, const size_t megabytes)
+{
+    PrintHeader(__func__);
+
+    size_t lines = 0;
+    const auto paste = MakePaste(megabytes, lines);
+
+    wil::unique_handle inputRead, inputWrite, outputRead, outputWrite;
+    THROW_IF_WIN32_BOOL_FALSE(CreatePipe(inputRead.addressof(), inputWrite.addressof(), nullptr, 0));
+    THROW_IF_WIN32_BOOL_FALSE(CreatePipe(outputRead.addressof(), outputWrite.addressof(), nullptr, 0));
+
+    HPCON console = nullptr;
+    THROW_IF_FAILED(ConptyCreatePseudoConsole(ConsoleSize, inputRead.get(), outputWrite.get(), 0, &console));
+    auto closeConsole = wil::scope_exit([&]() { ConptyClosePseudoConsole(console); });
+    inputRead.reset();
+    outputWrite.reset();
+
+    // The echo of the paste has to be read, or the console blocks once the pipe is full.
+    std::thread drain{ [&]() {
+        std::vector<char> buffer(128 * 1024);
+        DWORD read = 0;
+        while (ReadFile(outputRead.get(), buffer.data(), gsl::narrow_cast<DWORD>(buffer.size()), &read, nullptr) && read != 0)
+        {
+        }
+    } };
+    auto joinDrain = wil::scope_exit([&]() {
+        closeConsole.reset();
+        drain.join();
+    });
+
+    SIZE_T attributeListSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeListSize);
+    std::vector<std::byte> attributeList(attributeListSize);
+    STARTUPINFOEXW startupInfo{};
+    startupInfo.StartupInfo.cb = sizeof(startupInfo);
+    startupInfo.lpAttributeList = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeList.data());
+    THROW_IF_WIN32_BOOL_FALSE(InitializeProcThreadAttributeList(startupInfo.lpAttributeList, 1, 0, &attributeListSize));
+    auto deleteAttributeList = wil::scope_exit([&]() { DeleteProcThreadAttributeList(startupInfo.lpAttributeList); });
+    THROW_IF_WIN32_BOOL_FALSE(UpdateProcThreadAttribute(startupInfo.lpAttributeList, 0, PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE, console, sizeof(console), nullptr, nullptr));
+
+    auto commandLine = L"\"" + self + L"\" --read " + std::to_wstring(lines);
+    wil::unique_process_information process;
+    THROW_IF_WIN32_BOOL_FALSE(CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, FALSE, EXTENDED_STARTUPINFO_PRESENT, nullptr, nullptr, &startupInfo.StartupInfo, &process));
+
+    GetDuration();
+
+    // Write the paste in chunks of the size a terminal would write it in.
+    static constexpr size_t chunkSize{ 64 * 1024 };
+    for (size_t offset = 0; offset < paste.size(); offset += chunkSize)
+    {
+        const auto size = std::min(chunkSize, paste.size() - offset);
+        DWORD written = 0;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(inputWrite.get(), paste.data() + offset, gsl::narrow_cast<DWORD>(size), &written, nullptr));
+    }
+
+    WaitForSingleObject(process.hProcess, INFINITE);
+    const double duration = GetDuration();
+
+    DWORD exitCode = 0;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    std::cout << " size " << megabytes << " MB\n lines " << lines << "\n exit code " << exitCode << "\n elapsed " << duration << "\n throughput " << megabytes / duration << " MB/s" << std::endl;
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+    if (argc == 3 && std::wstring_view{ argv[1] } == L"--read")
+    {
+        return ReadLines(std::stoull(argv[2]));
+    }
+
+    try
+    {
+        const auto self = wil::GetModuleFileNameW<std::wstring>(nullptr);
+        for (const size_t megabytes : { 1, 10, 100 })
+        {
+            PasteIntoCookedRead(self, megabytes);
+        }
+    }
+    catch (...)
+    {
+        std::cout << "failed with " << std::hex << wil::ResultFromCaughtException() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+double GetDuration()
+{
+    static std::chrono::time_point<std::chrono::high_resolution_clock> previous{};
+    const auto current = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = current - previous;
+    previous = current;
+    return elapsed.count();
+}
+
+// print the header for a test in function funcName
+void PrintHeader(const char* const funcName)
+{
+    std::cout << "\n~~~\ntest \"" << funcName << "\"" << std::endl;
+}
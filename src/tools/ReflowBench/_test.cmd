@@ -0,0 +1,6 @@
+:: TEST TOOL ReflowBench
+@echo off &setlocal
+cd /d "%~dp0"
+..\..\..\x64\Release\ReflowBench.exe
+echo(
+pause
@@ -0,0 +1,147 @@
+// TEST TOOL ReflowBench
+// Benchmark for TextBuffer::Reflow, which runs whenever a window with a full scrollback is resized.
+// A buffer with the default history size of 9001 rows is filled with a mix of short lines,
+// long wrapped lines, colored text and wide glyphs. It's then reflowed into buffers that are
+// narrower, just as wide and wider than the original one, which moves every row of it around.
+
+#include "precomp.h"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <array>
+
+#include "textBuffer.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+
+// helper functions
+double GetDuration();
+void PrintHeader(const char* const funcName);
+
+constexpr SHORT BufferWidth{ 120 };
+constexpr SHORT BufferHeight{ 9001 };
+constexpr UINT CursorSize{ 12 };
+
+// buffer generators
+void FillBuffer(TextBuffer& buffer)
+{
+    static constexpr std::wstring_view prompt{ L"PS C:\\Users\\me\\source\\repos\\terminal> " };
+    static constexpr std::wstring_view log{ L"[ 42%] Building CXX object src/buffer/out/CMakeFiles/buffer.dir/textBuffer.cpp.obj" };
+
+    std::default_random_engine generator{ 42 };
+    std::uniform_int_distribution<int> kind{ 0, 3 };
+    std::uniform_int_distribution<int> cjk{ 0x4E00, 0x9FFF };
+    std::uniform_int_distribution<int> color{ 0, 15 };
+
+    const TextAttribute plain{};
+    COORD position{ 0, 0 };
+    while (position.Y < BufferHeight - 1)
+    {
+        std::vector<std::pair<std::wstring, TextAttribute>> segments;
+        switch (kind(generator))
+        {
+        case 0:
+            // A prompt followed by a command.
+            segments.emplace_back(prompt, TextAttribute{ FOREGROUND_GREEN });
+            segments.emplace_back(L"git log --oneline", plain);
+            break;
+        case 1:
+            // A long line that wraps a couple of times.
+            segments.emplace_back(std::wstring{}, plain);
+            while (segments.back().first.size() < BufferWidth * 3)
+            {
+                segments.back().first.append(log);
+            }
+            break;
+        case 2:
+        {
+            // Syntax highlighted text, changing colors every few characters.
+            for (auto i = 0; i < 12; ++i)
+            {
+                TextAttribute attr;
+                attr.SetIndexedForeground(gsl::narrow_cast<BYTE>(color(generator)));
+                segments.emplace_back(L"token ", attr);
+            }
+            break;
+        }
+        default:
+        {
+            // Wide glyphs, which have to be padded at the end of some rows.
+            std::wstring text;
+            for (auto i = 0; i < BufferWidth * 3 / 4; ++i)
+            {
+                text.push_back(gsl::narrow_cast<wchar_t>(cjk(generator)));
+            }
+            segments.emplace_back(std::move(text), plain);
+            break;
+        }
+        }
+
+        for (const auto& [text, attr] : segments)
+        {
+            const auto result = buffer.WriteStream(text, attr, position, false);
+            position = result.cursorPosition;
+            if (result.charsConsumed < text.size())
+            {
+                buffer.GetCursor().SetPosition(position);
+                return;
+            }
+        }
+
+        position = { 0, gsl::narrow_cast<SHORT>(position.Y + 1) };
+    }
+
+    buffer.GetCursor().SetPosition(position);
+}
+
+// test functions
+void Reflow(TextBuffer& oldBuffer, const SHORT width, DummyRenderTarget& renderTarget)
+{
+    PrintHeader(__func__);
+
+    TextBuffer newBuffer{ { width, BufferHeight }, TextAttribute{}, CursorSize, renderTarget };
+    TextBuffer::PositionInformation positionInfo{ BufferHeight - 30, BufferHeight - 30 };
+
+    GetDuration();
+    THROW_IF_FAILED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, positionInfo));
+    const double duration = GetDuration();
+
+    // The scrollback moved into the new buffer. Give it back for the next run.
+    oldBuffer.GetScrollback() = std::move(newBuffer.GetScrollback());
+
+    const auto cursor = newBuffer.GetCursor().GetPosition();
+    std::cout << " width " << width << "\n cursor " << cursor.X << "," << cursor.Y << "\n viewport top " << positionInfo.mutableViewportTop << "\n elapsed " << duration << std::endl;
+}
+
+int main()
+{
+    DummyRenderTarget renderTarget;
+    TextBuffer buffer{ { BufferWidth, BufferHeight }, TextAttribute{}, CursorSize, renderTarget };
+    FillBuffer(buffer);
+
+    std::cout << "\n\n### " << BufferWidth << "x" << BufferHeight << " buffer, " << std::thread::hardware_concurrency() << " threads ###" << std::endl;
+
+    static constexpr std::array<SHORT, 7> widths{ 40, 80, 119, 120, 121, 160, 240 };
+    for (const auto width : widths)
+    {
+        Reflow(buffer, width, renderTarget);
+    }
+
+    return 0;
+}
+
+// returns the time elapsed between two calls (the return value of the first call is undefined)
+double GetDuration()
+{
+    static std::chrono::time_point<std::chrono::high_resolution_clock> previous{};
+    const auto current = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = current - previous;
+    previous = current;
+    return elapsed.count();
+}
+
+// print the header for a test in function funcName
+void PrintHeader(const char* const funcName)
+{
+    std::cout << "\n~~~\ntest \"" << funcName << "\"" << std::endl;
+}
@@ -3,8 +3,10 @@
 // NOTE The functions u8u16 and u16u8 contain own algorithms. Tests have shown that they perform
 // worse than the platform API functions.
 // Thus, these functions are *unrelated* to the til::u8u16 and til::u16u8 implementation.
+// The "til Throughput" tests at the end measure the til::u8u16 and til::u16u8 implementation itself.
 
 #include <iostream>
+#include <iomanip>
 #include <memory>
 #include <chrono>
 #include <random>
@@ -13,6 +15,11 @@
 
 #include "U8U16Test.hpp"
 
+#include <wil/result_macros.h>
+#include <gsl/gsl>
+#include <base/numerics/safe_math.h>
+#include <til/u8u16convert.h>
+
 typedef NTSTATUS(WINAPI* t_RtlUTF8ToUnicodeN)(PWSTR, ULONG, PULONG, PCCH, ULONG);
 typedef NTSTATUS(WINAPI* t_RtlUnicodeToUTF8N)(PCHAR, ULONG, PULONG, PCWSTR, ULONG);
 NTSTATUS(WINAPI* p_RtlUTF8ToUnicodeN)
@@ -442,6 +449,85 @@ void CompNaturalLang_Chunks(const std::string& fileName)
     std::cout << " u16u8_ptr           length " << lenTotalU16U8 << " elapsed " << durTotalU16U8 << std::endl;
 }
 
+// prints the throughput of a conversion in MB of UTF-8 per second
+void PrintThroughput(const char* const name, size_t u8Length, double duration)
+{
+    std::cout << " " << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+              << static_cast<double>(u8Length) / duration / 1e6 << " MB/s" << std::endl;
+}
+
+// Compares til::u8u16 and til::u16u8 with the platform functions they fall back to, for the
+// whole text at once and for the 4 KiB chunks in which conpty output arrives (with partials).
+void TilThroughput(const std::string& fileName)
+{
+    std::string head{ __func__ };
+    head += " - " + fileName;
+    PrintHeader(head.c_str());
+    std::ostringstream u8Ss{};
+    std::ostringstream buf{};
+    buf << std::ifstream{ fileName }.rdbuf();
+    std::fill_n(std::ostream_iterator<const char*>{ u8Ss }, 300000u, buf.str().c_str());
+    const std::string u8Str = u8Ss.str();
+
+    std::wstring u16Str{};
+    if (FAILED(til::u8u16(u8Str, u16Str)))
+    {
+        return;
+    }
+
+    std::wstring u16Out{};
+    std::string u8Out{};
+    double duration{};
+
+    std::unique_ptr<wchar_t[]> u16Buffer{ std::make_unique<wchar_t[]>(u8Str.length()) };
+    GetDuration();
+    MultiByteToWideChar(65001, 0, u8Str.data(), static_cast<int>(u8Str.length()), u16Buffer.get(), static_cast<int>(u8Str.length()));
+    duration = GetDuration();
+    u16Buffer.reset();
+    PrintThroughput("MultiByteToWideChar", u8Str.length(), duration);
+
+    GetDuration();
+    const HRESULT hRes1 = til::u8u16(u8Str, u16Out);
+    duration = GetDuration();
+    PrintThroughput(SUCCEEDED(hRes1) ? "til::u8u16" : "til::u8u16 (failed)", u8Str.length(), duration);
+
+    std::unique_ptr<char[]> u8Buffer{ std::make_unique<char[]>(u16Str.length() * 3) };
+    GetDuration();
+    WideCharToMultiByte(65001, 0, u16Str.data(), static_cast<int>(u16Str.length()), u8Buffer.get(), static_cast<int>(u16Str.length()) * 3, nullptr, nullptr);
+    duration = GetDuration();
+    u8Buffer.reset();
+    PrintThroughput("WideCharToMultiByte", u8Str.length(), duration);
+
+    GetDuration();
+    const HRESULT hRes2 = til::u16u8(u16Str, u8Out);
+    duration = GetDuration();
+    PrintThroughput(SUCCEEDED(hRes2) ? "til::u16u8" : "til::u16u8 (failed)", u8Str.length(), duration);
+
+    constexpr const size_t chunkSize{ 4096u };
+    const std::string_view u8View{ u8Str };
+    const std::wstring_view u16View{ u16Str };
+
+    til::u8state u8State{};
+    HRESULT hRes3{};
+    GetDuration();
+    for (size_t idx = 0u; idx < u8View.length() && SUCCEEDED(hRes3); idx += chunkSize)
+    {
+        hRes3 = til::u8u16(u8View.substr(idx, chunkSize), u16Out, u8State);
+    }
+    duration = GetDuration();
+    PrintThroughput(SUCCEEDED(hRes3) ? "til::u8u16 (4 KiB chunks)" : "til::u8u16 (4 KiB chunks, failed)", u8Str.length(), duration);
+
+    til::u16state u16State{};
+    HRESULT hRes4{};
+    GetDuration();
+    for (size_t idx = 0u; idx < u16View.length() && SUCCEEDED(hRes4); idx += chunkSize)
+    {
+        hRes4 = til::u16u8(u16View.substr(idx, chunkSize), u8Out, u16State);
+    }
+    duration = GetDuration();
+    PrintThroughput(SUCCEEDED(hRes4) ? "til::u16u8 (4 Ki chunks)" : "til::u16u8 (4 Ki chunks, failed)", u8Str.length(), duration);
+}
+
 int main()
 {
     // UTF-16 string length
@@ -519,6 +605,13 @@ int main()
     CompNaturalLang_Chunks("ru.txt");
     CompNaturalLang_Chunks("zh.txt");
 
+    std::cout << "\n\n### til Throughput ###" << std::endl;
+
+    TilThroughput("en.txt");
+    TilThroughput("fr.txt");
+    TilThroughput("ru.txt");
+    TilThroughput("zh.txt");
+
     FreeLibrary(ntdll);
     return 0;
 }
@@ -0,0 +1,6 @@
+:: TEST TOOL VtParserBench
+@echo off &setlocal
+cd /d "%~dp0"
+..\..\..\x64\Release\VtParserBench.exe
+echo(
+pause
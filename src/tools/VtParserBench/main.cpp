@@ -0,0 +1,213 @@
+// TEST TOOL VtParserBench
+// Throughput benchmark for the VT state machine and its vectorized ground state scanner.
+// Every corpus is scanned with the scalar reference implementation and the vectorized
+// GroundScanner, and then parsed by a StateMachine with an engine that ignores all actions.
+// With plain text the parse time should approach the scan time. It should only grow
+// with the number of escape sequences, not with the number of characters.
+// The UTF-8 encoded corpus is parsed by converting all of it to UTF-16 up front,
+// like ConptyConnection does, and by the UTF-8 entry point of the StateMachine.
+
+#include "precomp.h"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+
+#include "stateMachine.hpp"
+#include "groundScanner.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+// An engine that does nothing, so that we only measure the state machine itself.
+class NullEngine final : public IStateMachineEngine
+{
+public:
+    bool ActionExecute(const wchar_t) override { return true; }
+    bool ActionExecuteFromEscape(const wchar_t) override { return true; }
+    bool ActionPrint(const wchar_t) override { return true; }
+    bool ActionPrintString(const std::wstring_view string) override
+    {
+        printed += string.size();
+        return true;
+    }
+    bool ActionPassThroughString(const std::wstring_view) override { return true; }
+    bool ActionEscDispatch(const VTID) override { return true; }
+    bool ActionVt52EscDispatch(const VTID, const VTParameters) override { return true; }
+    bool ActionCsiDispatch(const VTID, const VTParameters) override { return true; }
+    StringHandler ActionDcsDispatch(const VTID, const VTParameters) override { return nullptr; }
+    bool ActionClear() override { return true; }
+    bool ActionIgnore() override { return true; }
+    bool ActionOscDispatch(const wchar_t, const size_t, const std::wstring_view) override { return true; }
+    bool ActionSs3Dispatch(const wchar_t, const VTParameters) override { return true; }
+    bool ParseControlSequenceAfterSs3() const override { return false; }
+    bool FlushAtEndOfString() const override { return false; }
+    bool DispatchControlCharsFromEscape() const override { return false; }
+    bool DispatchIntermediatesFromEscape() const override { return false; }
+
+    size_t printed{};
+};
+
+// helper functions
+double GetDuration();
+void PrintHeader(const char* const funcName);
+
+// corpus generators
+std::wstring MakeAsciiCorpus(const size_t length)
+{
+    // Build log style lines of printable ASCII.
+    static constexpr std::wstring_view line{ L"[ 42%] Building CXX object src/buffer/out/CMakeFiles/buffer.dir/textBuffer.cpp.obj\r\n" };
+    std::wstring corpus;
+    corpus.reserve(length + line.size());
+    while (corpus.size() < length)
+    {
+        corpus.append(line);
+    }
+    return corpus;
+}
+
+std::wstring MakeCjkCorpus(const size_t length)
+{
+    // Long lines of random CJK Unified Ideographs.
+    std::default_random_engine generator{ 42 };
+    std::uniform_int_distribution<int> distribution{ 0x4E00, 0x9FFF };
+    std::wstring corpus;
+    corpus.reserve(length + 2);
+    while (corpus.size() < length)
+    {
+        for (auto i = 0; i < 60; ++i)
+        {
+            corpus.push_back(static_cast<wchar_t>(distribution(generator)));
+        }
+        corpus.append(L"\r\n");
+    }
+    return corpus;
+}
+
+std::wstring MakeEscapeHeavyCorpus(const size_t length)
+{
+    // Syntax highlighted source code: a color change every couple of characters.
+    static constexpr std::wstring_view line{ L"\x1b[38;5;33mint\x1b[0m \x1b[38;2;220;220;170mmain\x1b[0m()\x1b[K\r\n\x1b[1;4H\x1b[?25l{\x1b[m\r\n" };
+    std::wstring corpus;
+    corpus.reserve(length + line.size());
+    while (corpus.size() < length)
+    {
+        corpus.append(line);
+    }
+    return corpus;
+}
+
+// test functions
+template<typename Scanner>
+void Scan(const char* const name, std::wstring_view corpus, Scanner scanner)
+{
+    PrintHeader(name);
+    size_t actionable{};
+    GetDuration();
+    for (;;)
+    {
+        const auto offset = scanner(corpus);
+        if (offset >= corpus.size())
+        {
+            break;
+        }
+        ++actionable;
+        corpus = corpus.substr(offset + 1);
+    }
+    const double duration = GetDuration();
+    std::cout << " actionable " << actionable << "\n elapsed " << duration << std::endl;
+}
+
+void Parse(std::wstring_view corpus, const size_t chunkLen)
+{
+    PrintHeader(__func__);
+    auto enginePtr{ std::make_unique<NullEngine>() };
+    const auto& engine{ *enginePtr };
+    StateMachine machine{ std::move(enginePtr) };
+
+    GetDuration();
+    for (size_t i{}; i < corpus.size(); i += chunkLen)
+    {
+        machine.ProcessString(corpus.substr(i, chunkLen));
+    }
+    const double duration = GetDuration();
+    std::cout << " chunk " << chunkLen << "\n printed " << engine.printed << "\n elapsed " << duration << std::endl;
+}
+
+void ParseConvertedUtf8(std::string_view corpus, const size_t chunkLen)
+{
+    PrintHeader(__func__);
+    auto enginePtr{ std::make_unique<NullEngine>() };
+    const auto& engine{ *enginePtr };
+    StateMachine machine{ std::move(enginePtr) };
+    til::u8state state{};
+    std::wstring u16Str{};
+
+    GetDuration();
+    for (size_t i{}; i < corpus.size(); i += chunkLen)
+    {
+        THROW_IF_FAILED(til::u8u16(corpus.substr(i, chunkLen), u16Str, state));
+        machine.ProcessString(u16Str);
+    }
+    const double duration = GetDuration();
+    std::cout << " chunk " << chunkLen << "\n printed " << engine.printed << "\n elapsed " << duration << std::endl;
+}
+
+void ParseUtf8(std::string_view corpus, const size_t chunkLen)
+{
+    PrintHeader(__func__);
+    auto enginePtr{ std::make_unique<NullEngine>() };
+    const auto& engine{ *enginePtr };
+    StateMachine machine{ std::move(enginePtr) };
+
+    GetDuration();
+    for (size_t i{}; i < corpus.size(); i += chunkLen)
+    {
+        machine.ProcessString(corpus.substr(i, chunkLen));
+    }
+    const double duration = GetDuration();
+    std::cout << " chunk " << chunkLen << "\n printed " << engine.printed << "\n elapsed " << duration << std::endl;
+}
+
+void RunCorpus(const char* const name, const std::wstring& corpus)
+{
+    std::cout << "\n\n### " << name << " (" << corpus.size() << " code units) ###" << std::endl;
+
+    Scan("GroundScanner::FindActionableScalar", corpus, [](const std::wstring_view string) { return GroundScanner::FindActionableScalar(string); });
+    Scan("GroundScanner::FindActionable", corpus, [](const std::wstring_view string) { return GroundScanner::FindActionable(string); });
+
+    // ConptyConnection hands the state machine 4 KB at a time.
+    Parse(corpus, 4096);
+    Parse(corpus, corpus.size());
+
+    const auto u8Corpus{ til::u16u8(corpus) };
+    ParseConvertedUtf8(u8Corpus, 4096);
+    ParseUtf8(u8Corpus, 4096);
+}
+
+int main()
+{
+    // UTF-16 corpus length
+    constexpr size_t u16Length{ 64u * 1024u * 1024u };
+
+    RunCorpus("ASCII", MakeAsciiCorpus(u16Length));
+    RunCorpus("CJK", MakeCjkCorpus(u16Length));
+    RunCorpus("Escape heavy", MakeEscapeHeavyCorpus(u16Length));
+
+    return 0;
+}
+
+// returns the time elapsed between two calls (the return value of the first call is undefined)
+double GetDuration()
+{
+    static std::chrono::time_point<std::chrono::high_resolution_clock> previous{};
+    const auto current = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = current - previous;
+    previous = current;
+    return elapsed.count();
+}
+
+// print the header for a test in function funcName
+void PrintHeader(const char* const funcName)
+{
+    std::cout << "\n~~~\ntest \"" << funcName << "\"" << std::endl;
+}
@@ -14,11 +14,6 @@ namespace
         CodepointWidth width;
     };
 
-    static bool operator<(const UnicodeRange& range, const unsigned int searchTerm) noexcept
-    {
-        return range.upperBound < searchTerm;
-    }
-
     // Generated by Generate-CodepointWidthsFromUCD.ps1 -Pack:True -Full:False -NoOverrides:False
     // on 10/25/2020 7:32:04 AM (UTC) from Unicode 13.0.0.
     // 321205 (0x4E6B5) codepoints covered.
@@ -321,6 +316,76 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous },
     };
+
+    // The widths of all codepoints, built from s_wideAndAmbiguousTable, so
+    // that looking one up doesn't need a binary search. It's a two-level
+    // table: the upper bits of a codepoint select a block of 256 widths, the
+    // lower bits the width in that block. Most blocks are alike (all narrow,
+    // for instance), so every distinct block is stored only once. A width
+    // takes 2 bits, the values of CodepointWidth::Narrow/Wide/Ambiguous.
+    class WidthTable final
+    {
+    public:
+        WidthTable()
+        {
+            std::map<Block, uint16_t> blockIndices;
+            auto range = s_wideAndAmbiguousTable.begin();
+
+            for (unsigned int blockStart = 0; blockStart < CodepointCount; blockStart += BlockSize)
+            {
+                const auto blockEnd = blockStart + BlockSize - 1;
+                Block block{};
+
+                // Ranges can span several blocks, so don't skip a range
+                // before we're past its end.
+                while (range != s_wideAndAmbiguousTable.end() && range->upperBound < blockStart)
+                {
+                    ++range;
+                }
+                for (auto it = range; it != s_wideAndAmbiguousTable.end() && it->lowerBound <= blockEnd; ++it)
+                {
+                    const auto first = std::max(it->lowerBound, blockStart) - blockStart;
+                    const auto last = std::min(it->upperBound, blockEnd) - blockStart;
+                    for (auto i = first; i <= last; ++i)
+                    {
+                        til::at(block, i / 4) |= static_cast<uint8_t>(static_cast<uint8_t>(it->width) << (i % 4 * 2));
+                    }
+                }
+
+                const auto [entry, inserted] = blockIndices.emplace(block, gsl::narrow<uint16_t>(blockIndices.size()));
+                if (inserted)
+                {
+                    _blocks.emplace_back(block);
+                }
+                til::at(_index, blockStart / BlockSize) = entry->second;
+            }
+        }
+
+        CodepointWidth Lookup(const unsigned int codepoint) const noexcept
+        {
+            if (codepoint >= CodepointCount)
+            {
+                return CodepointWidth::Narrow;
+            }
+            const auto& block = til::at(_blocks, til::at(_index, codepoint / BlockSize));
+            const auto i = codepoint % BlockSize;
+            return static_cast<CodepointWidth>((til::at(block, i / 4) >> (i % 4 * 2)) & 0b11);
+        }
+
+    private:
+        static constexpr unsigned int CodepointCount = 0x110000;
+        static constexpr unsigned int BlockSize = 256;
+        using Block = std::array<uint8_t, BlockSize / 4>;
+
+        std::array<uint16_t, CodepointCount / BlockSize> _index{};
+        std::vector<Block> _blocks;
+    };
+
+    const WidthTable& s_widthTable()
+    {
+        static const WidthTable table;
+        return table;
+    }
 }
 
 // Routine Description:
@@ -404,7 +469,35 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
 }
 
 // Routine Description:
-// - returns the width type of codepoint by searching the map generated from the unicode spec
+// - returns the width type of every codepoint in the given text. This saves the
+//   caller from splitting the text into codepoints to measure a whole run.
+// Arguments:
+// - text - the utf16 encoded text to measure
+// - widths - receives one width per codepoint
+// Return Value:
+// - the number of codepoints that were measured. This is less than the number
+//   of codepoints in text if widths is too small for all of them.
+size_t CodepointWidthDetector::GetWidths(const std::wstring_view text, const gsl::span<CodepointWidth> widths) const
+{
+    size_t measured = 0;
+    for (size_t i = 0; i < text.size() && measured < widths.size(); ++measured)
+    {
+        // A surrogate pair is measured as a whole. A lone surrogate is
+        // measured on its own, like GetWidth would.
+        size_t length = 1;
+        if (IS_HIGH_SURROGATE(til::at(text, i)) && i + 1 < text.size() && IS_LOW_SURROGATE(til::at(text, i + 1)))
+        {
+            length = 2;
+        }
+
+        til::at(widths, measured) = GetWidth(text.substr(i, length));
+        i += length;
+    }
+    return measured;
+}
+
+// Routine Description:
+// - returns the width type of codepoint by looking it up in the table generated from the unicode spec
 // Arguments:
 // - glyph - the utf16 encoded codepoint to search for
 // Return Value:
@@ -416,17 +509,7 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidth(const std::wstring_view
         return CodepointWidth::Invalid;
     }
 
-    const auto codepoint = _extractCodepoint(glyph);
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
-
-    // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
-    // We must check its bounds to make sure that our hit was a true hit.
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
-    {
-        return it->width;
-    }
-
-    return CodepointWidth::Narrow;
+    return s_widthTable().Lookup(_extractCodepoint(glyph));
 }
 
 // Routine Description:
@@ -476,20 +559,15 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidthWithCache(const std::wst
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
-
-    // TODO: Cache needs to be emptied when font changes.
-    const auto it = _fallbackCache.find(findMe);
-    if (it == _fallbackCache.end())
-    {
-        auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
-        return result;
-    }
-    else
+    const auto codepoint = _extractCodepoint(glyph);
+    auto& entry = til::at(_fallbackCache, codepoint % FallbackCacheSize);
+    if (entry.codepoint != codepoint)
     {
-        return it->second;
+        // Evict whatever was in this slot before.
+        entry.isWide = _pfnFallbackMethod(glyph);
+        entry.codepoint = codepoint;
     }
+    return entry.isWide;
 }
 
 // Routine Description:
@@ -542,5 +620,5 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() const noexcept
 {
-    _fallbackCache.clear();
+    _fallbackCache.fill({});
 }
@@ -31,6 +31,7 @@ public:
     CodepointWidthDetector& operator=(CodepointWidthDetector&&) = delete;
 
     CodepointWidth GetWidth(const std::wstring_view glyph) const;
+    size_t GetWidths(const std::wstring_view text, const gsl::span<CodepointWidth> widths) const;
     bool IsWide(const std::wstring_view glyph) const;
     bool IsWide(const wchar_t wch) const noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view)> pfnFallback);
@@ -46,6 +47,15 @@ private:
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
 
-    mutable std::unordered_map<std::wstring, bool> _fallbackCache;
+    // The answers of the fallback method for the last few ambiguous codepoints,
+    // in a slot that's picked by the lower bits of the codepoint. Codepoints
+    // next to each other (like in a Cyrillic or Greek text) don't evict each other.
+    struct FallbackCacheEntry
+    {
+        unsigned int codepoint; // 0 if the slot is empty. U+0000 is never ambiguous.
+        bool isWide;
+    };
+    static constexpr size_t FallbackCacheSize = 256;
+    mutable std::array<FallbackCacheEntry, FallbackCacheSize> _fallbackCache;
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
@@ -20,6 +20,7 @@ class ConPtyTests
     TEST_METHOD(SurvivesOnBreakOutput);
     TEST_METHOD(DiesOnBreakBoth);
     TEST_METHOD(DiesOnClose);
+    TEST_METHOD(SurvivesDumpApiStatistics);
 };
 
 HRESULT _CreatePseudoConsole(const COORD size,
@@ -455,3 +456,69 @@ void ConPtyTests::DiesOnClose()
     GetExitCodeProcess(hConPtyProcess.get(), &dwExit);
     VERIFY_ARE_NOT_EQUAL(dwExit, (DWORD)STILL_ACTIVE);
 }
+
+void ConPtyTests::SurvivesDumpApiStatistics()
+{
+    PseudoConsole pty = { 0 };
+    wil::unique_handle outPipeOurSide;
+    wil::unique_handle inPipeOurSide;
+    wil::unique_handle outPipePseudoConsoleSide;
+    wil::unique_handle inPipePseudoConsoleSide;
+    SECURITY_ATTRIBUTES sa;
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+    sa.lpSecurityDescriptor = nullptr;
+    VERIFY_IS_TRUE(CreatePipe(inPipePseudoConsoleSide.addressof(), inPipeOurSide.addressof(), &sa, 0));
+    VERIFY_IS_TRUE(CreatePipe(outPipeOurSide.addressof(), outPipePseudoConsoleSide.addressof(), &sa, 0));
+    VERIFY_IS_TRUE(SetHandleInformation(inPipeOurSide.get(), HANDLE_FLAG_INHERIT, 0));
+    VERIFY_IS_TRUE(SetHandleInformation(outPipeOurSide.get(), HANDLE_FLAG_INHERIT, 0));
+
+    VERIFY_SUCCEEDED(
+        _CreatePseudoConsole(defaultSize,
+                             inPipePseudoConsoleSide.get(),
+                             outPipePseudoConsoleSide.get(),
+                             0,
+                             &pty));
+    auto closePty1 = wil::scope_exit([&] {
+        _ClosePseudoConsoleMembers(&pty);
+    });
+
+    // The statistics can be asked for before any client connected...
+    VERIFY_SUCCEEDED(_DumpApiStatisticsPseudoConsole(&pty));
+
+    STARTUPINFOEXW siEx;
+    siEx = { 0 };
+    siEx.StartupInfo.cb = sizeof(STARTUPINFOEXW);
+    size_t size;
+    VERIFY_IS_FALSE(InitializeProcThreadAttributeList(NULL, 1, 0, (PSIZE_T)&size));
+    BYTE* attrList = new BYTE[size];
+    auto freeAttrList = wil::scope_exit([&] {
+        delete[] attrList;
+    });
+
+    siEx.lpAttributeList = reinterpret_cast<PPROC_THREAD_ATTRIBUTE_LIST>(attrList);
+    VERIFY_IS_TRUE(InitializeProcThreadAttributeList(siEx.lpAttributeList, 1, 0, (PSIZE_T)&size));
+    auto deleteAttrList = wil::scope_exit([&] {
+        DeleteProcThreadAttributeList(siEx.lpAttributeList);
+    });
+    VERIFY_SUCCEEDED(
+        AttachPseudoConsole(reinterpret_cast<HPCON>(&pty), siEx.lpAttributeList));
+
+    wil::unique_process_information piClient;
+    std::wstring realCommand = L"cmd.exe";
+    _CreateChildProcess(realCommand, &siEx, piClient.addressof());
+
+    DWORD dwExit;
+    VERIFY_IS_TRUE(GetExitCodeProcess(piClient.hProcess, &dwExit));
+    VERIFY_ARE_EQUAL(dwExit, (DWORD)STILL_ACTIVE);
+
+    // ... and while a client is making calls.
+    VERIFY_SUCCEEDED(_DumpApiStatisticsPseudoConsole(&pty));
+    VERIFY_ARE_EQUAL(E_INVALIDARG, _DumpApiStatisticsPseudoConsole(nullptr));
+
+    // An unknown signal would tear down the signal thread, and with it the
+    // conpty. Make sure it's still alive.
+    VERIFY_ARE_EQUAL(WaitForSingleObject(pty.hConPtyProcess, 2000), (DWORD)WAIT_TIMEOUT);
+    VERIFY_IS_TRUE(GetExitCodeProcess(pty.hConPtyProcess, &dwExit));
+    VERIFY_ARE_EQUAL(dwExit, (DWORD)STILL_ACTIVE);
+}
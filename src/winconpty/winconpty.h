@@ -19,12 +19,14 @@ typedef struct _PseudoConsole
 //      the signal pipe.
 #define PTY_SIGNAL_CLEAR_WINDOW (2u)
 #define PTY_SIGNAL_RESIZE_WINDOW (8u)
+#define PTY_SIGNAL_DUMP_API_STATISTICS (16u)
 
 // CreatePseudoConsole Flags
 // The other flag (PSEUDOCONSOLE_INHERIT_CURSOR) is actually defined in consoleapi.h in the OS repo
 // #define PSEUDOCONSOLE_INHERIT_CURSOR (0x1)
 #define PSEUDOCONSOLE_RESIZE_QUIRK (0x2)
 #define PSEUDOCONSOLE_WIN32_INPUT_MODE (0x4)
+#define PSEUDOCONSOLE_PASSTHROUGH_MODE (0x8)
 
 // Implementations of the various PseudoConsole functions.
 HRESULT _CreatePseudoConsole(const HANDLE hToken,
@@ -36,6 +38,7 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
 
 HRESULT _ResizePseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const COORD size);
 HRESULT _ClearPseudoConsole(_In_ const PseudoConsole* const pPty);
+HRESULT _DumpApiStatisticsPseudoConsole(_In_ const PseudoConsole* const pPty);
 void _ClosePseudoConsoleMembers(_In_ PseudoConsole* pPty);
 VOID _ClosePseudoConsole(_In_ PseudoConsole* pPty);
 